@@ -17,12 +17,52 @@
 #include "EtcConfig.h"
 #include "Etc.h"
 #include "EtcThreadedExecutor.h"
+#include "EtcBlock4x4EncodingArena.h"
 #include "EtcFilter.h"
 
+#include <algorithm>
+#include <chrono>
 #include <cstring>
+#include <thread>
+#include <vector>
 
 namespace Etc
 {
+	// ----------------------------------------------------------------------------------------------------
+	// encode a source image of any of the source formats Image can be constructed from
+	//
+	template <typename T>
+	static void EncodeSource(T *a_paSourceRGBA,
+				unsigned int a_uiSourceWidth, 
+				unsigned int a_uiSourceHeight,
+				Image::Format a_format,
+				ErrorMetric a_eErrMetric,
+				float a_fEffort,
+				unsigned int a_uiJobs,
+				unsigned int a_uiMaxJobs,
+				unsigned char **a_ppaucEncodingBits,
+				unsigned int *a_puiEncodingBitsBytes,
+				unsigned int *a_puiExtendedWidth,
+				unsigned int *a_puiExtendedHeight, 
+				int *a_piEncodingTime_ms, bool a_bVerboseOutput,
+				DiskCache *a_pdiskcache)
+	{
+
+		Image image(a_paSourceRGBA, a_uiSourceWidth,
+					a_uiSourceHeight,
+					a_eErrMetric);
+		ThreadedExecutor executor(image);
+		executor.m_bVerboseOutput = a_bVerboseOutput;
+		executor.SetDiskCache(a_pdiskcache);
+		auto result = TimeEncode(executor, a_format, a_eErrMetric, a_fEffort, a_uiJobs, a_uiMaxJobs);
+
+		*a_ppaucEncodingBits = executor.GetEncodingBits();
+		*a_puiEncodingBitsBytes = executor.GetEncodingBitsBytes();
+		*a_puiExtendedWidth = image.GetExtendedWidth();
+		*a_puiExtendedHeight = image.GetExtendedHeight();
+		*a_piEncodingTime_ms = result.m_msEncodeTime.count();
+	}
+
 	// ----------------------------------------------------------------------------------------------------
 	// C-style inteface to the encoder
 	//
@@ -38,7 +78,89 @@ namespace Etc
 				unsigned int *a_puiEncodingBitsBytes,
 				unsigned int *a_puiExtendedWidth,
 				unsigned int *a_puiExtendedHeight, 
-				int *a_piEncodingTime_ms, bool a_bVerboseOutput)
+				int *a_piEncodingTime_ms, bool a_bVerboseOutput,
+				DiskCache *a_pdiskcache)
+	{
+		EncodeSource(a_pafSourceRGBA, a_uiSourceWidth, a_uiSourceHeight, a_format, a_eErrMetric,
+						a_fEffort, a_uiJobs, a_uiMaxJobs, a_ppaucEncodingBits, a_puiEncodingBitsBytes,
+						a_puiExtendedWidth, a_puiExtendedHeight, a_piEncodingTime_ms, a_bVerboseOutput, a_pdiskcache);
+	}
+
+	void Encode(const unsigned char *a_paucSourceRGBA8,
+				unsigned int a_uiSourceWidth, 
+				unsigned int a_uiSourceHeight,
+				Image::Format a_format,
+				ErrorMetric a_eErrMetric,
+				float a_fEffort,
+				unsigned int a_uiJobs,
+				unsigned int a_uiMaxJobs,
+				unsigned char **a_ppaucEncodingBits,
+				unsigned int *a_puiEncodingBitsBytes,
+				unsigned int *a_puiExtendedWidth,
+				unsigned int *a_puiExtendedHeight, 
+				int *a_piEncodingTime_ms, bool a_bVerboseOutput,
+				DiskCache *a_pdiskcache)
+	{
+		EncodeSource(a_paucSourceRGBA8, a_uiSourceWidth, a_uiSourceHeight, a_format, a_eErrMetric,
+						a_fEffort, a_uiJobs, a_uiMaxJobs, a_ppaucEncodingBits, a_puiEncodingBitsBytes,
+						a_puiExtendedWidth, a_puiExtendedHeight, a_piEncodingTime_ms, a_bVerboseOutput, a_pdiskcache);
+	}
+
+	void Encode(const unsigned short *a_paushSourceRGBA16,
+				unsigned int a_uiSourceWidth, 
+				unsigned int a_uiSourceHeight,
+				Image::Format a_format,
+				ErrorMetric a_eErrMetric,
+				float a_fEffort,
+				unsigned int a_uiJobs,
+				unsigned int a_uiMaxJobs,
+				unsigned char **a_ppaucEncodingBits,
+				unsigned int *a_puiEncodingBitsBytes,
+				unsigned int *a_puiExtendedWidth,
+				unsigned int *a_puiExtendedHeight, 
+				int *a_piEncodingTime_ms, bool a_bVerboseOutput,
+				DiskCache *a_pdiskcache)
+	{
+		EncodeSource(a_paushSourceRGBA16, a_uiSourceWidth, a_uiSourceHeight, a_format, a_eErrMetric,
+						a_fEffort, a_uiJobs, a_uiMaxJobs, a_ppaucEncodingBits, a_puiEncodingBitsBytes,
+						a_puiExtendedWidth, a_puiExtendedHeight, a_piEncodingTime_ms, a_bVerboseOutput, a_pdiskcache);
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	//
+	unsigned int GetEncodingBitsBytes(unsigned int a_uiSourceWidth,
+										unsigned int a_uiSourceHeight,
+										Image::Format a_format)
+	{
+		Block4x4EncodingBits::Format encodingbitsformat = DetermineEncodingBitsFormat(a_format);
+		if (encodingbitsformat == Block4x4EncodingBits::Format::UNKNOWN)
+		{
+			return 0;
+		}
+
+		unsigned int uiBlocks = (Image::CalcExtendedDimension((unsigned short)a_uiSourceWidth) >> 2) *
+								(Image::CalcExtendedDimension((unsigned short)a_uiSourceHeight) >> 2);
+
+		return uiBlocks * Block4x4EncodingBits::GetBytesPerBlock(encodingbitsformat);
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// encode straight into a_paucEncodingBits, with no allocation of the encoding bits by the library
+	//
+	Executor::EncodingStatus Encode(float *a_pafSourceRGBA,
+				unsigned int a_uiSourceWidth, 
+				unsigned int a_uiSourceHeight,
+				Image::Format a_format,
+				ErrorMetric a_eErrMetric,
+				float a_fEffort,
+				unsigned int a_uiJobs,
+				unsigned int a_uiMaxJobs,
+				unsigned char *a_paucEncodingBits,
+				unsigned int a_uiEncodingBitsBytes,
+				unsigned int *a_puiExtendedWidth,
+				unsigned int *a_puiExtendedHeight, 
+				int *a_piEncodingTime_ms, bool a_bVerboseOutput,
+				DiskCache *a_pdiskcache)
 	{
 
 		Image image(a_pafSourceRGBA, a_uiSourceWidth,
@@ -46,16 +168,136 @@ namespace Etc
 					a_eErrMetric);
 		ThreadedExecutor executor(image);
 		executor.m_bVerboseOutput = a_bVerboseOutput;
+		executor.SetDiskCache(a_pdiskcache);
+		executor.SetEncodingBitsBuffer(a_paucEncodingBits, a_uiEncodingBitsBytes);
 		auto result = TimeEncode(executor, a_format, a_eErrMetric, a_fEffort, a_uiJobs, a_uiMaxJobs);
 
-		*a_ppaucEncodingBits = executor.GetEncodingBits();
-		*a_puiEncodingBitsBytes = executor.GetEncodingBitsBytes();
 		*a_puiExtendedWidth = image.GetExtendedWidth();
 		*a_puiExtendedHeight = image.GetExtendedHeight();
 		*a_piEncodingTime_ms = result.m_msEncodeTime.count();
+
+		return result.m_status;
 	}
 
-	void EncodeMipmaps(float *a_pafSourceRGBA,
+	// levels of fewer blocks than this per job are too small to keep every job busy
+	// they are encoded side by side, a job each, once the larger levels are done
+	static const unsigned int TAIL_MIPMAP_BLOCKS_PER_JOB = 64;
+
+	struct MipmapLevel
+	{
+		float *pafImage;
+		unsigned int uiWidth;
+		unsigned int uiHeight;
+	};
+
+	// ----------------------------------------------------------------------------------------------------
+	// the float pixels of level 0 that FilterTwoPass filters from
+	// an RGBA8 source is converted to a float copy, which the caller deletes
+	//
+	static float *GetFloatMipmapSource(float *a_pafSourceRGBA, unsigned int, unsigned int, float **a_ppafCopy)
+	{
+		*a_ppafCopy = nullptr;
+		return a_pafSourceRGBA;
+	}
+
+	static float *GetFloatMipmapSource(const unsigned char *a_paucSourceRGBA8, unsigned int a_uiSourceWidth,
+										unsigned int a_uiSourceHeight, float **a_ppafCopy)
+	{
+		unsigned int const uiFloats = a_uiSourceWidth * a_uiSourceHeight * 4;
+		*a_ppafCopy = new float[uiFloats];
+		for (unsigned int uiFloat = 0; uiFloat < uiFloats; uiFloat++)
+		{
+			(*a_ppafCopy)[uiFloat] = a_paucSourceRGBA8[uiFloat] / 255.0f;
+		}
+		return *a_ppafCopy;
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// filter levels [a_uiFirstLevel, a_uiEndLevel)
+	// with MipFilter::LANCZOS3, each level is filtered from the source or cascaded from the level before it,
+	// and with the other filters each level is a halving of the level before it, level 1 of a_paSourceRGBA
+	// the rows of each level are filtered on the threads of a_pthreadpool, alongside any encode running on them
+	// returns the number of levels that were filtered before one failed
+	//
+	template <typename T>
+	static unsigned int FilterMipmaps(T *a_paSourceRGBA, MipmapLevel *a_palevels,
+										unsigned int a_uiFirstLevel, unsigned int a_uiEndLevel,
+										unsigned int a_uiSourceFilteredMipmaps, unsigned int a_uiMipFilterFlags,
+										MipFilter a_mipfilter, ThreadPool *a_pthreadpool)
+	{
+		for (unsigned int uiLevel = a_uiFirstLevel; uiLevel < a_uiEndLevel; uiLevel++)
+		{
+			MipmapLevel const &to = a_palevels[uiLevel];
+			int iFiltered;
+
+			if (a_mipfilter == MipFilter::LANCZOS3)
+			{
+				MipmapLevel const &from = (uiLevel <= a_uiSourceFilteredMipmaps) ? a_palevels[0] : a_palevels[uiLevel - 1];
+				iFiltered = FilterTwoPass(from.pafImage, from.uiWidth, from.uiHeight, to.pafImage, to.uiWidth, to.uiHeight,
+											a_uiMipFilterFlags, Etc::FilterLanczos3, a_pthreadpool);
+			}
+			else
+			{
+				MipmapLevel const &from = a_palevels[uiLevel - 1];
+				iFiltered = (uiLevel == 1) ?
+								FilterHalve(a_paSourceRGBA, from.uiWidth, from.uiHeight, to.pafImage, to.uiWidth, to.uiHeight,
+											a_mipfilter, a_uiMipFilterFlags, a_pthreadpool) :
+								FilterHalve(from.pafImage, from.uiWidth, from.uiHeight, to.pafImage, to.uiWidth, to.uiHeight,
+											a_mipfilter, a_uiMipFilterFlags, a_pthreadpool);
+			}
+
+			if (!iFiltered)
+			{
+				return uiLevel - a_uiFirstLevel;
+			}
+		}
+
+		return a_uiEndLevel - a_uiFirstLevel;
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// encode one mip level into a_prawimage
+	// returns the encode time in ms
+	//
+	template <typename T>
+	static int EncodeMipmap(T *a_paImage,
+							unsigned int a_uiWidth,
+							unsigned int a_uiHeight,
+							Image::Format a_format,
+							ErrorMetric a_eErrMetric,
+							float a_fEffort,
+							unsigned int a_uiJobs,
+							unsigned int a_uiMaxJobs,
+							ThreadPool *a_pthreadpool,
+							Block4x4EncodingArena *a_parena,
+							bool a_bVerboseOutput,
+							BlockCache *a_pblockcache,
+							DiskCache *a_pdiskcache,
+							RawImage *a_prawimage)
+	{
+		Image image(a_paImage, a_uiWidth, a_uiHeight, a_eErrMetric, a_parena);
+		ThreadedExecutor executor(image, a_pthreadpool);
+		executor.m_bVerboseOutput = a_bVerboseOutput;
+		executor.SetBlockCache(a_pblockcache);
+		executor.SetDiskCache(a_pdiskcache);
+		auto const result = TimeEncode(executor, a_format, a_eErrMetric, a_fEffort, a_uiJobs, a_uiMaxJobs);
+
+		a_prawimage->paucEncodingBits = std::shared_ptr<unsigned char>(executor.GetEncodingBits(), [](unsigned char *p) { delete[] p; });
+		a_prawimage->uiEncodingBitsBytes = executor.GetEncodingBitsBytes();
+		a_prawimage->uiExtendedWidth = image.GetExtendedWidth();
+		a_prawimage->uiExtendedHeight = image.GetExtendedHeight();
+
+		return static_cast<int>(result.m_msEncodeTime.count());
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// encode the mip levels of a float or RGBA8 source image
+	// with more than one job, the next level is filtered on a thread of its own while a level encodes,
+	// and the tail levels, which have too few blocks to keep every job busy, are encoded side by side
+	// the encoding time is the time spent in the encodes, not counting the filtering they overlap
+	//
+	template <typename T>
+	static void EncodeMipmapsSource(T *a_paSourceRGBA,
 		unsigned int a_uiSourceWidth,
 		unsigned int a_uiSourceHeight,
 		Image::Format a_format,
@@ -67,62 +309,210 @@ namespace Etc
 		unsigned int a_uiMipFilterFlags,
 		RawImage* a_pMipmapImages,
 		int *a_piEncodingTime_ms, 
-		bool a_bVerboseOutput)
+		bool a_bVerboseOutput,
+		BlockCache *a_pblockcache,
+		DiskCache *a_pdiskcache,
+		unsigned int a_uiSourceFilteredMipmaps,
+		MipFilter a_mipfilter)
 	{
-		auto mipWidth = a_uiSourceWidth;
-		auto mipHeight = a_uiSourceHeight;
 		int totalEncodingTime = 0;
-		for(unsigned int mip = 0; mip < a_uiMaxMipmaps && mipWidth >= 1 && mipHeight >= 1; mip++)
+
+		std::vector<MipmapLevel> alevels;
+		for (unsigned int mipWidth = a_uiSourceWidth, mipHeight = a_uiSourceHeight;
+				alevels.size() < a_uiMaxMipmaps && mipWidth >= 1 && mipHeight >= 1;
+				mipWidth >>= 1, mipHeight >>= 1)
+		{
+			alevels.push_back({ nullptr, mipWidth, mipHeight });
+		}
+
+		unsigned int uiLevels = static_cast<unsigned int>(alevels.size());
+		if (uiLevels == 0)
+		{
+			*a_piEncodingTime_ms = 0;
+			return;
+		}
+
+		// only FilterTwoPass needs level 0 in float, the halving filters convert each row as they read it
+		float *pafSourceCopy = nullptr;
+		if (a_mipfilter == MipFilter::LANCZOS3)
+		{
+			alevels[0].pafImage = GetFloatMipmapSource(a_paSourceRGBA, a_uiSourceWidth, a_uiSourceHeight, &pafSourceCopy);
+		}
+
+		// one set of worker threads serves every mip level
+		// too many jobs are clamped to a_uiMaxJobs, as ThreadedExecutor::Encode() does
+		unsigned int const uiPoolJobs = std::min(a_uiJobs, a_uiMaxJobs);
+		ThreadPool threadpool((uiPoolJobs > 1) ? uiPoolJobs - 1 : 0);
+		unsigned int const uiJobs = threadpool.GetNumberOfThreads() + 1;
+
+		unsigned int uiFirstTailLevel = uiLevels;
+		if (uiJobs > 1)
+		{
+			while (uiFirstTailLevel > 0)
+			{
+				MipmapLevel const &level = alevels[uiFirstTailLevel - 1];
+				unsigned int const uiBlocks = ((level.uiWidth + 3) >> 2) * ((level.uiHeight + 3) >> 2);
+				if (uiBlocks >= uiJobs * TAIL_MIPMAP_BLOCKS_PER_JOB)
+				{
+					break;
+				}
+				uiFirstTailLevel--;
+			}
+		}
+
+		// the levels before the tail ping-pong between two halves of one scratch buffer, sized for levels 1 and 2,
+		// so that a level filtered from the level before it, or while it encodes, never overwrites it
+		// the tail levels, which are encoded at the same time, each have their own part of a tail buffer
+		unsigned int const uiLevel1Floats = (a_uiSourceWidth >> 1) * (a_uiSourceHeight >> 1) * 4;
+		unsigned int const uiLevel2Floats = (a_uiSourceWidth >> 2) * (a_uiSourceHeight >> 2) * 4;
+		float *pafScratch = (uiFirstTailLevel > 1) ? new float[uiLevel1Floats + uiLevel2Floats] : nullptr;
+
+		unsigned int uiTailFloats = 0;
+		for (unsigned int mip = (uiFirstTailLevel > 1) ? uiFirstTailLevel : 1; mip < uiLevels; mip++)
 		{
-			float* pImageData = nullptr;
-			float* pMipImage = nullptr;
+			uiTailFloats += alevels[mip].uiWidth * alevels[mip].uiHeight * 4;
+		}
+		float *pafTail = (uiTailFloats > 0) ? new float[uiTailFloats] : nullptr;
 
-			if(mip == 0)
+		for (unsigned int mip = 1, uiTailOffset = 0; mip < uiLevels; mip++)
+		{
+			if (mip < uiFirstTailLevel)
 			{
-				pImageData = a_pafSourceRGBA;
+				alevels[mip].pafImage = (mip & 1) ? pafScratch : pafScratch + uiLevel1Floats;
 			}
 			else
 			{
-				pMipImage = new float[mipWidth*mipHeight*4];
-				if(FilterTwoPass(a_pafSourceRGBA, a_uiSourceWidth, a_uiSourceHeight, pMipImage, mipWidth, mipHeight, a_uiMipFilterFlags, Etc::FilterLanczos3) )
-				{
-					pImageData = pMipImage;
-				}
+				alevels[mip].pafImage = pafTail + uiTailOffset;
+				uiTailOffset += alevels[mip].uiWidth * alevels[mip].uiHeight * 4;
 			}
+		}
 
-			if ( pImageData )
+		// the encoders of every level before the tail fit in the storage of the first level
+		Block4x4EncodingArena arena;
+
+		// level 0 is encoded from the source itself, which may not be float
+		auto encodemipmap = [&](unsigned int mip, unsigned int uiEncodeJobs, Block4x4EncodingArena *parena) {
+			MipmapLevel const &level = alevels[mip];
+			return (mip == 0) ?
+					EncodeMipmap(a_paSourceRGBA, level.uiWidth, level.uiHeight, a_format, a_eErrMetric, a_fEffort,
+									uiEncodeJobs, a_uiMaxJobs, &threadpool, parena, a_bVerboseOutput,
+									a_pblockcache, a_pdiskcache, &a_pMipmapImages[mip]) :
+					EncodeMipmap(level.pafImage, level.uiWidth, level.uiHeight, a_format, a_eErrMetric, a_fEffort,
+									uiEncodeJobs, a_uiMaxJobs, &threadpool, parena, a_bVerboseOutput,
+									a_pblockcache, a_pdiskcache, &a_pMipmapImages[mip]);
+		};
+
+		if (uiFirstTailLevel == 0)
+		{
+			uiLevels = 1 + FilterMipmaps(a_paSourceRGBA, alevels.data(), 1, uiLevels, a_uiSourceFilteredMipmaps,
+											a_uiMipFilterFlags, a_mipfilter, &threadpool);
+		}
+
+		for (unsigned int mip = 0; mip < uiFirstTailLevel && mip < uiLevels; mip++)
+		{
+			// the next level, or every level of the tail after the last level before it
+			unsigned int const uiFirstFilteredLevel = mip + 1;
+			unsigned int const uiEndFilteredLevel = (mip + 1 < uiFirstTailLevel) ? mip + 2 : uiLevels;
+			unsigned int uiFilteredLevels = 0;
+
+			auto filter = [&]() {
+				uiFilteredLevels = FilterMipmaps(a_paSourceRGBA, alevels.data(), uiFirstFilteredLevel, uiEndFilteredLevel,
+													a_uiSourceFilteredMipmaps, a_uiMipFilterFlags, a_mipfilter, &threadpool);
+			};
+
+			std::thread filterthread;
+			if (uiJobs > 1 && uiFirstFilteredLevel < uiEndFilteredLevel)
 			{
-			
-				Image image(pImageData, mipWidth, mipHeight,	a_eErrMetric);
-				ThreadedExecutor executor(image);
-				executor.m_bVerboseOutput = a_bVerboseOutput;
-				auto const result = TimeEncode(executor, a_format, a_eErrMetric, a_fEffort, a_uiJobs, a_uiMaxJobs);
-
-				a_pMipmapImages[mip].paucEncodingBits = std::shared_ptr<unsigned char>(executor.GetEncodingBits(), [](unsigned char *p) { delete[] p; });
-				a_pMipmapImages[mip].uiEncodingBitsBytes = executor.GetEncodingBitsBytes();
-			a_pMipmapImages[mip].uiExtendedWidth = image.GetExtendedWidth();
-			a_pMipmapImages[mip].uiExtendedHeight = image.GetExtendedHeight();
-
-				totalEncodingTime += result.m_msEncodeTime.count();
+				filterthread = std::thread(filter);
 			}
 
-			if(pMipImage)
+			totalEncodingTime += encodemipmap(mip, a_uiJobs, &arena);
+
+			if (filterthread.joinable())
+			{
+				filterthread.join();
+			}
+			else
 			{
-				delete[] pMipImage;
+				filter();
 			}
 
-			if (!pImageData)
+			if (uiFilteredLevels < uiEndFilteredLevel - uiFirstFilteredLevel)
 			{
-				break;
+				uiLevels = uiFirstFilteredLevel + uiFilteredLevels;
 			}
+		}
+
+		if (uiFirstTailLevel < uiLevels)
+		{
+			auto const start = std::chrono::steady_clock::now();
 
-			mipWidth >>= 1;
-			mipHeight >>= 1;
+			// the tail levels encode with a job each, out of the same queue of worker threads
+			threadpool.Run(uiLevels - uiFirstTailLevel, [&](unsigned int a_uiTask) {
+				encodemipmap(uiFirstTailLevel + a_uiTask, 1, nullptr);
+			});
+
+			totalEncodingTime += static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+									std::chrono::steady_clock::now() - start).count());
 		}
 
+		delete[] pafScratch;
+		delete[] pafTail;
+		delete[] pafSourceCopy;
+
 		*a_piEncodingTime_ms = totalEncodingTime;
 	}
 
+	// ----------------------------------------------------------------------------------------------------
+	//
+	void EncodeMipmaps(float *a_pafSourceRGBA,
+		unsigned int a_uiSourceWidth,
+		unsigned int a_uiSourceHeight,
+		Image::Format a_format,
+		ErrorMetric a_eErrMetric,
+		float a_fEffort,
+		unsigned int a_uiJobs,
+		unsigned int a_uiMaxJobs,
+		unsigned int a_uiMaxMipmaps,
+		unsigned int a_uiMipFilterFlags,
+		RawImage* a_pMipmapImages,
+		int *a_piEncodingTime_ms, 
+		bool a_bVerboseOutput,
+		BlockCache *a_pblockcache,
+		DiskCache *a_pdiskcache,
+		unsigned int a_uiSourceFilteredMipmaps,
+		MipFilter a_mipfilter)
+	{
+		EncodeMipmapsSource(a_pafSourceRGBA, a_uiSourceWidth, a_uiSourceHeight, a_format, a_eErrMetric, a_fEffort,
+							a_uiJobs, a_uiMaxJobs, a_uiMaxMipmaps, a_uiMipFilterFlags, a_pMipmapImages,
+							a_piEncodingTime_ms, a_bVerboseOutput, a_pblockcache, a_pdiskcache,
+							a_uiSourceFilteredMipmaps, a_mipfilter);
+	}
+
+	void EncodeMipmaps(const unsigned char *a_paucSourceRGBA8,
+		unsigned int a_uiSourceWidth,
+		unsigned int a_uiSourceHeight,
+		Image::Format a_format,
+		ErrorMetric a_eErrMetric,
+		float a_fEffort,
+		unsigned int a_uiJobs,
+		unsigned int a_uiMaxJobs,
+		unsigned int a_uiMaxMipmaps,
+		unsigned int a_uiMipFilterFlags,
+		RawImage* a_pMipmapImages,
+		int *a_piEncodingTime_ms, 
+		bool a_bVerboseOutput,
+		BlockCache *a_pblockcache,
+		DiskCache *a_pdiskcache,
+		unsigned int a_uiSourceFilteredMipmaps,
+		MipFilter a_mipfilter)
+	{
+		EncodeMipmapsSource(a_paucSourceRGBA8, a_uiSourceWidth, a_uiSourceHeight, a_format, a_eErrMetric, a_fEffort,
+							a_uiJobs, a_uiMaxJobs, a_uiMaxMipmaps, a_uiMipFilterFlags, a_pMipmapImages,
+							a_piEncodingTime_ms, a_bVerboseOutput, a_pblockcache, a_pdiskcache,
+							a_uiSourceFilteredMipmaps, a_mipfilter);
+	}
+
 
 	// ----------------------------------------------------------------------------------------------------
 	//
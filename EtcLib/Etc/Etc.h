@@ -18,8 +18,11 @@
 
 #include "EtcConfig.h"
 #include "EtcImage.h"
+#include "EtcExecutor.h"
 #include "EtcColor.h"
 #include "EtcErrorMetric.h"
+#include "EtcFilter.h"
+#include <climits>
 #include <memory>
 
 namespace Etc
@@ -29,6 +32,8 @@ namespace Etc
 	constexpr float ETCCOMP_MAX_EFFORT_LEVEL = 100.0f;
 
 	class Block4x4EncodingBits;
+	class BlockCache;
+	class DiskCache;
 
 	struct RawImage
 	{
@@ -41,6 +46,8 @@ namespace Etc
 
 
 	// C-style inteface to the encoder
+	// a_pdiskcache, if not null, copies the encodings of the images or rows of blocks that an earlier encode
+	// with the same settings stored in it, see Executor::SetDiskCache()
 	void Encode(float *a_pafSourceRGBA,
 				unsigned int a_uiSourceWidth,
 				unsigned int a_uiSourceHeight,
@@ -53,8 +60,74 @@ namespace Etc
 				unsigned int *a_puiEncodingBitsBytes,
 				unsigned int *a_puiExtendedWidth,
 				unsigned int *a_puiExtendedHeight,
-				int *a_piEncodingTime_ms, bool a_bVerboseOutput = false);
+				int *a_piEncodingTime_ms, bool a_bVerboseOutput = false,
+				DiskCache *a_pdiskcache = nullptr);
 
+	// same as above for 8 and 16 bit per channel RGBA sources
+	// the source is converted to float per 4x4 block, so no float copy of the image is needed
+	void Encode(const unsigned char *a_paucSourceRGBA8,
+				unsigned int a_uiSourceWidth,
+				unsigned int a_uiSourceHeight,
+				Image::Format a_format,
+				ErrorMetric a_eErrMetric,
+				float a_fEffort,
+				unsigned int a_uiJobs,
+				unsigned int a_uimaxJobs,
+				unsigned char **a_ppaucEncodingBits,
+				unsigned int *a_puiEncodingBitsBytes,
+				unsigned int *a_puiExtendedWidth,
+				unsigned int *a_puiExtendedHeight,
+				int *a_piEncodingTime_ms, bool a_bVerboseOutput = false,
+				DiskCache *a_pdiskcache = nullptr);
+
+	void Encode(const unsigned short *a_paushSourceRGBA16,
+				unsigned int a_uiSourceWidth,
+				unsigned int a_uiSourceHeight,
+				Image::Format a_format,
+				ErrorMetric a_eErrMetric,
+				float a_fEffort,
+				unsigned int a_uiJobs,
+				unsigned int a_uimaxJobs,
+				unsigned char **a_ppaucEncodingBits,
+				unsigned int *a_puiEncodingBitsBytes,
+				unsigned int *a_puiExtendedWidth,
+				unsigned int *a_puiExtendedHeight,
+				int *a_piEncodingTime_ms, bool a_bVerboseOutput = false,
+				DiskCache *a_pdiskcache = nullptr);
+
+	// number of encoding bits bytes for an image of the given size and format
+	// 0 if a_format is unknown
+	unsigned int GetEncodingBitsBytes(unsigned int a_uiSourceWidth,
+										unsigned int a_uiSourceHeight,
+										Image::Format a_format);
+
+	// encode into memory owned by the caller, e.g. a mapped file or a staging buffer
+	// a_uiEncodingBitsBytes must be at least GetEncodingBitsBytes() for the image,
+	// else nothing is encoded and ERROR_ENCODING_BITS_BUFFER_TOO_SMALL is returned
+	Executor::EncodingStatus Encode(float *a_pafSourceRGBA,
+				unsigned int a_uiSourceWidth,
+				unsigned int a_uiSourceHeight,
+				Image::Format a_format,
+				ErrorMetric a_eErrMetric,
+				float a_fEffort,
+				unsigned int a_uiJobs,
+				unsigned int a_uimaxJobs,
+				unsigned char *a_paucEncodingBits,
+				unsigned int a_uiEncodingBitsBytes,
+				unsigned int *a_puiExtendedWidth,
+				unsigned int *a_puiExtendedHeight,
+				int *a_piEncodingTime_ms, bool a_bVerboseOutput = false,
+				DiskCache *a_pdiskcache = nullptr);
+
+	// a_pblockcache, if not null, copies the encodings of blocks that repeat within and across the mip levels
+	// and across calls given the same cache, see Executor::SetBlockCache()
+	// a_pdiskcache, if not null, does the same for the images or rows of blocks of every mip level, see Etc::Encode()
+	// the first a_uiSourceFilteredMipmaps levels after level 0 are filtered from the source, and each later level
+	// from the level before it, which reads a quarter of the pixels for every level instead of the whole source
+	// with more than one job, each level is filtered while the level before it encodes, and the small levels
+	// at the end of the chain are encoded at the same time, with a job each
+	// a_mipfilter other than MipFilter::LANCZOS3 makes each level by halving the level before it, see FilterHalve(),
+	// and ignores a_uiSourceFilteredMipmaps; FILTER_SRGB in a_uiMipFilterFlags filters sRGB sources in linear light
 	void EncodeMipmaps(float *a_pafSourceRGBA,
 		unsigned int a_uiSourceWidth,
 		unsigned int a_uiSourceHeight,
@@ -66,6 +139,30 @@ namespace Etc
 		unsigned int a_uiMaxMipmaps,
 		unsigned int a_uiMipFilterFlags,
 		RawImage* a_pMipmaps,
-		int *a_piEncodingTime_ms, bool a_bVerboseOutput = false);
+		int *a_piEncodingTime_ms, bool a_bVerboseOutput = false,
+		BlockCache *a_pblockcache = nullptr,
+		DiskCache *a_pdiskcache = nullptr,
+		unsigned int a_uiSourceFilteredMipmaps = UINT_MAX,
+		MipFilter a_mipfilter = MipFilter::LANCZOS3);
+
+	// same as above for an RGBA8 source
+	// level 0 is encoded from the source as Etc::Encode() does, and the halving filters convert the rows
+	// of the source to float as they read them, so only MipFilter::LANCZOS3 makes a float copy of the source
+	void EncodeMipmaps(const unsigned char *a_paucSourceRGBA8,
+		unsigned int a_uiSourceWidth,
+		unsigned int a_uiSourceHeight,
+		Image::Format a_format,
+		ErrorMetric a_eErrMetric,
+		float a_fEffort,
+		unsigned int a_uiJobs,
+		unsigned int a_uiMaxJobs,
+		unsigned int a_uiMaxMipmaps,
+		unsigned int a_uiMipFilterFlags,
+		RawImage* a_pMipmaps,
+		int *a_piEncodingTime_ms, bool a_bVerboseOutput = false,
+		BlockCache *a_pblockcache = nullptr,
+		DiskCache *a_pdiskcache = nullptr,
+		unsigned int a_uiSourceFilteredMipmaps = UINT_MAX,
+		MipFilter a_mipfilter = MipFilter::LANCZOS3);
 
 }
@@ -0,0 +1,142 @@
+#include <cassert>
+#include <cstring>
+
+#include "EtcBlockCache.h"
+#include "EtcKeyHasher.h"
+
+namespace Etc {
+
+	// ----------------------------------------------------------------------------------------------------
+	//
+	bool BlockCache::Key::operator==(Key const& a_key) const
+	{
+		return auiHash[0] == a_key.auiHash[0] &&
+				auiHash[1] == a_key.auiHash[1] &&
+				uiFormat == a_key.uiFormat &&
+				uiErrorMetric == a_key.uiErrorMetric &&
+				memcmp(&fEffort, &a_key.fEffort, sizeof(fEffort)) == 0;
+	}
+
+	// the pixel hash is already well mixed
+	std::size_t BlockCache::KeyHash::operator()(Key const& a_key) const
+	{
+		return static_cast<std::size_t>(a_key.auiHash[0] ^ (a_key.auiHash[1] >> 7) ^ a_key.uiFormat ^
+										(static_cast<std::uint64_t>(a_key.uiErrorMetric) << 8));
+	}
+
+	BlockCache::BlockCache(unsigned int a_uiMaxEntries)
+		: m_uiMaxEntries(a_uiMaxEntries)
+		, m_uiHits(0)
+		, m_uiMisses(0)
+	{
+		assert(m_uiMaxEntries > 0);
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// the pixels are hashed as bits, so that the NAN border pixels of identical blocks are equal
+	//
+	void BlockCache::MakeKey(const ColorFloatRGBA *a_pafrgbaSource, Image::Format a_format,
+								ErrorMetric a_errormetric, float a_fEffort, Key *a_pkey)
+	{
+		static_assert(sizeof(ColorFloatRGBA) == 4 * sizeof(std::uint32_t), "ColorFloatRGBA must be 4 floats");
+
+		KeyHasher hasher;
+		hasher.Add(a_pafrgbaSource, 16 * sizeof(ColorFloatRGBA));
+		hasher.Get(a_pkey->auiHash);
+
+		a_pkey->uiFormat = static_cast<std::uint32_t>(a_format);
+		a_pkey->uiErrorMetric = static_cast<std::uint32_t>(a_errormetric);
+		a_pkey->fEffort = a_fEffort;
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	//
+	bool BlockCache::Find(Key const& a_key, unsigned char *a_paucEncodingBits, unsigned int a_uiEncodingBitsBytes,
+							float *a_pfError) const
+	{
+		assert(a_uiEncodingBitsBytes <= MAX_ENCODING_BITS_BYTES);
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		auto const it = m_entries.find(a_key);
+		if (it == m_entries.end())
+		{
+			return false;
+		}
+
+		m_lru.splice(m_lru.begin(), m_lru, it->second);
+
+		Entry const& entry = it->second->second;
+		memcpy(a_paucEncodingBits, entry.aucEncodingBits, a_uiEncodingBitsBytes);
+		*a_pfError = entry.fError;
+		return true;
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// the first encoding of a block wins, so that every later copy of it gets the same bits
+	//
+	void BlockCache::Insert(Key const& a_key, const unsigned char *a_paucEncodingBits, unsigned int a_uiEncodingBitsBytes,
+							float a_fError)
+	{
+		assert(a_uiEncodingBitsBytes <= MAX_ENCODING_BITS_BYTES);
+
+		Entry entry;
+		memset(entry.aucEncodingBits, 0, sizeof(entry.aucEncodingBits));
+		memcpy(entry.aucEncodingBits, a_paucEncodingBits, a_uiEncodingBitsBytes);
+		entry.fError = a_fError;
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		auto const it = m_entries.find(a_key);
+		if (it != m_entries.end())
+		{
+			m_lru.splice(m_lru.begin(), m_lru, it->second);
+			return;
+		}
+
+		if (m_entries.size() >= m_uiMaxEntries)
+		{
+			m_entries.erase(m_lru.back().first);
+			m_lru.pop_back();
+		}
+
+		m_lru.emplace_front(a_key, entry);
+		m_entries.emplace(a_key, m_lru.begin());
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	//
+	void BlockCache::Clear(void)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_entries.clear();
+		m_lru.clear();
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	//
+	unsigned int BlockCache::GetNumberOfEntries(void) const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return static_cast<unsigned int>(m_entries.size());
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	//
+	float BlockCache::GetHitRate(void) const
+	{
+		unsigned int const uiHits = m_uiHits;
+		unsigned int const uiLookups = uiHits + m_uiMisses;
+
+		return (uiLookups == 0) ? 0.0f : static_cast<float>(uiHits) / static_cast<float>(uiLookups);
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	//
+	void BlockCache::ResetCounters(void)
+	{
+		m_uiHits = 0;
+		m_uiMisses = 0;
+	}
+
+} // namespace Etc
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+#include "EtcImage.h"
+
+namespace Etc {
+
+	// finished encodings of 4x4 blocks, keyed on the block's 16 source pixels, format, error metric and effort
+	//
+	// an Executor that is given a cache copies the encoding bits of the blocks the cache has seen, and of the
+	// blocks that repeat an earlier block of the same image, instead of encoding them again
+	// the cache is owned by the caller and can be shared by the executors of any number of images and mip levels,
+	// including executors that encode at the same time
+	// it keeps at most the number of entries given to the constructor, and forgets the least recently used ones,
+	// so a batch of images with few repeated blocks doesn't grow it without bound
+	//
+	class BlockCache
+	{
+	public:
+		static const unsigned int MAX_ENCODING_BITS_BYTES = 16;
+
+		// about 100 bytes each, with the list and map nodes
+		static const unsigned int DEFAULT_MAX_ENTRIES = 1u << 20;
+
+		// a 128-bit hash of the source pixels as bits, like DiskCache's, and the format, error metric and effort
+		// keys are compared in full, so a hit needs all 128 bits and the settings to match
+		struct Key
+		{
+			std::uint64_t auiHash[2];
+			std::uint32_t uiFormat;
+			std::uint32_t uiErrorMetric;
+			float fEffort;
+
+			bool operator==(Key const& a_key) const;
+		};
+
+		struct KeyHash
+		{
+			std::size_t operator()(Key const& a_key) const;
+		};
+
+		BlockCache(unsigned int a_uiMaxEntries = DEFAULT_MAX_ENTRIES);
+
+		BlockCache(BlockCache const&) = delete;
+		BlockCache& operator=(BlockCache const&) = delete;
+
+		static void MakeKey(const ColorFloatRGBA *a_pafrgbaSource, Image::Format a_format,
+							ErrorMetric a_errormetric, float a_fEffort, Key *a_pkey);
+
+		// copy the a_uiEncodingBitsBytes encoding bits and the error of a_key's block
+		// returns false if the cache doesn't have them
+		bool Find(Key const& a_key, unsigned char *a_paucEncodingBits, unsigned int a_uiEncodingBitsBytes,
+					float *a_pfError) const;
+
+		// keep the encoding of a_key's block, unless the cache already has one
+		// the least recently used entry is forgotten once the cache is full
+		void Insert(Key const& a_key, const unsigned char *a_paucEncodingBits, unsigned int a_uiEncodingBitsBytes,
+					float a_fError);
+
+		// forget every encoding, but not the counters
+		void Clear(void);
+
+		unsigned int GetNumberOfEntries(void) const;
+
+		inline unsigned int GetMaxEntries(void) const
+		{
+			return m_uiMaxEntries;
+		}
+
+		// blocks whose encoding bits were copied, from the cache or from an identical block of the same image
+		inline unsigned int GetHits(void) const
+		{
+			return m_uiHits;
+		}
+
+		// blocks that were encoded
+		inline unsigned int GetMisses(void) const
+		{
+			return m_uiMisses;
+		}
+
+		// hits / (hits + misses), 0 before the first encode
+		float GetHitRate(void) const;
+
+		void ResetCounters(void);
+
+	private:
+
+		struct Entry
+		{
+			unsigned char aucEncodingBits[MAX_ENCODING_BITS_BYTES];
+			float fError;
+		};
+
+		// each encode adds up its blocks once they have been looked up
+		inline void AddToCounters(unsigned int a_uiHits, unsigned int a_uiMisses)
+		{
+			m_uiHits += a_uiHits;
+			m_uiMisses += a_uiMisses;
+		}
+
+		typedef std::list<std::pair<Key, Entry>> EntryList;
+
+		mutable std::mutex m_mutex;
+		mutable EntryList m_lru;		// most recently used first, Find() moves its entry to the front
+		std::unordered_map<Key, EntryList::iterator, KeyHash> m_entries;
+		unsigned int m_uiMaxEntries;
+
+		std::atomic<unsigned int> m_uiHits;
+		std::atomic<unsigned int> m_uiMisses;
+
+		friend class Executor;
+	};
+
+} // namespace Etc
@@ -0,0 +1,234 @@
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <process.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "EtcBlock4x4.h"
+#include "EtcDiskCache.h"
+#include "EtcKeyHasher.h"
+
+namespace Etc {
+
+	static const std::uint32_t ENTRY_MAGIC = 0x44435445;	// "ETCD"
+
+	// at the start of each entry file, followed by the encoding bits and the error of each block
+	struct EntryHeader
+	{
+		std::uint32_t uiMagic;
+		std::uint32_t uiVersion;
+		std::uint64_t auiHash[2];
+		std::uint32_t uiBlocks;
+		std::uint32_t uiBytesPerBlock;
+	};
+
+	// ----------------------------------------------------------------------------------------------------
+	//
+	static unsigned int GetEntryBytes(unsigned int a_uiBlocks, unsigned int a_uiBytesPerBlock)
+	{
+		return static_cast<unsigned int>(sizeof(EntryHeader)) + a_uiBlocks * (a_uiBytesPerBlock + sizeof(float));
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// copy the blocks of an entry file's contents, if they are an entry of a_key of that size
+	//
+	static bool ReadEntry(const unsigned char *a_pauc, DiskCache::Key const& a_key,
+							unsigned int a_uiBlocks, unsigned int a_uiBytesPerBlock,
+							unsigned char *a_paucEncodingBits, float *a_pafErrors)
+	{
+		EntryHeader header;
+		memcpy(&header, a_pauc, sizeof(header));
+
+		if (header.uiMagic != ENTRY_MAGIC ||
+			header.uiVersion != DiskCache::VERSION ||
+			header.auiHash[0] != a_key.auiHash[0] ||
+			header.auiHash[1] != a_key.auiHash[1] ||
+			header.uiBlocks != a_uiBlocks ||
+			header.uiBytesPerBlock != a_uiBytesPerBlock)
+		{
+			return false;
+		}
+
+		unsigned int const uiEncodingBitsBytes = a_uiBlocks * a_uiBytesPerBlock;
+		memcpy(a_paucEncodingBits, &a_pauc[sizeof(header)], uiEncodingBitsBytes);
+		memcpy(a_pafErrors, &a_pauc[sizeof(header) + uiEncodingBitsBytes], a_uiBlocks * sizeof(float));
+		return true;
+	}
+
+	DiskCache::DiskCache(const char *a_pstrDirectory, Granularity a_granularity)
+		: m_strDirectory(a_pstrDirectory)
+		, m_granularity(a_granularity)
+		, m_uiHits(0)
+		, m_uiMisses(0)
+	{
+		if (!m_strDirectory.empty() && m_strDirectory.back() != '/' && m_strDirectory.back() != '\\')
+		{
+			m_strDirectory += '/';
+		}
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// the source pixels are hashed as bits, so that the NAN border pixels of identical blocks are equal
+	//
+	void DiskCache::MakeKey(Block4x4 *a_pablock, unsigned int a_uiBlocks, unsigned int a_uiBlockColumns,
+							Image::Format a_format, ErrorMetric a_errormetric, float a_fEffort, Key *a_pkey)
+	{
+		KeyHasher hasher;
+
+		for (unsigned int uiBlock = 0; uiBlock < a_uiBlocks; uiBlock++)
+		{
+			hasher.Add(a_pablock[uiBlock].GetSource(), Block4x4::PIXELS * sizeof(ColorFloatRGBA));
+		}
+
+		hasher.Add(a_uiBlocks);
+		hasher.Add(a_uiBlockColumns);
+		hasher.Add(static_cast<std::uint32_t>(a_format));
+		hasher.Add(static_cast<std::uint32_t>(a_errormetric));
+		hasher.Add(&a_fEffort, sizeof(a_fEffort));
+		hasher.Add(VERSION);
+
+		hasher.Get(a_pkey->auiHash);
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// the key in hex
+	//
+	std::string DiskCache::GetEntryPath(Key const& a_key) const
+	{
+		char strName[40];
+		snprintf(strName, sizeof(strName), "%016llx%016llx.etc",
+					static_cast<unsigned long long>(a_key.auiHash[0]),
+					static_cast<unsigned long long>(a_key.auiHash[1]));
+
+		return m_strDirectory + strName;
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	//
+	bool DiskCache::Find(Key const& a_key, unsigned int a_uiBlocks, unsigned int a_uiBytesPerBlock,
+							unsigned char *a_paucEncodingBits, float *a_pafErrors)
+	{
+		std::string const strPath = GetEntryPath(a_key);
+		unsigned int const uiEntryBytes = GetEntryBytes(a_uiBlocks, a_uiBytesPerBlock);
+		bool boolFound = false;
+
+#ifdef _WIN32
+		FILE *pfile = fopen(strPath.c_str(), "rb");
+		if (pfile != nullptr)
+		{
+			unsigned char *pauc = new unsigned char[uiEntryBytes + 1];
+
+			// one more byte than the entry, to tell a longer file from an entry
+			if (fread(pauc, 1, uiEntryBytes + 1, pfile) == uiEntryBytes)
+			{
+				boolFound = ReadEntry(pauc, a_key, a_uiBlocks, a_uiBytesPerBlock, a_paucEncodingBits, a_pafErrors);
+			}
+
+			delete[] pauc;
+			fclose(pfile);
+		}
+#else
+		int const iFile = open(strPath.c_str(), O_RDONLY);
+		if (iFile >= 0)
+		{
+			struct stat filestat;
+			if (fstat(iFile, &filestat) == 0 && filestat.st_size == static_cast<off_t>(uiEntryBytes))
+			{
+				void *pMapping = mmap(nullptr, uiEntryBytes, PROT_READ, MAP_PRIVATE, iFile, 0);
+				if (pMapping != MAP_FAILED)
+				{
+					boolFound = ReadEntry(static_cast<const unsigned char *>(pMapping), a_key,
+											a_uiBlocks, a_uiBytesPerBlock, a_paucEncodingBits, a_pafErrors);
+					munmap(pMapping, uiEntryBytes);
+				}
+			}
+
+			close(iFile);
+		}
+#endif
+
+		if (boolFound)
+		{
+			m_uiHits++;
+		}
+		else
+		{
+			m_uiMisses++;
+		}
+
+		return boolFound;
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// the temporary file is unique to the process and the call, so that any number of writers can store
+	// the same entry at the same time, and the last rename wins with the same contents
+	//
+	bool DiskCache::Store(Key const& a_key, unsigned int a_uiBlocks, unsigned int a_uiBytesPerBlock,
+							const unsigned char *a_paucEncodingBits, const float *a_pafErrors)
+	{
+		static std::atomic<unsigned int> s_uiTemporaryFiles(0);
+
+		std::string const strPath = GetEntryPath(a_key);
+
+#ifdef _WIN32
+		unsigned int const uiProcess = static_cast<unsigned int>(_getpid());
+#else
+		unsigned int const uiProcess = static_cast<unsigned int>(getpid());
+#endif
+		char strSuffix[32];
+		snprintf(strSuffix, sizeof(strSuffix), ".%u.%u.tmp", uiProcess, s_uiTemporaryFiles++);
+		std::string const strTemporaryPath = strPath + strSuffix;
+
+		FILE *pfile = fopen(strTemporaryPath.c_str(), "wb");
+		if (pfile == nullptr)
+		{
+			return false;
+		}
+
+		EntryHeader header;
+		memset(&header, 0, sizeof(header));
+		header.uiMagic = ENTRY_MAGIC;
+		header.uiVersion = VERSION;
+		header.auiHash[0] = a_key.auiHash[0];
+		header.auiHash[1] = a_key.auiHash[1];
+		header.uiBlocks = a_uiBlocks;
+		header.uiBytesPerBlock = a_uiBytesPerBlock;
+
+		bool boolWritten = fwrite(&header, sizeof(header), 1, pfile) == 1 &&
+							fwrite(a_paucEncodingBits, a_uiBytesPerBlock, a_uiBlocks, pfile) == a_uiBlocks &&
+							fwrite(a_pafErrors, sizeof(float), a_uiBlocks, pfile) == a_uiBlocks;
+		boolWritten = (fclose(pfile) == 0) && boolWritten;
+
+		if (boolWritten)
+		{
+#ifdef _WIN32
+			boolWritten = MoveFileExA(strTemporaryPath.c_str(), strPath.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+			boolWritten = rename(strTemporaryPath.c_str(), strPath.c_str()) == 0;
+#endif
+		}
+
+		if (!boolWritten)
+		{
+			remove(strTemporaryPath.c_str());
+		}
+
+		return boolWritten;
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	//
+	void DiskCache::ResetCounters(void)
+	{
+		m_uiHits = 0;
+		m_uiMisses = 0;
+	}
+
+} // namespace Etc
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "EtcImage.h"
+
+namespace Etc {
+
+	class Block4x4;
+
+	// finished encodings of whole images or of rows of 4x4 blocks, kept as files in a directory
+	//
+	// an entry is addressed by a hash of its blocks' source pixels, the block columns, the format, the error metric,
+	// the effort and VERSION, so an edited texture only encodes the regions that changed and the regions it shares
+	// with any earlier encode cost just the hash
+	// an Executor that is given a cache copies the encoding bits of the regions the cache has, and adds the regions
+	// it encoded to the cache
+	// entries are read through a read-only mapping of the file, and written to a temporary file that is renamed
+	// over the entry, so readers in this or another process never see an entry that is partly written
+	// the directory is created by the caller
+	//
+	class DiskCache
+	{
+	public:
+		// change whenever the encoder gives other encoding bits for the same source, so old entries are not found
+		static const std::uint32_t VERSION = 1;
+
+		enum class Granularity
+		{
+			IMAGE,			// one entry per image
+			BLOCK_ROW		// one entry per row of blocks
+		};
+
+		struct Key
+		{
+			std::uint64_t auiHash[2];
+		};
+
+		DiskCache(const char *a_pstrDirectory, Granularity a_granularity = Granularity::BLOCK_ROW);
+
+		DiskCache(DiskCache const&) = delete;
+		DiskCache& operator=(DiskCache const&) = delete;
+
+		inline Granularity GetGranularity(void) const
+		{
+			return m_granularity;
+		}
+
+		inline const std::string& GetDirectory(void) const
+		{
+			return m_strDirectory;
+		}
+
+		// the key of a_uiBlocks consecutive blocks of an image with a_uiBlockColumns columns of blocks
+		static void MakeKey(Block4x4 *a_pablock, unsigned int a_uiBlocks, unsigned int a_uiBlockColumns,
+							Image::Format a_format, ErrorMetric a_errormetric, float a_fEffort, Key *a_pkey);
+
+		// copy the encoding bits and the error of each of a_uiBlocks blocks of a_key's entry
+		// returns false if the cache doesn't have the entry, or its file isn't a valid entry of that size
+		bool Find(Key const& a_key, unsigned int a_uiBlocks, unsigned int a_uiBytesPerBlock,
+					unsigned char *a_paucEncodingBits, float *a_pafErrors);
+
+		// write the entry of a_key
+		// returns false if the entry couldn't be written, which leaves the cache as it was
+		bool Store(Key const& a_key, unsigned int a_uiBlocks, unsigned int a_uiBytesPerBlock,
+					const unsigned char *a_paucEncodingBits, const float *a_pafErrors);
+
+		// entries that were found
+		inline unsigned int GetHits(void) const
+		{
+			return m_uiHits;
+		}
+
+		// entries that were looked up but not found
+		inline unsigned int GetMisses(void) const
+		{
+			return m_uiMisses;
+		}
+
+		void ResetCounters(void);
+
+	private:
+
+		std::string GetEntryPath(Key const& a_key) const;
+
+		std::string m_strDirectory;
+		Granularity m_granularity;
+
+		std::atomic<unsigned int> m_uiHits;
+		std::atomic<unsigned int> m_uiMisses;
+	};
+
+} // namespace Etc
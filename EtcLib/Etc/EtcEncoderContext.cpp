@@ -0,0 +1,126 @@
+/*
+ * Copyright 2015 The Etc2Comp Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+EtcEncoderContext.cpp
+
+EncoderContext runs ThreadedExecutor on an Image it keeps between encodes.
+
+*/
+
+#include "EtcConfig.h"
+#include "EtcEncoderContext.h"
+
+#include "EtcThreadedExecutor.h"
+
+#include <algorithm>
+
+namespace Etc
+{
+
+	// ----------------------------------------------------------------------------------------------------
+	//
+	EncoderContext::EncoderContext(void)
+	{
+		m_pimage = nullptr;
+		m_pthreadpool = nullptr;
+		m_pblockcache = nullptr;
+		m_pdiskcache = nullptr;
+
+		m_paucEncodingBits = nullptr;
+		m_uiEncodingBitsCapacity = 0;
+		m_uiEncodingBitsBytes = 0;
+
+		m_uiExtendedWidth = 0;
+		m_uiExtendedHeight = 0;
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	//
+	EncoderContext::~EncoderContext(void)
+	{
+		// the image's encoders live in m_arena, so the image goes first
+		delete m_pimage;
+		delete m_pthreadpool;
+		delete[] m_paucEncodingBits;
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// encode a_pafSourceRGBA, reusing whatever the previous encode allocated
+	// the image is only rebuilt when the dimensions change
+	// the thread pool is only rebuilt when the number of jobs changes
+	// the encoding bits buffer only grows
+	//
+	Executor::EncodingStatus EncoderContext::Encode(float *a_pafSourceRGBA,
+													unsigned int a_uiSourceWidth,
+													unsigned int a_uiSourceHeight,
+													Image::Format a_format,
+													ErrorMetric a_errormetric,
+													float a_fEffort,
+													unsigned int a_uiJobs,
+													unsigned int a_uiMaxJobs)
+	{
+		if (m_pimage != nullptr &&
+			m_pimage->GetSourceWidth() == a_uiSourceWidth &&
+			m_pimage->GetSourceHeight() == a_uiSourceHeight)
+		{
+			m_pimage->SetSource(a_pafSourceRGBA, a_errormetric);
+		}
+		else
+		{
+			delete m_pimage;
+			m_pimage = new Image(a_pafSourceRGBA, a_uiSourceWidth, a_uiSourceHeight, a_errormetric, &m_arena);
+		}
+
+		m_uiExtendedWidth = m_pimage->GetExtendedWidth();
+		m_uiExtendedHeight = m_pimage->GetExtendedHeight();
+
+		// too many jobs are clamped to a_uiMaxJobs, as ThreadedExecutor::Encode() does
+		unsigned int const uiPoolJobs = std::min(a_uiJobs, a_uiMaxJobs);
+		unsigned int uiThreads = (uiPoolJobs > 1) ? uiPoolJobs - 1 : 0;
+		if (m_pthreadpool == nullptr || m_pthreadpool->GetNumberOfThreads() != uiThreads)
+		{
+			delete m_pthreadpool;
+			m_pthreadpool = new ThreadPool(uiThreads);
+		}
+
+		// size the encoding bits for the requested format; unknown formats are reported by the executor
+		m_uiEncodingBitsBytes = 0;
+		Block4x4EncodingBits::Format encodingbitsformat = DetermineEncodingBitsFormat(a_format);
+		if (encodingbitsformat != Block4x4EncodingBits::Format::UNKNOWN)
+		{
+			unsigned int uiBytes = m_pimage->GetNumberOfBlocks() * Block4x4EncodingBits::GetBytesPerBlock(encodingbitsformat);
+			if (uiBytes > m_uiEncodingBitsCapacity)
+			{
+				delete[] m_paucEncodingBits;
+				m_paucEncodingBits = new unsigned char[uiBytes];
+				m_uiEncodingBitsCapacity = uiBytes;
+			}
+		}
+
+		ThreadedExecutor executor(*m_pimage, m_pthreadpool);
+		executor.SetEncodingBitsBuffer(m_paucEncodingBits, m_uiEncodingBitsCapacity);
+		executor.SetBlockCache(m_pblockcache);
+		executor.SetDiskCache(m_pdiskcache);
+
+		Executor::EncodingStatus encodingStatus = executor.Encode(a_format, a_errormetric, a_fEffort, a_uiJobs, a_uiMaxJobs);
+
+		m_uiEncodingBitsBytes = executor.GetEncodingBitsBytes();
+
+		return encodingStatus;
+	}
+
+} // namespace Etc
@@ -0,0 +1,106 @@
+/*
+ * Copyright 2015 The Etc2Comp Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "EtcBlock4x4EncodingArena.h"
+#include "EtcExecutor.h"
+
+namespace Etc
+{
+	class BlockCache;
+	class DiskCache;
+	class ThreadPool;
+
+	// keeps the allocations of an encode around for the next one
+	//
+	// the image (blocks, per block state, block sorter), the block encoders, the worker threads
+	// and the encoding bits are reused as long as consecutive source images have the same dimensions
+	// a batch of same sized images is then encoded without touching the heap after the first encode
+	//
+	class EncoderContext
+	{
+	public:
+
+		EncoderContext(void);
+		~EncoderContext(void);
+
+		EncoderContext(EncoderContext const&) = delete;
+		EncoderContext& operator=(EncoderContext const&) = delete;
+
+		// same parameters as Etc::Encode()
+		// the encoding bits belong to the context and stay valid until the next Encode()
+		Executor::EncodingStatus Encode(float *a_pafSourceRGBA,
+										unsigned int a_uiSourceWidth,
+										unsigned int a_uiSourceHeight,
+										Image::Format a_format,
+										ErrorMetric a_errormetric,
+										float a_fEffort,
+										unsigned int a_uiJobs,
+										unsigned int a_uiMaxJobs);
+
+		// share the encodings of repeated blocks between the encodes of the batch, see Executor::SetBlockCache()
+		// the cache is owned by the caller, nullptr to stop using it
+		inline void SetBlockCache(BlockCache *a_pblockcache)
+		{
+			m_pblockcache = a_pblockcache;
+		}
+
+		// skip the regions an earlier encode stored in a_pdiskcache, see Executor::SetDiskCache()
+		// the cache is owned by the caller, nullptr to stop using it
+		inline void SetDiskCache(DiskCache *a_pdiskcache)
+		{
+			m_pdiskcache = a_pdiskcache;
+		}
+
+		inline unsigned char * GetEncodingBits(void)
+		{
+			return m_paucEncodingBits;
+		}
+
+		inline unsigned int GetEncodingBitsBytes(void)
+		{
+			return m_uiEncodingBitsBytes;
+		}
+
+		inline unsigned int GetExtendedWidth(void)
+		{
+			return m_uiExtendedWidth;
+		}
+
+		inline unsigned int GetExtendedHeight(void)
+		{
+			return m_uiExtendedHeight;
+		}
+
+	private:
+
+		Block4x4EncodingArena m_arena;
+		Image *m_pimage;
+		ThreadPool *m_pthreadpool;
+		BlockCache *m_pblockcache;
+		DiskCache *m_pdiskcache;
+
+		unsigned char *m_paucEncodingBits;
+		unsigned int m_uiEncodingBitsCapacity;		// bytes allocated for m_paucEncodingBits
+		unsigned int m_uiEncodingBitsBytes;			// bytes used by the last encode
+
+		unsigned int m_uiExtendedWidth;
+		unsigned int m_uiExtendedHeight;
+
+	};
+
+} // namespace Etc
@@ -1,11 +1,22 @@
 
+#include <climits>
+#include <cstring>
+#include <unordered_map>
+
 #include "Etc.h"
 #include "EtcBlock4x4.h"
+#include "EtcBlock4x4EncodingArena.h"
+#include "EtcBlockCache.h"
+#include "EtcDiskCache.h"
 #include "EtcExecutor.h"
 #include "EtcSortedBlockList.h"
 
 namespace Etc {
 
+	// m_auiCopiedFrom values other than the index of the block whose encoding bits are copied
+	static const unsigned int ENCODED_BLOCK = UINT_MAX;
+	static const unsigned int CACHED_BLOCK = UINT_MAX - 1;
+
 	Executor::Executor(Image& image)
 		: m_image(image)
 	{}
@@ -18,7 +29,8 @@ namespace Etc {
 		m_errormetric = a_errormetric;
 		m_fEffort = a_fEffort;
 
-		if (m_errormetric < 0 || m_errormetric > ERROR_METRICS)
+		// every block's encoder looks up the kernels of this metric once, when InitBlocksAndBlockSorter() inits it
+		if (m_errormetric < 0 || m_errormetric >= ERROR_METRICS)
 		{
 			AddToEncodingStatus(ERROR_UNKNOWN_ERROR_METRIC);
 			return m_encodingStatus;
@@ -45,7 +57,19 @@ namespace Etc {
 
 		assert(m_paucEncodingBits == nullptr);
 		m_uiEncodingBitsBytes = m_image.GetNumberOfBlocks() * Block4x4EncodingBits::GetBytesPerBlock(m_encodingbitsformat);
-		m_paucEncodingBits = new unsigned char[m_uiEncodingBitsBytes];
+		if (m_paucEncodingBitsBuffer != nullptr)
+		{
+			if (m_uiEncodingBitsBufferBytes < m_uiEncodingBitsBytes)
+			{
+				AddToEncodingStatus(ERROR_ENCODING_BITS_BUFFER_TOO_SMALL);
+				return m_encodingStatus;
+			}
+			m_paucEncodingBits = m_paucEncodingBitsBuffer;
+		}
+		else
+		{
+			m_paucEncodingBits = new unsigned char[m_uiEncodingBitsBytes];
+		}
 
 		InitBlocksAndBlockSorter();
 		return m_encodingStatus;
@@ -121,8 +145,23 @@ namespace Etc {
 	{
 		FindEncodingWarningTypesForCurFormat();
 
+		// the source census is redone by every encode, since the image may have been given a new source
+		m_image.m_iNumOpaquePixels = 0;
+		m_image.m_iNumTranslucentPixels = 0;
+		m_image.m_iNumTransparentPixels = 0;
+		m_image.m_numColorValues = ColorFloatRGBA();
+		m_image.m_numOutOfRangeValues = ColorFloatRGBA();
+
+		// encoders from an earlier encode of this image must be gone before the arena is resized
+		for (unsigned int uiBlock = 0; uiBlock < m_image.GetNumberOfBlocks(); uiBlock++)
+		{
+			m_image.m_pablock[uiBlock].ReleaseEncoding();
+		}
+		m_image.m_parena->Reserve(m_image.GetNumberOfBlocks(), m_image.GetFormat());
+
 		// init each block
 		Block4x4 *pblock = m_image.m_pablock;
+		unsigned int uiBlock = 0;
 		unsigned char *paucEncodingBits = m_paucEncodingBits;
 		for (unsigned int uiBlockRow = 0; uiBlockRow < m_image.m_uiBlockRows; uiBlockRow++)
 		{
@@ -132,27 +171,263 @@ namespace Etc {
 			{
 				unsigned int uiBlockH = uiBlockColumn * 4;
 
-				pblock->InitFromSource(&m_image, uiBlockH, uiBlockV, paucEncodingBits, m_errormetric);
+				pblock->InitFromSource(&m_image, uiBlockH, uiBlockV, paucEncodingBits, m_errormetric,
+										m_image.m_parena->GetStorage(uiBlock),
+										&m_image.m_pafrgbaBlockSources[uiBlock * Block4x4::PIXELS],
+										&m_image.m_pafrgbaBlockDecodedColors[uiBlock * Block4x4::PIXELS]);
 
 				paucEncodingBits += Block4x4EncodingBits::GetBytesPerBlock(m_encodingbitsformat);
 
 				pblock++;
+				uiBlock++;
 			}
 		}
 
 		FindAndSetEncodingWarnings();
 
+		FindCopiedBlocks();
+
+		// the blocks InitFromSource() encoded from the solid color tables are done before the first pass
+		m_uiSolidColorBlocks = 0;
+		for (uiBlock = 0; uiBlock < m_image.GetNumberOfBlocks(); uiBlock++)
+		{
+			pblock = &m_image.m_pablock[uiBlock];
+			if (!pblock->IsCopiedEncoding() && pblock->GetEncoding()->IsDone())
+			{
+				m_uiSolidColorBlocks++;
+			}
+		}
+
 		// init block sorter
+		// the image keeps it, so that later encodes of the same image don't allocate another
+		if (m_image.m_psortedblocklist == nullptr)
 		{
-			m_psortedblocklist = new SortedBlockList(m_image.GetNumberOfBlocks(), 100);
+			m_image.m_psortedblocklist = new SortedBlockList(m_image.GetNumberOfBlocks(), 100,
+															m_image.GetBlockErrors(), m_image.GetBlockDoneFlags());
 
-			for (unsigned int uiBlock = 0; uiBlock < m_image.GetNumberOfBlocks(); uiBlock++)
+			for (uiBlock = 0; uiBlock < m_image.GetNumberOfBlocks(); uiBlock++)
 			{
 				pblock = &m_image.m_pablock[uiBlock];
-				m_psortedblocklist->AddBlock(pblock);
+				m_image.m_psortedblocklist->AddBlock(pblock);
+			}
+		}
+		m_psortedblocklist = m_image.m_psortedblocklist;
+
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// with a block or disk cache, mark the blocks whose encoding bits are copied instead of encoded as done:
+	// the blocks of the regions the disk cache has, and the blocks the block cache has an encoding of,
+	// whose bits are copied here,
+	// and the blocks that repeat an earlier block of the image, which FinishCopiedBlocks() copies
+	// the first of identical blocks is encoded
+	//
+	void Executor::FindCopiedBlocks(void)
+	{
+		m_uiCopiedBlocks = 0;
+
+		if (m_pblockcache == nullptr && m_pdiskcache == nullptr)
+		{
+			return;
+		}
+
+		unsigned int const uiBlocks = m_image.GetNumberOfBlocks();
+		unsigned int const uiBytesPerBlock = Block4x4EncodingBits::GetBytesPerBlock(m_encodingbitsformat);
+
+		m_auiCopiedFrom.assign(uiBlocks, ENCODED_BLOCK);
+
+		FindDiskCachedBlocks();
+
+		if (m_pblockcache == nullptr)
+		{
+			return;
+		}
+
+		unsigned int const uiDiskCachedBlocks = m_uiCopiedBlocks;
+
+		// the encoded blocks of the image, by hash
+		std::unordered_multimap<std::size_t, unsigned int> encodedblocks;
+		encodedblocks.reserve(uiBlocks);
+
+		for (unsigned int uiBlock = 0; uiBlock < uiBlocks; uiBlock++)
+		{
+			if (m_auiCopiedFrom[uiBlock] == CACHED_BLOCK)
+			{
+				continue;
+			}
+
+			Block4x4 *pblock = &m_image.m_pablock[uiBlock];
+
+			BlockCache::Key key;
+			BlockCache::MakeKey(pblock->GetSource(), m_image.GetFormat(), m_errormetric, m_fEffort, &key);
+
+			float fError;
+			if (m_pblockcache->Find(key, &m_paucEncodingBits[uiBlock * uiBytesPerBlock], uiBytesPerBlock, &fError))
+			{
+				pblock->SetCopiedEncoding(fError);
+				m_auiCopiedFrom[uiBlock] = CACHED_BLOCK;
+				m_uiCopiedBlocks++;
+				continue;
+			}
+
+			std::size_t const uiHash = BlockCache::KeyHash()(key);
+
+			auto const range = encodedblocks.equal_range(uiHash);
+			for (auto it = range.first; it != range.second; ++it)
+			{
+				if (memcmp(m_image.m_pablock[it->second].GetSource(), pblock->GetSource(),
+							Block4x4::PIXELS * sizeof(ColorFloatRGBA)) == 0)
+				{
+					m_auiCopiedFrom[uiBlock] = it->second;
+					break;
+				}
+			}
+
+			if (m_auiCopiedFrom[uiBlock] == ENCODED_BLOCK)
+			{
+				encodedblocks.emplace(uiHash, uiBlock);
+			}
+			else
+			{
+				// the error is known once the block it copies is encoded
+				pblock->SetCopiedEncoding(0.0f);
+				m_uiCopiedBlocks++;
+			}
+		}
+
+		m_pblockcache->AddToCounters(m_uiCopiedBlocks - uiDiskCachedBlocks, uiBlocks - m_uiCopiedBlocks);
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// block rows per disk cache entry
+	//
+	unsigned int Executor::GetDiskCacheRegionRows(void) const
+	{
+		return (m_pdiskcache->GetGranularity() == DiskCache::Granularity::IMAGE) ? m_image.m_uiBlockRows : 1;
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// copy the encoding bits of the regions the disk cache has, and remember the regions it doesn't
+	//
+	void Executor::FindDiskCachedBlocks(void)
+	{
+		m_auiDiskCacheMisses.clear();
+
+		if (m_pdiskcache == nullptr)
+		{
+			return;
+		}
+
+		unsigned int const uiBytesPerBlock = Block4x4EncodingBits::GetBytesPerBlock(m_encodingbitsformat);
+		unsigned int const uiRegionRows = GetDiskCacheRegionRows();
+		unsigned int const uiBlockColumns = m_image.m_uiBlockColumns;
+
+		std::vector<float> afErrors(uiRegionRows * uiBlockColumns);
+
+		for (unsigned int uiBlockRow = 0; uiBlockRow < m_image.m_uiBlockRows; uiBlockRow += uiRegionRows)
+		{
+			unsigned int const uiFirstBlock = uiBlockRow * uiBlockColumns;
+			unsigned int const uiRegionBlocks = uiRegionRows * uiBlockColumns;
+
+			DiskCache::Key key;
+			DiskCache::MakeKey(&m_image.m_pablock[uiFirstBlock], uiRegionBlocks, uiBlockColumns,
+								m_image.GetFormat(), m_errormetric, m_fEffort, &key);
+
+			if (!m_pdiskcache->Find(key, uiRegionBlocks, uiBytesPerBlock,
+									&m_paucEncodingBits[uiFirstBlock * uiBytesPerBlock], afErrors.data()))
+			{
+				m_auiDiskCacheMisses.push_back(uiBlockRow);
+				continue;
+			}
+
+			for (unsigned int uiBlock = 0; uiBlock < uiRegionBlocks; uiBlock++)
+			{
+				m_image.m_pablock[uiFirstBlock + uiBlock].SetCopiedEncoding(afErrors[uiBlock]);
+				m_auiCopiedFrom[uiFirstBlock + uiBlock] = CACHED_BLOCK;
+			}
+			m_uiCopiedBlocks += uiRegionBlocks;
+		}
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// add the regions the disk cache didn't have, once every block of them has its encoding bits
+	//
+	void Executor::StoreDiskCachedBlocks(void)
+	{
+		if (m_pdiskcache == nullptr)
+		{
+			return;
+		}
+
+		unsigned int const uiBytesPerBlock = Block4x4EncodingBits::GetBytesPerBlock(m_encodingbitsformat);
+		unsigned int const uiRegionRows = GetDiskCacheRegionRows();
+		unsigned int const uiBlockColumns = m_image.m_uiBlockColumns;
+		unsigned int const uiRegionBlocks = uiRegionRows * uiBlockColumns;
+
+		std::vector<float> afErrors(uiRegionBlocks);
+
+		for (unsigned int uiBlockRow : m_auiDiskCacheMisses)
+		{
+			unsigned int const uiFirstBlock = uiBlockRow * uiBlockColumns;
+
+			for (unsigned int uiBlock = 0; uiBlock < uiRegionBlocks; uiBlock++)
+			{
+				afErrors[uiBlock] = m_image.m_pablock[uiFirstBlock + uiBlock].GetError();
 			}
+
+			DiskCache::Key key;
+			DiskCache::MakeKey(&m_image.m_pablock[uiFirstBlock], uiRegionBlocks, uiBlockColumns,
+								m_image.GetFormat(), m_errormetric, m_fEffort, &key);
+
+			// a cache that can't be written to only costs the encodes it would have saved
+			m_pdiskcache->Store(key, uiRegionBlocks, uiBytesPerBlock,
+								&m_paucEncodingBits[uiFirstBlock * uiBytesPerBlock], afErrors.data());
 		}
 
+		m_auiDiskCacheMisses.clear();
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// with a block cache, copy the encoding bits of the encoded blocks to the blocks that repeat them
+	// and add the encoded blocks to the cache
+	// with a disk cache, add the regions it didn't have
+	//
+	void Executor::FinishCopiedBlocks(void)
+	{
+		if (m_pblockcache == nullptr)
+		{
+			StoreDiskCachedBlocks();
+			return;
+		}
+
+		unsigned int const uiBytesPerBlock = Block4x4EncodingBits::GetBytesPerBlock(m_encodingbitsformat);
+
+		for (unsigned int uiBlock = 0; uiBlock < m_image.GetNumberOfBlocks(); uiBlock++)
+		{
+			Block4x4 *pblock = &m_image.m_pablock[uiBlock];
+			unsigned int const uiCopiedFrom = m_auiCopiedFrom[uiBlock];
+
+			if (uiCopiedFrom == CACHED_BLOCK)
+			{
+				continue;
+			}
+
+			if (uiCopiedFrom == ENCODED_BLOCK)
+			{
+				BlockCache::Key key;
+				BlockCache::MakeKey(pblock->GetSource(), m_image.GetFormat(), m_errormetric, m_fEffort, &key);
+				m_pblockcache->Insert(key, &m_paucEncodingBits[uiBlock * uiBytesPerBlock], uiBytesPerBlock,
+										pblock->GetError());
+				continue;
+			}
+
+			memcpy(&m_paucEncodingBits[uiBlock * uiBytesPerBlock], &m_paucEncodingBits[uiCopiedFrom * uiBytesPerBlock],
+					uiBytesPerBlock);
+			pblock->SetCopiedEncoding(m_image.m_pablock[uiCopiedFrom].GetError());
+			m_image.UpdateBlockState(uiBlock);
+		}
+
+		StoreDiskCachedBlocks();
 	}
 
     // ----------------------------------------------------------------------------------------------------
@@ -172,6 +447,21 @@ namespace Etc {
 		}
 
 	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// set the encoding bits for the consecutive blocks [a_uiFirstBlock, a_uiEndBlock)
+	//
+	void Executor::SetEncodingBitsOnRange(unsigned int const a_uiFirstBlock,
+											unsigned int const a_uiEndBlock)
+	{
+		assert(a_uiEndBlock <= m_image.GetNumberOfBlocks());
+
+		for (unsigned int uiBlock = a_uiFirstBlock; uiBlock < a_uiEndBlock; uiBlock++)
+		{
+			m_image.m_pablock[uiBlock].SetEncodingBitsFromEncoding(m_image.GetFormat());
+		}
+	}
+
 	// ----------------------------------------------------------------------------------------------------
 	// determine the encoding bits format based on the encoding format
 	// the encoding bits format is a family of bit encodings that are shared across various encoding formats
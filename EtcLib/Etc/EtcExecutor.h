@@ -2,11 +2,15 @@
 #pragma once
 
 #include <chrono>
+#include <vector>
 
 #include "EtcImage.h"
 
 namespace Etc {
 
+	class BlockCache;
+	class DiskCache;
+
 	class Executor
 	{
 	public:
@@ -34,6 +38,9 @@ namespace Etc {
 			ERROR_UNKNOWN_FORMAT = 1 << 17,
 			ERROR_UNKNOWN_ERROR_METRIC = 1 << 18,
 			ERROR_ZERO_WIDTH_OR_HEIGHT = 1 << 19,
+			ERROR_ENCODING_BITS_BUFFER_TOO_SMALL = 1 << 20,
+			ERROR_STREAM_SOURCE_FAILED = 1 << 21,		// see StreamEncoder
+			ERROR_STREAM_SINK_FAILED = 1 << 22,
 			//
 		};
 
@@ -44,11 +51,22 @@ namespace Etc {
 			m_encodingStatus = (EncodingStatus)((unsigned int)m_encodingStatus | (unsigned int)a_encStatus);
 		}
 
+		// the encoding bits are owned by the caller
+		// they were allocated with new[] unless a buffer was given to SetEncodingBitsBuffer()
 		inline unsigned char * GetEncodingBits(void)
 		{
 			return m_paucEncodingBits;
 		}
 
+		// encode into a_paucEncodingBits instead of a newly allocated buffer
+		// Encode() fails with ERROR_ENCODING_BITS_BUFFER_TOO_SMALL if a_uiEncodingBitsBytes
+		// doesn't cover every block of the image in the encoding bits format
+		inline void SetEncodingBitsBuffer(unsigned char *a_paucEncodingBits, unsigned int a_uiEncodingBitsBytes)
+		{
+			m_paucEncodingBitsBuffer = a_paucEncodingBits;
+			m_uiEncodingBitsBufferBytes = a_uiEncodingBitsBytes;
+		}
+
 		inline unsigned int GetEncodingBitsBytes(void)
 		{
 			return m_uiEncodingBitsBytes;
@@ -64,11 +82,43 @@ namespace Etc {
 		{
 			return m_image;
 		}
+
+		// copy the encoding bits of the blocks a_pblockcache has seen, and of the blocks that repeat an earlier
+		// block of the image, instead of encoding them, and add the blocks that were encoded to a_pblockcache
+		// the cache is owned by the caller and may be shared with other executors, including ones encoding at the same time
+		inline void SetBlockCache(BlockCache *a_pblockcache)
+		{
+			m_pblockcache = a_pblockcache;
+		}
+
+		inline BlockCache * GetBlockCache(void) const
+		{
+			return m_pblockcache;
+		}
+
+		// copy the encoding bits of the images or rows of blocks a_pdiskcache has, instead of encoding them,
+		// and add the ones that were encoded to a_pdiskcache
+		// the regions the disk cache doesn't have still use the block cache, if there is one
+		inline void SetDiskCache(DiskCache *a_pdiskcache)
+		{
+			m_pdiskcache = a_pdiskcache;
+		}
+
+		inline DiskCache * GetDiskCache(void) const
+		{
+			return m_pdiskcache;
+		}
 	protected:
 		EncodingStatus InitEncode(Format a_format, ErrorMetric a_errormetric, float a_fEffort);
 
 		void SetEncodingBits(unsigned int a_uiMultithreadingOffset,
 								unsigned int a_uiMultithreadingStride);
+
+		void SetEncodingBitsOnRange(unsigned int a_uiFirstBlock,
+									unsigned int a_uiEndBlock);
+
+		// once the encoding bits are set
+		void FinishCopiedBlocks(void);
 	private:
 
 		//add a warning or error to check for while encoding
@@ -93,14 +143,28 @@ namespace Etc {
 
 		void InitBlocksAndBlockSorter(void);
 
+		void FindCopiedBlocks(void);
+
+		unsigned int GetDiskCacheRegionRows(void) const;
+		void FindDiskCachedBlocks(void);
+		void StoreDiskCachedBlocks(void);
+
 		Image& m_image;
 	protected:
 		float m_fEffort = 0.0f;
+		unsigned int m_uiCopiedBlocks = 0;		// blocks that are done without encoding, see SetBlockCache() and SetDiskCache()
+		unsigned int m_uiSolidColorBlocks = 0;	// blocks that are done without iterating, see Block4x4Encoding::EncodeSolidColor()
 	private:
 		Block4x4EncodingBits::Format m_encodingbitsformat = Block4x4EncodingBits::Format::UNKNOWN;
 		unsigned int m_uiEncodingBitsBytes = 0;		// for entire image
 		unsigned char *m_paucEncodingBits = nullptr;
+		unsigned char *m_paucEncodingBitsBuffer = nullptr;	// caller's buffer, if any
+		unsigned int m_uiEncodingBitsBufferBytes = 0;
 		ErrorMetric m_errormetric;
+		BlockCache *m_pblockcache = nullptr;
+		std::vector<unsigned int> m_auiCopiedFrom;	// per block, when there is a block or disk cache
+		DiskCache *m_pdiskcache = nullptr;
+		std::vector<unsigned int> m_auiDiskCacheMisses;	// first block row of each region to add to the disk cache
 		
 	protected:
 		SortedBlockList *m_psortedblocklist;
@@ -118,7 +182,7 @@ namespace Etc {
 
 	constexpr bool IsError(Executor::EncodingStatus const status)
 	{
-		return ((status & Executor::ERROR_THRESHOLD) - 1) >= (Executor::ERROR_THRESHOLD - 1);
+		return status >= Executor::ERROR_THRESHOLD;
 	}
 
 	constexpr Executor::EncodingStatus GetEncodingWarningTypes(Image::Format const a_format)
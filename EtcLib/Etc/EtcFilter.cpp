@@ -1,6 +1,21 @@
 #include <cstdlib>
 #include <cmath>
+#include <cstring>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
 #include "EtcFilter.h"
+#include "EtcThreadPool.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define ETC_FILTER_SSE 1
+#include <emmintrin.h>
+#else
+#define ETC_FILTER_SSE 0
+#endif
 
 
 namespace Etc
@@ -29,38 +44,38 @@ inline double sinc(double x)
 //    return sinf(x)/x;
 //}
 //
-//double bessel0(double x) 
-//{
-//    const double EPSILON_RATIO = 1E-16;
-//    double xh, sum, pow, ds;
-//    int k;
-//
-//    xh = 0.5 * x;
-//    sum = 1.0;
-//    pow = 1.0;
-//    k = 0;
-//    ds = 1.0;
-//    while (ds > sum * EPSILON_RATIO) 
-//    {
-//        ++k;
-//        pow = pow * (xh / k);
-//        ds = pow * pow;
-//        sum = sum + ds;
-//    }
-//
-//    return sum;
-//}
+static double bessel0(double x) 
+{
+    const double EPSILON_RATIO = 1E-16;
+    double xh, sum, pow, ds;
+    int k;
+
+    xh = 0.5 * x;
+    sum = 1.0;
+    pow = 1.0;
+    k = 0;
+    ds = 1.0;
+    while (ds > sum * EPSILON_RATIO) 
+    {
+        ++k;
+        pow = pow * (xh / k);
+        ds = pow * pow;
+        sum = sum + ds;
+    }
+
+    return sum;
+}
 
 //**--------------------------------------------------------------------------
 //** Name: kaiser(double alpha, double half_width, double x) 
 //** Returns:
 //** Description: Alpha controls shape of filter.  We are using 4.
 //**--------------------------------------------------------------------------
-//inline double kaiser(double alpha, double half_width, double x) 
-//{
-//    double ratio = (x / half_width);
-//    return bessel0(alpha * sqrt(1 - ratio * ratio)) / bessel0(alpha);
-//}
+inline double kaiser(double alpha, double half_width, double x) 
+{
+    double ratio = (x / half_width);
+    return bessel0(alpha * sqrt(1 - ratio * ratio)) / bessel0(alpha);
+}
 //
 //float Filter_Lanczos4Sinc(float x)
 //{
@@ -92,6 +107,16 @@ double FilterLanczos3( double t )
     return sinc( t ) * sinc( t / 3.0 );
 }
 
+double FilterKaiser( double t )
+{
+	if ( t <= -3.0 || t >= 3.0 ) 
+    {
+        return 0.0;
+    }
+
+    return sinc( t ) * kaiser( 4.0, 3.0, t );
+}
+
 double FilterBox( double t )
 {
     return ( t > -0.5 && t < 0.5) ? 1.0 : 0.0;
@@ -309,6 +334,711 @@ int FilterTwoPass( RGBCOLOR *pSrcImage, int srcWidth, int srcHeight,
     return 1;
 }
 
+//**-------------------------------------------------------------------------
+//** The contributions of one filter pass as float weights, with the source
+//** index of each weight wrapped into the source, stored maxWeights apart
+//** for each destination pixel.
+//**-------------------------------------------------------------------------
+struct FilterContributions
+{
+	int maxWeights;
+	std::vector<int> numWeights;
+	std::vector<int> sources;
+	std::vector<float> weights;
+};
+
+typedef std::tuple<int, int, bool, double (*)(double)> FilterContributionsKey;
+
+// contributions kept by GetFilterContributions(), enough for the two passes
+// of every level of a mip chain
+static const size_t MaxCachedFilterContributions = 32;
+
+// rows of a float image filtered by one task
+static const int FilterTileRows = 16;
+
+//**-------------------------------------------------------------------------
+//** Name: GetFilterContributions( int srcSize, int destSize, bool wrap,
+//**                               double (*FilterProc)(double) )
+//** Returns: the contributions, which stay valid while the caller holds them
+//** Description: Calculates the contributions the first time they are asked
+//**    for and keeps the most recently used ones, so that every image of the
+//**    same size filtered to the same size, e.g. every mip level, shares them
+//**    without the cache growing with every size a process ever filters.
+//**-------------------------------------------------------------------------
+static std::shared_ptr<const FilterContributions> GetFilterContributions( int srcSize, int destSize, bool wrap, double (*FilterProc)(double) )
+{
+	typedef std::pair<FilterContributionsKey, std::shared_ptr<const FilterContributions>> CachedContributions;
+
+	static std::mutex s_mutex;
+	static std::list<CachedContributions> s_contributions;		// most recently used first
+
+	FilterContributionsKey const key(srcSize, destSize, wrap, FilterProc);
+
+	std::lock_guard<std::mutex> lock(s_mutex);
+
+	for ( auto it = s_contributions.begin(); it != s_contributions.end(); ++it )
+	{
+		if ( it->first == key )
+		{
+			s_contributions.splice(s_contributions.begin(), s_contributions, it);
+			return it->second;
+		}
+	}
+
+	FilterWeights *contrib = new FilterWeights[destSize];
+	CalcContributions( srcSize, destSize, 3.0, wrap, FilterProc, contrib );
+
+	FilterContributions *pNew = new FilterContributions;
+	pNew->maxWeights = 1;
+	for ( int iDest = 0; iDest < destSize; iDest++ )
+	{
+		pNew->maxWeights = std::max(pNew->maxWeights, contrib[iDest].numWeights);
+	}
+
+	pNew->numWeights.resize(destSize);
+	pNew->sources.assign(destSize * pNew->maxWeights, 0);
+	pNew->weights.assign(destSize * pNew->maxWeights, 0.0f);
+	for ( int iDest = 0; iDest < destSize; iDest++ )
+	{
+		pNew->numWeights[iDest] = contrib[iDest].numWeights;
+		for ( int iWeight = 0; iWeight < contrib[iDest].numWeights; iWeight++ )
+		{
+			// a filter wider than a small source wraps around it more than once
+			int iSrc = (iWeight + contrib[iDest].first) % srcSize;
+			pNew->sources[iDest * pNew->maxWeights + iWeight] = (iSrc < 0) ? iSrc + srcSize : iSrc;
+			pNew->weights[iDest * pNew->maxWeights + iWeight] = static_cast<float>(contrib[iDest].weight[iWeight]);
+		}
+	}
+
+	delete[] contrib;
+
+	s_contributions.emplace_front(key, std::shared_ptr<const FilterContributions>(pNew));
+	if ( s_contributions.size() > MaxCachedFilterContributions )
+	{
+		s_contributions.pop_back();
+	}
+
+	return s_contributions.front().second;
+}
+
+//**-------------------------------------------------------------------------
+//** Name: FilterRowsHorizontally( ... )
+//** Description: Filters the rows [firstRow, endRow) of the source image
+//**    into the same rows of the horizontally scaled image.
+//**-------------------------------------------------------------------------
+static void FilterRowsHorizontally( const float *pSrcImage, int srcWidth, float *pTempImage, int destWidth,
+                                    const FilterContributions &contributions, int firstRow, int endRow )
+{
+	for ( int iRow = firstRow; iRow < endRow; iRow++ )
+	{
+		const float *pSrcRow = pSrcImage + (size_t)iRow * srcWidth * 4;
+		float *pTempRow = pTempImage + (size_t)iRow * destWidth * 4;
+
+		for ( int iCol = 0; iCol < destWidth; iCol++ )
+		{
+			const int *pSources = &contributions.sources[iCol * contributions.maxWeights];
+			const float *pWeights = &contributions.weights[iCol * contributions.maxWeights];
+			int numWeights = contributions.numWeights[iCol];
+
+#if ETC_FILTER_SSE
+			__m128 vSum = _mm_setzero_ps();
+			for ( int iWeight = 0; iWeight < numWeights; iWeight++ )
+			{
+				vSum = _mm_add_ps(vSum, _mm_mul_ps(_mm_set1_ps(pWeights[iWeight]), _mm_loadu_ps(pSrcRow + pSources[iWeight] * 4)));
+			}
+			_mm_storeu_ps(pTempRow + iCol * 4, _mm_min_ps(_mm_max_ps(vSum, _mm_setzero_ps()), _mm_set1_ps(255.0f)));
+#else
+			float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+			for ( int iWeight = 0; iWeight < numWeights; iWeight++ )
+			{
+				const float *pSrcPixel = pSrcRow + pSources[iWeight] * 4;
+				for ( int iComponent = 0; iComponent < 4; iComponent++ )
+				{
+					sum[iComponent] += pWeights[iWeight] * pSrcPixel[iComponent];
+				}
+			}
+			for ( int iComponent = 0; iComponent < 4; iComponent++ )
+			{
+				pTempRow[iCol * 4 + iComponent] = std::max(0.0f, std::min(255.0f, sum[iComponent]));
+			}
+#endif
+		}
+	}
+}
+
+//**-------------------------------------------------------------------------
+//** Name: FilterRowsVertically( ... )
+//** Description: Filters the horizontally scaled image into the rows
+//**    [firstRow, endRow) of the destination image, adding up whole source
+//**    rows into pSum, which holds one destination row.
+//**-------------------------------------------------------------------------
+static void FilterRowsVertically( const float *pTempImage, float *pDestImage, int destWidth,
+                                  const FilterContributions &contributions, int firstRow, int endRow, float *pSum )
+{
+	int rowFloats = destWidth * 4;
+
+	for ( int iRow = firstRow; iRow < endRow; iRow++ )
+	{
+		const int *pSources = &contributions.sources[iRow * contributions.maxWeights];
+		const float *pWeights = &contributions.weights[iRow * contributions.maxWeights];
+		int numWeights = contributions.numWeights[iRow];
+		float *pDestRow = pDestImage + (size_t)iRow * rowFloats;
+
+		memset(pSum, 0, rowFloats * sizeof(float));
+
+		for ( int iWeight = 0; iWeight < numWeights; iWeight++ )
+		{
+			const float *pTempRow = pTempImage + (size_t)pSources[iWeight] * rowFloats;
+#if ETC_FILTER_SSE
+			__m128 vWeight = _mm_set1_ps(pWeights[iWeight]);
+			for ( int iFloat = 0; iFloat < rowFloats; iFloat += 4 )
+			{
+				_mm_storeu_ps(pSum + iFloat, _mm_add_ps(_mm_loadu_ps(pSum + iFloat), _mm_mul_ps(vWeight, _mm_loadu_ps(pTempRow + iFloat))));
+			}
+#else
+			for ( int iFloat = 0; iFloat < rowFloats; iFloat++ )
+			{
+				pSum[iFloat] += pWeights[iWeight] * pTempRow[iFloat];
+			}
+#endif
+		}
+
+#if ETC_FILTER_SSE
+		for ( int iFloat = 0; iFloat < rowFloats; iFloat += 4 )
+		{
+			_mm_storeu_ps(pDestRow + iFloat, _mm_min_ps(_mm_max_ps(_mm_loadu_ps(pSum + iFloat), _mm_setzero_ps()), _mm_set1_ps(255.0f)));
+		}
+#else
+		for ( int iFloat = 0; iFloat < rowFloats; iFloat++ )
+		{
+			pDestRow[iFloat] = std::max(0.0f, std::min(255.0f, pSum[iFloat]));
+		}
+#endif
+	}
+}
+
+//**-------------------------------------------------------------------------
+//** Name: RunFilterTiles( ThreadPool *pThreadPool, int rows,
+//**                       std::function<void(int, int)> const &tileProc,
+//**                       int tileRows )
+//** Description: Calls tileProc( firstRow, endRow ) for each tile of
+//**    tileRows rows, on the threads of pThreadPool if there is one.
+//**-------------------------------------------------------------------------
+static void RunFilterTiles( ThreadPool *pThreadPool, int rows, std::function<void(int, int)> const &tileProc,
+                            int tileRows = FilterTileRows )
+{
+	int tiles = (rows + tileRows - 1) / tileRows;
+
+	auto tile = [&](unsigned int iTile) {
+		int firstRow = (int)iTile * tileRows;
+		tileProc( firstRow, std::min(rows, firstRow + tileRows) );
+	};
+
+	if ( pThreadPool == nullptr )
+	{
+		for ( int iTile = 0; iTile < tiles; iTile++ )
+		{
+			tile( iTile );
+		}
+		return;
+	}
+
+	pThreadPool->Run( tiles, tile );
+}
+
+//**-------------------------------------------------------------------------
+//** Name: FilterTwoPass( float *pSrcImage, 
+//**                      int srcWidth, int srcHeight, 
+//**                      float *pDestImage, 
+//**                      int destWidth, int destHeight, 
+//**                      unsigned int wrapFlags,
+//**                      double (*FilterProc)(double),
+//**                      ThreadPool *pThreadPool )
+//** Returns: 0 on failure and 1 on success
+//** Description: Same filter as the RGBCOLOR and template versions, for
+//**    RGBA float images. Each pass filters tiles of rows, which are spread
+//**    over the threads of pThreadPool.
+//**-------------------------------------------------------------------------
+int FilterTwoPass( float *pSrcImage, int srcWidth, int srcHeight,
+                   float *pDestImage, int destWidth, int destHeight, unsigned int wrapFlags, double (*FilterProc)(double),
+                   ThreadPool *pThreadPool )
+{
+	float *pTempImage = new float[(size_t)destWidth * srcHeight * 4];
+
+	//**-------------------------------------------------------
+	//** Horizontally filter the image into the temporary image
+	//**-------------------------------------------------------
+	std::shared_ptr<const FilterContributions> const pHorizontal = GetFilterContributions( srcWidth, destWidth, !!(wrapFlags&FILTER_WRAP_X), FilterProc );
+	const FilterContributions &horizontal = *pHorizontal;
+	RunFilterTiles( pThreadPool, srcHeight, [&](int firstRow, int endRow) {
+		FilterRowsHorizontally( pSrcImage, srcWidth, pTempImage, destWidth, horizontal, firstRow, endRow );
+	});
+
+	//**-------------------------------------------------------
+	//** Vertically filter the image into the destination image
+	//**-------------------------------------------------------
+	std::shared_ptr<const FilterContributions> const pVertical = GetFilterContributions( srcHeight, destHeight, !!(wrapFlags&FILTER_WRAP_Y), FilterProc );
+	const FilterContributions &vertical = *pVertical;
+	RunFilterTiles( pThreadPool, destHeight, [&](int firstRow, int endRow) {
+		float *pSum = new float[destWidth * 4];
+		FilterRowsVertically( pTempImage, pDestImage, destWidth, vertical, firstRow, endRow, pSum );
+		delete[] pSum;
+	});
+
+	delete[] pTempImage;
+
+	return 1;
+}
+
+//**-------------------------------------------------------------------------
+//** The sRGB transfer function. The 8 bit tables are exact; the float tables
+//** are interpolated between SrgbTableSize + 1 samples, which is far finer
+//** than the 8 bits of an encoded pixel.
+//**-------------------------------------------------------------------------
+static const int SrgbTableSize = 4096;
+
+struct SrgbTables
+{
+	float unorm8[256];						// each 8 bit value / 255, as Image converts RGBA8 sources
+	float linear8[256];						// the linear value of each 8 bit sRGB value
+	float linear[SrgbTableSize + 1];		// sRGB to linear
+	float srgb[SrgbTableSize + 1];			// linear to sRGB
+};
+
+static double SrgbToLinear( double v )
+{
+	return (v <= 0.04045) ? v / 12.92 : pow( (v + 0.055) / 1.055, 2.4 );
+}
+
+static double LinearToSrgb( double v )
+{
+	return (v <= 0.0031308) ? v * 12.92 : 1.055 * pow( v, 1.0 / 2.4 ) - 0.055;
+}
+
+static SrgbTables MakeSrgbTables( void )
+{
+	SrgbTables tables;
+
+	for ( int i = 0; i < 256; i++ )
+	{
+		tables.unorm8[i] = i / 255.0f;
+		tables.linear8[i] = static_cast<float>(SrgbToLinear( i / 255.0 ));
+	}
+
+	for ( int i = 0; i <= SrgbTableSize; i++ )
+	{
+		tables.linear[i] = static_cast<float>(SrgbToLinear( (double)i / SrgbTableSize ));
+		tables.srgb[i] = static_cast<float>(LinearToSrgb( (double)i / SrgbTableSize ));
+	}
+
+	return tables;
+}
+
+static const SrgbTables &GetSrgbTables( void )
+{
+	static const SrgbTables s_tables = MakeSrgbTables();
+
+	return s_tables;
+}
+
+static inline float LookUpSrgbTable( const float *table, float v )
+{
+	float x = std::max(0.0f, std::min(1.0f, v)) * SrgbTableSize;
+	int i = std::min((int)x, SrgbTableSize - 1);
+
+	return table[i] + (x - i) * (table[i + 1] - table[i]);
+}
+
+//**-------------------------------------------------------------------------
+//** Name: LoadRow( const T *pSrcRow, int width, bool srgb, float *pRow )
+//** Returns: the row as linear float RGBA, which is pSrcRow itself if it
+//**    needs no conversion, else pRow
+//** Description: Converts a row of source pixels to linear float RGBA as
+//**    the row is needed, so that no float copy of the source is made.
+//**-------------------------------------------------------------------------
+static const float *LoadRow( const float *pSrcRow, int width, bool srgb, float *pRow )
+{
+	if ( !srgb )
+	{
+		return pSrcRow;
+	}
+
+	const SrgbTables &tables = GetSrgbTables();
+	for ( int iFloat = 0; iFloat < width * 4; iFloat += 4 )
+	{
+		pRow[iFloat + 0] = LookUpSrgbTable( tables.linear, pSrcRow[iFloat + 0] );
+		pRow[iFloat + 1] = LookUpSrgbTable( tables.linear, pSrcRow[iFloat + 1] );
+		pRow[iFloat + 2] = LookUpSrgbTable( tables.linear, pSrcRow[iFloat + 2] );
+		pRow[iFloat + 3] = pSrcRow[iFloat + 3];
+	}
+
+	return pRow;
+}
+
+static const float *LoadRow( const unsigned char *pSrcRow, int width, bool srgb, float *pRow )
+{
+	const SrgbTables &tables = GetSrgbTables();
+	int iFloat = 0;
+
+	if ( srgb )
+	{
+		for ( ; iFloat < width * 4; iFloat += 4 )
+		{
+			pRow[iFloat + 0] = tables.linear8[pSrcRow[iFloat + 0]];
+			pRow[iFloat + 1] = tables.linear8[pSrcRow[iFloat + 1]];
+			pRow[iFloat + 2] = tables.linear8[pSrcRow[iFloat + 2]];
+			pRow[iFloat + 3] = tables.unorm8[pSrcRow[iFloat + 3]];
+		}
+
+		return pRow;
+	}
+
+#if ETC_FILTER_SSE
+	// 4 pixels at a time, divided rather than multiplied by 1 / 255 to give the same floats as Image
+	__m128i vZero = _mm_setzero_si128();
+	__m128 v255 = _mm_set1_ps(255.0f);
+	for ( ; iFloat + 16 <= width * 4; iFloat += 16 )
+	{
+		__m128i vBytes = _mm_loadu_si128((const __m128i *)(pSrcRow + iFloat));
+		__m128i vWords0 = _mm_unpacklo_epi8(vBytes, vZero);
+		__m128i vWords1 = _mm_unpackhi_epi8(vBytes, vZero);
+		_mm_storeu_ps(pRow + iFloat + 0, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(vWords0, vZero)), v255));
+		_mm_storeu_ps(pRow + iFloat + 4, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(vWords0, vZero)), v255));
+		_mm_storeu_ps(pRow + iFloat + 8, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(vWords1, vZero)), v255));
+		_mm_storeu_ps(pRow + iFloat + 12, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(vWords1, vZero)), v255));
+	}
+#endif
+	for ( ; iFloat < width * 4; iFloat++ )
+	{
+		pRow[iFloat] = tables.unorm8[pSrcRow[iFloat]];
+	}
+
+	return pRow;
+}
+
+//**-------------------------------------------------------------------------
+//** Name: EncodeSrgbRow( float *pRow, int width )
+//** Description: Converts the RGB of a row of linear pixels back to sRGB.
+//**-------------------------------------------------------------------------
+static void EncodeSrgbRow( float *pRow, int width )
+{
+	const SrgbTables &tables = GetSrgbTables();
+	for ( int iFloat = 0; iFloat < width * 4; iFloat += 4 )
+	{
+		pRow[iFloat + 0] = LookUpSrgbTable( tables.srgb, pRow[iFloat + 0] );
+		pRow[iFloat + 1] = LookUpSrgbTable( tables.srgb, pRow[iFloat + 1] );
+		pRow[iFloat + 2] = LookUpSrgbTable( tables.srgb, pRow[iFloat + 2] );
+	}
+}
+
+//**-------------------------------------------------------------------------
+//** Name: HalveRowsBox( ... )
+//** Description: Averages each 2x2 source pixels into the rows
+//**    [firstRow, endRow) of the destination image. pRows holds two
+//**    converted source rows.
+//**-------------------------------------------------------------------------
+template <typename T>
+static void HalveRowsBox( const T *pSrcImage, int srcWidth, float *pDestImage, int destWidth, bool srgb,
+                          int firstRow, int endRow, float *pRows )
+{
+	for ( int iRow = firstRow; iRow < endRow; iRow++ )
+	{
+		const float *pRow0 = LoadRow( pSrcImage + (size_t)(2 * iRow) * srcWidth * 4, srcWidth, srgb, pRows );
+		const float *pRow1 = LoadRow( pSrcImage + (size_t)(2 * iRow + 1) * srcWidth * 4, srcWidth, srgb, pRows + srcWidth * 4 );
+		float *pDestRow = pDestImage + (size_t)iRow * destWidth * 4;
+
+		for ( int iCol = 0; iCol < destWidth; iCol++ )
+		{
+			const float *pPixels0 = pRow0 + iCol * 8;
+			const float *pPixels1 = pRow1 + iCol * 8;
+#if ETC_FILTER_SSE
+			__m128 vSum = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(pPixels0), _mm_loadu_ps(pPixels0 + 4)),
+			                         _mm_add_ps(_mm_loadu_ps(pPixels1), _mm_loadu_ps(pPixels1 + 4)));
+			_mm_storeu_ps(pDestRow + iCol * 4, _mm_mul_ps(vSum, _mm_set1_ps(0.25f)));
+#else
+			for ( int iComponent = 0; iComponent < 4; iComponent++ )
+			{
+				pDestRow[iCol * 4 + iComponent] = 0.25f * ((pPixels0[iComponent] + pPixels0[4 + iComponent]) +
+				                                           (pPixels1[iComponent] + pPixels1[4 + iComponent]));
+			}
+#endif
+		}
+
+		if ( srgb )
+		{
+			EncodeSrgbRow( pDestRow, destWidth );
+		}
+	}
+}
+
+// taps of the windowed sinc halving filters, 3 destination pixels either side of each destination pixel
+static const int HalveTaps = 12;
+static const int HalvePad = HalveTaps / 2;
+
+// destination rows of a windowed sinc halving task, whose first and last source rows are filtered
+// horizontally by the tasks either side of it too
+static const int HalveTileRows = 32;
+
+//**-------------------------------------------------------------------------
+//** Name: CalcHalveWeights( double (*FilterProc)(double),
+//**                         float weights[HalveTaps] )
+//** Description: Source pixel 2 * iDest - 5 + iTap is (iTap - 5.5) / 2
+//**    destination pixels from the centre of destination pixel iDest.
+//**-------------------------------------------------------------------------
+static void CalcHalveWeights( double (*FilterProc)(double), float weights[HalveTaps] )
+{
+	double weight[HalveTaps];
+	double totalWeight = 0.0;
+
+	for ( int iTap = 0; iTap < HalveTaps; iTap++ )
+	{
+		weight[iTap] = (*FilterProc)( (iTap - 5.5) * 0.5 );
+		totalWeight += weight[iTap];
+	}
+
+	for ( int iTap = 0; iTap < HalveTaps; iTap++ )
+	{
+		weights[iTap] = static_cast<float>(weight[iTap] / totalWeight);
+	}
+}
+
+static inline int HalveSourceIndex( int i, int size, bool wrap )
+{
+	if ( wrap )
+	{
+		i %= size;
+		return (i < 0) ? i + size : i;
+	}
+
+	return std::max(0, std::min(size - 1, i));
+}
+
+//**-------------------------------------------------------------------------
+//** Name: HalveRowHorizontally( ... )
+//** Description: Filters one converted source row, which is in pPadded
+//**    after HalvePad pixels, into a row of half its width. The HalvePad
+//**    pixels either side of the row are filled with the clamped or wrapped
+//**    source first, so that no tap needs a bounds check.
+//**-------------------------------------------------------------------------
+static void HalveRowHorizontally( float *pPadded, int srcWidth, bool wrap, const float *pWeights,
+                                  float *pTempRow, int destWidth )
+{
+	const float *pRow = pPadded + HalvePad * 4;
+	for ( int iPad = 0; iPad < HalvePad; iPad++ )
+	{
+		memcpy( pPadded + iPad * 4, pRow + HalveSourceIndex( iPad - HalvePad, srcWidth, wrap ) * 4, 4 * sizeof(float) );
+		memcpy( pPadded + (HalvePad + srcWidth + iPad) * 4, pRow + HalveSourceIndex( srcWidth + iPad, srcWidth, wrap ) * 4, 4 * sizeof(float) );
+	}
+
+#if ETC_FILTER_SSE
+	__m128 vWeights[HalveTaps];
+	for ( int iTap = 0; iTap < HalveTaps; iTap++ )
+	{
+		vWeights[iTap] = _mm_set1_ps(pWeights[iTap]);
+	}
+#endif
+
+	for ( int iCol = 0; iCol < destWidth; iCol++ )
+	{
+		// source pixel 2 * iCol - 5 is at 2 * iCol + 1 of the padded row
+		const float *pTaps = pPadded + (2 * iCol + 1) * 4;
+#if ETC_FILTER_SSE
+		__m128 vSum = _mm_setzero_ps();
+		for ( int iTap = 0; iTap < HalveTaps; iTap++ )
+		{
+			vSum = _mm_add_ps(vSum, _mm_mul_ps(vWeights[iTap], _mm_loadu_ps(pTaps + iTap * 4)));
+		}
+		_mm_storeu_ps(pTempRow + iCol * 4, _mm_min_ps(_mm_max_ps(vSum, _mm_setzero_ps()), _mm_set1_ps(255.0f)));
+#else
+		for ( int iComponent = 0; iComponent < 4; iComponent++ )
+		{
+			float sum = 0.0f;
+			for ( int iTap = 0; iTap < HalveTaps; iTap++ )
+			{
+				sum += pWeights[iTap] * pTaps[iTap * 4 + iComponent];
+			}
+			pTempRow[iCol * 4 + iComponent] = std::max(0.0f, std::min(255.0f, sum));
+		}
+#endif
+	}
+}
+
+//**-------------------------------------------------------------------------
+//** Name: HalveRowsSinc( ... )
+//** Description: Filters the rows [firstRow, endRow) of the destination
+//**    image with a windowed sinc, first filtering the source rows they
+//**    need horizontally into a tile of half width rows.
+//**-------------------------------------------------------------------------
+template <typename T>
+static void HalveRowsSinc( const T *pSrcImage, int srcWidth, int srcHeight, float *pDestImage, int destWidth,
+                           unsigned int flags, const float *pWeights, int firstRow, int endRow )
+{
+	bool srgb = !!(flags & FILTER_SRGB);
+	int rowFloats = destWidth * 4;
+	int firstSrcRow = 2 * firstRow - (HalvePad - 1);
+	int tempRows = 2 * (endRow - firstRow) + HalveTaps - 2;
+
+	float *pPadded = new float[(srcWidth + 2 * HalvePad) * 4];
+	float *pTempRows = new float[(size_t)tempRows * rowFloats];
+
+	for ( int iTempRow = 0; iTempRow < tempRows; iTempRow++ )
+	{
+		int iSrcRow = HalveSourceIndex( firstSrcRow + iTempRow, srcHeight, !!(flags & FILTER_WRAP_Y) );
+		float *pRow = pPadded + HalvePad * 4;
+		const float *pLoadedRow = LoadRow( pSrcImage + (size_t)iSrcRow * srcWidth * 4, srcWidth, srgb, pRow );
+		if ( pLoadedRow != pRow )
+		{
+			memcpy( pRow, pLoadedRow, srcWidth * 4 * sizeof(float) );
+		}
+
+		HalveRowHorizontally( pPadded, srcWidth, !!(flags & FILTER_WRAP_X), pWeights,
+		                      pTempRows + (size_t)iTempRow * rowFloats, destWidth );
+	}
+
+#if ETC_FILTER_SSE
+	__m128 vWeights[HalveTaps];
+	for ( int iTap = 0; iTap < HalveTaps; iTap++ )
+	{
+		vWeights[iTap] = _mm_set1_ps(pWeights[iTap]);
+	}
+#endif
+
+	for ( int iRow = firstRow; iRow < endRow; iRow++ )
+	{
+		const float *pTaps = pTempRows + (size_t)(2 * (iRow - firstRow)) * rowFloats;
+		float *pDestRow = pDestImage + (size_t)iRow * rowFloats;
+
+		for ( int iFloat = 0; iFloat < rowFloats; iFloat += 4 )
+		{
+#if ETC_FILTER_SSE
+			__m128 vSum = _mm_setzero_ps();
+			for ( int iTap = 0; iTap < HalveTaps; iTap++ )
+			{
+				vSum = _mm_add_ps(vSum, _mm_mul_ps(vWeights[iTap], _mm_loadu_ps(pTaps + (size_t)iTap * rowFloats + iFloat)));
+			}
+			_mm_storeu_ps(pDestRow + iFloat, _mm_min_ps(_mm_max_ps(vSum, _mm_setzero_ps()), _mm_set1_ps(255.0f)));
+#else
+			for ( int iComponent = 0; iComponent < 4; iComponent++ )
+			{
+				float sum = 0.0f;
+				for ( int iTap = 0; iTap < HalveTaps; iTap++ )
+				{
+					sum += pWeights[iTap] * pTaps[(size_t)iTap * rowFloats + iFloat + iComponent];
+				}
+				pDestRow[iFloat + iComponent] = std::max(0.0f, std::min(255.0f, sum));
+			}
+#endif
+		}
+
+		if ( srgb )
+		{
+			EncodeSrgbRow( pDestRow, destWidth );
+		}
+	}
+
+	delete[] pTempRows;
+	delete[] pPadded;
+}
+
+//**-------------------------------------------------------------------------
+//** Name: FilterHalveResample( ... )
+//** Description: Filters a source that isn't twice the size of the
+//**    destination with FilterTwoPass, from a linear float copy of it.
+//**-------------------------------------------------------------------------
+template <typename T>
+static int FilterHalveResample( const T *pSrcImage, int srcWidth, int srcHeight,
+                                float *pDestImage, int destWidth, int destHeight, MipFilter filter, unsigned int flags,
+                                ThreadPool *pThreadPool )
+{
+	bool srgb = !!(flags & FILTER_SRGB);
+	double (*FilterProc)(double) = (filter == MipFilter::HALVE_BOX) ? FilterBox :
+	                               (filter == MipFilter::HALVE_KAISER) ? FilterKaiser : FilterLanczos3;
+
+	float *pLinearImage = new float[(size_t)srcWidth * srcHeight * 4];
+	RunFilterTiles( pThreadPool, srcHeight, [&](int firstRow, int endRow) {
+		for ( int iRow = firstRow; iRow < endRow; iRow++ )
+		{
+			float *pRow = pLinearImage + (size_t)iRow * srcWidth * 4;
+			const float *pLoadedRow = LoadRow( pSrcImage + (size_t)iRow * srcWidth * 4, srcWidth, srgb, pRow );
+			if ( pLoadedRow != pRow )
+			{
+				memcpy( pRow, pLoadedRow, srcWidth * 4 * sizeof(float) );
+			}
+		}
+	});
+
+	int result = FilterTwoPass( pLinearImage, srcWidth, srcHeight, pDestImage, destWidth, destHeight,
+	                            flags & (FILTER_WRAP_X | FILTER_WRAP_Y), FilterProc, pThreadPool );
+	delete[] pLinearImage;
+
+	if ( result && srgb )
+	{
+		RunFilterTiles( pThreadPool, destHeight, [&](int firstRow, int endRow) {
+			for ( int iRow = firstRow; iRow < endRow; iRow++ )
+			{
+				EncodeSrgbRow( pDestImage + (size_t)iRow * destWidth * 4, destWidth );
+			}
+		});
+	}
+
+	return result;
+}
+
+//**-------------------------------------------------------------------------
+//** Name: FilterHalveImage( ... )
+//** Returns: 0 on failure and 1 on success
+//** Description: The FilterHalve overloads, for float and RGBA8 sources.
+//**-------------------------------------------------------------------------
+template <typename T>
+static int FilterHalveImage( const T *pSrcImage, int srcWidth, int srcHeight,
+                             float *pDestImage, int destWidth, int destHeight, MipFilter filter, unsigned int flags,
+                             ThreadPool *pThreadPool )
+{
+	if ( destWidth < 1 || destHeight < 1 )
+	{
+		return 0;
+	}
+
+	if ( srcWidth != 2 * destWidth || srcHeight != 2 * destHeight )
+	{
+		return FilterHalveResample( pSrcImage, srcWidth, srcHeight, pDestImage, destWidth, destHeight, filter, flags, pThreadPool );
+	}
+
+	if ( filter == MipFilter::HALVE_BOX )
+	{
+		RunFilterTiles( pThreadPool, destHeight, [&](int firstRow, int endRow) {
+			float *pRows = new float[srcWidth * 8];
+			HalveRowsBox( pSrcImage, srcWidth, pDestImage, destWidth, !!(flags & FILTER_SRGB), firstRow, endRow, pRows );
+			delete[] pRows;
+		});
+
+		return 1;
+	}
+
+	float weights[HalveTaps];
+	CalcHalveWeights( (filter == MipFilter::HALVE_KAISER) ? FilterKaiser : FilterLanczos3, weights );
+
+	RunFilterTiles( pThreadPool, destHeight, [&](int firstRow, int endRow) {
+		HalveRowsSinc( pSrcImage, srcWidth, srcHeight, pDestImage, destWidth, flags, weights, firstRow, endRow );
+	}, HalveTileRows );
+
+	return 1;
+}
+
+int FilterHalve( const float *pSrcImage, int srcWidth, int srcHeight,
+                 float *pDestImage, int destWidth, int destHeight, MipFilter filter, unsigned int flags,
+                 ThreadPool *pThreadPool )
+{
+	return FilterHalveImage( pSrcImage, srcWidth, srcHeight, pDestImage, destWidth, destHeight, filter, flags, pThreadPool );
+}
+
+int FilterHalve( const unsigned char *pSrcImage, int srcWidth, int srcHeight,
+                 float *pDestImage, int destWidth, int destHeight, MipFilter filter, unsigned int flags,
+                 ThreadPool *pThreadPool )
+{
+	return FilterHalveImage( pSrcImage, srcWidth, srcHeight, pDestImage, destWidth, destHeight, filter, flags, pThreadPool );
+}
+
 //**-------------------------------------------------------------------------
 //** Name: FilterResample(RGBCOLOR *pSrcImage, int srcWidth, int srcHeight, 
 //**                       RGBCOLOR *pDstImage, int dstWidth, int dstHeight)
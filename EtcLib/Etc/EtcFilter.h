@@ -17,6 +17,20 @@ enum WrapFlags
 	FILTER_WRAP_Y = 0x2
 };
 
+enum ColorSpaceFlags
+{
+	FILTER_SRGB = 0x4		// the RGB of the source is sRGB encoded, and is filtered in linear light by FilterHalve
+};
+
+// the filters EncodeMipmaps makes each mip level with
+enum class MipFilter
+{
+	LANCZOS3,			// FilterTwoPass with FilterLanczos3, from the source or the level before
+	HALVE_BOX,			// FilterHalve of the level before, averaging 2x2 pixels
+	HALVE_KAISER,		// FilterHalve of the level before, with a Kaiser windowed sinc
+	HALVE_LANCZOS3		// FilterHalve of the level before, with a Lanczos3 windowed sinc
+};
+
 typedef struct tagFilterWeights
 {
 	int   first;
@@ -37,6 +51,7 @@ typedef struct tagRGBCOLOR
 double FilterBox( double t );
 double FilterLinear( double t );
 double FilterLanczos3( double t );
+double FilterKaiser( double t );
 
 int FilterTwoPass( RGBCOLOR *pSrcImage, int srcWidth, int srcHeight, 
                     RGBCOLOR *pDestImage, int destWidth, int destHeight, unsigned int wrapFlags, double (*FilterProc)(double) );
@@ -46,6 +61,27 @@ void FilterResample( RGBCOLOR *pSrcImage, int srcWidth, int srcHeight,
 
 void CalcContributions(int srcSize, int destSize, double filterSize, bool wrap, double(*FilterProc)(double), FilterWeights contrib[]);
 
+class ThreadPool;
+
+// float images are filtered a tile of rows at a time, on the threads of pThreadPool if it isn't null,
+// accumulating in float with the contributions of each source size, destination size, wrap and filter
+// computed once and kept for later calls
+int FilterTwoPass(float *pSrcImage, int srcWidth, int srcHeight,
+                  float *pDestImage, int destWidth, int destHeight, unsigned int wrapFlags, double (*FilterProc)(double),
+                  ThreadPool *pThreadPool = nullptr);
+
+// halve a float or RGBA8 image with one of the HALVE_ filters, whose taps are centred on the 2x2 source
+// pixels each destination pixel covers, converting each row of RGBA8 pixels to float as it is read
+// flags are the wrap flags and FILTER_SRGB
+// a source that doesn't have twice the destination's width and height, i.e. an odd size, is converted to
+// float and filtered by FilterTwoPass with FilterBox, FilterKaiser or FilterLanczos3
+int FilterHalve(const float *pSrcImage, int srcWidth, int srcHeight,
+                float *pDestImage, int destWidth, int destHeight, MipFilter filter, unsigned int flags,
+                ThreadPool *pThreadPool = nullptr);
+int FilterHalve(const unsigned char *pSrcImage, int srcWidth, int srcHeight,
+                float *pDestImage, int destWidth, int destHeight, MipFilter filter, unsigned int flags,
+                ThreadPool *pThreadPool = nullptr);
+
 template <typename T>
 void FilterResample(T *pSrcImage, int srcWidth, int srcHeight, T *pDstImage, int dstWidth, int dstHeight)
 {
@@ -29,8 +29,10 @@ Image is an array of 4x4 blocks that represent the encoding of the source image
 
 #include "Etc.h"
 #include "EtcBlock4x4.h"
+#include "EtcBlock4x4EncodingArena.h"
 #include "EtcBlock4x4EncodingBits.h"
 #include "EtcExecutor.h"
+#include "EtcSortedBlockList.h"
 
 #if ETC_WINDOWS
 #include <windows.h>
@@ -56,9 +58,19 @@ namespace Etc
 	//
 	Image::Image(void)
 	{
+		m_sourceformat = SourceFormat::RGBA32F;
 		m_pafrgbaSource = nullptr;
+		m_paucSourceRGBA8 = nullptr;
+		m_paushSourceRGBA16 = nullptr;
 
 		m_pablock = nullptr;
+		m_pafrgbaBlockSources = nullptr;
+		m_pafrgbaBlockDecodedColors = nullptr;
+		m_pafBlockError = nullptr;
+		m_paboolBlockDone = nullptr;
+		m_parena = nullptr;
+		m_boolOwnsArena = false;
+		m_psortedblocklist = nullptr;
 
 		m_format = Format::UNKNOWN;
 		m_iNumOpaquePixels = 0;
@@ -72,9 +84,55 @@ namespace Etc
 	//
 	Image::Image(float *a_pafSourceRGBA, unsigned int a_uiSourceWidth,
 					unsigned int a_uiSourceHeight, 
-					ErrorMetric a_errormetric)
+					ErrorMetric a_errormetric,
+					Block4x4EncodingArena *a_parena)
 	{
+		m_sourceformat = SourceFormat::RGBA32F;
 		m_pafrgbaSource = (ColorFloatRGBA *) a_pafSourceRGBA;
+		m_paucSourceRGBA8 = nullptr;
+		m_paushSourceRGBA16 = nullptr;
+
+		InitSourceBlocks(a_uiSourceWidth, a_uiSourceHeight, a_errormetric, a_parena);
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// constructor using an 8 bit per channel source image
+	//
+	Image::Image(const unsigned char *a_paucSourceRGBA8, unsigned int a_uiSourceWidth,
+					unsigned int a_uiSourceHeight,
+					ErrorMetric a_errormetric,
+					Block4x4EncodingArena *a_parena)
+	{
+		m_sourceformat = SourceFormat::RGBA8;
+		m_pafrgbaSource = nullptr;
+		m_paucSourceRGBA8 = a_paucSourceRGBA8;
+		m_paushSourceRGBA16 = nullptr;
+
+		InitSourceBlocks(a_uiSourceWidth, a_uiSourceHeight, a_errormetric, a_parena);
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// constructor using a 16 bit per channel source image
+	//
+	Image::Image(const unsigned short *a_paushSourceRGBA16, unsigned int a_uiSourceWidth,
+					unsigned int a_uiSourceHeight,
+					ErrorMetric a_errormetric,
+					Block4x4EncodingArena *a_parena)
+	{
+		m_sourceformat = SourceFormat::RGBA16;
+		m_pafrgbaSource = nullptr;
+		m_paucSourceRGBA8 = nullptr;
+		m_paushSourceRGBA16 = a_paushSourceRGBA16;
+
+		InitSourceBlocks(a_uiSourceWidth, a_uiSourceHeight, a_errormetric, a_parena);
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// set up the blocks of an image that will be encoded from a source image
+	//
+	void Image::InitSourceBlocks(unsigned int a_uiSourceWidth, unsigned int a_uiSourceHeight,
+									ErrorMetric a_errormetric, Block4x4EncodingArena *a_parena)
+	{
 		m_uiSourceWidth = a_uiSourceWidth;
 		m_uiSourceHeight = a_uiSourceHeight;
 
@@ -87,6 +145,18 @@ namespace Etc
 		m_pablock = new Block4x4[GetNumberOfBlocks()];
 		assert(m_pablock);
 
+		// the blocks keep their source pixels and decoded colors here, block after block
+		m_pafrgbaBlockSources = new ColorFloatRGBA[GetNumberOfBlocks() * Block4x4::PIXELS];
+		m_pafrgbaBlockDecodedColors = new ColorFloatRGBA[GetNumberOfBlocks() * Block4x4::PIXELS];
+
+		m_pafBlockError = new float[GetNumberOfBlocks()]();
+		m_paboolBlockDone = new bool[GetNumberOfBlocks()]();
+
+		// the arena is sized by the executor once the format is known
+		m_boolOwnsArena = (a_parena == nullptr);
+		m_parena = m_boolOwnsArena ? new Block4x4EncodingArena : a_parena;
+		m_psortedblocklist = nullptr;
+
 		m_format = Format::UNKNOWN;
 
 		m_errormetric = a_errormetric;
@@ -104,10 +174,14 @@ namespace Etc
 					unsigned int a_uiSourceWidth, unsigned int a_uiSourceHeight,
 					unsigned char *a_paucEncidingBits, unsigned int a_uiEncodingBitsBytes,
 					Block4x4EncodingBits::Format const a_encodingbitsformat,
-					Image *a_pimageSource, ErrorMetric a_errormetric)
+					Image *a_pimageSource, ErrorMetric a_errormetric,
+					Block4x4EncodingArena *a_parena)
 	{
 		assert(a_encodingbitsformat != Block4x4EncodingBits::Format::UNKNOWN);
+		m_sourceformat = SourceFormat::RGBA32F;
 		m_pafrgbaSource = nullptr;
+		m_paucSourceRGBA8 = nullptr;
+		m_paushSourceRGBA16 = nullptr;
 		m_uiSourceWidth = a_uiSourceWidth;
 		m_uiSourceHeight = a_uiSourceHeight;
 
@@ -122,6 +196,17 @@ namespace Etc
 		m_pablock = new Block4x4[uiBlocks];
 		assert(m_pablock);
 
+		m_pafrgbaBlockSources = new ColorFloatRGBA[uiBlocks * Block4x4::PIXELS];
+		m_pafrgbaBlockDecodedColors = new ColorFloatRGBA[uiBlocks * Block4x4::PIXELS];
+
+		m_pafBlockError = new float[uiBlocks]();
+		m_paboolBlockDone = new bool[uiBlocks]();
+
+		m_boolOwnsArena = (a_parena == nullptr);
+		m_parena = m_boolOwnsArena ? new Block4x4EncodingArena : a_parena;
+		m_parena->Reserve(uiBlocks, a_format);
+		m_psortedblocklist = nullptr;
+
 		m_format = a_format;
 
 		m_iNumOpaquePixels = 0;
@@ -137,7 +222,10 @@ namespace Etc
 		for (unsigned int uiBlock = 0; uiBlock < uiBlocks; uiBlock++)
 		{
 			m_pablock[uiBlock].InitFromEtcEncodingBits(a_format, uiH, uiV, paucEncodingBits, 
-														a_pimageSource, a_errormetric);
+														a_pimageSource, a_errormetric,
+														m_parena->GetStorage(uiBlock),
+														&m_pafrgbaBlockSources[uiBlock * Block4x4::PIXELS],
+														&m_pafrgbaBlockDecodedColors[uiBlock * Block4x4::PIXELS]);
 			paucEncodingBits += uiEncodingBitsBytesPerBlock;
 			uiH += 4;
 			if (uiH >= m_uiSourceWidth)
@@ -159,13 +247,72 @@ namespace Etc
 			m_pablock = nullptr;
 		}
 
+		delete[] m_pafrgbaBlockSources;
+		delete[] m_pafrgbaBlockDecodedColors;
+		delete[] m_pafBlockError;
+		delete[] m_paboolBlockDone;
+		delete m_psortedblocklist;
+
+		// the blocks, and with them the encoders in the arena, are already destroyed
+		if (m_boolOwnsArena)
+		{
+			delete m_parena;
+		}
+
 		/*if (m_paucEncodingBits != nullptr)
 		{
 			delete[] m_paucEncodingBits;
 			m_paucEncodingBits = nullptr;
 		}*/
 	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// reuse the image for a new source image with the same dimensions
+	// the source pixels are read again by the next encode
+	//
+	void Image::SetSource(float *a_pafSourceRGBA, ErrorMetric a_errormetric)
+	{
+		m_sourceformat = SourceFormat::RGBA32F;
+		m_pafrgbaSource = (ColorFloatRGBA *) a_pafSourceRGBA;
+		m_paucSourceRGBA8 = nullptr;
+		m_paushSourceRGBA16 = nullptr;
+		m_errormetric = a_errormetric;
+		m_format = Format::UNKNOWN;
+	}
+
+	void Image::SetSource(const unsigned char *a_paucSourceRGBA8, ErrorMetric a_errormetric)
+	{
+		m_sourceformat = SourceFormat::RGBA8;
+		m_pafrgbaSource = nullptr;
+		m_paucSourceRGBA8 = a_paucSourceRGBA8;
+		m_paushSourceRGBA16 = nullptr;
+		m_errormetric = a_errormetric;
+		m_format = Format::UNKNOWN;
+	}
+
+	void Image::SetSource(const unsigned short *a_paushSourceRGBA16, ErrorMetric a_errormetric)
+	{
+		m_sourceformat = SourceFormat::RGBA16;
+		m_pafrgbaSource = nullptr;
+		m_paucSourceRGBA8 = nullptr;
+		m_paushSourceRGBA16 = a_paushSourceRGBA16;
+		m_errormetric = a_errormetric;
+		m_format = Format::UNKNOWN;
+	}
 	
+	// ----------------------------------------------------------------------------------------------------
+	// copy the error and done flag of a block's encoding into the per block arrays
+	// each block is only updated by the thread that just iterated it
+	//
+	void Image::UpdateBlockState(unsigned int a_uiBlock)
+	{
+		assert(a_uiBlock < GetNumberOfBlocks());
+
+		Block4x4 *pblock = &m_pablock[a_uiBlock];
+		m_pafBlockError[a_uiBlock] = pblock->GetError();
+		m_paboolBlockDone[a_uiBlock] = pblock->GetEncoding()->IsDone();
+	}
+
 	// ----------------------------------------------------------------------------------------------------
 	// return a string name for a given image format
 	//
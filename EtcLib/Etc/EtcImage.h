@@ -25,6 +25,7 @@
 namespace Etc
 {
 	class Block4x4;
+	class Block4x4EncodingArena;
 	class EncoderSpec;
 	class SortedBlockList;
 
@@ -56,9 +57,24 @@ namespace Etc
 		};
 
 		// constructor using source image
+		// a_parena, if not null, holds the block encoders and may be reused by a later image
+		// once this image is destroyed; otherwise the image allocates its own
 		Image(float *a_pafSourceRGBA, unsigned int a_uiSourceWidth,
 				unsigned int a_uiSourceHeight,
-				ErrorMetric a_errormetric);
+				ErrorMetric a_errormetric,
+				Block4x4EncodingArena *a_parena = nullptr);
+
+		// constructors using an 8 or 16 bit per channel RGBA source image
+		// the source is converted to float one 4x4 block at a time while encoding
+		Image(const unsigned char *a_paucSourceRGBA8, unsigned int a_uiSourceWidth,
+				unsigned int a_uiSourceHeight,
+				ErrorMetric a_errormetric,
+				Block4x4EncodingArena *a_parena = nullptr);
+
+		Image(const unsigned short *a_paushSourceRGBA16, unsigned int a_uiSourceWidth,
+				unsigned int a_uiSourceHeight,
+				ErrorMetric a_errormetric,
+				Block4x4EncodingArena *a_parena = nullptr);
 
 		// constructor using encoding bits
 		Image(Format a_format, 
@@ -66,9 +82,29 @@ namespace Etc
 				unsigned char *a_paucEncodingBits, unsigned int a_uiEncodingBitsBytes,
 				Block4x4EncodingBits::Format a_encodingbitsformat,
 				Image *a_pimageSource,
-				ErrorMetric a_errormetric);
+				ErrorMetric a_errormetric,
+				Block4x4EncodingArena *a_parena = nullptr);
 
 		~Image(void);
+
+		// point the image at a new source image of the same dimensions
+		// the blocks, encoders and sorter of the image are kept and reused by the next encode
+		void SetSource(float *a_pafSourceRGBA, ErrorMetric a_errormetric);
+		void SetSource(const unsigned char *a_paucSourceRGBA8, ErrorMetric a_errormetric);
+		void SetSource(const unsigned short *a_paushSourceRGBA16, ErrorMetric a_errormetric);
+
+		// the pixel layout of the source image
+		enum class SourceFormat
+		{
+			RGBA32F,
+			RGBA8,
+			RGBA16
+		};
+
+		inline SourceFormat GetSourceFormat(void) const
+		{
+			return m_sourceformat;
+		}
 public:
 		
 		inline unsigned int GetSourceWidth(void)
@@ -96,17 +132,48 @@ public:
 			return m_uiBlockColumns * m_uiBlockRows;
 		}
 
+		inline unsigned int GetBlockColumns(void)
+		{
+			return m_uiBlockColumns;
+		}
+
+		inline unsigned int GetBlockRows(void)
+		{
+			return m_uiBlockRows;
+		}
+
 		inline Block4x4 * GetBlocks()
 		{
 			return m_pablock;
 		}
 
+		// per block copies of the encoding state that every effort pass scans
+		// kept as contiguous per field arrays so that sorting doesn't chase each block's encoder
+		inline const float * GetBlockErrors(void)
+		{
+			return m_pafBlockError;
+		}
+
+		inline const bool * GetBlockDoneFlags(void)
+		{
+			return m_paboolBlockDone;
+		}
+
+		inline Block4x4EncodingArena * GetEncodingArena(void)
+		{
+			return m_parena;
+		}
+
+		// copy the state of block a_uiBlock's encoding after an encoding iteration
+		void UpdateBlockState(unsigned int a_uiBlock);
+
 
 		float GetError(void);
 
+		// only for RGBA32F sources
 		inline ColorFloatRGBA * GetSourcePixel(unsigned int a_uiH, unsigned int a_uiV)
 		{
-			if (a_uiH >= m_uiSourceWidth || a_uiV >= m_uiSourceHeight)
+			if (a_uiH >= m_uiSourceWidth || a_uiV >= m_uiSourceHeight || m_pafrgbaSource == nullptr)
 			{
 				return nullptr;
 			}
@@ -114,6 +181,41 @@ public:
 			return &m_pafrgbaSource[a_uiV*m_uiSourceWidth + a_uiH];
 		}
 
+		// read a source pixel of any source format as float
+		// returns false if [a_uiH,a_uiV] is outside of the source image
+		inline bool ReadSourcePixel(unsigned int a_uiH, unsigned int a_uiV, ColorFloatRGBA &a_frgba)
+		{
+			if (a_uiH >= m_uiSourceWidth || a_uiV >= m_uiSourceHeight)
+			{
+				return false;
+			}
+
+			unsigned int uiPixel = a_uiV*m_uiSourceWidth + a_uiH;
+
+			switch (m_sourceformat)
+			{
+			case SourceFormat::RGBA8:
+				{
+					const unsigned char *pauc = &m_paucSourceRGBA8[4 * uiPixel];
+					a_frgba = ColorFloatRGBA(pauc[0] / 255.0f, pauc[1] / 255.0f, pauc[2] / 255.0f, pauc[3] / 255.0f);
+				}
+				break;
+
+			case SourceFormat::RGBA16:
+				{
+					const unsigned short *paush = &m_paushSourceRGBA16[4 * uiPixel];
+					a_frgba = ColorFloatRGBA(paush[0] / 65535.0f, paush[1] / 65535.0f, paush[2] / 65535.0f, paush[3] / 65535.0f);
+				}
+				break;
+
+			default:
+				a_frgba = m_pafrgbaSource[uiPixel];
+				break;
+			}
+
+			return true;
+		}
+
 		inline Format GetFormat(void)
 		{
 			return m_format;
@@ -143,9 +245,16 @@ public:
 
 		Image(void);
 
+		void InitSourceBlocks(unsigned int a_uiSourceWidth, unsigned int a_uiSourceHeight,
+								ErrorMetric a_errormetric, Block4x4EncodingArena *a_parena);
+
 
 		// inputs
+		// only the source pointer for m_sourceformat is set
+		SourceFormat m_sourceformat;
 		ColorFloatRGBA *m_pafrgbaSource;
+		const unsigned char *m_paucSourceRGBA8;
+		const unsigned short *m_paushSourceRGBA16;
 		unsigned int m_uiSourceWidth;
 		unsigned int m_uiSourceHeight;
 		unsigned int m_uiExtendedWidth;
@@ -154,6 +263,13 @@ public:
 		unsigned int m_uiBlockRows;
 		// intermediate data
 		Block4x4 *m_pablock;
+		ColorFloatRGBA *m_pafrgbaBlockSources;			// Block4x4::PIXELS per block, vertical scan
+		ColorFloatRGBA *m_pafrgbaBlockDecodedColors;	// Block4x4::PIXELS per block
+		float *m_pafBlockError;
+		bool *m_paboolBlockDone;
+		Block4x4EncodingArena *m_parena;
+		bool m_boolOwnsArena;
+		SortedBlockList *m_psortedblocklist;	// created by the first encode
 		// encoding
 		Format m_format;
 		ErrorMetric m_errormetric;
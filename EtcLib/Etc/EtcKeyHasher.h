@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+namespace Etc {
+
+	// two 64-bit hashes with different mixing, so that a 128-bit key tells cache entries apart
+	// used by BlockCache and DiskCache
+	//
+	class KeyHasher
+	{
+	public:
+		KeyHasher(void)
+			: m_uiHash0(0xcbf29ce484222325ull)
+			, m_uiHash1(0x6a09e667f3bcc909ull)
+		{}
+
+		inline void Add(std::uint32_t a_uiWord)
+		{
+			m_uiHash0 ^= a_uiWord;
+			m_uiHash0 *= 0x100000001b3ull;
+
+			m_uiHash1 += a_uiWord;
+			m_uiHash1 *= 0x9e3779b97f4a7c15ull;
+			m_uiHash1 ^= m_uiHash1 >> 32;
+		}
+
+		inline void Add(const void *a_pWords, unsigned int a_uiBytes)
+		{
+			const unsigned char *pauc = static_cast<const unsigned char *>(a_pWords);
+			for (unsigned int uiByte = 0; uiByte < a_uiBytes; uiByte += sizeof(std::uint32_t))
+			{
+				std::uint32_t uiWord;
+				memcpy(&uiWord, &pauc[uiByte], sizeof(uiWord));
+				Add(uiWord);
+			}
+		}
+
+		inline void Get(std::uint64_t a_auiHash[2]) const
+		{
+			a_auiHash[0] = m_uiHash0;
+			a_auiHash[1] = m_uiHash1;
+		}
+
+	private:
+		std::uint64_t m_uiHash0;
+		std::uint64_t m_uiHash1;
+	};
+
+} // namespace Etc
@@ -0,0 +1,235 @@
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+#include "EtcBlock4x4EncodingArena.h"
+#include "EtcStreamEncoder.h"
+#include "EtcThreadedExecutor.h"
+
+namespace Etc {
+
+	// error buckets per doubling of the error, and the buckets of errors below and above 2^0
+	static const int ERROR_BUCKETS_PER_OCTAVE = 8;
+	static const int ERROR_BUCKET_OCTAVES = 32;
+	static const unsigned int ERROR_BUCKETS = 2 * ERROR_BUCKETS_PER_OCTAVE * ERROR_BUCKET_OCTAVES + 1;
+
+	// a block whose error is below that of half an 8 bit step in every component of every pixel looks the same
+	// once stored, so it isn't worth any of the global budget
+	static const float MIN_WORTHY_ERROR = 16 * 4 * (0.5f / 255.0f) * (0.5f / 255.0f);
+
+	// ----------------------------------------------------------------------------------------------------
+	// a bucket for each 1 / ERROR_BUCKETS_PER_OCTAVE of a doubling of the error, with bucket 0 for no error
+	//
+	static unsigned int GetErrorBucket(float a_fError)
+	{
+		if (!(a_fError > 0.0f))
+		{
+			return 0;
+		}
+
+		int iBucket = static_cast<int>(std::floor(std::log2(a_fError) * ERROR_BUCKETS_PER_OCTAVE)) +
+						ERROR_BUCKETS_PER_OCTAVE * ERROR_BUCKET_OCTAVES + 1;
+
+		return static_cast<unsigned int>(std::max(1, std::min(static_cast<int>(ERROR_BUCKETS) - 1, iBucket)));
+	}
+
+	StreamEncoder::StreamEncoder(unsigned int a_uiBandBlockRows, EffortBudget a_effortbudget)
+		: m_uiBandBlockRows((a_uiBandBlockRows > 0) ? a_uiBandBlockRows : 1)
+		, m_effortbudget(a_effortbudget)
+		, m_fError(0.0f)
+		, m_uiEncodingBitsBytes(0)
+		, m_fEffort(0.0f)
+		, m_uiImageBlocks(0)
+		, m_uiBudgetBlocks(0)
+		, m_uiSpentBlocks(0)
+		, m_uiBucketedBlocks(0)
+	{
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// the band is pulled into one half of a double buffer while the band before it, in the other half, encodes
+	// the image, its blocks and its encoders are kept from band to band, and only rebuilt for a shorter last band
+	//
+	Executor::EncodingStatus StreamEncoder::Encode(SourceFunction const &a_source,
+													unsigned int a_uiSourceWidth,
+													unsigned int a_uiSourceHeight,
+													Image::Format a_format,
+													ErrorMetric a_errormetric,
+													float a_fEffort,
+													unsigned int a_uiJobs,
+													unsigned int a_uiMaxJobs,
+													SinkFunction const &a_sink)
+	{
+		m_fError = 0.0f;
+		m_uiEncodingBitsBytes = 0;
+
+		if (a_uiSourceWidth == 0 || a_uiSourceHeight == 0)
+		{
+			return Executor::ERROR_ZERO_WIDTH_OR_HEIGHT;
+		}
+
+		Block4x4EncodingBits::Format const encodingbitsformat = DetermineEncodingBitsFormat(a_format);
+		if (encodingbitsformat == Block4x4EncodingBits::Format::UNKNOWN)
+		{
+			return Executor::ERROR_UNKNOWN_FORMAT;
+		}
+
+		unsigned int const uiBandRows = 4 * m_uiBandBlockRows;
+		unsigned int const uiBlockColumns = (a_uiSourceWidth + 3) >> 2;
+		unsigned int const uiBlockRows = (a_uiSourceHeight + 3) >> 2;
+		unsigned int const uiBands = (uiBlockRows + m_uiBandBlockRows - 1) / m_uiBandBlockRows;
+
+		m_fEffort = a_fEffort;
+		m_uiImageBlocks = uiBlockColumns * uiBlockRows;
+		m_uiBudgetBlocks = static_cast<unsigned int>(roundf(0.01f * a_fEffort * m_uiImageBlocks));
+		m_uiSpentBlocks = 0;
+		m_auiErrorBuckets.assign(ERROR_BUCKETS, 0);
+		m_uiBucketedBlocks = 0;
+
+		unsigned int const uiBandFloats = a_uiSourceWidth * uiBandRows * 4;
+		float *apafBand[2] = { new float[uiBandFloats], new float[uiBandFloats] };
+
+		unsigned int const uiBandEncodingBitsBytes = uiBlockColumns * m_uiBandBlockRows *
+														Block4x4EncodingBits::GetBytesPerBlock(encodingbitsformat);
+		unsigned char *paucEncodingBits = new unsigned char[uiBandEncodingBitsBytes];
+
+		// too many jobs are clamped to a_uiMaxJobs, as ThreadedExecutor::Encode() does
+		unsigned int const uiPoolJobs = std::min(a_uiJobs, a_uiMaxJobs);
+		ThreadPool threadpool((uiPoolJobs > 1) ? uiPoolJobs - 1 : 0);
+		Block4x4EncodingArena arena;
+		Image *pimage = nullptr;
+
+		auto bandrows = [&](unsigned int a_uiBand) {
+			return std::min(uiBandRows, a_uiSourceHeight - a_uiBand * uiBandRows);
+		};
+
+		// the WARNING_ALL_ warnings hold for the image only if they hold for every band
+		unsigned int const uiAllWarnings = Executor::WARNING_ALL_OPAQUE_PIXELS | Executor::WARNING_ALL_TRANSPARENT_PIXELS;
+		unsigned int uiStatus = uiAllWarnings;
+
+		if (!a_source(0, bandrows(0), apafBand[0]))
+		{
+			uiStatus = Executor::ERROR_STREAM_SOURCE_FAILED;
+		}
+
+		for (unsigned int uiBand = 0; uiBand < uiBands && !IsError(static_cast<Executor::EncodingStatus>(uiStatus)); uiBand++)
+		{
+			float *pafBand = apafBand[uiBand & 1];
+			unsigned int const uiRows = bandrows(uiBand);
+
+			bool boolPulled = true;
+			std::thread sourcethread;
+			if (uiBand + 1 < uiBands)
+			{
+				sourcethread = std::thread([&]() {
+					boolPulled = a_source((uiBand + 1) * uiBandRows, bandrows(uiBand + 1), apafBand[(uiBand + 1) & 1]);
+				});
+			}
+
+			if (pimage != nullptr && pimage->GetSourceHeight() == uiRows)
+			{
+				pimage->SetSource(pafBand, a_errormetric);
+			}
+			else
+			{
+				// the image's encoders live in the arena, so the last image goes before the next is made
+				delete pimage;
+				pimage = new Image(pafBand, a_uiSourceWidth, uiRows, a_errormetric, &arena);
+			}
+
+			ThreadedExecutor executor(*pimage, &threadpool);
+			executor.SetEncodingBitsBuffer(paucEncodingBits, uiBandEncodingBitsBytes);
+			if (m_effortbudget == EffortBudget::GLOBAL)
+			{
+				executor.SetEffortBlocksFunction([this](Image &a_image) { return CalcGlobalEffortBlocks(a_image); });
+			}
+
+			unsigned int const uiBandStatus = executor.Encode(a_format, a_errormetric, a_fEffort, a_uiJobs, a_uiMaxJobs);
+			uiStatus = (uiStatus & (uiBandStatus | ~uiAllWarnings)) | (uiBandStatus & ~uiAllWarnings);
+
+			if (sourcethread.joinable())
+			{
+				sourcethread.join();
+			}
+
+			if (IsError(static_cast<Executor::EncodingStatus>(uiBandStatus)))
+			{
+				break;
+			}
+
+			if (!a_sink(uiBand * m_uiBandBlockRows, pimage->GetBlockRows(), paucEncodingBits, executor.GetEncodingBitsBytes()))
+			{
+				uiStatus |= Executor::ERROR_STREAM_SINK_FAILED;
+				break;
+			}
+
+			m_fError += pimage->GetError();
+			m_uiEncodingBitsBytes += executor.GetEncodingBitsBytes();
+
+			if (!boolPulled)
+			{
+				uiStatus |= Executor::ERROR_STREAM_SOURCE_FAILED;
+			}
+		}
+
+		delete pimage;
+		delete[] paucEncodingBits;
+		delete[] apafBand[0];
+		delete[] apafBand[1];
+
+		return static_cast<Executor::EncodingStatus>(uiStatus);
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// the blocks of a band to finish under the global budget, once the band's first pass is done
+	// the band's first pass errors join those of the bands before it, and the blocks to finish are the blocks of
+	// the band whose error is in the worst effort percentage of them all, so a band with more error than the
+	// bands before it gets more of the budget, and one with less gets less
+	// a band takes at most twice its share of the budget that is left, so that the bands after it aren't starved
+	// returns the band's finished blocks once those are done, which includes the blocks done by the first pass
+	//
+	unsigned int StreamEncoder::CalcGlobalEffortBlocks(Image &a_image)
+	{
+		unsigned int const uiBlocks = a_image.GetNumberOfBlocks();
+		const float *pafErrors = a_image.GetBlockErrors();
+		const bool *paboolDone = a_image.GetBlockDoneFlags();
+		unsigned int const uiLeftBlocks = m_uiImageBlocks - m_uiBucketedBlocks;
+
+		for (unsigned int uiBlock = 0; uiBlock < uiBlocks; uiBlock++)
+		{
+			m_auiErrorBuckets[GetErrorBucket(pafErrors[uiBlock])]++;
+		}
+		m_uiBucketedBlocks += uiBlocks;
+
+		// the lowest bucket of the worst effort percentage of the blocks so far
+		unsigned int const uiWorstBlocks = static_cast<unsigned int>(roundf(0.01f * m_fEffort * m_uiBucketedBlocks));
+		unsigned int uiThresholdBucket = ERROR_BUCKETS;
+		for (unsigned int uiCounted = 0; uiThresholdBucket > 0 && uiCounted < uiWorstBlocks; )
+		{
+			uiCounted += m_auiErrorBuckets[--uiThresholdBucket];
+		}
+
+		unsigned int uiDoneBlocks = 0;
+		unsigned int uiWorthyBlocks = 0;
+		for (unsigned int uiBlock = 0; uiBlock < uiBlocks; uiBlock++)
+		{
+			if (paboolDone[uiBlock])
+			{
+				uiDoneBlocks++;
+			}
+			else if (pafErrors[uiBlock] >= MIN_WORTHY_ERROR && GetErrorBucket(pafErrors[uiBlock]) >= uiThresholdBucket)
+			{
+				uiWorthyBlocks++;
+			}
+		}
+
+		unsigned int const uiLeftBudgetBlocks = m_uiBudgetBlocks - m_uiSpentBlocks;
+		unsigned int const uiMaxBlocks = std::min(uiLeftBudgetBlocks, static_cast<unsigned int>(
+												2ull * uiLeftBudgetBlocks * uiBlocks / std::max(uiLeftBlocks, 1u)));
+		unsigned int const uiBlocksToFinish = std::min(uiWorthyBlocks, uiMaxBlocks);
+		m_uiSpentBlocks += uiBlocksToFinish;
+
+		return uiDoneBlocks + uiBlocksToFinish;
+	}
+
+} // namespace Etc
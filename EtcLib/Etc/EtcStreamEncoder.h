@@ -0,0 +1,91 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include "EtcExecutor.h"
+
+namespace Etc {
+
+	// encodes an image a band of block rows at a time, for images too large to hold as one float image
+	//
+	// the rows of each band are pulled from a SourceFunction, and the encoding bits of each band are pushed to a
+	// SinkFunction once the band is encoded, in block row order, so the encoding bits of the image are everything
+	// the sink is given, one band after the other
+	// the next band is pulled while the current one encodes, so two bands of float rows and one band of blocks,
+	// encoders and encoding bits are all the memory an encode holds, whatever the height of the image
+	//
+	class StreamEncoder
+	{
+	public:
+		// fill a_pafRGBA with a_uiRows rows of float RGBA pixels of the image, starting at row a_uiFirstRow
+		// called on a thread of its own while the band before encodes, one band after the other
+		// returns false if the rows can't be read, which stops the encode
+		using SourceFunction = std::function<bool(unsigned int a_uiFirstRow, unsigned int a_uiRows, float *a_pafRGBA)>;
+
+		// take the encoding bits of a_uiBlockRows block rows, starting at block row a_uiFirstBlockRow
+		// called on the thread of Encode()
+		// returns false if the encoding bits can't be written, which stops the encode
+		using SinkFunction = std::function<bool(unsigned int a_uiFirstBlockRow, unsigned int a_uiBlockRows,
+												const unsigned char *a_paucEncodingBits, unsigned int a_uiEncodingBitsBytes)>;
+
+		// how the effort is shared between the bands
+		enum class EffortBudget
+		{
+			PER_BAND,		// each band finishes the effort percentage of its blocks, as an image of its own would
+			GLOBAL			// a band finishes the blocks that are among the effort percentage of blocks with the most
+							// error in every band so far, up to the effort percentage of the image's blocks in all,
+							// and leaves blocks with no visible error to the bands after it
+		};
+
+		// a_uiBandBlockRows rows of blocks, 4 * a_uiBandBlockRows rows of pixels, are encoded at a time
+		StreamEncoder(unsigned int a_uiBandBlockRows = 16, EffortBudget a_effortbudget = EffortBudget::PER_BAND);
+
+		StreamEncoder(StreamEncoder const&) = delete;
+		StreamEncoder& operator=(StreamEncoder const&) = delete;
+
+		// same parameters as Etc::Encode(), with the source and the encoding bits streamed
+		// the returned status has the warnings of every band, with a WARNING_ALL_ warning only if every band had it
+		Executor::EncodingStatus Encode(SourceFunction const &a_source,
+										unsigned int a_uiSourceWidth,
+										unsigned int a_uiSourceHeight,
+										Image::Format a_format,
+										ErrorMetric a_errormetric,
+										float a_fEffort,
+										unsigned int a_uiJobs,
+										unsigned int a_uiMaxJobs,
+										SinkFunction const &a_sink);
+
+		// the error of the bands the last encode sank, see Image::GetError()
+		inline float GetError(void) const
+		{
+			return m_fError;
+		}
+
+		// the encoding bits bytes the last encode sank
+		inline unsigned int GetEncodingBitsBytes(void) const
+		{
+			return m_uiEncodingBitsBytes;
+		}
+
+	private:
+
+		unsigned int CalcGlobalEffortBlocks(Image &a_image);
+
+		unsigned int m_uiBandBlockRows;
+		EffortBudget m_effortbudget;
+
+		float m_fError;
+		unsigned int m_uiEncodingBitsBytes;
+
+		// the global budget of the encode: blocks it may finish, the blocks it finished,
+		// and the first pass errors of every band so far, counted by GetErrorBucket()
+		float m_fEffort;
+		unsigned int m_uiImageBlocks;
+		unsigned int m_uiBudgetBlocks;
+		unsigned int m_uiSpentBlocks;
+		std::vector<unsigned int> m_auiErrorBuckets;
+		unsigned int m_uiBucketedBlocks;
+	};
+
+} // namespace Etc
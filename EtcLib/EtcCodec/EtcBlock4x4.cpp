@@ -40,6 +40,7 @@ alpha of NAN
 #include <cstdio>
 #include <cstring>
 #include <cassert>
+#include <new>
 
 namespace Etc
 {
@@ -54,9 +55,14 @@ namespace Etc
 		m_uiSourceH = 0;
 		m_uiSourceV = 0;
 
+		m_pafrgbaSource = nullptr;
+		m_pafrgbaDecodedColors = nullptr;
+
 		m_sourcealphamix = SourceAlphaMix::UNKNOWN;
 		m_boolBorderPixels = false;
 		m_boolPunchThroughPixels = false;
+		m_boolSolidColor = false;
+		m_boolCopiedEncoding = false;
 
 		m_pencoding = nullptr;
 
@@ -64,10 +70,19 @@ namespace Etc
 
 	}
 	Block4x4::~Block4x4()
+	{
+		ReleaseEncoding();
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// destroy the encoder in place
+	// the encoder's storage belongs to the image's Block4x4EncodingArena
+	//
+	void Block4x4::ReleaseEncoding(void)
 	{
 		if (m_pencoding)
 		{
-			delete m_pencoding;
+			m_pencoding->~Block4x4Encoding();
 			m_pencoding = nullptr;
 		}
 	}
@@ -76,18 +91,27 @@ namespace Etc
 	// [a_uiSourceH,a_uiSourceV] is the location of the block in a_pimageSource
 	// a_paucEncodingBits is the place to store the final encoding
 	// a_errormetric is used for finding the best encoding
+	// the encoder is constructed in a_pvEncodingStorage, which must fit any encoder of the image's format
+	// the source pixels and decoded colors are kept in a_pafrgbaSource and a_pafrgbaDecodedColors,
+	// PIXELS colors each in the owner's per block arrays
 	//
 	void Block4x4::InitFromSource(Image *a_pimageSource, 
 									unsigned int a_uiSourceH, unsigned int a_uiSourceV,
 									unsigned char *a_paucEncodingBits,
-									ErrorMetric a_errormetric)
+									ErrorMetric a_errormetric,
+									void *a_pvEncodingStorage,
+									ColorFloatRGBA *a_pafrgbaSource,
+									ColorFloatRGBA *a_pafrgbaDecodedColors)
 	{
 
+		ReleaseEncoding();
 		*this = Block4x4();
 
 		m_uiSourceH = a_uiSourceH;
 		m_uiSourceV = a_uiSourceV;
 		m_errormetric = a_errormetric;
+		m_pafrgbaSource = a_pafrgbaSource;
+		m_pafrgbaDecodedColors = a_pafrgbaDecodedColors;
 
 		SetSourcePixels(a_pimageSource);
 
@@ -95,34 +119,34 @@ namespace Etc
 		switch (a_pimageSource->GetFormat())
 		{
 		case Image::Format::ETC1:
-			m_pencoding = new Block4x4Encoding_ETC1;
+			m_pencoding = new (a_pvEncodingStorage) Block4x4Encoding_ETC1;
 			break;
 
 		case Image::Format::RGB8:
 		case Image::Format::SRGB8:
-			m_pencoding = new Block4x4Encoding_RGB8;
+			m_pencoding = new (a_pvEncodingStorage) Block4x4Encoding_RGB8;
 			break;
 
 		case Image::Format::RGBA8:
 		case Image::Format::SRGBA8:
 			if (a_errormetric == RGBX)
 			{
-				m_pencoding = new Block4x4Encoding_RGBA8;
+				m_pencoding = new (a_pvEncodingStorage) Block4x4Encoding_RGBA8;
 			}
 			else
 			{
 				switch (m_sourcealphamix)
 				{
 				case SourceAlphaMix::OPAQUE:
-					m_pencoding = new Block4x4Encoding_RGBA8_Opaque;
+					m_pencoding = new (a_pvEncodingStorage) Block4x4Encoding_RGBA8_Opaque;
 					break;
 
 				case SourceAlphaMix::TRANSPARENT:
-					m_pencoding = new Block4x4Encoding_RGBA8_Transparent;
+					m_pencoding = new (a_pvEncodingStorage) Block4x4Encoding_RGBA8_Transparent;
 					break;
 
 				case SourceAlphaMix::TRANSLUCENT:
-					m_pencoding = new Block4x4Encoding_RGBA8;
+					m_pencoding = new (a_pvEncodingStorage) Block4x4Encoding_RGBA8;
 					break;
 
 				default:
@@ -138,21 +162,21 @@ namespace Etc
 			switch (m_sourcealphamix)
 			{
 			case SourceAlphaMix::OPAQUE:
-				m_pencoding = new Block4x4Encoding_RGB8A1_Opaque;
+				m_pencoding = new (a_pvEncodingStorage) Block4x4Encoding_RGB8A1_Opaque;
 				break;
 
 			case SourceAlphaMix::TRANSPARENT:
-				m_pencoding = new Block4x4Encoding_RGB8A1_Transparent;
+				m_pencoding = new (a_pvEncodingStorage) Block4x4Encoding_RGB8A1_Transparent;
 				break;
 
 			case SourceAlphaMix::TRANSLUCENT:
 				if (m_boolPunchThroughPixels)
 				{
-					m_pencoding = new Block4x4Encoding_RGB8A1;
+					m_pencoding = new (a_pvEncodingStorage) Block4x4Encoding_RGB8A1;
 				}
 				else
 				{
-					m_pencoding = new Block4x4Encoding_RGB8A1_Opaque;
+					m_pencoding = new (a_pvEncodingStorage) Block4x4Encoding_RGB8A1_Opaque;
 				}
 				break;
 
@@ -164,22 +188,28 @@ namespace Etc
 
 		case Image::Format::R11:
 		case Image::Format::SIGNED_R11:
-			m_pencoding = new Block4x4Encoding_R11;
+			m_pencoding = new (a_pvEncodingStorage) Block4x4Encoding_R11;
 			break;
 		case Image::Format::RG11:
 		case Image::Format::SIGNED_RG11:
-			m_pencoding = new Block4x4Encoding_RG11;
+			m_pencoding = new (a_pvEncodingStorage) Block4x4Encoding_RG11;
 			break;
 		default:
 			assert(0);
 			break;
 		}
 
-		m_pencoding->InitFromSource(this, m_afrgbaSource,
+		m_pencoding->InitFromSource(this, m_pafrgbaSource,
 									a_pimageSource->GetFormat(),
 									a_paucEncodingBits,
 									a_errormetric);
 
+		// the encoders that have a shortcut for solid color blocks encode them here, without iterating
+		if (m_boolSolidColor)
+		{
+			m_pencoding->EncodeSolidColor(a_pimageSource->GetFormat());
+		}
+
 	}
 
 	// ----------------------------------------------------------------------------------------------------
@@ -188,18 +218,26 @@ namespace Etc
 	// a_paucEncodingBits is the place to read the prior encoding
 	// a_imageformat is used to determine how to interpret a_paucEncodingBits
 	// a_errormetric was used for the prior encoding
+	// the encoder is constructed in a_pvEncodingStorage, which must fit any encoder of a_imageformat
+	// the source pixels and decoded colors are kept in a_pafrgbaSource and a_pafrgbaDecodedColors
 	//
 	void Block4x4::InitFromEtcEncodingBits(Image::Format a_imageformat,
 											unsigned int a_uiSourceH, unsigned int a_uiSourceV,
 											unsigned char *a_paucEncodingBits,
 											Image *a_pimageSource,
-											ErrorMetric a_errormetric)
+											ErrorMetric a_errormetric,
+											void *a_pvEncodingStorage,
+											ColorFloatRGBA *a_pafrgbaSource,
+											ColorFloatRGBA *a_pafrgbaDecodedColors)
 	{
+		ReleaseEncoding();
 		*this = Block4x4();
 
 		m_uiSourceH = a_uiSourceH;
 		m_uiSourceV = a_uiSourceV;
 		m_errormetric = a_errormetric;
+		m_pafrgbaSource = a_pafrgbaSource;
+		m_pafrgbaDecodedColors = a_pafrgbaDecodedColors;
 
 		SetSourcePixels(a_pimageSource);
 
@@ -207,31 +245,31 @@ namespace Etc
 		switch (a_imageformat)
 		{
 		case Image::Format::ETC1:
-			m_pencoding = new Block4x4Encoding_ETC1;
+			m_pencoding = new (a_pvEncodingStorage) Block4x4Encoding_ETC1;
 			break;
 
 		case Image::Format::RGB8:
 		case Image::Format::SRGB8:
-			m_pencoding = new Block4x4Encoding_RGB8;
+			m_pencoding = new (a_pvEncodingStorage) Block4x4Encoding_RGB8;
 			break;
 
 		case Image::Format::RGBA8:
 		case Image::Format::SRGBA8:
-			m_pencoding = new Block4x4Encoding_RGBA8;
+			m_pencoding = new (a_pvEncodingStorage) Block4x4Encoding_RGBA8;
 			break;
 
 		case Image::Format::RGB8A1:
 		case Image::Format::SRGB8A1:
-			m_pencoding = new Block4x4Encoding_RGB8A1;
+			m_pencoding = new (a_pvEncodingStorage) Block4x4Encoding_RGB8A1;
 			break;
 
 		case Image::Format::R11:
 		case Image::Format::SIGNED_R11:
-			m_pencoding = new Block4x4Encoding_R11;
+			m_pencoding = new (a_pvEncodingStorage) Block4x4Encoding_R11;
 			break;
 		case Image::Format::RG11:
 		case Image::Format::SIGNED_RG11:
-			m_pencoding = new Block4x4Encoding_RG11;
+			m_pencoding = new (a_pvEncodingStorage) Block4x4Encoding_RG11;
 			break;
 		default:
 			assert(0);
@@ -239,14 +277,14 @@ namespace Etc
 		}
 
 		m_pencoding->InitFromEncodingBits(this, a_imageformat, a_paucEncodingBits,
-										m_afrgbaSource,
+										m_pafrgbaSource,
 										a_errormetric);
 
 	}
 	
 	// ----------------------------------------------------------------------------------------------------
 	// set source pixels from m_pimageSource
-	// set m_alphamix
+	// set m_alphamix and m_boolSolidColor
 	//
 	void Block4x4::SetSourcePixels(Image *a_imageSource)
 	{
@@ -268,12 +306,13 @@ namespace Etc
 			{
 				unsigned int uiSourcePixelV = m_uiSourceV + uiBlockPixelV;
 
-				ColorFloatRGBA *pfrgbaSource = a_imageSource->GetSourcePixel(uiSourcePixelH, uiSourcePixelV);
+				// 8 and 16 bit sources are converted to float here, one block at a time
+				ColorFloatRGBA frgbaSource;
 
 				// if pixel extends beyond source image because of block padding
-				if (pfrgbaSource == nullptr)
+				if (!a_imageSource->ReadSourcePixel(uiSourcePixelH, uiSourcePixelV, frgbaSource))
 				{
-					m_afrgbaSource[uiPixel] = ColorFloatRGBA(0.0f, 0.0f, 0.0f, NAN);	// denotes border pixel
+					m_pafrgbaSource[uiPixel] = ColorFloatRGBA(0.0f, 0.0f, 0.0f, NAN);	// denotes border pixel
 					m_boolBorderPixels = true;
 					uiTransparentSourcePixels++;
 				}
@@ -282,17 +321,17 @@ namespace Etc
 					//get teh current pixel data, and store some of the attributes
 					//before capping values to fit the encoder type
 					
-					m_afrgbaSource[uiPixel] = (*pfrgbaSource).ClampRGBA();
+					m_pafrgbaSource[uiPixel] = frgbaSource.ClampRGBA();
 
-					if (m_afrgbaSource[uiPixel].fA == 1.0f || m_errormetric == RGBX)
+					if (m_pafrgbaSource[uiPixel].fA == 1.0f || m_errormetric == RGBX)
 					{
 						a_imageSource->m_iNumOpaquePixels++;
 					}
-					else if (m_afrgbaSource[uiPixel].fA == 0.0f)
+					else if (m_pafrgbaSource[uiPixel].fA == 0.0f)
 					{
 						a_imageSource->m_iNumTransparentPixels++;
 					}
-					else if(m_afrgbaSource[uiPixel].fA > 0.0f && m_afrgbaSource[uiPixel].fA < 1.0f)
+					else if(m_pafrgbaSource[uiPixel].fA > 0.0f && m_pafrgbaSource[uiPixel].fA < 1.0f)
 					{
 						a_imageSource->m_iNumTranslucentPixels++;
 					}
@@ -301,28 +340,28 @@ namespace Etc
 						a_imageSource->m_numOutOfRangeValues.fA++;
 					}
 
-					if (m_afrgbaSource[uiPixel].fR != 0.0f)
+					if (m_pafrgbaSource[uiPixel].fR != 0.0f)
 					{
 						a_imageSource->m_numColorValues.fR++;
 						//make sure we are getting a float between 0-1
-						if (m_afrgbaSource[uiPixel].fR - 1.0f > 0.0f)
+						if (m_pafrgbaSource[uiPixel].fR - 1.0f > 0.0f)
 						{
 							a_imageSource->m_numOutOfRangeValues.fR++;
 						}
 					}
 
-					if (m_afrgbaSource[uiPixel].fG != 0.0f)
+					if (m_pafrgbaSource[uiPixel].fG != 0.0f)
 					{
 						a_imageSource->m_numColorValues.fG++;
-						if (m_afrgbaSource[uiPixel].fG - 1.0f > 0.0f)
+						if (m_pafrgbaSource[uiPixel].fG - 1.0f > 0.0f)
 						{
 							a_imageSource->m_numOutOfRangeValues.fG++;
 						}
 					}
-					if (m_afrgbaSource[uiPixel].fB != 0.0f)
+					if (m_pafrgbaSource[uiPixel].fB != 0.0f)
 					{
 						a_imageSource->m_numColorValues.fB++;
-						if (m_afrgbaSource[uiPixel].fB - 1.0f > 0.0f)
+						if (m_pafrgbaSource[uiPixel].fB - 1.0f > 0.0f)
 						{
 							a_imageSource->m_numOutOfRangeValues.fB++;
 						}
@@ -332,22 +371,22 @@ namespace Etc
 						imageformat == Image::Format::RGB8 ||
 						imageformat == Image::Format::SRGB8)
 					{
-						m_afrgbaSource[uiPixel].fA = 1.0f;
+						m_pafrgbaSource[uiPixel].fA = 1.0f;
 					}
 
 					if (imageformat == Image::Format::R11 ||
 						imageformat == Image::Format::SIGNED_R11)
 					{
-						m_afrgbaSource[uiPixel].fA = 1.0f;
-						m_afrgbaSource[uiPixel].fG = 0.0f;
-						m_afrgbaSource[uiPixel].fB = 0.0f;
+						m_pafrgbaSource[uiPixel].fA = 1.0f;
+						m_pafrgbaSource[uiPixel].fG = 0.0f;
+						m_pafrgbaSource[uiPixel].fB = 0.0f;
 					}
 
 					if (imageformat == Image::Format::RG11 ||
 						imageformat == Image::Format::SIGNED_RG11)
 					{
-						m_afrgbaSource[uiPixel].fA = 1.0f;
-						m_afrgbaSource[uiPixel].fB = 0.0f;
+						m_pafrgbaSource[uiPixel].fA = 1.0f;
+						m_pafrgbaSource[uiPixel].fB = 0.0f;
 					}
 
 				
@@ -356,22 +395,22 @@ namespace Etc
 					if (imageformat == Image::Format::RGB8A1 ||
 						imageformat == Image::Format::SRGB8A1)
 					{
-						if (m_afrgbaSource[uiPixel].fA >= 0.5f)
+						if (m_pafrgbaSource[uiPixel].fA >= 0.5f)
 						{
-							m_afrgbaSource[uiPixel].fA = 1.0f;
+							m_pafrgbaSource[uiPixel].fA = 1.0f;
 						}
 						else
 						{
-							m_afrgbaSource[uiPixel].fA = 0.0f;
+							m_pafrgbaSource[uiPixel].fA = 0.0f;
 							m_boolPunchThroughPixels = true;
 						}
 					}
 
-					if (m_afrgbaSource[uiPixel].fA == 1.0f || m_errormetric == RGBX)
+					if (m_pafrgbaSource[uiPixel].fA == 1.0f || m_errormetric == RGBX)
 					{
 						uiOpaqueSourcePixels++;
 					}
-					else if (m_afrgbaSource[uiPixel].fA == 0.0f)
+					else if (m_pafrgbaSource[uiPixel].fA == 0.0f)
 					{
 						uiTransparentSourcePixels++;
 					}
@@ -382,6 +421,37 @@ namespace Etc
 			}
 		}
 
+		// solid color if there are pixels that aren't border pixels and they all have the same RGBA
+		const ColorFloatRGBA *pfrgbaSolidColor = nullptr;
+		m_boolSolidColor = true;
+		for (uiPixel = 0; uiPixel < PIXELS; uiPixel++)
+		{
+			const ColorFloatRGBA &frgbaPixel = m_pafrgbaSource[uiPixel];
+
+			// if a border pixel
+			if (std::isnan(frgbaPixel.fA))
+			{
+				continue;
+			}
+
+			if (pfrgbaSolidColor == nullptr)
+			{
+				pfrgbaSolidColor = &frgbaPixel;
+			}
+			else if (frgbaPixel.fR != pfrgbaSolidColor->fR ||
+						frgbaPixel.fG != pfrgbaSolidColor->fG ||
+						frgbaPixel.fB != pfrgbaSolidColor->fB ||
+						frgbaPixel.fA != pfrgbaSolidColor->fA)
+			{
+				m_boolSolidColor = false;
+				break;
+			}
+		}
+		if (pfrgbaSolidColor == nullptr)
+		{
+			m_boolSolidColor = false;
+		}
+
 		if (uiOpaqueSourcePixels == PIXELS)
 		{
 			m_sourcealphamix = SourceAlphaMix::OPAQUE;
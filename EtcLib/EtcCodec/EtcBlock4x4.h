@@ -54,24 +54,54 @@ namespace Etc
 							unsigned int a_uiSourceH,
 							unsigned int a_uiSourceV,
 							unsigned char *a_paucEncodingBits,
-							ErrorMetric a_errormetric);
+							ErrorMetric a_errormetric,
+							void *a_pvEncodingStorage,
+							ColorFloatRGBA *a_pafrgbaSource,
+							ColorFloatRGBA *a_pafrgbaDecodedColors);
 
 		void InitFromEtcEncodingBits(Image::Format a_imageformat,
 										unsigned int a_uiSourceH,
 										unsigned int a_uiSourceV,
 										unsigned char *a_paucEncodingBits,
 										Image *a_pimageSource,
-										ErrorMetric a_errormetric);
+										ErrorMetric a_errormetric,
+										void *a_pvEncodingStorage,
+										ColorFloatRGBA *a_pafrgbaSource,
+										ColorFloatRGBA *a_pafrgbaDecodedColors);
+
+		// destroy the encoder, leaving its storage to the owner
+		void ReleaseEncoding(void);
 
 		// return true if final iteration was performed
+		// solid color blocks encoded by InitFromSource() are already done
 		inline void PerformEncodingIteration(Image::Format const a_encoding, ErrorMetric const a_errormetric, float a_fEffort)
 		{
-			m_pencoding->PerformIteration(a_encoding, a_errormetric, a_fEffort);
+			if (!m_pencoding->IsDone())
+			{
+				m_pencoding->PerformIteration(a_encoding, a_errormetric, a_fEffort);
+			}
 		}
 
+		// blocks whose encoding bits are copied from an identical block keep the copy
 		inline void SetEncodingBitsFromEncoding(Image::Format const a_encoding)
 		{
-			m_pencoding->SetEncodingBits(a_encoding);
+			if (!m_boolCopiedEncoding)
+			{
+				m_pencoding->SetEncodingBits(a_encoding);
+			}
+		}
+
+		// the encoding bits of this block are copied from an identical block instead of encoded
+		// a_fError is the error of the copied encoding
+		inline void SetCopiedEncoding(float a_fError)
+		{
+			m_boolCopiedEncoding = true;
+			m_pencoding->SetCopied(a_fError);
+		}
+
+		inline bool IsCopiedEncoding(void) const
+		{
+			return m_boolCopiedEncoding;
 		}
 
 		inline unsigned int GetSourceH(void) const
@@ -93,7 +123,7 @@ namespace Etc
 
 		inline ColorFloatRGBA * GetDecodedColors(void)
 		{
-			return m_pencoding->GetDecodedColors();
+			return m_pafrgbaDecodedColors;
 		}
 
 		inline float * GetDecodedAlphas(void)
@@ -118,7 +148,7 @@ namespace Etc
 
 		inline ColorFloatRGBA * GetSource()
 		{
-			return m_afrgbaSource;
+			return m_pafrgbaSource;
 		}
 
 		inline ErrorMetric GetErrorMetric() const
@@ -148,6 +178,11 @@ namespace Etc
 			return m_boolPunchThroughPixels;
 		}
 
+		inline bool IsSolidColor(void) const
+		{
+			return m_boolSolidColor;
+		}
+
 	private:
 
 		void SetSourcePixels(Image *a_imageSource);
@@ -155,11 +190,14 @@ namespace Etc
 		unsigned int		m_uiSourceH;
 		unsigned int		m_uiSourceV;
 		ErrorMetric			m_errormetric;
-		ColorFloatRGBA		m_afrgbaSource[PIXELS];		// vertical scan
+		ColorFloatRGBA		*m_pafrgbaSource;			// vertical scan, in the image's per block source array
+		ColorFloatRGBA		*m_pafrgbaDecodedColors;	// in the image's per block decoded color array
 
 		SourceAlphaMix		m_sourcealphamix;
 		bool				m_boolBorderPixels;			// marked as rgba(NAN, NAN, NAN, NAN)
 		bool				m_boolPunchThroughPixels;	// RGB8A1 or SRGB8A1 with any pixels with alpha < 0.5
+		bool				m_boolSolidColor;			// all pixels that aren't border pixels have the same RGBA
+		bool				m_boolCopiedEncoding;		// encoding bits copied from an identical block
 
 		Block4x4Encoding	*m_pencoding;
 
@@ -27,6 +27,7 @@ particular file format (e.g. ETC1, RGB8, RGBA8, R11)
 
 #include "EtcBlock4x4EncodingBits.h"
 #include "EtcBlock4x4.h"
+#include "EtcBlockError.h"
 
 #include <cstdio>
 #include <cstring>
@@ -47,6 +48,7 @@ namespace Etc
 		m_pblockParent = nullptr;
 
 		m_pafrgbaSource = nullptr;
+		m_pafrgbaDecodedColors = nullptr;
 
 		m_boolBorderPixels = false;
 
@@ -57,9 +59,10 @@ namespace Etc
 		m_uiEncodingIterations = 0;
 		m_boolDone = false;
 
+		m_pmetrickernels = nullptr;
+
 		for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
 		{
-			m_afrgbaDecodedColors[uiPixel] = ColorFloatRGBA(-1.0f, -1.0f, -1.0f, -1.0f);
 			m_afDecodedAlphas[uiPixel] = -1.0f;
 		}
 
@@ -67,8 +70,9 @@ namespace Etc
 
 	// ----------------------------------------------------------------------------------------------------
 	// initialize the generic encoding for a 4x4 block
-	// a_pblockParent points to the block associated with this encoding
+	// a_pblockParent points to the block associated with this encoding, which also keeps the decoded colors
 	// a_errormetric is used to choose the best encoding
+	// the kernels specialized on a_errormetric are looked up here, so the searches never branch on the metric
 	// init the decoded pixels to -1 to mark them as undefined
 	// init the error to -1 to mark it as undefined
 	//
@@ -80,6 +84,8 @@ namespace Etc
 		m_pblockParent = a_pblockParent;
 
 		m_pafrgbaSource = a_pafrgbaSource;
+		m_pafrgbaDecodedColors = m_pblockParent->GetDecodedColors();
+		assert(m_pafrgbaDecodedColors);
 
 		m_boolBorderPixels = m_pblockParent->HasBorderPixels();
 
@@ -88,28 +94,38 @@ namespace Etc
 		m_uiEncodingIterations = 0;
 
 		m_errormetric = a_errormetric;
+		m_pmetrickernels = &GetMetricKernels(a_errormetric);
 
 		for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
 		{
-			m_afrgbaDecodedColors[uiPixel] = ColorFloatRGBA(-1.0f, -1.0f, -1.0f, -1.0f);
+			m_pafrgbaDecodedColors[uiPixel] = ColorFloatRGBA(-1.0f, -1.0f, -1.0f, -1.0f);
 			m_afDecodedAlphas[uiPixel] = -1.0f;
 		}
 
 	}
 
+	// ----------------------------------------------------------------------------------------------------
+	// encoders without a solid color shortcut iterate solid color blocks like any other block
+	//
+	bool Block4x4Encoding::EncodeSolidColor(Image::Format)
+	{
+		return false;
+	}
+
 	// ----------------------------------------------------------------------------------------------------
 	// calculate the error for the block by summing the pixel errors
 	//
 	void Block4x4Encoding::CalcBlockError(void)
 	{
-		m_fError = 0.0f;
+		m_fError = CalcBlockError(m_pafrgbaDecodedColors);
+	}
 
-		for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
-		{
-			m_fError += CalcPixelError(m_afrgbaDecodedColors[uiPixel], m_afDecodedAlphas[uiPixel],
-										m_pafrgbaSource[uiPixel]);
-		}
-		
+	// ----------------------------------------------------------------------------------------------------
+	// calculate the error for a candidate's decoded colors without changing the encoding
+	//
+	float Block4x4Encoding::CalcBlockError(const ColorFloatRGBA *a_pafrgbaDecodedColors) const
+	{
+		return m_pmetrickernels->pfnBlockError(a_pafrgbaDecodedColors, m_afDecodedAlphas, m_pafrgbaSource);
 	}
 
 	// ----------------------------------------------------------------------------------------------------
@@ -126,130 +142,18 @@ namespace Etc
 			return 0.0f;
 		}
 
-		if (m_errormetric == ErrorMetric::RGBA)
-		{
-			assert(a_fDecodedAlpha >= 0.0f);
-
-			float fDRed = (a_fDecodedAlpha * a_frgbaDecodedColor.fR) -
-							(a_frgbaSourcePixel.fA * a_frgbaSourcePixel.fR);
-			float fDGreen = (a_fDecodedAlpha * a_frgbaDecodedColor.fG) -
-							(a_frgbaSourcePixel.fA * a_frgbaSourcePixel.fG);
-			float fDBlue = (a_fDecodedAlpha * a_frgbaDecodedColor.fB) -
-							(a_frgbaSourcePixel.fA * a_frgbaSourcePixel.fB);
-
-			float fDAlpha = a_fDecodedAlpha - a_frgbaSourcePixel.fA;
-
-			return fDRed*fDRed + fDGreen*fDGreen + fDBlue*fDBlue + fDAlpha*fDAlpha;
-		}
-		else if (m_errormetric == ErrorMetric::RGBX)
-		{
-			assert(a_fDecodedAlpha >= 0.0f);
-
-			float fDRed = a_frgbaDecodedColor.fR - a_frgbaSourcePixel.fR;
-			float fDGreen = a_frgbaDecodedColor.fG - a_frgbaSourcePixel.fG;
-			float fDBlue = a_frgbaDecodedColor.fB - a_frgbaSourcePixel.fB;
-			float fDAlpha = a_fDecodedAlpha - a_frgbaSourcePixel.fA;
-
-			return fDRed*fDRed + fDGreen*fDGreen + fDBlue*fDBlue + fDAlpha*fDAlpha;
-		}
-		else if (m_errormetric == ErrorMetric::REC709)
-		{
-			assert(a_fDecodedAlpha >= 0.0f);
-
-			float fLuma1 = a_frgbaSourcePixel.fR*0.2126f + a_frgbaSourcePixel.fG*0.7152f + a_frgbaSourcePixel.fB*0.0722f;
-			float fChromaR1 = 0.5f * ((a_frgbaSourcePixel.fR - fLuma1) * (1.0f / (1.0f - 0.2126f)));
-			float fChromaB1 = 0.5f * ((a_frgbaSourcePixel.fB - fLuma1) * (1.0f / (1.0f - 0.0722f)));
-
-			float fLuma2 = a_frgbaDecodedColor.fR*0.2126f +
-							a_frgbaDecodedColor.fG*0.7152f +
-							a_frgbaDecodedColor.fB*0.0722f;
-			float fChromaR2 = 0.5f * ((a_frgbaDecodedColor.fR - fLuma2) * (1.0f / (1.0f - 0.2126f)));
-			float fChromaB2 = 0.5f * ((a_frgbaDecodedColor.fB - fLuma2) * (1.0f / (1.0f - 0.0722f)));
-
-			float fDeltaL = a_frgbaSourcePixel.fA * fLuma1 - a_fDecodedAlpha * fLuma2;
-			float fDeltaCr = a_frgbaSourcePixel.fA * fChromaR1 - a_fDecodedAlpha * fChromaR2;
-			float fDeltaCb = a_frgbaSourcePixel.fA * fChromaB1 - a_fDecodedAlpha * fChromaB2;
-
-			float fDAlpha = a_fDecodedAlpha - a_frgbaSourcePixel.fA;
-
-			// Favor Luma accuracy over Chroma, and Red over Blue 
-			return LUMA_WEIGHT*fDeltaL*fDeltaL +
-					fDeltaCr*fDeltaCr +
-					CHROMA_BLUE_WEIGHT*fDeltaCb*fDeltaCb +
-					fDAlpha*fDAlpha;
-	#if 0
-			float fDRed = a_frgbaDecodedPixel.fR - a_frgbaSourcePixel.fR;
-			float fDGreen = a_frgbaDecodedPixel.fG - a_frgbaSourcePixel.fG;
-			float fDBlue = a_frgbaDecodedPixel.fB - a_frgbaSourcePixel.fB;
-			return 2.0f * 3.0f * fDeltaL * fDeltaL + fDRed*fDRed + fDGreen*fDGreen + fDBlue*fDBlue;
-#endif
-		}
-		else if (m_errormetric == ErrorMetric::NORMALXYZ)
+		switch (m_errormetric)
 		{
-			float fDecodedX = 2.0f * a_frgbaDecodedColor.fR - 1.0f;
-			float fDecodedY = 2.0f * a_frgbaDecodedColor.fG - 1.0f;
-			float fDecodedZ = 2.0f * a_frgbaDecodedColor.fB - 1.0f;
-
-			float fDecodedLength = sqrtf(fDecodedX*fDecodedX + fDecodedY*fDecodedY + fDecodedZ*fDecodedZ);
-
-			if (fDecodedLength < 0.5f)
-			{
-				return 1.0f;
-			}
-			else if (fDecodedLength == 0.0f)
-			{
-				fDecodedX = 1.0f;
-				fDecodedY = 0.0f;
-				fDecodedZ = 0.0f;
-			}
-			else
-			{
-				fDecodedX /= fDecodedLength;
-				fDecodedY /= fDecodedLength;
-				fDecodedZ /= fDecodedLength;
-			}
-
-			float fSourceX = 2.0f * a_frgbaSourcePixel.fR - 1.0f;
-			float fSourceY = 2.0f * a_frgbaSourcePixel.fG - 1.0f;
-			float fSourceZ = 2.0f * a_frgbaSourcePixel.fB - 1.0f;
-
-			float fSourceLength = sqrtf(fSourceX*fSourceX + fSourceY*fSourceY + fSourceZ*fSourceZ);
-
-			if (fSourceLength == 0.0f)
-			{
-				fSourceX = 1.0f;
-				fSourceY = 0.0f;
-				fSourceZ = 0.0f;
-			}
-			else
-			{
-				fSourceX /= fSourceLength;
-				fSourceY /= fSourceLength;
-				fSourceZ /= fSourceLength;
-			}
-
-			float fDotProduct = fSourceX*fDecodedX + fSourceY*fDecodedY + fSourceZ*fDecodedZ;
-			float fNormalizedDotProduct = 1.0f - 0.5f * (fDotProduct + 1.0f);
-			float fDotProductError = fNormalizedDotProduct * fNormalizedDotProduct;
-			
-			float fLength2 = fDecodedX*fDecodedX + fDecodedY*fDecodedY + fDecodedZ*fDecodedZ;
-			float fLength2Error = fabsf(1.0f - fLength2);
-
-			float fDeltaW = a_frgbaDecodedColor.fA - a_frgbaSourcePixel.fA;
-			float fErrorW = fDeltaW * fDeltaW;
-
-			return fDotProductError + fLength2Error + fErrorW;
-		}
-		else // ErrorMetric::NUMERIC
-		{
-			assert(a_fDecodedAlpha >= 0.0f);
-
-			float fDX = a_frgbaDecodedColor.fR - a_frgbaSourcePixel.fR;
-			float fDY = a_frgbaDecodedColor.fG - a_frgbaSourcePixel.fG;
-			float fDZ = a_frgbaDecodedColor.fB - a_frgbaSourcePixel.fB;
-			float fDW = a_frgbaDecodedColor.fA - a_frgbaSourcePixel.fA;
-
-			return fDX*fDX + fDY*fDY + fDZ*fDZ + fDW*fDW;
+		case ErrorMetric::RGBA:
+			return CalcPixelErrorForMetric<ErrorMetric::RGBA>(a_frgbaDecodedColor, a_fDecodedAlpha, a_frgbaSourcePixel);
+		case ErrorMetric::RGBX:
+			return CalcPixelErrorForMetric<ErrorMetric::RGBX>(a_frgbaDecodedColor, a_fDecodedAlpha, a_frgbaSourcePixel);
+		case ErrorMetric::REC709:
+			return CalcPixelErrorForMetric<ErrorMetric::REC709>(a_frgbaDecodedColor, a_fDecodedAlpha, a_frgbaSourcePixel);
+		case ErrorMetric::NORMALXYZ:
+			return CalcPixelErrorForMetric<ErrorMetric::NORMALXYZ>(a_frgbaDecodedColor, a_fDecodedAlpha, a_frgbaSourcePixel);
+		default:
+			return CalcPixelErrorForMetric<ErrorMetric::NUMERIC>(a_frgbaDecodedColor, a_fDecodedAlpha, a_frgbaSourcePixel);
 		}
 
 	}
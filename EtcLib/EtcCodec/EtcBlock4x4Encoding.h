@@ -27,6 +27,7 @@
 namespace Etc
 {
 	class Block4x4;
+	struct MetricKernels;
 
 	// abstract base class for specific encodings
 	class Block4x4Encoding
@@ -72,7 +73,12 @@ namespace Etc
 		// the first iteration must generate a complete, valid (if poor) encoding
 		virtual void PerformIteration(Image::Format a_encoding, ErrorMetric a_errormetric, float a_fEffort) = 0;
 
+		// encode a block whose pixels all have the same color without iterating
+		// returns true and marks the encoding done if the encoder has a shortcut for the block
+		virtual bool EncodeSolidColor(Image::Format a_encoding);
+
 		void CalcBlockError(void);
+		float CalcBlockError(const ColorFloatRGBA *a_pafrgbaDecodedColors) const;
 
 		inline float GetError(void)
 		{
@@ -83,7 +89,7 @@ namespace Etc
 
 		inline ColorFloatRGBA * GetDecodedColors(void)
 		{
-			return m_afrgbaDecodedColors;
+			return m_pafrgbaDecodedColors;
 		}
 
 		inline float * GetDecodedAlphas(void)
@@ -109,6 +115,13 @@ namespace Etc
 			return m_boolDone;
 		}
 
+		// mark the encoding done with the error of an identical block's encoding, whose encoding bits are copied
+		inline void SetCopied(float a_fError)
+		{
+			m_fError = a_fError;
+			m_boolDone = true;
+		}
+
 		inline void SetDoneIfPerfect()
 		{
 			if (GetError() == 0.0f)
@@ -132,7 +145,7 @@ namespace Etc
 
 		bool			m_boolBorderPixels;				// if block has any border pixels
 
-		ColorFloatRGBA	m_afrgbaDecodedColors[PIXELS];	// decoded RGB components, ignore Alpha
+		ColorFloatRGBA	*m_pafrgbaDecodedColors;		// decoded RGB components, ignore Alpha, kept by the parent block
 		float			m_afDecodedAlphas[PIXELS];		// decoded alpha component
 		float			m_fError;						// error for RGBA relative to m_pafrgbaSource
 
@@ -142,6 +155,7 @@ namespace Etc
 		unsigned int	m_uiEncodingIterations;
 		bool			m_boolDone;						// all iterations have been done
 		ErrorMetric		m_errormetric;
+		const MetricKernels *m_pmetrickernels;			// m_errormetric's kernels, looked up once by Init()
 
 	private:
 
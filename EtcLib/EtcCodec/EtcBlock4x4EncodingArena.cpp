@@ -0,0 +1,131 @@
+/*
+ * Copyright 2015 The Etc2Comp Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+EtcBlock4x4EncodingArena.cpp
+
+Block4x4EncodingArena is one bulk allocation holding the encoders of every 4x4 block of an image.
+
+The slot size depends on the image format, so that e.g. an R11 image doesn't pay for RGBA8 sized slots.
+
+*/
+
+#include "EtcConfig.h"
+#include "EtcBlock4x4EncodingArena.h"
+
+#include "EtcBlock4x4Encoding_ETC1.h"
+#include "EtcBlock4x4Encoding_RGB8.h"
+#include "EtcBlock4x4Encoding_RGBA8.h"
+#include "EtcBlock4x4Encoding_RGB8A1.h"
+#include "EtcBlock4x4Encoding_R11.h"
+#include "EtcBlock4x4Encoding_RG11.h"
+
+#include <cstddef>
+
+namespace Etc
+{
+	// every slot starts on this alignment, which new[] also guarantees for the start of the storage
+	static const unsigned int SLOT_ALIGNMENT = alignof(std::max_align_t);
+
+	template <typename T>
+	static constexpr unsigned int SlotBytes(void)
+	{
+		static_assert(alignof(T) <= SLOT_ALIGNMENT, "encoder is over-aligned for the arena");
+		return (unsigned int)((sizeof(T) + SLOT_ALIGNMENT - 1) & ~(size_t)(SLOT_ALIGNMENT - 1));
+	}
+
+	template <typename T, typename U, typename... Rest>
+	static constexpr unsigned int SlotBytes(void)
+	{
+		return SlotBytes<T>() > SlotBytes<U, Rest...>() ? SlotBytes<T>() : SlotBytes<U, Rest...>();
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	//
+	Block4x4EncodingArena::Block4x4EncodingArena(void)
+	{
+		m_paucStorage = nullptr;
+		m_uiAllocatedBytes = 0;
+		m_uiBlocks = 0;
+		m_uiSlotBytes = 0;
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	//
+	Block4x4EncodingArena::~Block4x4EncodingArena(void)
+	{
+		delete[] m_paucStorage;
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// the storage is kept if it's already big enough, so consecutive images of the same size
+	// (or smaller, like mipmaps) reuse the same allocation
+	//
+	void Block4x4EncodingArena::Reserve(unsigned int a_uiBlocks, Image::Format a_format)
+	{
+		m_uiSlotBytes = CalcSlotBytes(a_format);
+		m_uiBlocks = a_uiBlocks;
+
+		size_t uiBytes = (size_t)m_uiBlocks * m_uiSlotBytes;
+		if (uiBytes > m_uiAllocatedBytes)
+		{
+			delete[] m_paucStorage;
+			m_paucStorage = new unsigned char[uiBytes];
+			m_uiAllocatedBytes = uiBytes;
+		}
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// covers every encoder that Block4x4::InitFromSource or InitFromEtcEncodingBits picks for a_format
+	//
+	unsigned int Block4x4EncodingArena::CalcSlotBytes(Image::Format a_format)
+	{
+		switch (a_format)
+		{
+		case Image::Format::ETC1:
+			return SlotBytes<Block4x4Encoding_ETC1>();
+
+		case Image::Format::RGB8:
+		case Image::Format::SRGB8:
+			return SlotBytes<Block4x4Encoding_RGB8>();
+
+		case Image::Format::RGBA8:
+		case Image::Format::SRGBA8:
+			return SlotBytes<Block4x4Encoding_RGBA8,
+								Block4x4Encoding_RGBA8_Opaque,
+								Block4x4Encoding_RGBA8_Transparent>();
+
+		case Image::Format::RGB8A1:
+		case Image::Format::SRGB8A1:
+			return SlotBytes<Block4x4Encoding_RGB8A1,
+								Block4x4Encoding_RGB8A1_Opaque,
+								Block4x4Encoding_RGB8A1_Transparent>();
+
+		case Image::Format::R11:
+		case Image::Format::SIGNED_R11:
+			return SlotBytes<Block4x4Encoding_R11>();
+
+		case Image::Format::RG11:
+		case Image::Format::SIGNED_RG11:
+			return SlotBytes<Block4x4Encoding_RG11>();
+
+		default:
+			assert(0);
+			return 0;
+		}
+	}
+
+} // namespace Etc
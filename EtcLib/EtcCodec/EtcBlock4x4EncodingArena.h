@@ -0,0 +1,69 @@
+/*
+ * Copyright 2015 The Etc2Comp Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "EtcImage.h"
+
+#include <cassert>
+
+namespace Etc
+{
+	// storage for the Block4x4Encoding objects of an image, one fixed size slot per block
+	//
+	// the encoders are placement constructed into the slots and destroyed in place by their Block4x4,
+	// so an image's encoders cost one heap allocation instead of one per block
+	// an arena may be passed to several images in turn; it only grows when an image needs more room
+	//
+	class Block4x4EncodingArena
+	{
+	public:
+
+		Block4x4EncodingArena(void);
+		~Block4x4EncodingArena(void);
+
+		Block4x4EncodingArena(Block4x4EncodingArena const&) = delete;
+		Block4x4EncodingArena& operator=(Block4x4EncodingArena const&) = delete;
+
+		// make room for a_uiBlocks encoders of a_format
+		// must not be called while encoders constructed in the arena are still alive
+		void Reserve(unsigned int a_uiBlocks, Image::Format a_format);
+
+		// storage for the encoder of block a_uiBlock
+		inline void * GetStorage(unsigned int a_uiBlock)
+		{
+			assert(a_uiBlock < m_uiBlocks);
+			return m_paucStorage + (size_t)a_uiBlock * m_uiSlotBytes;
+		}
+
+		inline size_t GetAllocatedBytes(void) const
+		{
+			return m_uiAllocatedBytes;
+		}
+
+		// size of a slot that fits any encoder used for a_format
+		static unsigned int CalcSlotBytes(Image::Format a_format);
+
+	private:
+
+		unsigned char *m_paucStorage;
+		size_t m_uiAllocatedBytes;
+		unsigned int m_uiBlocks;
+		unsigned int m_uiSlotBytes;
+
+	};
+
+} // namespace Etc
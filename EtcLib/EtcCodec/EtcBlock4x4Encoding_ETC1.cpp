@@ -27,6 +27,7 @@ used for the ETC1 subset of file format RGB8, RGBA8 and RGB8A1
 
 #include "EtcBlock4x4.h"
 #include "EtcBlock4x4EncodingBits.h"
+#include "EtcBlockError.h"
 #include "EtcDifferentialTrys.h"
 
 #include <cstdio>
@@ -86,8 +87,6 @@ namespace Etc
 			m_afDecodedAlphas[uiPixel] = 1.0f;
 		}
 
-		m_boolMostLikelyFlip = false;
-
 		m_fError = -1.0f;
 
 		m_fError1 = -1.0f;
@@ -126,6 +125,8 @@ namespace Etc
 
 		m_fError = -1.0f;
 
+		m_analysis.Reset();
+
 		m_pencodingbitsRGB8 = (Block4x4EncodingBits_RGB8 *)(a_paucEncodingBits);
 
 	}
@@ -147,6 +148,8 @@ namespace Etc
 		Block4x4Encoding::Init(a_pblockParent, a_pafrgbaSource,a_errormetric);
 		m_fError = -1.0f;
 
+		m_analysis.Reset();
+
 		m_pencodingbitsRGB8 = (Block4x4EncodingBits_RGB8 *)a_paucEncodingBits;
 
 		m_mode = MODE_ETC1;
@@ -243,11 +246,11 @@ namespace Etc
 			break;
 
 		case 1:
-			TryDifferential(m_boolMostLikelyFlip, 1, 0, 0);
+			TryDifferential(m_analysis.boolMostLikelyFlip, 1, 0, 0);
 			break;
 
 		case 2:
-			TryIndividual(m_boolMostLikelyFlip, 1);
+			TryIndividual(m_analysis.boolMostLikelyFlip, 1);
 			if (a_fEffort <= 49.5f)
 			{
 				m_boolDone = true;
@@ -255,7 +258,7 @@ namespace Etc
 			break;
 
 		case 3:
-			TryDifferential(!m_boolMostLikelyFlip, 1, 0, 0);
+			TryDifferential(!m_analysis.boolMostLikelyFlip, 1, 0, 0);
 			if (a_fEffort <= 59.5f)
 			{
 				m_boolDone = true;
@@ -263,7 +266,7 @@ namespace Etc
 			break;
 
 		case 4:
-			TryIndividual(!m_boolMostLikelyFlip, 1);
+			TryIndividual(!m_analysis.boolMostLikelyFlip, 1);
 			if (a_fEffort <= 69.5f)
 			{
 				m_boolDone = true;
@@ -308,38 +311,148 @@ namespace Etc
 		SetDoneIfPerfect();
 	}
 
+	// ----------------------------------------------------------------------------------------------------
+	// encode a solid color block with the best ETC1 encoding of its color, looked up instead of iterated
+	//
+	bool Block4x4Encoding_ETC1::EncodeSolidColor(Image::Format)
+	{
+		SolidColor::Encoding encoding;
+		if (!FindSolidColor(SolidColor::ETC1_MODES, &encoding))
+		{
+			return false;
+		}
+
+		SetSolidColor_ETC1(encoding);
+		CalcBlockError();
+
+		m_uiEncodingIterations = 1;
+		m_boolDone = true;
+
+		return true;
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// find the best encoding of a_uiModes for a block whose pixels all have the same color
+	// returns false if the block isn't a solid color or the encoding that decodes closest to the color
+	// might not have the lowest error
+	//
+	bool Block4x4Encoding_ETC1::FindSolidColor(unsigned int a_uiModes, SolidColor::Encoding *a_pencoding) const
+	{
+		if (!m_pblockParent->IsSolidColor() || !SolidColor::IsBestForMetric(m_errormetric))
+		{
+			return false;
+		}
+
+		for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
+		{
+			// if a border pixel
+			if (std::isnan(m_pafrgbaSource[uiPixel].fA))
+			{
+				continue;
+			}
+
+			// the RGBA metric scales the color by alpha, so an alpha that doesn't decode exactly moves the
+			// color with the lowest error away from the source color
+			if (m_errormetric == ErrorMetric::RGBA && m_afDecodedAlphas[uiPixel] != m_pafrgbaSource[uiPixel].fA)
+			{
+				return false;
+			}
+
+			// the NUMERIC metric measures the alpha of the decoded colors, which the iterations carry over
+			// from the source colors they start from
+			if (m_errormetric == ErrorMetric::NUMERIC && m_pafrgbaSource[uiPixel].fA != 1.0f)
+			{
+				return false;
+			}
+
+			break;
+		}
+
+		return SolidColor::Find(m_pafrgbaSource, a_uiModes, a_pencoding);
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// set the encoding state to an ETC1 solid color encoding
+	// both halves get the same color, CW and selector
+	// the decoded alphas are left to the caller
+	//
+	void Block4x4Encoding_ETC1::SetSolidColor_ETC1(const SolidColor::Encoding &a_encoding)
+	{
+		assert(a_encoding.mode == MODE_ETC1);
+
+		unsigned char ucRed = (unsigned char)a_encoding.auiBase[0];
+		unsigned char ucGreen = (unsigned char)a_encoding.auiBase[1];
+		unsigned char ucBlue = (unsigned char)a_encoding.auiBase[2];
+
+		m_mode = MODE_ETC1;
+		m_boolDiff = a_encoding.boolDiff;
+		m_boolFlip = false;
+		if (m_boolDiff)
+		{
+			m_frgbaColor1 = ColorFloatRGBA::ConvertFromRGB5(ucRed, ucGreen, ucBlue);
+		}
+		else
+		{
+			m_frgbaColor1 = ColorFloatRGBA::ConvertFromRGB4(ucRed, ucGreen, ucBlue);
+		}
+		m_frgbaColor2 = m_frgbaColor1;
+		m_uiCW1 = a_encoding.uiCW;
+		m_uiCW2 = a_encoding.uiCW;
+
+		ColorFloatRGBA frgbaDecoded = (m_frgbaColor1 + s_aafCwTable[m_uiCW1][a_encoding.uiSelector]).ClampRGB();
+
+		for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
+		{
+			m_auiSelectors[uiPixel] = a_encoding.uiSelector;
+			m_pafrgbaDecodedColors[uiPixel] = frgbaDecoded;
+		}
+
+		m_boolSeverelyBentDifferentialColors = false;
+	}
+
 	// ----------------------------------------------------------------------------------------------------
 	// find best initial encoding to ensure block has a valid encoding
+	// the block analysis calculated here is read by the later iterations
 	//
 	void Block4x4Encoding_ETC1::PerformFirstIteration(ErrorMetric const a_errormetric)
 	{
-		CalculateMostLikelyFlip(a_errormetric);
+		AnalyzeSource(a_errormetric);
 
 		m_fError = FLT_MAX;
 
-		TryDifferential(m_boolMostLikelyFlip, 0, 0, 0);
+		TryDifferential(m_analysis.boolMostLikelyFlip, 0, 0, 0);
 		SetDoneIfPerfect();
 		if (m_boolDone)
 		{
 			return;
 		}
 
-		TryIndividual(m_boolMostLikelyFlip, 0);
+		TryIndividual(m_analysis.boolMostLikelyFlip, 0);
 		SetDoneIfPerfect();
 		if (m_boolDone)
 		{
 			return;
 		}
-		TryDifferential(!m_boolMostLikelyFlip, 0, 0, 0);
+		TryDifferential(!m_analysis.boolMostLikelyFlip, 0, 0, 0);
 		SetDoneIfPerfect();
 		if (m_boolDone)
 		{
 			return;
 		}
-		TryIndividual(!m_boolMostLikelyFlip, 0);
+		TryIndividual(!m_analysis.boolMostLikelyFlip, 0);
 
 	}
 
+	// ----------------------------------------------------------------------------------------------------
+	// fill the parts of the block analysis that every ETC1 based encoder needs
+	// planar and T/H features are added by the first iteration that tries those modes, and the color statistics
+	// by the first search that reads them
+	//
+	void Block4x4Encoding_ETC1::AnalyzeSource(ErrorMetric a_errormetric)
+	{
+		CalculateMostLikelyFlip(a_errormetric);
+	}
+
 	// ----------------------------------------------------------------------------------------------------
 	// algorithm:
 	// create a source average color for the Left, Right, Top and Bottom halves using the 8 pixels in each half
@@ -368,10 +481,10 @@ namespace Etc
 			ColorFloatRGBA *pfrgbaTop = &m_pafrgbaSource[s_auiTopPixelMapping[uiPixel]];
 			ColorFloatRGBA *pfrgbaBottom = &m_pafrgbaSource[s_auiBottomPixelMapping[uiPixel]];
 
-			float fLeftGrayError = CalcGrayDistance2(*pfrgbaLeft, m_frgbaSourceAverageLeft);
-			float fRightGrayError = CalcGrayDistance2(*pfrgbaRight, m_frgbaSourceAverageRight);
-			float fTopGrayError = CalcGrayDistance2(*pfrgbaTop, m_frgbaSourceAverageTop);
-			float fBottomGrayError = CalcGrayDistance2(*pfrgbaBottom, m_frgbaSourceAverageBottom);
+			float fLeftGrayError = CalcGrayDistance2(*pfrgbaLeft, m_analysis.frgbaAverageLeft);
+			float fRightGrayError = CalcGrayDistance2(*pfrgbaRight, m_analysis.frgbaAverageRight);
+			float fTopGrayError = CalcGrayDistance2(*pfrgbaTop, m_analysis.frgbaAverageTop);
+			float fBottomGrayError = CalcGrayDistance2(*pfrgbaBottom, m_analysis.frgbaAverageBottom);
 
 			fLeftGrayErrorSum += fLeftGrayError;
 			fRightGrayErrorSum += fRightGrayError;
@@ -384,7 +497,7 @@ namespace Etc
 			printf("\n%.2f %.2f\n", fLeftGrayErrorSum + fRightGrayErrorSum, fTopGrayErrorSum + fBottomGrayErrorSum);
 		}
 
-		m_boolMostLikelyFlip = (fTopGrayErrorSum + fBottomGrayErrorSum) < (fLeftGrayErrorSum + fRightGrayErrorSum);
+		m_analysis.boolMostLikelyFlip = (fTopGrayErrorSum + fBottomGrayErrorSum) < (fLeftGrayErrorSum + fRightGrayErrorSum);
 
 	}
 
@@ -398,6 +511,8 @@ namespace Etc
 	{
 		static const bool DEBUG_PRINT = false;
 
+		m_analysis.boolHalfAverages = true;
+
 		bool boolRGBX = a_errormetric == ErrorMetric::RGBX;
 
 		if (m_pblockParent->GetSourceAlphaMix() == Block4x4::SourceAlphaMix::OPAQUE || boolRGBX)
@@ -407,10 +522,10 @@ namespace Etc
 			ColorFloatRGBA frgbaSumUR = m_pafrgbaSource[8] + m_pafrgbaSource[9] + m_pafrgbaSource[12] + m_pafrgbaSource[13];
 			ColorFloatRGBA frgbaSumLR = m_pafrgbaSource[10] + m_pafrgbaSource[11] + m_pafrgbaSource[14] + m_pafrgbaSource[15];
 
-			m_frgbaSourceAverageLeft = (frgbaSumUL + frgbaSumLL) * 0.125f;
-			m_frgbaSourceAverageRight = (frgbaSumUR + frgbaSumLR) * 0.125f;
-			m_frgbaSourceAverageTop = (frgbaSumUL + frgbaSumUR) * 0.125f;
-			m_frgbaSourceAverageBottom = (frgbaSumLL + frgbaSumLR) * 0.125f;
+			m_analysis.frgbaAverageLeft = (frgbaSumUL + frgbaSumLL) * 0.125f;
+			m_analysis.frgbaAverageRight = (frgbaSumUR + frgbaSumLR) * 0.125f;
+			m_analysis.frgbaAverageTop = (frgbaSumUL + frgbaSumUR) * 0.125f;
+			m_analysis.frgbaAverageBottom = (frgbaSumLL + frgbaSumLR) * 0.125f;
 		}
 		else
 		{
@@ -487,40 +602,40 @@ namespace Etc
 
 			if (fWeightSumLeft > 0.0f)
 			{
-				m_frgbaSourceAverageLeft = frgbaSumLeft * (1.0f/fWeightSumLeft);
+				m_analysis.frgbaAverageLeft = frgbaSumLeft * (1.0f/fWeightSumLeft);
 			}
 			if (fWeightSumRight > 0.0f)
 			{
-				m_frgbaSourceAverageRight = frgbaSumRight * (1.0f/fWeightSumRight);
+				m_analysis.frgbaAverageRight = frgbaSumRight * (1.0f/fWeightSumRight);
 			}
 			if (fWeightSumTop > 0.0f)
 			{
-				m_frgbaSourceAverageTop = frgbaSumTop * (1.0f/fWeightSumTop);
+				m_analysis.frgbaAverageTop = frgbaSumTop * (1.0f/fWeightSumTop);
 			}
 			if (fWeightSumBottom > 0.0f)
 			{
-				m_frgbaSourceAverageBottom = frgbaSumBottom * (1.0f/fWeightSumBottom);
+				m_analysis.frgbaAverageBottom = frgbaSumBottom * (1.0f/fWeightSumBottom);
 			}
 
 			if (fWeightSumLeft == 0.0f)
 			{
 				assert(fWeightSumRight > 0.0f);
-				m_frgbaSourceAverageLeft = m_frgbaSourceAverageRight;
+				m_analysis.frgbaAverageLeft = m_analysis.frgbaAverageRight;
 			}
 			if (fWeightSumRight == 0.0f)
 			{
 				assert(fWeightSumLeft > 0.0f);
-				m_frgbaSourceAverageRight = m_frgbaSourceAverageLeft;
+				m_analysis.frgbaAverageRight = m_analysis.frgbaAverageLeft;
 			}
 			if (fWeightSumTop == 0.0f)
 			{
 				assert(fWeightSumBottom > 0.0f);
-				m_frgbaSourceAverageTop = m_frgbaSourceAverageBottom;
+				m_analysis.frgbaAverageTop = m_analysis.frgbaAverageBottom;
 			}
 			if (fWeightSumBottom == 0.0f)
 			{
 				assert(fWeightSumTop > 0.0f);
-				m_frgbaSourceAverageBottom = m_frgbaSourceAverageTop;
+				m_analysis.frgbaAverageBottom = m_analysis.frgbaAverageTop;
 			}
 		}
 
@@ -529,10 +644,10 @@ namespace Etc
 		if (DEBUG_PRINT)
 		{
 			printf("\ntarget: [%.2f,%.2f,%.2f] [%.2f,%.2f,%.2f] [%.2f,%.2f,%.2f] [%.2f,%.2f,%.2f]\n",
-				m_frgbaSourceAverageLeft.fR, m_frgbaSourceAverageLeft.fG, m_frgbaSourceAverageLeft.fB,
-				m_frgbaSourceAverageRight.fR, m_frgbaSourceAverageRight.fG, m_frgbaSourceAverageRight.fB,
-				m_frgbaSourceAverageTop.fR, m_frgbaSourceAverageTop.fG, m_frgbaSourceAverageTop.fB,
-				m_frgbaSourceAverageBottom.fR, m_frgbaSourceAverageBottom.fG, m_frgbaSourceAverageBottom.fB);
+				m_analysis.frgbaAverageLeft.fR, m_analysis.frgbaAverageLeft.fG, m_analysis.frgbaAverageLeft.fB,
+				m_analysis.frgbaAverageRight.fR, m_analysis.frgbaAverageRight.fG, m_analysis.frgbaAverageRight.fB,
+				m_analysis.frgbaAverageTop.fR, m_analysis.frgbaAverageTop.fG, m_analysis.frgbaAverageTop.fB,
+				m_analysis.frgbaAverageBottom.fR, m_analysis.frgbaAverageBottom.fG, m_analysis.frgbaAverageBottom.fB);
 		}
 
 	}
@@ -556,16 +671,16 @@ namespace Etc
 
 		if (a_boolFlip)
 		{
-			frgbaColor1 = m_frgbaSourceAverageTop;
-			frgbaColor2 = m_frgbaSourceAverageBottom;
+			frgbaColor1 = m_analysis.frgbaAverageTop;
+			frgbaColor2 = m_analysis.frgbaAverageBottom;
 
 			pauiPixelMapping1 = s_auiTopPixelMapping;
 			pauiPixelMapping2 = s_auiBottomPixelMapping;
 		}
 		else
 		{
-			frgbaColor1 = m_frgbaSourceAverageLeft;
-			frgbaColor2 = m_frgbaSourceAverageRight;
+			frgbaColor1 = m_analysis.frgbaAverageLeft;
+			frgbaColor2 = m_analysis.frgbaAverageRight;
 
 			pauiPixelMapping1 = s_auiLeftPixelMapping;
 			pauiPixelMapping2 = s_auiRightPixelMapping;
@@ -574,16 +689,13 @@ namespace Etc
 		DifferentialTrys trys(frgbaColor1, frgbaColor2, pauiPixelMapping1, pauiPixelMapping2, 
 								a_uiRadius, a_iGrayOffset1, a_iGrayOffset2);
 
-		Block4x4Encoding_ETC1 encodingTry = *this;
-		encodingTry.m_boolFlip = a_boolFlip;
-
-		encodingTry.TryDifferentialHalf(&trys.m_half1);
-		encodingTry.TryDifferentialHalf(&trys.m_half2);
+		TryDifferentialHalf(&trys.m_half1);
+		TryDifferentialHalf(&trys.m_half2);
 
 		// find best halves that are within differential range
 		DifferentialTrys::Try *ptryBest1 = nullptr;
 		DifferentialTrys::Try *ptryBest2 = nullptr;
-		encodingTry.m_fError = FLT_MAX;
+		float fBestError = FLT_MAX;
 
 		// see if the best of each half are in differential range
 		int iDRed = trys.m_half2.m_ptryBest->m_iRed - trys.m_half1.m_ptryBest->m_iRed;
@@ -593,7 +705,7 @@ namespace Etc
 		{
 			ptryBest1 = trys.m_half1.m_ptryBest;
 			ptryBest2 = trys.m_half2.m_ptryBest;
-			encodingTry.m_fError = trys.m_half1.m_ptryBest->m_fError + trys.m_half2.m_ptryBest->m_fError;
+			fBestError = trys.m_half1.m_ptryBest->m_fError + trys.m_half2.m_ptryBest->m_fError;
 		}
 		else
 		{
@@ -615,11 +727,33 @@ namespace Etc
 
 					if (boolValidRedDelta && boolValidGreenDelta && boolValidBlueDelta)
 					{
+						// TryDifferentialHalf() skipped the CWs that can't be the best of their half,
+						// evaluate the rest of a try only if it could be part of the best pair
+						if (ptry1->m_fError >= ptry1->m_fErrorBound || ptry2->m_fError >= ptry2->m_fErrorBound)
+						{
+							float fErrorBound = ((ptry1->m_fError < ptry1->m_fErrorBound) ? ptry1->m_fError : ptry1->m_fErrorBound) +
+												((ptry2->m_fError < ptry2->m_fErrorBound) ? ptry2->m_fError : ptry2->m_fErrorBound);
+							if (fErrorBound >= fBestError)
+							{
+								continue;
+							}
+
+							if (ptry1->m_fError >= ptry1->m_fErrorBound)
+							{
+								EvaluateDifferentialTry(ptry1, trys.m_half1.m_pauiPixelMapping, nullptr, FLT_MAX);
+							}
+							if (ptry2->m_fError >= ptry2->m_fErrorBound)
+							{
+								EvaluateDifferentialTry(ptry2, trys.m_half2.m_pauiPixelMapping, nullptr, FLT_MAX);
+							}
+							assert(ptry1->m_fError < ptry1->m_fErrorBound && ptry2->m_fError < ptry2->m_fErrorBound);
+						}
+
 						float fError = ptry1->m_fError + ptry2->m_fError;
 
-						if (fError < encodingTry.m_fError)
+						if (fError < fBestError)
 						{
-							encodingTry.m_fError = fError;
+							fBestError = fError;
 
 							ptryBest1 = ptry1;
 							ptryBest2 = ptry2;
@@ -628,16 +762,16 @@ namespace Etc
 
 				}
 			}
-			assert(encodingTry.m_fError < FLT_MAX);
+			assert(fBestError < FLT_MAX);
 			assert(ptryBest1 != nullptr);
 			assert(ptryBest2 != nullptr);
 		}
 
-		if (encodingTry.m_fError < m_fError)
+		if (fBestError < m_fError)
 		{
 			m_mode = MODE_ETC1;
 			m_boolDiff = true;
-			m_boolFlip = encodingTry.m_boolFlip;
+			m_boolFlip = a_boolFlip;
 			m_frgbaColor1 = ColorFloatRGBA::ConvertFromRGB5((unsigned char)ptryBest1->m_iRed, (unsigned char)ptryBest1->m_iGreen, (unsigned char)ptryBest1->m_iBlue);
 			m_frgbaColor2 = ColorFloatRGBA::ConvertFromRGB5((unsigned char)ptryBest2->m_iRed, (unsigned char)ptryBest2->m_iGreen, (unsigned char)ptryBest2->m_iBlue);
 			m_uiCW1 = ptryBest1->m_uiCW;
@@ -657,8 +791,8 @@ namespace Etc
 				float fDeltaRGB1 = s_aafCwTable[m_uiCW1][uiSelector1];
 				float fDeltaRGB2 = s_aafCwTable[m_uiCW2][uiSelector2];
 
-				m_afrgbaDecodedColors[uiPixel1] = (m_frgbaColor1 + fDeltaRGB1).ClampRGB();
-				m_afrgbaDecodedColors[uiPixel2] = (m_frgbaColor2 + fDeltaRGB2).ClampRGB();
+				m_pafrgbaDecodedColors[uiPixel1] = (m_frgbaColor1 + fDeltaRGB1).ClampRGB();
+				m_pafrgbaDecodedColors[uiPixel2] = (m_frgbaColor2 + fDeltaRGB2).ClampRGB();
 			}
 
 			m_fError1 = ptryBest1->m_fError;
@@ -691,13 +825,14 @@ namespace Etc
 	// ----------------------------------------------------------------------------------------------------
 	// try an ETC1 differential mode encoding for a half of a 4x4 block
 	// vary the basecolor components using a radius
+	// the center try is evaluated first, then the CWs of the other trys whose error bound shows
+	// that they can't beat the best try so far are skipped
+	// ties go to the first try, as if all of them were evaluated in order
+	// TryDifferential() evaluates the rest of a try if it needs its error
 	//
 	void Block4x4Encoding_ETC1::TryDifferentialHalf(DifferentialTrys::Half *a_phalf)
 	{
 
-		a_phalf->m_ptryBest = nullptr;
-		float fBestTryError = FLT_MAX;
-
 		a_phalf->m_uiTrys = 0;
 		for (int iRed = a_phalf->m_iRed - (int)a_phalf->m_uiRadius; 
 				iRed <= a_phalf->m_iRed + (int)a_phalf->m_uiRadius;
@@ -723,82 +858,58 @@ namespace Etc
 					ptry->m_iRed = iRed;
 					ptry->m_iGreen = iGreen;
 					ptry->m_iBlue = iBlue;
-					ptry->m_fError = FLT_MAX;
-					ColorFloatRGBA frgbaColor = ColorFloatRGBA::ConvertFromRGB5((unsigned char)iRed, (unsigned char)iGreen, (unsigned char)iBlue);
-
-					// try each CW
-					for (unsigned int uiCW = 0; uiCW < CW_RANGES; uiCW++)
-					{
-						unsigned int auiPixelSelectors[PIXELS / 2];
-						ColorFloatRGBA	afrgbaDecodedPixels[PIXELS / 2];
-						float afPixelErrors[PIXELS / 2] = { FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX, 
-															FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX };
-
-						// pre-compute decoded pixels for each selector
-						ColorFloatRGBA afrgbaSelectors[SELECTORS];
-						static_assert(SELECTORS == 4, "");
-						afrgbaSelectors[0] = (frgbaColor + s_aafCwTable[uiCW][0]).ClampRGB();
-						afrgbaSelectors[1] = (frgbaColor + s_aafCwTable[uiCW][1]).ClampRGB();
-						afrgbaSelectors[2] = (frgbaColor + s_aafCwTable[uiCW][2]).ClampRGB();
-						afrgbaSelectors[3] = (frgbaColor + s_aafCwTable[uiCW][3]).ClampRGB();
-
-						for (unsigned int uiPixel = 0; uiPixel < 8; uiPixel++)
-						{
-							ColorFloatRGBA *pfrgbaSourcePixel = &m_pafrgbaSource[a_phalf->m_pauiPixelMapping[uiPixel]];
-							ColorFloatRGBA frgbaDecodedPixel;
-
-							for (unsigned int uiSelector = 0; uiSelector < SELECTORS; uiSelector++)
-							{
-								frgbaDecodedPixel = afrgbaSelectors[uiSelector];
-
-								float fPixelError;
 
-								fPixelError = CalcPixelError(frgbaDecodedPixel, m_afDecodedAlphas[a_phalf->m_pauiPixelMapping[uiPixel]],
-																	*pfrgbaSourcePixel);
+					a_phalf->m_uiTrys++;
+				}
+			}
+		}
 
-								if (fPixelError < afPixelErrors[uiPixel])
-								{
-									auiPixelSelectors[uiPixel] = uiSelector;
-									afrgbaDecodedPixels[uiPixel] = frgbaDecodedPixel;
-									afPixelErrors[uiPixel] = fPixelError;
-								}
+		HalfErrorBoundStatistics statistics;
+		m_pmetrickernels->pfnHalfErrorBoundStatistics(m_afDecodedAlphas, m_pafrgbaSource, a_phalf->m_pauiPixelMapping,
+														&statistics);
 
-							}
-						}
+		// the trys are a cube around the center
+		DifferentialTrys::Try *ptryCenter = &a_phalf->m_atry[a_phalf->m_uiTrys / 2];
+		EvaluateDifferentialTry(ptryCenter, a_phalf->m_pauiPixelMapping, &statistics, FLT_MAX);
+		a_phalf->m_ptryBest = ptryCenter;
 
-						// add up all pixel errors
-						float fCWError = 0.0f;
-						for (unsigned int uiPixel = 0; uiPixel < 8; uiPixel++)
-						{	
-							fCWError += afPixelErrors[uiPixel];
-						}
+		for (DifferentialTrys::Try *ptry = &a_phalf->m_atry[0]; ptry < &a_phalf->m_atry[a_phalf->m_uiTrys]; ptry++)
+		{
+			if (ptry == ptryCenter)
+			{
+				continue;
+			}
 
-						// if best CW so far
-						if (fCWError < ptry->m_fError)
-						{
-							ptry->m_uiCW = uiCW;
-							for (unsigned int uiPixel = 0; uiPixel < 8; uiPixel++)
-							{
-								ptry->m_auiSelectors[uiPixel] = auiPixelSelectors[uiPixel];
-							}
-							ptry->m_fError = fCWError;
-						}
+			// a try with skipped CWs is only the best if a CW that wasn't skipped beats the best so far,
+			// since the skipped ones can't
+			float fBestTryError = a_phalf->m_ptryBest->m_fError;
+			EvaluateDifferentialTry(ptry, a_phalf->m_pauiPixelMapping, &statistics, fBestTryError);
 
-					}
+			if (ptry->m_fError < fBestTryError ||
+				(ptry->m_fError == fBestTryError && ptry < a_phalf->m_ptryBest))
+			{
+				assert(ptry->m_fError < ptry->m_fErrorBound);
+				a_phalf->m_ptryBest = ptry;
+			}
+		}
 
-					if (ptry->m_fError < fBestTryError)
-					{
-						a_phalf->m_ptryBest = ptry;
-						fBestTryError = ptry->m_fError;
-					}
+		assert(a_phalf->m_ptryBest->m_fError < FLT_MAX);
 
-					assert(ptry->m_fError < FLT_MAX);
+	}
 
-					a_phalf->m_uiTrys++;
-				}
-			}
-		}
+	// ----------------------------------------------------------------------------------------------------
+	// find the best CW and selectors of a differential mode try
+	// with a_pstatistics, CWs that can't have an error <= a_fMaxError are skipped
+	//
+	void Block4x4Encoding_ETC1::EvaluateDifferentialTry(DifferentialTrys::Try *a_ptry, const unsigned int *a_pauiPixelMapping,
+												const HalfErrorBoundStatistics *a_pstatistics, float a_fMaxError)
+	{
+		ColorFloatRGBA frgbaColor = ColorFloatRGBA::ConvertFromRGB5((unsigned char)a_ptry->m_iRed,
+																	(unsigned char)a_ptry->m_iGreen,
+																	(unsigned char)a_ptry->m_iBlue);
 
+		a_ptry->m_fError = FindBestCW(frgbaColor, a_pauiPixelMapping, a_pstatistics, a_fMaxError,
+										&a_ptry->m_uiCW, a_ptry->m_auiSelectors, &a_ptry->m_fErrorBound);
 	}
 
 	// ----------------------------------------------------------------------------------------------------
@@ -818,16 +929,16 @@ namespace Etc
 
 		if (a_boolFlip)
 		{
-			frgbaColor1 = m_frgbaSourceAverageTop;
-			frgbaColor2 = m_frgbaSourceAverageBottom;
+			frgbaColor1 = m_analysis.frgbaAverageTop;
+			frgbaColor2 = m_analysis.frgbaAverageBottom;
 
 			pauiPixelMapping1 = s_auiTopPixelMapping;
 			pauiPixelMapping2 = s_auiBottomPixelMapping;
 		}
 		else
 		{
-			frgbaColor1 = m_frgbaSourceAverageLeft;
-			frgbaColor2 = m_frgbaSourceAverageRight;
+			frgbaColor1 = m_analysis.frgbaAverageLeft;
+			frgbaColor2 = m_analysis.frgbaAverageRight;
 
 			pauiPixelMapping1 = s_auiLeftPixelMapping;
 			pauiPixelMapping2 = s_auiRightPixelMapping;
@@ -835,22 +946,19 @@ namespace Etc
 
 		IndividualTrys trys(frgbaColor1, frgbaColor2, pauiPixelMapping1, pauiPixelMapping2, a_uiRadius);
 
-		Block4x4Encoding_ETC1 encodingTry = *this;
-		encodingTry.m_boolFlip = a_boolFlip;
-
-		encodingTry.TryIndividualHalf(&trys.m_half1);
-		encodingTry.TryIndividualHalf(&trys.m_half2);
+		TryIndividualHalf(&trys.m_half1);
+		TryIndividualHalf(&trys.m_half2);
 
 		// use the best of each half
 		IndividualTrys::Try *ptryBest1 = trys.m_half1.m_ptryBest;
 		IndividualTrys::Try *ptryBest2 = trys.m_half2.m_ptryBest;
-		encodingTry.m_fError = trys.m_half1.m_ptryBest->m_fError + trys.m_half2.m_ptryBest->m_fError;
+		float fBestError = trys.m_half1.m_ptryBest->m_fError + trys.m_half2.m_ptryBest->m_fError;
 
-		if (encodingTry.m_fError < m_fError)
+		if (fBestError < m_fError)
 		{
 			m_mode = MODE_ETC1;
 			m_boolDiff = false;
-			m_boolFlip = encodingTry.m_boolFlip;
+			m_boolFlip = a_boolFlip;
 			m_frgbaColor1 = ColorFloatRGBA::ConvertFromRGB4((unsigned char)ptryBest1->m_iRed, (unsigned char)ptryBest1->m_iGreen, (unsigned char)ptryBest1->m_iBlue);
 			m_frgbaColor2 = ColorFloatRGBA::ConvertFromRGB4((unsigned char)ptryBest2->m_iRed, (unsigned char)ptryBest2->m_iGreen, (unsigned char)ptryBest2->m_iBlue);
 			m_uiCW1 = ptryBest1->m_uiCW;
@@ -870,8 +978,8 @@ namespace Etc
 				float fDeltaRGB1 = s_aafCwTable[m_uiCW1][uiSelector1];
 				float fDeltaRGB2 = s_aafCwTable[m_uiCW2][uiSelector2];
 
-				m_afrgbaDecodedColors[uiPixel1] = (m_frgbaColor1 + fDeltaRGB1).ClampRGB();
-				m_afrgbaDecodedColors[uiPixel2] = (m_frgbaColor2 + fDeltaRGB2).ClampRGB();
+				m_pafrgbaDecodedColors[uiPixel1] = (m_frgbaColor1 + fDeltaRGB1).ClampRGB();
+				m_pafrgbaDecodedColors[uiPixel2] = (m_frgbaColor2 + fDeltaRGB2).ClampRGB();
 			}
 
 			m_fError1 = ptryBest1->m_fError;
@@ -882,15 +990,15 @@ namespace Etc
 	}
 
 	// ----------------------------------------------------------------------------------------------------
-	// try an ETC1 differential mode encoding for a half of a 4x4 block
+	// try an ETC1 individual mode encoding for a half of a 4x4 block
 	// vary the basecolor components using a radius
+	// the center try is evaluated first, then the CWs of the other trys whose error bound shows
+	// that they can't beat the best try so far are skipped
+	// ties go to the first try, as if all of them were evaluated in order
 	//
 	void Block4x4Encoding_ETC1::TryIndividualHalf(IndividualTrys::Half *a_phalf)
 	{
 
-		a_phalf->m_ptryBest = nullptr;
-		float fBestTryError = FLT_MAX;
-
 		a_phalf->m_uiTrys = 0;
 		for (int iRed = a_phalf->m_iRed - (int)a_phalf->m_uiRadius;
 			iRed <= a_phalf->m_iRed + (int)a_phalf->m_uiRadius;
@@ -916,82 +1024,134 @@ namespace Etc
 					ptry->m_iRed = iRed;
 					ptry->m_iGreen = iGreen;
 					ptry->m_iBlue = iBlue;
-					ptry->m_fError = FLT_MAX;
-					ColorFloatRGBA frgbaColor = ColorFloatRGBA::ConvertFromRGB4((unsigned char)iRed, (unsigned char)iGreen, (unsigned char)iBlue);
 
-					// try each CW
-					for (unsigned int uiCW = 0; uiCW < CW_RANGES; uiCW++)
-					{
-						unsigned int auiPixelSelectors[PIXELS / 2];
-						ColorFloatRGBA	afrgbaDecodedPixels[PIXELS / 2];
-						float afPixelErrors[PIXELS / 2] = { FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX,
-															FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX };
-
-						// pre-compute decoded pixels for each selector
-						ColorFloatRGBA afrgbaSelectors[SELECTORS];
-						static_assert(SELECTORS == 4, "");
-						afrgbaSelectors[0] = (frgbaColor + s_aafCwTable[uiCW][0]).ClampRGB();
-						afrgbaSelectors[1] = (frgbaColor + s_aafCwTable[uiCW][1]).ClampRGB();
-						afrgbaSelectors[2] = (frgbaColor + s_aafCwTable[uiCW][2]).ClampRGB();
-						afrgbaSelectors[3] = (frgbaColor + s_aafCwTable[uiCW][3]).ClampRGB();
-
-						for (unsigned int uiPixel = 0; uiPixel < 8; uiPixel++)
-						{
-							ColorFloatRGBA *pfrgbaSourcePixel = &m_pafrgbaSource[a_phalf->m_pauiPixelMapping[uiPixel]];
-							ColorFloatRGBA frgbaDecodedPixel;
+					a_phalf->m_uiTrys++;
+				}
+			}
+		}
 
-							for (unsigned int uiSelector = 0; uiSelector < SELECTORS; uiSelector++)
-							{
-								frgbaDecodedPixel = afrgbaSelectors[uiSelector];
+		HalfErrorBoundStatistics statistics;
+		m_pmetrickernels->pfnHalfErrorBoundStatistics(m_afDecodedAlphas, m_pafrgbaSource, a_phalf->m_pauiPixelMapping,
+														&statistics);
 
-								float fPixelError;
+		// the trys are a cube around the center
+		IndividualTrys::Try *ptryCenter = &a_phalf->m_atry[a_phalf->m_uiTrys / 2];
+		EvaluateIndividualTry(ptryCenter, a_phalf->m_pauiPixelMapping, &statistics, FLT_MAX);
+		a_phalf->m_ptryBest = ptryCenter;
 
-								fPixelError = CalcPixelError(frgbaDecodedPixel, m_afDecodedAlphas[a_phalf->m_pauiPixelMapping[uiPixel]],
-										*pfrgbaSourcePixel);
+		for (IndividualTrys::Try *ptry = &a_phalf->m_atry[0]; ptry < &a_phalf->m_atry[a_phalf->m_uiTrys]; ptry++)
+		{
+			if (ptry == ptryCenter)
+			{
+				continue;
+			}
 
-								if (fPixelError < afPixelErrors[uiPixel])
-								{
-									auiPixelSelectors[uiPixel] = uiSelector;
-									afrgbaDecodedPixels[uiPixel] = frgbaDecodedPixel;
-									afPixelErrors[uiPixel] = fPixelError;
-								}
+			// a try with skipped CWs is only the best if a CW that wasn't skipped beats the best so far,
+			// since the skipped ones can't
+			float fBestTryError = a_phalf->m_ptryBest->m_fError;
+			EvaluateIndividualTry(ptry, a_phalf->m_pauiPixelMapping, &statistics, fBestTryError);
 
-							}
-						}
+			if (ptry->m_fError < fBestTryError ||
+				(ptry->m_fError == fBestTryError && ptry < a_phalf->m_ptryBest))
+			{
+				assert(ptry->m_fError < ptry->m_fErrorBound);
+				a_phalf->m_ptryBest = ptry;
+			}
+		}
 
-						// add up all pixel errors
-						float fCWError = 0.0f;
-						for (unsigned int uiPixel = 0; uiPixel < 8; uiPixel++)
-						{
-							fCWError += afPixelErrors[uiPixel];
-						}
+		assert(a_phalf->m_ptryBest->m_fError < FLT_MAX);
 
-						// if best CW so far
-						if (fCWError < ptry->m_fError)
-						{
-							ptry->m_uiCW = uiCW;
-							for (unsigned int uiPixel = 0; uiPixel < 8; uiPixel++)
-							{
-								ptry->m_auiSelectors[uiPixel] = auiPixelSelectors[uiPixel];
-							}
-							ptry->m_fError = fCWError;
-						}
+	}
 
-					}
+	// ----------------------------------------------------------------------------------------------------
+	// find the best CW and selectors of an individual mode try
+	// with a_pstatistics, CWs that can't have an error <= a_fMaxError are skipped
+	//
+	void Block4x4Encoding_ETC1::EvaluateIndividualTry(IndividualTrys::Try *a_ptry, const unsigned int *a_pauiPixelMapping,
+												const HalfErrorBoundStatistics *a_pstatistics, float a_fMaxError)
+	{
+		ColorFloatRGBA frgbaColor = ColorFloatRGBA::ConvertFromRGB4((unsigned char)a_ptry->m_iRed,
+																	(unsigned char)a_ptry->m_iGreen,
+																	(unsigned char)a_ptry->m_iBlue);
 
-					if (ptry->m_fError < fBestTryError)
-					{
-						a_phalf->m_ptryBest = ptry;
-						fBestTryError = ptry->m_fError;
-					}
+		a_ptry->m_fError = FindBestCW(frgbaColor, a_pauiPixelMapping, a_pstatistics, a_fMaxError,
+										&a_ptry->m_uiCW, a_ptry->m_auiSelectors, &a_ptry->m_fErrorBound);
+	}
 
-					assert(ptry->m_fError < FLT_MAX);
+	// ----------------------------------------------------------------------------------------------------
+	// find the CW and selectors with the lowest error for a half of a 4x4 block with base color a_frgbaColor
+	// ties go to the lower CW
+	// with the statistics of the half, CWs whose error bound shows that they can't have an error <= a_fMaxError,
+	// or can't beat a lower CW, are skipped, and the lowest of their error bounds is written to a_pfSkippedErrorBound
+	// returns the lowest error of the CWs that weren't skipped, or FLT_MAX if all were
+	//
+	float Block4x4Encoding_ETC1::FindBestCW(ColorFloatRGBA a_frgbaColor, const unsigned int *a_pauiPixelMapping,
+											const HalfErrorBoundStatistics *a_pstatistics, float a_fMaxError,
+											unsigned int *a_puiCW, unsigned int *a_pauiSelectors, float *a_pfSkippedErrorBound)
+	{
+		float afErrorBounds[CW_RANGES];
+		if (a_pstatistics != nullptr)
+		{
+			// the largest modifier of each CW
+			float afMaxModifiers[CW_RANGES];
+			for (unsigned int uiCW = 0; uiCW < CW_RANGES; uiCW++)
+			{
+				assert(s_aafCwTable[uiCW][1] == -s_aafCwTable[uiCW][3]);
+				afMaxModifiers[uiCW] = s_aafCwTable[uiCW][1];
+			}
 
-					a_phalf->m_uiTrys++;
+			m_pmetrickernels->pfnHalfErrorBounds(*a_pstatistics, a_frgbaColor, afMaxModifiers, CW_RANGES, afErrorBounds);
+		}
+		else
+		{
+			for (unsigned int uiCW = 0; uiCW < CW_RANGES; uiCW++)
+			{
+				afErrorBounds[uiCW] = -FLT_MAX;
+			}
+		}
+
+		float fBestError = FLT_MAX;
+		*a_pfSkippedErrorBound = FLT_MAX;
+
+		for (unsigned int uiCW = 0; uiCW < CW_RANGES; uiCW++)
+		{
+			if (afErrorBounds[uiCW] > a_fMaxError || afErrorBounds[uiCW] > fBestError)
+			{
+				if (afErrorBounds[uiCW] < *a_pfSkippedErrorBound)
+				{
+					*a_pfSkippedErrorBound = afErrorBounds[uiCW];
+				}
+				continue;
+			}
+
+			unsigned int auiPixelSelectors[PIXELS / 2];
+
+			// pre-compute decoded pixels for each selector
+			ColorFloatRGBA afrgbaSelectors[SELECTORS];
+			static_assert(SELECTORS == 4, "");
+			afrgbaSelectors[0] = (a_frgbaColor + s_aafCwTable[uiCW][0]).ClampRGB();
+			afrgbaSelectors[1] = (a_frgbaColor + s_aafCwTable[uiCW][1]).ClampRGB();
+			afrgbaSelectors[2] = (a_frgbaColor + s_aafCwTable[uiCW][2]).ClampRGB();
+			afrgbaSelectors[3] = (a_frgbaColor + s_aafCwTable[uiCW][3]).ClampRGB();
+
+			// pick the best selector for each pixel and add up the pixel errors
+			float fCWError = m_pmetrickernels->pfnHalfSelectors(afrgbaSelectors, m_afDecodedAlphas, m_pafrgbaSource,
+																a_pauiPixelMapping, false, auiPixelSelectors);
+			assert(fCWError >= afErrorBounds[uiCW]);
+
+			// if best CW so far
+			if (fCWError < fBestError)
+			{
+				*a_puiCW = uiCW;
+				for (unsigned int uiPixel = 0; uiPixel < PIXELS / 2; uiPixel++)
+				{
+					a_pauiSelectors[uiPixel] = auiPixelSelectors[uiPixel];
 				}
+				fBestError = fCWError;
 			}
 		}
 
+		return fBestError;
 	}
 
 	// ----------------------------------------------------------------------------------------------------
@@ -1003,10 +1163,10 @@ namespace Etc
 	void Block4x4Encoding_ETC1::TryDegenerates1(void)
 	{
 
-		TryDifferential(m_boolMostLikelyFlip, 1, -2, 0);
-		TryDifferential(m_boolMostLikelyFlip, 1, 2, 0);
-		TryDifferential(m_boolMostLikelyFlip, 1, 0, 2);
-		TryDifferential(m_boolMostLikelyFlip, 1, 0, -2);
+		TryDifferential(m_analysis.boolMostLikelyFlip, 1, -2, 0);
+		TryDifferential(m_analysis.boolMostLikelyFlip, 1, 2, 0);
+		TryDifferential(m_analysis.boolMostLikelyFlip, 1, 0, 2);
+		TryDifferential(m_analysis.boolMostLikelyFlip, 1, 0, -2);
 
 	}
 
@@ -1019,10 +1179,10 @@ namespace Etc
 	void Block4x4Encoding_ETC1::TryDegenerates2(void)
 	{
 
-		TryDifferential(!m_boolMostLikelyFlip, 1, -2, 0);
-		TryDifferential(!m_boolMostLikelyFlip, 1, 2, 0);
-		TryDifferential(!m_boolMostLikelyFlip, 1, 0, 2);
-		TryDifferential(!m_boolMostLikelyFlip, 1, 0, -2);
+		TryDifferential(!m_analysis.boolMostLikelyFlip, 1, -2, 0);
+		TryDifferential(!m_analysis.boolMostLikelyFlip, 1, 2, 0);
+		TryDifferential(!m_analysis.boolMostLikelyFlip, 1, 0, 2);
+		TryDifferential(!m_analysis.boolMostLikelyFlip, 1, 0, -2);
 
 	}
 
@@ -1035,10 +1195,10 @@ namespace Etc
 	void Block4x4Encoding_ETC1::TryDegenerates3(void)
 	{
 
-		TryDifferential(m_boolMostLikelyFlip, 1, -2, -2);
-		TryDifferential(m_boolMostLikelyFlip, 1, -2, 2);
-		TryDifferential(m_boolMostLikelyFlip, 1, 2, -2);
-		TryDifferential(m_boolMostLikelyFlip, 1, 2, 2);
+		TryDifferential(m_analysis.boolMostLikelyFlip, 1, -2, -2);
+		TryDifferential(m_analysis.boolMostLikelyFlip, 1, -2, 2);
+		TryDifferential(m_analysis.boolMostLikelyFlip, 1, 2, -2);
+		TryDifferential(m_analysis.boolMostLikelyFlip, 1, 2, 2);
 
 	}
 
@@ -1051,10 +1211,10 @@ namespace Etc
 	void Block4x4Encoding_ETC1::TryDegenerates4(void)
 	{
 
-		TryDifferential(m_boolMostLikelyFlip, 1, -4, 0);
-		TryDifferential(m_boolMostLikelyFlip, 1, 4, 0);
-		TryDifferential(m_boolMostLikelyFlip, 1, 0, 4);
-		TryDifferential(m_boolMostLikelyFlip, 1, 0, -4);
+		TryDifferential(m_analysis.boolMostLikelyFlip, 1, -4, 0);
+		TryDifferential(m_analysis.boolMostLikelyFlip, 1, 4, 0);
+		TryDifferential(m_analysis.boolMostLikelyFlip, 1, 0, 4);
+		TryDifferential(m_analysis.boolMostLikelyFlip, 1, 0, -4);
 
 	}
 
@@ -1175,7 +1335,7 @@ namespace Etc
 				for (unsigned int uiPixel = 0; uiPixel < 8; uiPixel++)
 				{
 					m_auiSelectors[pauiPixelMapping[uiPixel]] = auiPixelSelectors[uiPixel];
-					m_afrgbaDecodedColors[pauiPixelMapping[uiPixel]] = afrgbaDecodedPixels[uiPixel];
+					m_pafrgbaDecodedColors[pauiPixelMapping[uiPixel]] = afrgbaDecodedPixels[uiPixel];
 				}
 			}
 		}
@@ -1272,7 +1432,7 @@ namespace Etc
 			unsigned int uiPixel = pauiPixelOrder[uiPixelOrder];
 
 			float fDelta = s_aafCwTable[uiCW][m_auiSelectors[uiPixel]];
-			m_afrgbaDecodedColors[uiPixel] = (*pfrgbaCenter + fDelta).ClampRGB();
+			m_pafrgbaDecodedColors[uiPixel] = (*pfrgbaCenter + fDelta).ClampRGB();
 			m_afDecodedAlphas[uiPixel] = 1.0f;
 		}
 
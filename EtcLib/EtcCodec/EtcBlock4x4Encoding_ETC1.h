@@ -18,11 +18,14 @@
 
 #include "EtcBlock4x4Encoding.h"
 #include "EtcBlock4x4EncodingBits.h"
+#include "EtcBlockAnalysis.h"
 #include "EtcDifferentialTrys.h"
 #include "EtcIndividualTrys.h"
+#include "EtcSolidColor.h"
 
 namespace Etc
 {
+	struct HalfErrorBoundStatistics;
 
 	// base class for Block4x4Encoding_RGB8
 	class Block4x4Encoding_ETC1 : public Block4x4Encoding
@@ -46,6 +49,8 @@ namespace Etc
 
 		virtual void PerformIteration(Image::Format a_encoding, ErrorMetric a_errormetric, float a_fEffort) override;
 
+		virtual bool EncodeSolidColor(Image::Format a_encoding) override;
+
 		inline virtual bool GetFlip(void) override
 		{
 			return m_boolFlip;
@@ -116,14 +121,26 @@ namespace Etc
 		void InitFromEncodingBits_Selectors(void);
 
 		void PerformFirstIteration(ErrorMetric a_errormetric);
+		void AnalyzeSource(ErrorMetric a_errormetric);
 		void CalculateMostLikelyFlip(ErrorMetric a_errormetric);
 
+		bool FindSolidColor(unsigned int a_uiModes, SolidColor::Encoding *a_pencoding) const;
+		void SetSolidColor_ETC1(const SolidColor::Encoding &a_encoding);
+
 		void TryDifferential(bool a_boolFlip, unsigned int a_uiRadius,
 								int a_iGrayOffset1, int a_iGrayOffset2);
 		void TryDifferentialHalf(DifferentialTrys::Half *a_phalf);
+		void EvaluateDifferentialTry(DifferentialTrys::Try *a_ptry, const unsigned int *a_pauiPixelMapping,
+										const HalfErrorBoundStatistics *a_pstatistics, float a_fMaxError);
 
 		void TryIndividual(bool a_boolFlip, unsigned int a_uiRadius);
 		void TryIndividualHalf(IndividualTrys::Half *a_phalf);
+		void EvaluateIndividualTry(IndividualTrys::Try *a_ptry, const unsigned int *a_pauiPixelMapping,
+									const HalfErrorBoundStatistics *a_pstatistics, float a_fMaxError);
+
+		float FindBestCW(ColorFloatRGBA a_frgbaColor, const unsigned int *a_pauiPixelMapping,
+							const HalfErrorBoundStatistics *a_pstatistics, float a_fMaxError,
+							unsigned int *a_puiCW, unsigned int *a_pauiSelectors, float *a_pfSkippedErrorBound);
 
 		void TryDegenerates1(void);
 		void TryDegenerates2(void);
@@ -163,11 +180,7 @@ namespace Etc
 		unsigned int	m_auiSelectors[PIXELS];
 
 		// state shared between iterations
-		ColorFloatRGBA	m_frgbaSourceAverageLeft;
-		ColorFloatRGBA	m_frgbaSourceAverageRight;
-		ColorFloatRGBA	m_frgbaSourceAverageTop;
-		ColorFloatRGBA	m_frgbaSourceAverageBottom;
-		bool			m_boolMostLikelyFlip;
+		BlockAnalysis	m_analysis;
 
 		// stats
 		float			m_fError1;	// error for Etc1 half 1
@@ -36,30 +36,6 @@ Block4x4Encoding_R11 is the encoder to use when targetting file format R11 and S
 namespace Etc
 {
 
-	// modifier values to use for R11, SR11, RG11 and SRG11
-	float Block4x4Encoding_R11::s_aafModifierTable[MODIFIER_TABLE_ENTRYS][SELECTORS]
-	{
-		{ -3.0f / 255.0f, -6.0f / 255.0f,  -9.0f / 255.0f, -15.0f / 255.0f, 2.0f / 255.0f, 5.0f / 255.0f, 8.0f / 255.0f, 14.0f / 255.0f },
-		{ -3.0f / 255.0f, -7.0f / 255.0f, -10.0f / 255.0f, -13.0f / 255.0f, 2.0f / 255.0f, 6.0f / 255.0f, 9.0f / 255.0f, 12.0f / 255.0f },
-		{ -2.0f / 255.0f, -5.0f / 255.0f,  -8.0f / 255.0f, -13.0f / 255.0f, 1.0f / 255.0f, 4.0f / 255.0f, 7.0f / 255.0f, 12.0f / 255.0f },
-		{ -2.0f / 255.0f, -4.0f / 255.0f,  -6.0f / 255.0f, -13.0f / 255.0f, 1.0f / 255.0f, 3.0f / 255.0f, 5.0f / 255.0f, 12.0f / 255.0f },
-
-		{ -3.0f / 255.0f, -6.0f / 255.0f,  -8.0f / 255.0f, -12.0f / 255.0f, 2.0f / 255.0f, 5.0f / 255.0f, 7.0f / 255.0f, 11.0f / 255.0f },
-		{ -3.0f / 255.0f, -7.0f / 255.0f,  -9.0f / 255.0f, -11.0f / 255.0f, 2.0f / 255.0f, 6.0f / 255.0f, 8.0f / 255.0f, 10.0f / 255.0f },
-		{ -4.0f / 255.0f, -7.0f / 255.0f,  -8.0f / 255.0f, -11.0f / 255.0f, 3.0f / 255.0f, 6.0f / 255.0f, 7.0f / 255.0f, 10.0f / 255.0f },
-		{ -3.0f / 255.0f, -5.0f / 255.0f,  -8.0f / 255.0f, -11.0f / 255.0f, 2.0f / 255.0f, 4.0f / 255.0f, 7.0f / 255.0f, 10.0f / 255.0f },
-
-		{ -2.0f / 255.0f, -6.0f / 255.0f,  -8.0f / 255.0f, -10.0f / 255.0f, 1.0f / 255.0f, 5.0f / 255.0f, 7.0f / 255.0f,  9.0f / 255.0f },
-		{ -2.0f / 255.0f, -5.0f / 255.0f,  -8.0f / 255.0f, -10.0f / 255.0f, 1.0f / 255.0f, 4.0f / 255.0f, 7.0f / 255.0f,  9.0f / 255.0f },
-		{ -2.0f / 255.0f, -4.0f / 255.0f,  -8.0f / 255.0f, -10.0f / 255.0f, 1.0f / 255.0f, 3.0f / 255.0f, 7.0f / 255.0f,  9.0f / 255.0f },
-		{ -2.0f / 255.0f, -5.0f / 255.0f,  -7.0f / 255.0f, -10.0f / 255.0f, 1.0f / 255.0f, 4.0f / 255.0f, 6.0f / 255.0f,  9.0f / 255.0f },
-
-		{ -3.0f / 255.0f, -4.0f / 255.0f,  -7.0f / 255.0f, -10.0f / 255.0f, 2.0f / 255.0f, 3.0f / 255.0f, 6.0f / 255.0f,  9.0f / 255.0f },
-		{ -1.0f / 255.0f, -2.0f / 255.0f,  -3.0f / 255.0f, -10.0f / 255.0f, 0.0f / 255.0f, 1.0f / 255.0f, 2.0f / 255.0f,  9.0f / 255.0f },
-		{ -4.0f / 255.0f, -6.0f / 255.0f,  -8.0f / 255.0f,  -9.0f / 255.0f, 3.0f / 255.0f, 5.0f / 255.0f, 7.0f / 255.0f,  8.0f / 255.0f },
-		{ -3.0f / 255.0f, -5.0f / 255.0f,  -7.0f / 255.0f,  -9.0f / 255.0f, 2.0f / 255.0f, 4.0f / 255.0f, 6.0f / 255.0f,  8.0f / 255.0f }
-	};
-
 	// ----------------------------------------------------------------------------------------------------
 	//
 	Block4x4Encoding_R11::Block4x4Encoding_R11(void)
@@ -158,7 +134,7 @@ namespace Etc
 				{
 					assert(0);
 				}
-				m_afrgbaDecodedColors[uiPixel] = ColorFloatRGBA(fDecodedPixelData, 0.0f, 0.0f, 1.0f);
+				m_pafrgbaDecodedColors[uiPixel] = ColorFloatRGBA(fDecodedPixelData, 0.0f, 0.0f, 1.0f);
 			}
 			CalcBlockError();
 		}
@@ -181,6 +157,13 @@ namespace Etc
 		case 0:
 			m_fError = FLT_MAX;
 			m_fRedBlockError = FLT_MAX;		// artificially high value
+			if (a_fEffort <= FAST_SEARCH_MAX_EFFORT)
+			{
+				CalculateR11Fast(a_encoding);
+				m_fError = m_fRedBlockError;
+				m_boolDone = true;
+				break;
+			}
 			CalculateR11(a_encoding, 8, 0.0f, 0.0f);
 			m_fError = m_fRedBlockError;
 			break;
@@ -188,19 +171,11 @@ namespace Etc
 		case 1:
 			CalculateR11(a_encoding, 8, 2.0f, 1.0f);
 			m_fError = m_fRedBlockError;
-			if (a_fEffort <= 24.5f)
-			{
-				m_boolDone = true;
-			}
 			break;
 
 		case 2:
 			CalculateR11(a_encoding, 8, 12.0f, 1.0f);
 			m_fError = m_fRedBlockError;
-			if (a_fEffort <= 49.5f)
-			{
-				m_boolDone = true;
-			}
 			break;
 
 		case 3:
@@ -228,6 +203,37 @@ namespace Etc
 		SetDoneIfPerfect();
 	}
 
+	// ----------------------------------------------------------------------------------------------------
+	// encode a block whose pixels all have the same red with the base, multiplier and modifier table entry
+	// looked up by EacSearch
+	//
+	bool Block4x4Encoding_R11::EncodeSolidColor(Image::Format const a_encoding)
+	{
+		if (!m_pblockParent->IsSolidColor() || !SolidColor::IsBestForMetric(m_errormetric))
+		{
+			return false;
+		}
+
+		EacSearch<EacChannel::R11> eacsearch(m_pafrgbaSource, m_errormetric);
+
+		EacSearch<EacChannel::R11>::Encoding encoding;
+		encoding.fError = FLT_MAX;		// artificially high value
+
+		if (!eacsearch.SearchSolid(&encoding))
+		{
+			return false;
+		}
+
+		m_mode = MODE_R11;
+		SetRedEncoding(a_encoding, encoding);
+		m_fError = m_fRedBlockError;
+
+		m_uiEncodingIterations = 1;
+		m_boolDone = true;
+
+		return true;
+	}
+
 	// ----------------------------------------------------------------------------------------------------
 	// find the best combination of base color, multiplier and selectors
 	//
@@ -238,158 +244,61 @@ namespace Etc
 	void Block4x4Encoding_R11::CalculateR11(Image::Format const a_format, unsigned int a_uiSelectorsUsed, 
 												float a_fBaseRadius, float a_fMultiplierRadius)
 	{
-		// maps from virtual (monotonic) selector to ETC selector
-		static const unsigned int auiVirtualSelectorMap[8] = {3, 2, 1, 0, 4, 5, 6, 7};
+		EacSearch<EacChannel::R11> eacsearch(m_pafrgbaSource, m_errormetric);
 
-		// find min/max red
-		float fMinRed = 1.0f;
-		float fMaxRed = 0.0f;
-		for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
-		{
-			// ignore border pixels
-			float fAlpha = m_pafrgbaSource[uiPixel].fA;
-			if (std::isnan(fAlpha))
-			{
-				continue;
-			}
-
-			float fRed = m_pafrgbaSource[uiPixel].fR;
+		EacSearch<EacChannel::R11>::Encoding encoding;
+		encoding.fError = m_fRedBlockError;
 
-			if (fRed < fMinRed)
-			{
-				fMinRed = fRed;
-			}
-			if (fRed > fMaxRed)
-			{
-				fMaxRed = fRed;
-			}
-		}
-		assert(fMinRed <= fMaxRed);
-
-		float fRedRange = (fMaxRed - fMinRed);
-
-		// try each modifier table entry							  
-		for (unsigned int uiTableEntry = 0; uiTableEntry < MODIFIER_TABLE_ENTRYS; uiTableEntry++)
+		if (eacsearch.Search(a_uiSelectorsUsed, a_fBaseRadius, a_fMultiplierRadius, &encoding))
 		{
-			for (unsigned int uiMinVirtualSelector = 0; 
-					uiMinVirtualSelector <= (8- a_uiSelectorsUsed); 
-					uiMinVirtualSelector++)
-			{
-				unsigned int uiMaxVirtualSelector = uiMinVirtualSelector + a_uiSelectorsUsed - 1;
-
-				unsigned int uiMinSelector = auiVirtualSelectorMap[uiMinVirtualSelector];
-				unsigned int uiMaxSelector = auiVirtualSelectorMap[uiMaxVirtualSelector];
-
-				float fTableEntryCenter = -s_aafModifierTable[uiTableEntry][uiMinSelector];
-
-				float fTableEntryRange = s_aafModifierTable[uiTableEntry][uiMaxSelector] -
-											s_aafModifierTable[uiTableEntry][uiMinSelector];
+			SetRedEncoding(a_format, encoding);
+		}
+	}
 
-				float fCenterRatio = fTableEntryCenter / fTableEntryRange;
+	// ----------------------------------------------------------------------------------------------------
+	// closed-form search for the red channel, used instead of CalculateR11() at low effort
+	//
+	void Block4x4Encoding_R11::CalculateR11Fast(Image::Format const a_format)
+	{
+		EacSearch<EacChannel::R11> eacsearch(m_pafrgbaSource, m_errormetric);
 
-				float fCenter = fMinRed + fCenterRatio*fRedRange;
-				fCenter = roundf(255.0f * fCenter) / 255.0f;
+		EacSearch<EacChannel::R11>::Encoding encoding;
+		encoding.fError = m_fRedBlockError;
 
-				float fMinBase = fCenter - (a_fBaseRadius / 255.0f);
-				if (fMinBase < 0.0f)
-				{
-					fMinBase = 0.0f;
-				}
+		if (eacsearch.SearchFast(&encoding))
+		{
+			SetRedEncoding(a_format, encoding);
+		}
+	}
 
-				float fMaxBase = fCenter + (a_fBaseRadius / 255.0f);
-				if (fMaxBase > 1.0f)
-				{
-					fMaxBase = 1.0f;
-				}
+	// ----------------------------------------------------------------------------------------------------
+	// replace the red encoding with a better one found by EacSearch
+	//
+	void Block4x4Encoding_R11::SetRedEncoding(Image::Format const a_format,
+												const EacSearch<EacChannel::R11>::Encoding &a_encoding)
+	{
+		m_fRedBlockError = a_encoding.fError;
 
-				for (float fBase = fMinBase; fBase <= fMaxBase; fBase += (0.999999f / 255.0f))
-				{
-					float fRangeMultiplier = roundf(fRedRange / fTableEntryRange);
-
-					float fMinMultiplier = fRangeMultiplier - a_fMultiplierRadius;
-					if (fMinMultiplier < 1.0f)
-					{
-						fMinMultiplier = 0.0f;
-					}
-					else if (fMinMultiplier > 15.0f)
-					{
-						fMinMultiplier = 15.0f;
-					}
-
-					float fMaxMultiplier = fRangeMultiplier + a_fMultiplierRadius;
-					if (fMaxMultiplier < 1.0f)
-					{
-						fMaxMultiplier = 1.0f;
-					}
-					else if (fMaxMultiplier > 15.0f)
-					{
-						fMaxMultiplier = 15.0f;
-					}
-
-					for (float fMultiplier = fMinMultiplier; fMultiplier <= fMaxMultiplier; fMultiplier += 1.0f)
-					{
-						// find best selector for each pixel
-						unsigned int auiBestSelectors[PIXELS];
-						float afBestRedError[PIXELS];
-						float afBestPixelRed[PIXELS];
-
-						for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
-						{
-							float fBestPixelRedError = FLT_MAX;
-
-							for (unsigned int uiSelector = 0; uiSelector < SELECTORS; uiSelector++)
-							{
-								float fPixelRed = DecodePixelRed(fBase * 255.0f, fMultiplier, uiTableEntry, uiSelector);
-
-								ColorFloatRGBA frgba(fPixelRed, m_pafrgbaSource[uiPixel].fG,0.0f,1.0f);
-
-								float fPixelRedError = CalcPixelError(frgba, 1.0f, m_pafrgbaSource[uiPixel]);
-
-								if (fPixelRedError < fBestPixelRedError)
-								{
-									fBestPixelRedError = fPixelRedError;
-									auiBestSelectors[uiPixel] = uiSelector;
-									afBestRedError[uiPixel] = fBestPixelRedError;
-									afBestPixelRed[uiPixel] = fPixelRed;
-								}
-							}
-						}
-						float fBlockError = 0.0f;  
-						for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
-						{
-							fBlockError += afBestRedError[uiPixel];
-						}
-						if (fBlockError < m_fRedBlockError)
-						{
-							m_fRedBlockError = fBlockError;
-
-							if (a_format == Image::Format::R11 || a_format == Image::Format::RG11)
-							{
-								m_fRedBase = 255.0f * fBase;
-							}
-							else if (a_format == Image::Format::SIGNED_R11 || a_format == Image::Format::SIGNED_RG11)
-							{
-								m_fRedBase = (fBase * 255) - 128;
-							}
-							else
-							{
-								assert(0);
-							}
-							m_fRedMultiplier = fMultiplier;
-							m_uiRedModifierTableIndex = uiTableEntry;
-
-							for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
-							{
-								m_auiRedSelectors[uiPixel] = auiBestSelectors[uiPixel];
-								float fBestPixelRed = afBestPixelRed[uiPixel];
-								m_afrgbaDecodedColors[uiPixel] = ColorFloatRGBA(fBestPixelRed, 0.0f, 0.0f, 1.0f);
-								m_afDecodedAlphas[uiPixel] = 1.0f;
-							}
-						}
-					}
-				}
+		if (a_format == Image::Format::R11 || a_format == Image::Format::RG11)
+		{
+			m_fRedBase = 255.0f * a_encoding.fBase;
+		}
+		else if (a_format == Image::Format::SIGNED_R11 || a_format == Image::Format::SIGNED_RG11)
+		{
+			m_fRedBase = (a_encoding.fBase * 255) - 128;
+		}
+		else
+		{
+			assert(0);
+		}
+		m_fRedMultiplier = a_encoding.fMultiplier;
+		m_uiRedModifierTableIndex = a_encoding.uiTableEntry;
 
-			}
+		for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
+		{
+			m_auiRedSelectors[uiPixel] = a_encoding.auiSelectors[uiPixel];
+			m_pafrgbaDecodedColors[uiPixel] = ColorFloatRGBA(a_encoding.afDecodedValues[uiPixel], 0.0f, 0.0f, 1.0f);
+			m_afDecodedAlphas[uiPixel] = 1.0f;
 		}
 	}
 
@@ -17,6 +17,7 @@
 #pragma once
 
 #include "EtcBlock4x4Encoding_RGB8.h"
+#include "EtcEacSearch.h"
 
 namespace Etc
 {
@@ -47,6 +48,8 @@ namespace Etc
 
 		virtual void PerformIteration(Image::Format a_encoding, ErrorMetric a_errormetric, float a_fEffort) override;
 
+		virtual bool EncodeSolidColor(Image::Format a_encoding) override;
+
 		virtual void SetEncodingBits(Image::Format a_encoding) override;
 
 		inline float GetRedBase(void) const
@@ -71,18 +74,19 @@ namespace Etc
 
 	protected:
 
-		static const unsigned int MODIFIER_TABLE_ENTRYS = 16;
 		static const unsigned int SELECTOR_BITS = 3;
 		static const unsigned int SELECTORS = 1 << SELECTOR_BITS;
 
-		static float s_aafModifierTable[MODIFIER_TABLE_ENTRYS][SELECTORS];
+		// at or below this effort, the closed-form search replaces the exhaustive search
+		static constexpr float FAST_SEARCH_MAX_EFFORT = 49.5f;
 
 		void CalculateR11(Image::Format a_format, unsigned int a_uiSelectorsUsed, 
 							float a_fBaseRadius, float a_fMultiplierRadius);
 
-		
+		void CalculateR11Fast(Image::Format a_format);
+
+		void SetRedEncoding(Image::Format a_format, const EacSearch<EacChannel::R11>::Encoding &a_encoding);
 
-	
 		inline float DecodePixelRed(float a_fBase, float a_fMultiplier,
 			unsigned int a_uiTableIndex, unsigned int a_uiSelector)
 		{
@@ -93,7 +97,7 @@ namespace Etc
 			}
 
 			float fPixelRed = a_fBase * 8 + 4 +
-				8 * fMultiplier*s_aafModifierTable[a_uiTableIndex][a_uiSelector]*255;
+				8 * fMultiplier*EacModifierTable::s_aafModifiers[a_uiTableIndex][a_uiSelector]*255;
 			fPixelRed /= 2047.0f;
 
 			if (fPixelRed < 0.0f)
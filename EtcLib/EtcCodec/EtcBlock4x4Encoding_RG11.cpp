@@ -144,7 +144,7 @@ namespace Etc
 				{
 					assert(0);
 				}
-				m_afrgbaDecodedColors[uiPixel] = ColorFloatRGBA(fRedDecodedData, fGrnDecodedData, 0.0f, 1.0f);
+				m_pafrgbaDecodedColors[uiPixel] = ColorFloatRGBA(fRedDecodedData, fGrnDecodedData, 0.0f, 1.0f);
 			}
 
 		}
@@ -168,6 +168,14 @@ namespace Etc
 			m_fError = FLT_MAX;
 			m_fGrnBlockError = FLT_MAX;		// artificially high value
 			m_fRedBlockError = FLT_MAX;
+			if (a_fEffort <= FAST_SEARCH_MAX_EFFORT)
+			{
+				CalculateR11Fast(a_encoding);
+				CalculateG11Fast(a_encoding);
+				m_fError = (m_fGrnBlockError + m_fRedBlockError);
+				m_boolDone = true;
+				break;
+			}
 			CalculateR11(a_encoding, 8, 0.0f, 0.0f);
 			CalculateG11(a_encoding, 8, 0.0f, 0.0f);
 			m_fError = (m_fGrnBlockError + m_fRedBlockError);
@@ -177,20 +185,12 @@ namespace Etc
 			CalculateR11(a_encoding, 8, 2.0f, 1.0f);
 			CalculateG11(a_encoding, 8, 2.0f, 1.0f);
 			m_fError = (m_fGrnBlockError + m_fRedBlockError);
-			if (a_fEffort <= 24.5f)
-			{
-				m_boolDone = true;
-			}
 			break;
 
 		case 2:
 			CalculateR11(a_encoding, 8, 12.0f, 1.0f);
 			CalculateG11(a_encoding, 8, 12.0f, 1.0f);
 			m_fError = (m_fGrnBlockError + m_fRedBlockError);
-			if (a_fEffort <= 49.5f)
-			{
-				m_boolDone = true;
-			}
 			break;
 
 		case 3:
@@ -221,6 +221,41 @@ namespace Etc
 		SetDoneIfPerfect();
 	}
 
+	// ----------------------------------------------------------------------------------------------------
+	// encode a block whose pixels all have the same red and green with the bases, multipliers and modifier
+	// table entries looked up by EacSearch
+	//
+	bool Block4x4Encoding_RG11::EncodeSolidColor(Image::Format const a_encoding)
+	{
+		if (!m_pblockParent->IsSolidColor() || !SolidColor::IsBestForMetric(m_errormetric))
+		{
+			return false;
+		}
+
+		EacSearch<EacChannel::R11> eacsearchR(m_pafrgbaSource, m_errormetric);
+		EacSearch<EacChannel::G11> eacsearchG(m_pafrgbaSource, m_errormetric);
+
+		EacSearch<EacChannel::R11>::Encoding encodingR;
+		encodingR.fError = FLT_MAX;		// artificially high value
+		EacSearch<EacChannel::G11>::Encoding encodingG;
+		encodingG.fError = FLT_MAX;
+
+		if (!eacsearchR.SearchSolid(&encodingR) || !eacsearchG.SearchSolid(&encodingG))
+		{
+			return false;
+		}
+
+		m_mode = MODE_RG11;
+		SetRedEncoding(a_encoding, encodingR);
+		SetGrnEncoding(a_encoding, encodingG);
+		m_fError = (m_fGrnBlockError + m_fRedBlockError);
+
+		m_uiEncodingIterations = 1;
+		m_boolDone = true;
+
+		return true;
+	}
+
 	// ----------------------------------------------------------------------------------------------------
 	// find the best combination of base color, multiplier and selectors
 	//
@@ -232,158 +267,60 @@ namespace Etc
 		unsigned int a_uiSelectorsUsed,
 		float a_fBaseRadius, float a_fMultiplierRadius)
 	{
-		// maps from virtual (monotonic) selector to etc selector
-		static const unsigned int auiVirtualSelectorMap[8] = { 3, 2, 1, 0, 4, 5, 6, 7 };
+		EacSearch<EacChannel::G11> eacsearch(m_pafrgbaSource, m_errormetric);
 
-		// find min/max Grn
-		float fMinGrn = 1.0f;
-		float fMaxGrn = 0.0f;
-		for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
-		{
-			// ignore border pixels
-			float fAlpha = m_pafrgbaSource[uiPixel].fA;
-			if (std::isnan(fAlpha))
-			{
-				continue;
-			}
-
-			float fGrn = m_pafrgbaSource[uiPixel].fG;
-
-			if (fGrn < fMinGrn)
-			{
-				fMinGrn = fGrn;
-			}
-			if (fGrn > fMaxGrn)
-			{
-				fMaxGrn = fGrn;
-			}
-		}
-		assert(fMinGrn <= fMaxGrn);
+		EacSearch<EacChannel::G11>::Encoding encoding;
+		encoding.fError = m_fGrnBlockError;
 
-		float fGrnRange = (fMaxGrn - fMinGrn);
-
-		// try each modifier table entry							  
-		for (unsigned int uiTableEntry = 0; uiTableEntry < MODIFIER_TABLE_ENTRYS; uiTableEntry++)
+		if (eacsearch.Search(a_uiSelectorsUsed, a_fBaseRadius, a_fMultiplierRadius, &encoding))
 		{
-			for (unsigned int uiMinVirtualSelector = 0;
-			uiMinVirtualSelector <= (8 - a_uiSelectorsUsed);
-				uiMinVirtualSelector++)
-			{
-				unsigned int uiMaxVirtualSelector = uiMinVirtualSelector + a_uiSelectorsUsed - 1;
-
-				unsigned int uiMinSelector = auiVirtualSelectorMap[uiMinVirtualSelector];
-				unsigned int uiMaxSelector = auiVirtualSelectorMap[uiMaxVirtualSelector];
-
-				float fTableEntryCenter = -s_aafModifierTable[uiTableEntry][uiMinSelector];
-
-				float fTableEntryRange = s_aafModifierTable[uiTableEntry][uiMaxSelector] -
-					s_aafModifierTable[uiTableEntry][uiMinSelector];
-
-				float fCenterRatio = fTableEntryCenter / fTableEntryRange;
+			SetGrnEncoding(a_format, encoding);
+		}
+	}
 
-				float fCenter = fMinGrn + fCenterRatio*fGrnRange;
-				fCenter = roundf(255.0f * fCenter) / 255.0f;
+	// ----------------------------------------------------------------------------------------------------
+	// closed-form search for the green channel, used instead of CalculateG11() at low effort
+	//
+	void Block4x4Encoding_RG11::CalculateG11Fast(Image::Format const a_format)
+	{
+		EacSearch<EacChannel::G11> eacsearch(m_pafrgbaSource, m_errormetric);
 
-				float fMinBase = fCenter - (a_fBaseRadius / 255.0f);
-				if (fMinBase < 0.0f)
-				{
-					fMinBase = 0.0f;
-				}
+		EacSearch<EacChannel::G11>::Encoding encoding;
+		encoding.fError = m_fGrnBlockError;
 
-				float fMaxBase = fCenter + (a_fBaseRadius / 255.0f);
-				if (fMaxBase > 1.0f)
-				{
-					fMaxBase = 1.0f;
-				}
+		if (eacsearch.SearchFast(&encoding))
+		{
+			SetGrnEncoding(a_format, encoding);
+		}
+	}
 
-				for (float fBase = fMinBase; fBase <= fMaxBase; fBase += (0.999999f / 255.0f))
-				{
-					float fRangeMultiplier = roundf(fGrnRange / fTableEntryRange);
-
-					float fMinMultiplier = fRangeMultiplier - a_fMultiplierRadius;
-					if (fMinMultiplier < 1.0f)
-					{
-						fMinMultiplier = 0.0f;
-					}
-					else if (fMinMultiplier > 15.0f)
-					{
-						fMinMultiplier = 15.0f;
-					}
-
-					float fMaxMultiplier = fRangeMultiplier + a_fMultiplierRadius;
-					if (fMaxMultiplier < 1.0f)
-					{
-						fMaxMultiplier = 1.0f;
-					}
-					else if (fMaxMultiplier > 15.0f)
-					{
-						fMaxMultiplier = 15.0f;
-					}
-
-					for (float fMultiplier = fMinMultiplier; fMultiplier <= fMaxMultiplier; fMultiplier += 1.0f)
-					{
-						// find best selector for each pixel
-						unsigned int auiBestSelectors[PIXELS];
-						float afBestGrnError[PIXELS];
-						float afBestPixelGrn[PIXELS];
-
-						for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
-						{
-							float fBestPixelGrnError = FLT_MAX;
-
-							for (unsigned int uiSelector = 0; uiSelector < SELECTORS; uiSelector++)
-							{
-								//DecodePixelRed is not red channel specific
-								float fPixelGrn = DecodePixelRed(fBase * 255.0f, fMultiplier, uiTableEntry, uiSelector);
-								
-								ColorFloatRGBA frgba(m_pafrgbaSource[uiPixel].fR, fPixelGrn, 0.0f, 1.0f);
-									
-								float fPixelGrnError = CalcPixelError(frgba, 1.0f, m_pafrgbaSource[uiPixel]);
-
-								if (fPixelGrnError < fBestPixelGrnError)
-								{
-									fBestPixelGrnError = fPixelGrnError;
-									auiBestSelectors[uiPixel] = uiSelector;
-									afBestGrnError[uiPixel] = fBestPixelGrnError;
-									afBestPixelGrn[uiPixel] = fPixelGrn;
-								}
-							}
-						}
-						float fBlockError = 0.0f;
-						for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
-						{
-							fBlockError += afBestGrnError[uiPixel];
-						}
-
-						if (fBlockError < m_fGrnBlockError)
-						{
-							m_fGrnBlockError = fBlockError;
-
-							if (a_format == Image::Format::RG11)
-							{
-								m_fGrnBase = 255.0f * fBase;
-							}
-							else if (a_format == Image::Format::SIGNED_RG11)
-							{
-								m_fGrnBase = (fBase * 255) - 128;
-							}
-							else
-							{
-								assert(0);
-							}
-							m_fGrnMultiplier = fMultiplier;
-							m_uiGrnModifierTableIndex = uiTableEntry;
-							for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
-							{
-								m_auiGrnSelectors[uiPixel] = auiBestSelectors[uiPixel];
-								m_afrgbaDecodedColors[uiPixel].fG = afBestPixelGrn[uiPixel];
-								m_afDecodedAlphas[uiPixel] = 1.0f;
-							}
-						}
-					}
-				}
+	// ----------------------------------------------------------------------------------------------------
+	// replace the green encoding with a better one found by EacSearch
+	//
+	void Block4x4Encoding_RG11::SetGrnEncoding(Image::Format const a_format,
+												const EacSearch<EacChannel::G11>::Encoding &a_encoding)
+	{
+		m_fGrnBlockError = a_encoding.fError;
 
-			}
+		if (a_format == Image::Format::RG11)
+		{
+			m_fGrnBase = 255.0f * a_encoding.fBase;
+		}
+		else if (a_format == Image::Format::SIGNED_RG11)
+		{
+			m_fGrnBase = (a_encoding.fBase * 255) - 128;
+		}
+		else
+		{
+			assert(0);
+		}
+		m_fGrnMultiplier = a_encoding.fMultiplier;
+		m_uiGrnModifierTableIndex = a_encoding.uiTableEntry;
+		for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
+		{
+			m_auiGrnSelectors[uiPixel] = a_encoding.auiSelectors[uiPixel];
+			m_pafrgbaDecodedColors[uiPixel].fG = a_encoding.afDecodedValues[uiPixel];
+			m_afDecodedAlphas[uiPixel] = 1.0f;
 		}
 	}
 	
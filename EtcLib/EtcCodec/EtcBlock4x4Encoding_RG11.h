@@ -54,12 +54,18 @@ namespace Etc
 
 		virtual void PerformIteration(Image::Format a_encoding, ErrorMetric a_errormetric, float a_fEffort) override;
 
+		virtual bool EncodeSolidColor(Image::Format a_encoding) override;
+
 		virtual void SetEncodingBits(Image::Format a_encoding) override;
 
 		Block4x4EncodingBits_RG11 *m_pencodingbitsRG11;
 
 		void CalculateG11(Image::Format a_format, unsigned int a_uiSelectorsUsed, float a_fBaseRadius, float a_fMultiplierRadius);
 
+		void CalculateG11Fast(Image::Format a_format);
+
+		void SetGrnEncoding(Image::Format a_format, const EacSearch<EacChannel::G11>::Encoding &a_encoding);
+
 		inline float GetGrnBase(void) const
 		{
 			return m_fGrnBase;
@@ -29,6 +29,7 @@ Block4x4Encoding_ETC1 encodes the ETC1 subset of RGB8.
 
 #include "EtcBlock4x4EncodingBits.h"
 #include "EtcBlock4x4.h"
+#include "EtcBlockError.h"
 #include "EtcMath.h"
 
 #include <cstdio>
@@ -250,19 +251,19 @@ namespace Etc
 			break;
 
 		case 1:
-			Block4x4Encoding_ETC1::TryDifferential(m_boolMostLikelyFlip, 1, 0, 0);
+			Block4x4Encoding_ETC1::TryDifferential(m_analysis.boolMostLikelyFlip, 1, 0, 0);
 			break;
 
 		case 2:
-			Block4x4Encoding_ETC1::TryIndividual(m_boolMostLikelyFlip, 1);
+			Block4x4Encoding_ETC1::TryIndividual(m_analysis.boolMostLikelyFlip, 1);
 			break;
 
 		case 3:
-			Block4x4Encoding_ETC1::TryDifferential(!m_boolMostLikelyFlip, 1, 0, 0);
+			Block4x4Encoding_ETC1::TryDifferential(!m_analysis.boolMostLikelyFlip, 1, 0, 0);
 			break;
 
 		case 4:
-			Block4x4Encoding_ETC1::TryIndividual(!m_boolMostLikelyFlip, 1);
+			Block4x4Encoding_ETC1::TryIndividual(!m_analysis.boolMostLikelyFlip, 1);
 			break;
 
 		case 5:
@@ -320,49 +321,146 @@ namespace Etc
 		SetDoneIfPerfect();
 	}
 
+	// ----------------------------------------------------------------------------------------------------
+	// encode a solid color block with the best ETC1, planar or T encoding of its color
+	// H mode can't do better than T mode for a single color
+	//
+	bool Block4x4Encoding_RGB8::EncodeSolidColor(Image::Format)
+	{
+		SolidColor::Encoding encoding;
+		if (!FindSolidColor(SolidColor::ETC2_MODES, &encoding))
+		{
+			return false;
+		}
+
+		SetSolidColor_ETC2(encoding);
+		CalcBlockError();
+
+		m_uiEncodingIterations = 1;
+		m_boolDone = true;
+
+		return true;
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// set the encoding state to an ETC1, planar or T solid color encoding
+	// the decoded alphas are left to the caller
+	//
+	void Block4x4Encoding_RGB8::SetSolidColor_ETC2(const SolidColor::Encoding &a_encoding)
+	{
+		unsigned char ucRed = (unsigned char)a_encoding.auiBase[0];
+		unsigned char ucGreen = (unsigned char)a_encoding.auiBase[1];
+		unsigned char ucBlue = (unsigned char)a_encoding.auiBase[2];
+
+		switch (a_encoding.mode)
+		{
+		case MODE_ETC1:
+			SetSolidColor_ETC1(a_encoding);
+			break;
+
+		case MODE_PLANAR:
+			m_mode = MODE_PLANAR;
+			m_boolDiff = true;
+			m_boolFlip = false;
+			m_frgbaColor1 = ColorFloatRGBA::ConvertFromR6G7B6(ucRed, ucGreen, ucBlue);
+			m_frgbaColor2 = ColorFloatRGBA::ConvertFromR6G7B6((unsigned char)a_encoding.auiHorizontal[0],
+																(unsigned char)a_encoding.auiHorizontal[1],
+																(unsigned char)a_encoding.auiHorizontal[2]);
+			m_frgbaColor3 = ColorFloatRGBA::ConvertFromR6G7B6((unsigned char)a_encoding.auiVertical[0],
+																(unsigned char)a_encoding.auiVertical[1],
+																(unsigned char)a_encoding.auiVertical[2]);
+			DecodePixels_Planar();
+			break;
+
+		case MODE_T:
+			// selector 0 decodes color 1 and the other selectors decode from color 2, so both get the color
+			m_mode = MODE_T;
+			m_boolDiff = true;
+			m_boolFlip = false;
+			m_frgbaColor1 = ColorFloatRGBA::ConvertFromRGB4(ucRed, ucGreen, ucBlue);
+			m_frgbaColor2 = m_frgbaColor1;
+			m_uiCW1 = a_encoding.uiCW;
+			for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
+			{
+				m_auiSelectors[uiPixel] = a_encoding.uiSelector;
+			}
+			DecodePixels_T();
+			break;
+
+		default:
+			assert(0);
+			break;
+		}
+	}
+
 	// ----------------------------------------------------------------------------------------------------
 	// try encoding in Planar mode
 	// save this encoding if it improves the error
 	//
 	void Block4x4Encoding_RGB8::TryPlanar(unsigned int a_uiRadius)
 	{
-		Block4x4Encoding_RGB8 encodingTry = *this;
+		Candidate candidate;
+		candidate.mode = MODE_PLANAR;
 
-		// init "try"
+		if (!m_analysis.boolPlanarCornerColors)
 		{
-			encodingTry.m_mode = MODE_PLANAR;
-			encodingTry.m_boolDiff = true;
-			encodingTry.m_boolFlip = false;
+			CalculatePlanarCornerColors();
 		}
+		candidate.frgbaColor1 = m_analysis.afrgbaPlanarCornerColors[0];
+		candidate.frgbaColor2 = m_analysis.afrgbaPlanarCornerColors[1];
+		candidate.frgbaColor3 = m_analysis.afrgbaPlanarCornerColors[2];
 
-		encodingTry.CalculatePlanarCornerColors();
+		DecodePixels_Planar(candidate.frgbaColor1, candidate.frgbaColor2, candidate.frgbaColor3,
+							candidate.afrgbaDecodedColors);
 
-		encodingTry.DecodePixels_Planar();
-
-		encodingTry.CalcBlockError();
+		candidate.fError = CalcBlockError(candidate.afrgbaDecodedColors);
 
 		if (a_uiRadius > 0)
 		{
-			encodingTry.TwiddlePlanar();
+			TwiddlePlanar(&candidate);
 		}
 
-		if (encodingTry.m_fError < m_fError)
+		if (candidate.fError < m_fError)
 		{
-			m_mode = MODE_PLANAR;
-			m_boolDiff = true;
-			m_boolFlip = false;
-			m_frgbaColor1 = encodingTry.m_frgbaColor1;
-			m_frgbaColor2 = encodingTry.m_frgbaColor2;
-			m_frgbaColor3 = encodingTry.m_frgbaColor3;
+			CommitCandidate(candidate);
+		}
+
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// replace the encoding with a T, H or planar candidate
+	// planar candidates leave the selectors and CW1 untouched
+	//
+	void Block4x4Encoding_RGB8::CommitCandidate(const Candidate &a_candidate)
+	{
+		assert(a_candidate.mode == MODE_T || a_candidate.mode == MODE_H || a_candidate.mode == MODE_PLANAR);
+
+		m_mode = a_candidate.mode;
+		m_boolDiff = true;
+		m_boolFlip = false;
+		m_frgbaColor1 = a_candidate.frgbaColor1;
+		m_frgbaColor2 = a_candidate.frgbaColor2;
+
+		if (a_candidate.mode == MODE_PLANAR)
+		{
+			m_frgbaColor3 = a_candidate.frgbaColor3;
+		}
+		else
+		{
+			m_uiCW1 = a_candidate.uiCW1;
 
 			for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
 			{
-				m_afrgbaDecodedColors[uiPixel] = encodingTry.m_afrgbaDecodedColors[uiPixel];
+				m_auiSelectors[uiPixel] = a_candidate.auiSelectors[uiPixel];
 			}
+		}
 
-			m_fError = encodingTry.m_fError;
+		for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
+		{
+			m_pafrgbaDecodedColors[uiPixel] = a_candidate.afrgbaDecodedColors[uiPixel];
 		}
 
+		m_fError = a_candidate.fError;
 	}
 
 	// ----------------------------------------------------------------------------------------------------
@@ -382,14 +480,20 @@ namespace Etc
 
 	// ----------------------------------------------------------------------------------------------------
 	// calculate original values for base colors
-	// store them in m_frgbaOriginalColor1 and m_frgbaOriginalColor2
+	// store them in m_analysis.frgbaTAndHColor1 and m_analysis.frgbaTAndHColor2
+	// they only depend on the source, so they are calculated once
 	//
 	void Block4x4Encoding_RGB8::CalculateBaseColorsForTAndH(ErrorMetric const a_errormetric)
 	{
+		if (m_analysis.boolTAndHBaseColors)
+		{
+			return;
+		}
+		m_analysis.boolTAndHBaseColors = true;
 
 		bool boolRGBX = a_errormetric == ErrorMetric::RGBX;
 
-		ColorFloatRGBA frgbaBlockAverage = (m_frgbaSourceAverageLeft + m_frgbaSourceAverageRight) * 0.5f;
+		ColorFloatRGBA frgbaBlockAverage = (m_analysis.frgbaAverageLeft + m_analysis.frgbaAverageRight) * 0.5f;
 
 		// find pixel farthest from average gray line
 		unsigned int uiFarthestPixel = 0;
@@ -420,8 +524,8 @@ namespace Etc
 		//		half way to the farthest pixel and
 		//		the mirror color on the other side of the average
 		ColorFloatRGBA frgbaOffset = (m_pafrgbaSource[uiFarthestPixel] - frgbaBlockAverage) * 0.5f;
-		m_frgbaOriginalColor1_TAndH = (frgbaBlockAverage + frgbaOffset).QuantizeR4G4B4();
-		m_frgbaOriginalColor2_TAndH = (frgbaBlockAverage - frgbaOffset).ClampRGB().QuantizeR4G4B4();	// the "other side" might be out of range
+		m_analysis.frgbaTAndHColor1 = (frgbaBlockAverage + frgbaOffset).QuantizeR4G4B4();
+		m_analysis.frgbaTAndHColor2 = (frgbaBlockAverage - frgbaOffset).ClampRGB().QuantizeR4G4B4();	// the "other side" might be out of range
 
 		// move base colors to find best fit
 		for (unsigned int uiIteration = 0; uiIteration < 10; uiIteration++)
@@ -439,8 +543,8 @@ namespace Etc
 					continue;
 				}
 
-				float fGrayDistance2ToColor1 = CalcGrayDistance2(m_pafrgbaSource[uiPixel], m_frgbaOriginalColor1_TAndH);
-				float fGrayDistance2ToColor2 = CalcGrayDistance2(m_pafrgbaSource[uiPixel], m_frgbaOriginalColor2_TAndH);
+				float fGrayDistance2ToColor1 = CalcGrayDistance2(m_pafrgbaSource[uiPixel], m_analysis.frgbaTAndHColor1);
+				float fGrayDistance2ToColor2 = CalcGrayDistance2(m_pafrgbaSource[uiPixel], m_analysis.frgbaTAndHColor2);
 
 				ColorFloatRGBA frgbaAlphaWeightedSource = m_pafrgbaSource[uiPixel] * m_pafrgbaSource[uiPixel].fA;
 					
@@ -463,18 +567,18 @@ namespace Etc
 			ColorFloatRGBA frgbAvgColor1Pixels = (frgbSumPixelsCloserToColor1 * (1.0f / fPixelsCloserToColor1)).QuantizeR4G4B4();
 			ColorFloatRGBA frgbAvgColor2Pixels = (frgbSumPixelsCloserToColor2 * (1.0f / fPixelsCloserToColor2)).QuantizeR4G4B4();
 
-			if (frgbAvgColor1Pixels.fR == m_frgbaOriginalColor1_TAndH.fR &&
-				frgbAvgColor1Pixels.fG == m_frgbaOriginalColor1_TAndH.fG &&
-				frgbAvgColor1Pixels.fB == m_frgbaOriginalColor1_TAndH.fB &&
-				frgbAvgColor2Pixels.fR == m_frgbaOriginalColor2_TAndH.fR &&
-				frgbAvgColor2Pixels.fG == m_frgbaOriginalColor2_TAndH.fG &&
-				frgbAvgColor2Pixels.fB == m_frgbaOriginalColor2_TAndH.fB)
+			if (frgbAvgColor1Pixels.fR == m_analysis.frgbaTAndHColor1.fR &&
+				frgbAvgColor1Pixels.fG == m_analysis.frgbaTAndHColor1.fG &&
+				frgbAvgColor1Pixels.fB == m_analysis.frgbaTAndHColor1.fB &&
+				frgbAvgColor2Pixels.fR == m_analysis.frgbaTAndHColor2.fR &&
+				frgbAvgColor2Pixels.fG == m_analysis.frgbaTAndHColor2.fG &&
+				frgbAvgColor2Pixels.fB == m_analysis.frgbaTAndHColor2.fB)
 			{
 				break;
 			}
 
-			m_frgbaOriginalColor1_TAndH = frgbAvgColor1Pixels;
-			m_frgbaOriginalColor2_TAndH = frgbAvgColor2Pixels;
+			m_analysis.frgbaTAndHColor1 = frgbAvgColor1Pixels;
+			m_analysis.frgbaTAndHColor2 = frgbAvgColor2Pixels;
 		}
 
 	}
@@ -488,19 +592,13 @@ namespace Etc
 	//
 	void Block4x4Encoding_RGB8::TryT(unsigned int a_uiRadius)
 	{
-		Block4x4Encoding_RGB8 encodingTry = *this;
+		Candidate candidate;
+		candidate.mode = MODE_T;
+		candidate.fError = FLT_MAX;
 
-		// init "try"
-		{
-			encodingTry.m_mode = MODE_T;
-			encodingTry.m_boolDiff = true;
-			encodingTry.m_boolFlip = false;
-			encodingTry.m_fError = FLT_MAX;
-		}
-
-		int iColor1Red = m_frgbaOriginalColor1_TAndH.IntRed(15.0f);
-		int iColor1Green = m_frgbaOriginalColor1_TAndH.IntGreen(15.0f);
-		int iColor1Blue = m_frgbaOriginalColor1_TAndH.IntBlue(15.0f);
+		int iColor1Red = m_analysis.frgbaTAndHColor1.IntRed(15.0f);
+		int iColor1Green = m_analysis.frgbaTAndHColor1.IntGreen(15.0f);
+		int iColor1Blue = m_analysis.frgbaTAndHColor1.IntBlue(15.0f);
 
 		int iMinRed1 = iColor1Red - (int)a_uiRadius;
 		if (iMinRed1 < 0)
@@ -535,9 +633,9 @@ namespace Etc
 			iMinBlue1 = 15;
 		}
 
-		int iColor2Red = m_frgbaOriginalColor2_TAndH.IntRed(15.0f);
-		int iColor2Green = m_frgbaOriginalColor2_TAndH.IntGreen(15.0f);
-		int iColor2Blue = m_frgbaOriginalColor2_TAndH.IntBlue(15.0f);
+		int iColor2Red = m_analysis.frgbaTAndHColor2.IntRed(15.0f);
+		int iColor2Green = m_analysis.frgbaTAndHColor2.IntGreen(15.0f);
+		int iColor2Blue = m_analysis.frgbaTAndHColor2.IntBlue(15.0f);
 
 		int iMinRed2 = iColor2Red - (int)a_uiRadius;
 		if (iMinRed2 < 0)
@@ -574,9 +672,9 @@ namespace Etc
 
 		for (unsigned int uiDistance = 0; uiDistance < TH_DISTANCES; uiDistance++)
 		{
-			encodingTry.m_uiCW1 = uiDistance;
+			candidate.uiCW1 = uiDistance;
 
-			// twiddle m_frgbaOriginalColor2_TAndH
+			// twiddle m_analysis.frgbaTAndHColor2
 			// twiddle color2 first, since it affects 3 selectors, while color1 only affects one selector
 			//
 			for (int iRed2 = iMinRed2; iRed2 <= iMaxRed2; iRed2++)
@@ -589,41 +687,27 @@ namespace Etc
 						{
 							if (uiBaseColorSwaps == 0)
 							{
-								encodingTry.m_frgbaColor1 = m_frgbaOriginalColor1_TAndH;
-								encodingTry.m_frgbaColor2 = ColorFloatRGBA::ConvertFromRGB4((unsigned char)iRed2, (unsigned char)iGreen2, (unsigned char)iBlue2);
+								candidate.frgbaColor1 = m_analysis.frgbaTAndHColor1;
+								candidate.frgbaColor2 = ColorFloatRGBA::ConvertFromRGB4((unsigned char)iRed2, (unsigned char)iGreen2, (unsigned char)iBlue2);
 							}
 							else
 							{
-								encodingTry.m_frgbaColor1 = ColorFloatRGBA::ConvertFromRGB4((unsigned char)iRed2, (unsigned char)iGreen2, (unsigned char)iBlue2);
-								encodingTry.m_frgbaColor2 = m_frgbaOriginalColor1_TAndH;
+								candidate.frgbaColor1 = ColorFloatRGBA::ConvertFromRGB4((unsigned char)iRed2, (unsigned char)iGreen2, (unsigned char)iBlue2);
+								candidate.frgbaColor2 = m_analysis.frgbaTAndHColor1;
 							}
 
-							encodingTry.TryT_BestSelectorCombination();
+							TryT_BestSelectorCombination(&candidate);
 
-							if (encodingTry.m_fError < m_fError)
+							if (candidate.fError < m_fError)
 							{
-								m_mode = encodingTry.m_mode;
-								m_boolDiff = encodingTry.m_boolDiff;
-								m_boolFlip = encodingTry.m_boolFlip;
-
-								m_frgbaColor1 = encodingTry.m_frgbaColor1;
-								m_frgbaColor2 = encodingTry.m_frgbaColor2;
-								m_uiCW1 = encodingTry.m_uiCW1;
-
-								for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
-								{
-									m_auiSelectors[uiPixel] = encodingTry.m_auiSelectors[uiPixel];
-									m_afrgbaDecodedColors[uiPixel] = encodingTry.m_afrgbaDecodedColors[uiPixel];
-								}
-
-								m_fError = encodingTry.m_fError;
+								CommitCandidate(candidate);
 							}
 						}
 					}
 				}
 			}
 
-			// twiddle m_frgbaOriginalColor1_TAndH
+			// twiddle m_analysis.frgbaTAndHColor1
 			for (int iRed1 = iMinRed1; iRed1 <= iMaxRed1; iRed1++)
 			{
 				for (int iGreen1 = iMinGreen1; iGreen1 <= iMaxGreen1; iGreen1++)
@@ -634,34 +718,20 @@ namespace Etc
 						{
 							if (uiBaseColorSwaps == 0)
 							{
-								encodingTry.m_frgbaColor1 = ColorFloatRGBA::ConvertFromRGB4((unsigned char)iRed1, (unsigned char)iGreen1, (unsigned char)iBlue1);
-								encodingTry.m_frgbaColor2 = m_frgbaOriginalColor2_TAndH;
+								candidate.frgbaColor1 = ColorFloatRGBA::ConvertFromRGB4((unsigned char)iRed1, (unsigned char)iGreen1, (unsigned char)iBlue1);
+								candidate.frgbaColor2 = m_analysis.frgbaTAndHColor2;
 							}
 							else
 							{
-								encodingTry.m_frgbaColor1 = m_frgbaOriginalColor2_TAndH;
-								encodingTry.m_frgbaColor2 = ColorFloatRGBA::ConvertFromRGB4((unsigned char)iRed1, (unsigned char)iGreen1, (unsigned char)iBlue1);
+								candidate.frgbaColor1 = m_analysis.frgbaTAndHColor2;
+								candidate.frgbaColor2 = ColorFloatRGBA::ConvertFromRGB4((unsigned char)iRed1, (unsigned char)iGreen1, (unsigned char)iBlue1);
 							}
 
-							encodingTry.TryT_BestSelectorCombination();
+							TryT_BestSelectorCombination(&candidate);
 
-							if (encodingTry.m_fError < m_fError)
+							if (candidate.fError < m_fError)
 							{
-								m_mode = encodingTry.m_mode;
-								m_boolDiff = encodingTry.m_boolDiff;
-								m_boolFlip = encodingTry.m_boolFlip;
-
-								m_frgbaColor1 = encodingTry.m_frgbaColor1;
-								m_frgbaColor2 = encodingTry.m_frgbaColor2;
-								m_uiCW1 = encodingTry.m_uiCW1;
-
-								for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
-								{
-									m_auiSelectors[uiPixel] = encodingTry.m_auiSelectors[uiPixel];
-									m_afrgbaDecodedColors[uiPixel] = encodingTry.m_afrgbaDecodedColors[uiPixel];
-								}
-
-								m_fError = encodingTry.m_fError;
+								CommitCandidate(candidate);
 							}
 						}
 					}
@@ -674,59 +744,33 @@ namespace Etc
 
 	// ----------------------------------------------------------------------------------------------------
 	// find best selector combination for TryT
-	// called on an encodingTry
+	// keep the selectors and decoded colors in a_pcandidate if they improve its error
 	//
-	void Block4x4Encoding_RGB8::TryT_BestSelectorCombination(void)
+	void Block4x4Encoding_RGB8::TryT_BestSelectorCombination(Candidate *a_pcandidate)
 	{
 
-		float fDistance = s_afTHDistanceTable[m_uiCW1];
+		float fDistance = s_afTHDistanceTable[a_pcandidate->uiCW1];
 
-		unsigned int auiBestPixelSelectors[PIXELS];
-		float afBestPixelErrors[PIXELS] = { FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX,
-			FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX };
-		ColorFloatRGBA	afrgbaBestDecodedPixels[PIXELS];
 		ColorFloatRGBA afrgbaDecodedPixel[SELECTORS];
 		
 		static_assert(SELECTORS == 4, "");
-		afrgbaDecodedPixel[0] = m_frgbaColor1;
-		afrgbaDecodedPixel[1] = (m_frgbaColor2 + fDistance).ClampRGB();
-		afrgbaDecodedPixel[2] = m_frgbaColor2;
-		afrgbaDecodedPixel[3] = (m_frgbaColor2 - fDistance).ClampRGB();
-		
-		// try each selector
-		for (unsigned int uiSelector = 0; uiSelector < SELECTORS; uiSelector++)
-		{
-			for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
-			{
-
-				float fPixelError = CalcPixelError(afrgbaDecodedPixel[uiSelector], m_afDecodedAlphas[uiPixel],
-														m_pafrgbaSource[uiPixel]);
-
-				if (fPixelError < afBestPixelErrors[uiPixel])
-				{
-					afBestPixelErrors[uiPixel] = fPixelError;
-					auiBestPixelSelectors[uiPixel] = uiSelector;
-					afrgbaBestDecodedPixels[uiPixel] = afrgbaDecodedPixel[uiSelector];
-				}
-			}
-		}
+		afrgbaDecodedPixel[0] = a_pcandidate->frgbaColor1;
+		afrgbaDecodedPixel[1] = (a_pcandidate->frgbaColor2 + fDistance).ClampRGB();
+		afrgbaDecodedPixel[2] = a_pcandidate->frgbaColor2;
+		afrgbaDecodedPixel[3] = (a_pcandidate->frgbaColor2 - fDistance).ClampRGB();
 		
+		unsigned int auiBestPixelSelectors[PIXELS];
+		float fBlockError = m_pmetrickernels->pfnBestSelectors(afrgbaDecodedPixel, m_afDecodedAlphas, m_pafrgbaSource,
+																	false, auiBestPixelSelectors);
 
-		// add up all of the pixel errors
-		float fBlockError = 0.0f;
-		for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
-		{
-			fBlockError += afBestPixelErrors[uiPixel];
-		}
-
-		if (fBlockError < m_fError)
+		if (fBlockError < a_pcandidate->fError)
 		{
-			m_fError = fBlockError;
+			a_pcandidate->fError = fBlockError;
 
 			for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
 			{
-				m_auiSelectors[uiPixel] = auiBestPixelSelectors[uiPixel];
-				m_afrgbaDecodedColors[uiPixel] = afrgbaBestDecodedPixels[uiPixel];
+				a_pcandidate->auiSelectors[uiPixel] = auiBestPixelSelectors[uiPixel];
+				a_pcandidate->afrgbaDecodedColors[uiPixel] = afrgbaDecodedPixel[auiBestPixelSelectors[uiPixel]];
 			}
 		}
 
@@ -741,19 +785,13 @@ namespace Etc
 	//
 	void Block4x4Encoding_RGB8::TryH(unsigned int a_uiRadius)
 	{
-		Block4x4Encoding_RGB8 encodingTry = *this;
+		Candidate candidate;
+		candidate.mode = MODE_H;
+		candidate.fError = FLT_MAX;
 
-		// init "try"
-		{
-			encodingTry.m_mode = MODE_H;
-			encodingTry.m_boolDiff = true;
-			encodingTry.m_boolFlip = false;
-			encodingTry.m_fError = FLT_MAX;
-		}
-
-		int iColor1Red = m_frgbaOriginalColor1_TAndH.IntRed(15.0f);
-		int iColor1Green = m_frgbaOriginalColor1_TAndH.IntGreen(15.0f);
-		int iColor1Blue = m_frgbaOriginalColor1_TAndH.IntBlue(15.0f);
+		int iColor1Red = m_analysis.frgbaTAndHColor1.IntRed(15.0f);
+		int iColor1Green = m_analysis.frgbaTAndHColor1.IntGreen(15.0f);
+		int iColor1Blue = m_analysis.frgbaTAndHColor1.IntBlue(15.0f);
 
 		int iMinRed1 = iColor1Red - (int)a_uiRadius;
 		if (iMinRed1 < 0)
@@ -788,9 +826,9 @@ namespace Etc
 			iMinBlue1 = 15;
 		}
 
-		int iColor2Red = m_frgbaOriginalColor2_TAndH.IntRed(15.0f);
-		int iColor2Green = m_frgbaOriginalColor2_TAndH.IntGreen(15.0f);
-		int iColor2Blue = m_frgbaOriginalColor2_TAndH.IntBlue(15.0f);
+		int iColor2Red = m_analysis.frgbaTAndHColor2.IntRed(15.0f);
+		int iColor2Green = m_analysis.frgbaTAndHColor2.IntGreen(15.0f);
+		int iColor2Blue = m_analysis.frgbaTAndHColor2.IntBlue(15.0f);
 
 		int iMinRed2 = iColor2Red - (int)a_uiRadius;
 		if (iMinRed2 < 0)
@@ -827,17 +865,17 @@ namespace Etc
 
 		for (unsigned int uiDistance = 0; uiDistance < TH_DISTANCES; uiDistance++)
 		{
-			encodingTry.m_uiCW1 = uiDistance;
+			candidate.uiCW1 = uiDistance;
 
-			// twiddle m_frgbaOriginalColor1_TAndH
+			// twiddle m_analysis.frgbaTAndHColor1
 			for (int iRed1 = iMinRed1; iRed1 <= iMaxRed1; iRed1++)
 			{
 				for (int iGreen1 = iMinGreen1; iGreen1 <= iMaxGreen1; iGreen1++)
 				{
 					for (int iBlue1 = iMinBlue1; iBlue1 <= iMaxBlue1; iBlue1++)
 					{
-						encodingTry.m_frgbaColor1 = ColorFloatRGBA::ConvertFromRGB4((unsigned char)iRed1, (unsigned char)iGreen1, (unsigned char)iBlue1);
-						encodingTry.m_frgbaColor2 = m_frgbaOriginalColor2_TAndH;
+						candidate.frgbaColor1 = ColorFloatRGBA::ConvertFromRGB4((unsigned char)iRed1, (unsigned char)iGreen1, (unsigned char)iBlue1);
+						candidate.frgbaColor2 = m_analysis.frgbaTAndHColor2;
 
 						// if color1 == color2, H encoding issues can pop up, so abort
 						if (iRed1 == iColor2Red && iGreen1 == iColor2Green && iBlue1 == iColor2Blue)
@@ -845,39 +883,25 @@ namespace Etc
 							continue;
 						}
 
-						encodingTry.TryH_BestSelectorCombination();
+						TryH_BestSelectorCombination(&candidate);
 
-						if (encodingTry.m_fError < m_fError)
+						if (candidate.fError < m_fError)
 						{
-							m_mode = encodingTry.m_mode;
-							m_boolDiff = encodingTry.m_boolDiff;
-							m_boolFlip = encodingTry.m_boolFlip;
-
-							m_frgbaColor1 = encodingTry.m_frgbaColor1;
-							m_frgbaColor2 = encodingTry.m_frgbaColor2;
-							m_uiCW1 = encodingTry.m_uiCW1;
-
-							for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
-							{
-								m_auiSelectors[uiPixel] = encodingTry.m_auiSelectors[uiPixel];
-								m_afrgbaDecodedColors[uiPixel] = encodingTry.m_afrgbaDecodedColors[uiPixel];
-							}
-
-							m_fError = encodingTry.m_fError;
+							CommitCandidate(candidate);
 						}
 					}
 				}
 			}
 
-			// twiddle m_frgbaOriginalColor2_TAndH
+			// twiddle m_analysis.frgbaTAndHColor2
 			for (int iRed2 = iMinRed2; iRed2 <= iMaxRed2; iRed2++)
 			{
 				for (int iGreen2 = iMinGreen2; iGreen2 <= iMaxGreen2; iGreen2++)
 				{
 					for (int iBlue2 = iMinBlue2; iBlue2 <= iMaxBlue2; iBlue2++)
 					{
-						encodingTry.m_frgbaColor1 = m_frgbaOriginalColor1_TAndH;
-						encodingTry.m_frgbaColor2 = ColorFloatRGBA::ConvertFromRGB4((unsigned char)iRed2, (unsigned char)iGreen2, (unsigned char)iBlue2);
+						candidate.frgbaColor1 = m_analysis.frgbaTAndHColor1;
+						candidate.frgbaColor2 = ColorFloatRGBA::ConvertFromRGB4((unsigned char)iRed2, (unsigned char)iGreen2, (unsigned char)iBlue2);
 
 						// if color1 == color2, H encoding issues can pop up, so abort
 						if (iRed2 == iColor1Red && iGreen2 == iColor1Green && iBlue2 == iColor1Blue)
@@ -885,25 +909,11 @@ namespace Etc
 							continue;
 						}
 
-						encodingTry.TryH_BestSelectorCombination();
+						TryH_BestSelectorCombination(&candidate);
 
-						if (encodingTry.m_fError < m_fError)
+						if (candidate.fError < m_fError)
 						{
-							m_mode = encodingTry.m_mode;
-							m_boolDiff = encodingTry.m_boolDiff;
-							m_boolFlip = encodingTry.m_boolFlip;
-
-							m_frgbaColor1 = encodingTry.m_frgbaColor1;
-							m_frgbaColor2 = encodingTry.m_frgbaColor2;
-							m_uiCW1 = encodingTry.m_uiCW1;
-
-							for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
-							{
-								m_auiSelectors[uiPixel] = encodingTry.m_auiSelectors[uiPixel];
-								m_afrgbaDecodedColors[uiPixel] = encodingTry.m_afrgbaDecodedColors[uiPixel];
-							}
-
-							m_fError = encodingTry.m_fError;
+							CommitCandidate(candidate);
 						}
 					}
 				}
@@ -915,59 +925,33 @@ namespace Etc
 
 	// ----------------------------------------------------------------------------------------------------
 	// find best selector combination for TryH
-	// called on an encodingTry
+	// keep the selectors and decoded colors in a_pcandidate if they improve its error
 	//
-	void Block4x4Encoding_RGB8::TryH_BestSelectorCombination(void)
+	void Block4x4Encoding_RGB8::TryH_BestSelectorCombination(Candidate *a_pcandidate)
 	{
 
-		float fDistance = s_afTHDistanceTable[m_uiCW1];
+		float fDistance = s_afTHDistanceTable[a_pcandidate->uiCW1];
 
-		unsigned int auiBestPixelSelectors[PIXELS];
-		float afBestPixelErrors[PIXELS] = { FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX,
-			FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX };
-		ColorFloatRGBA	afrgbaBestDecodedPixels[PIXELS];
 		ColorFloatRGBA afrgbaDecodedPixel[SELECTORS];
 		
 		static_assert(SELECTORS == 4, "");
-		afrgbaDecodedPixel[0] = (m_frgbaColor1 + fDistance).ClampRGB();
-		afrgbaDecodedPixel[1] = (m_frgbaColor1 - fDistance).ClampRGB();
-		afrgbaDecodedPixel[2] = (m_frgbaColor2 + fDistance).ClampRGB();
-		afrgbaDecodedPixel[3] = (m_frgbaColor2 - fDistance).ClampRGB();
-		
-		// try each selector
-		for (unsigned int uiSelector = 0; uiSelector < SELECTORS; uiSelector++)
-		{
-			for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
-			{
-
-				float fPixelError = CalcPixelError(afrgbaDecodedPixel[uiSelector], m_afDecodedAlphas[uiPixel],
-														m_pafrgbaSource[uiPixel]);
-
-				if (fPixelError < afBestPixelErrors[uiPixel])
-				{
-					afBestPixelErrors[uiPixel] = fPixelError;
-					auiBestPixelSelectors[uiPixel] = uiSelector;
-					afrgbaBestDecodedPixels[uiPixel] = afrgbaDecodedPixel[uiSelector];
-				}
-			}
-		}
+		afrgbaDecodedPixel[0] = (a_pcandidate->frgbaColor1 + fDistance).ClampRGB();
+		afrgbaDecodedPixel[1] = (a_pcandidate->frgbaColor1 - fDistance).ClampRGB();
+		afrgbaDecodedPixel[2] = (a_pcandidate->frgbaColor2 + fDistance).ClampRGB();
+		afrgbaDecodedPixel[3] = (a_pcandidate->frgbaColor2 - fDistance).ClampRGB();
 		
+		unsigned int auiBestPixelSelectors[PIXELS];
+		float fBlockError = m_pmetrickernels->pfnBestSelectors(afrgbaDecodedPixel, m_afDecodedAlphas, m_pafrgbaSource,
+																	false, auiBestPixelSelectors);
 
-		// add up all of the pixel errors
-		float fBlockError = 0.0f;
-		for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
-		{
-			fBlockError += afBestPixelErrors[uiPixel];
-		}
-
-		if (fBlockError < m_fError)
+		if (fBlockError < a_pcandidate->fError)
 		{
-			m_fError = fBlockError;
+			a_pcandidate->fError = fBlockError;
 
 			for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
 			{
-				m_auiSelectors[uiPixel] = auiBestPixelSelectors[uiPixel];
-				m_afrgbaDecodedColors[uiPixel] = afrgbaBestDecodedPixels[uiPixel];
+				a_pcandidate->auiSelectors[uiPixel] = auiBestPixelSelectors[uiPixel];
+				a_pcandidate->afrgbaDecodedColors[uiPixel] = afrgbaDecodedPixel[auiBestPixelSelectors[uiPixel]];
 			}
 		}
 
@@ -975,6 +959,7 @@ namespace Etc
 
 	// ----------------------------------------------------------------------------------------------------
 	// use linear regression to find the best fit for colors along the edges of the 4x4 block
+	// store the corner colors in m_analysis.afrgbaPlanarCornerColors
 	//
 	void Block4x4Encoding_RGB8::CalculatePlanarCornerColors(void)
 	{
@@ -982,14 +967,18 @@ namespace Etc
 		ColorFloatRGBA frgbaSlope;
 		ColorFloatRGBA frgbaOffset;
 
+		static_assert(BlockAnalysis::PLANAR_CORNER_COLORS == PLANAR_CORNER_COLORS, "");
+		ColorFloatRGBA *pafrgbaCornerColors = m_analysis.afrgbaPlanarCornerColors;
+		m_analysis.boolPlanarCornerColors = true;
+
 		// top edge
 		afrgbaRegression[0] = m_pafrgbaSource[0];
 		afrgbaRegression[1] = m_pafrgbaSource[4];
 		afrgbaRegression[2] = m_pafrgbaSource[8];
 		afrgbaRegression[3] = m_pafrgbaSource[12];
 		ColorRegression(afrgbaRegression, 4, &frgbaSlope, &frgbaOffset);
-		m_frgbaColor1 = frgbaOffset;
-		m_frgbaColor2 = (frgbaSlope * 4.0f) + frgbaOffset;
+		pafrgbaCornerColors[0] = frgbaOffset;
+		pafrgbaCornerColors[1] = (frgbaSlope * 4.0f) + frgbaOffset;
 
 		// left edge
 		afrgbaRegression[0] = m_pafrgbaSource[0];
@@ -997,8 +986,8 @@ namespace Etc
 		afrgbaRegression[2] = m_pafrgbaSource[2];
 		afrgbaRegression[3] = m_pafrgbaSource[3];
 		ColorRegression(afrgbaRegression, 4, &frgbaSlope, &frgbaOffset);
-		m_frgbaColor1 = (m_frgbaColor1 + frgbaOffset) * 0.5f;		// average with top edge
-		m_frgbaColor3 = (frgbaSlope * 4.0f) + frgbaOffset;
+		pafrgbaCornerColors[0] = (pafrgbaCornerColors[0] + frgbaOffset) * 0.5f;		// average with top edge
+		pafrgbaCornerColors[2] = (frgbaSlope * 4.0f) + frgbaOffset;
 
 		// right edge
 		afrgbaRegression[0] = m_pafrgbaSource[12];
@@ -1006,7 +995,7 @@ namespace Etc
 		afrgbaRegression[2] = m_pafrgbaSource[14];
 		afrgbaRegression[3] = m_pafrgbaSource[15];
 		ColorRegression(afrgbaRegression, 4, &frgbaSlope, &frgbaOffset);
-		m_frgbaColor2 = (m_frgbaColor2 + frgbaOffset) * 0.5f;		// average with top edge
+		pafrgbaCornerColors[1] = (pafrgbaCornerColors[1] + frgbaOffset) * 0.5f;		// average with top edge
 
 		// bottom edge
 		afrgbaRegression[0] = m_pafrgbaSource[3];
@@ -1014,12 +1003,12 @@ namespace Etc
 		afrgbaRegression[2] = m_pafrgbaSource[11];
 		afrgbaRegression[3] = m_pafrgbaSource[15];
 		ColorRegression(afrgbaRegression, 4, &frgbaSlope, &frgbaOffset);
-		m_frgbaColor3 = (m_frgbaColor3 + frgbaOffset) * 0.5f;		// average with left edge
+		pafrgbaCornerColors[2] = (pafrgbaCornerColors[2] + frgbaOffset) * 0.5f;		// average with left edge
 
 		// quantize corner colors to 6/7/6
-		m_frgbaColor1 = m_frgbaColor1.QuantizeR6G7B6();
-		m_frgbaColor2 = m_frgbaColor2.QuantizeR6G7B6();
-		m_frgbaColor3 = m_frgbaColor3.QuantizeR6G7B6();
+		pafrgbaCornerColors[0] = pafrgbaCornerColors[0].QuantizeR6G7B6();
+		pafrgbaCornerColors[1] = pafrgbaCornerColors[1].QuantizeR6G7B6();
+		pafrgbaCornerColors[2] = pafrgbaCornerColors[2].QuantizeR6G7B6();
 
 	}
 
@@ -1030,21 +1019,21 @@ namespace Etc
 	//
 	// return true if improvement
 	//
-	bool Block4x4Encoding_RGB8::TwiddlePlanar(void)
+	bool Block4x4Encoding_RGB8::TwiddlePlanar(Candidate *a_pcandidate)
 	{
 		bool boolImprovement = false;
 
-		while (TwiddlePlanarR())
+		while (TwiddlePlanarR(a_pcandidate))
 		{
 			boolImprovement = true;
 		}
 
-		while (TwiddlePlanarG())
+		while (TwiddlePlanarG(a_pcandidate))
 		{
 			boolImprovement = true;
 		}
 
-		while (TwiddlePlanarB())
+		while (TwiddlePlanarB(a_pcandidate))
 		{
 			boolImprovement = true;
 		}
@@ -1055,22 +1044,19 @@ namespace Etc
 	// ----------------------------------------------------------------------------------------------------
 	// try different corner colors by slightly changing R
 	//
-	bool Block4x4Encoding_RGB8::TwiddlePlanarR()
+	bool Block4x4Encoding_RGB8::TwiddlePlanarR(Candidate *a_pcandidate)
 	{
 		bool boolImprovement = false;
 
-		Block4x4Encoding_RGB8 encodingTry = *this;
+		Candidate candidateTry;
+		candidateTry.mode = MODE_PLANAR;
+		candidateTry.frgbaColor1 = a_pcandidate->frgbaColor1;
+		candidateTry.frgbaColor2 = a_pcandidate->frgbaColor2;
+		candidateTry.frgbaColor3 = a_pcandidate->frgbaColor3;
 
-		// init "try"
-		{
-			encodingTry.m_mode = MODE_PLANAR;
-			encodingTry.m_boolDiff = true;
-			encodingTry.m_boolFlip = false;
-		}
-
-		int iOriginRed = encodingTry.m_frgbaColor1.IntRed(63.0f);
-		int iHorizRed = encodingTry.m_frgbaColor2.IntRed(63.0f);
-		int iVertRed = encodingTry.m_frgbaColor3.IntRed(63.0f);
+		int iOriginRed = candidateTry.frgbaColor1.IntRed(63.0f);
+		int iHorizRed = candidateTry.frgbaColor2.IntRed(63.0f);
+		int iVertRed = candidateTry.frgbaColor3.IntRed(63.0f);
 
 		for (int iTryOriginRed = iOriginRed - 1; iTryOriginRed <= iOriginRed + 1; iTryOriginRed++)
 		{
@@ -1080,7 +1066,7 @@ namespace Etc
 				continue;
 			}
 
-			encodingTry.m_frgbaColor1.fR = ((iTryOriginRed << 2) + (iTryOriginRed >> 4)) / 255.0f;
+			candidateTry.frgbaColor1.fR = ((iTryOriginRed << 2) + (iTryOriginRed >> 4)) / 255.0f;
 
 			for (int iTryHorizRed = iHorizRed - 1; iTryHorizRed <= iHorizRed + 1; iTryHorizRed++)
 			{
@@ -1090,7 +1076,7 @@ namespace Etc
 					continue;
 				}
 
-				encodingTry.m_frgbaColor2.fR = ((iTryHorizRed << 2) + (iTryHorizRed >> 4)) / 255.0f;
+				candidateTry.frgbaColor2.fR = ((iTryHorizRed << 2) + (iTryHorizRed >> 4)) / 255.0f;
 
 				for (int iTryVertRed = iVertRed - 1; iTryVertRed <= iVertRed + 1; iTryVertRed++)
 				{
@@ -1106,27 +1092,16 @@ namespace Etc
 						continue;
 					}
 
-					encodingTry.m_frgbaColor3.fR = ((iTryVertRed << 2) + (iTryVertRed >> 4)) / 255.0f;
+					candidateTry.frgbaColor3.fR = ((iTryVertRed << 2) + (iTryVertRed >> 4)) / 255.0f;
 
-					encodingTry.DecodePixels_Planar();
+					DecodePixels_Planar(candidateTry.frgbaColor1, candidateTry.frgbaColor2, candidateTry.frgbaColor3,
+										candidateTry.afrgbaDecodedColors);
 
-					encodingTry.CalcBlockError();
+					candidateTry.fError = CalcBlockError(candidateTry.afrgbaDecodedColors);
 
-					if (encodingTry.m_fError < m_fError)
+					if (candidateTry.fError < a_pcandidate->fError)
 					{
-						m_mode = MODE_PLANAR;
-						m_boolDiff = true;
-						m_boolFlip = false;
-						m_frgbaColor1 = encodingTry.m_frgbaColor1;
-						m_frgbaColor2 = encodingTry.m_frgbaColor2;
-						m_frgbaColor3 = encodingTry.m_frgbaColor3;
-
-						for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
-						{
-							m_afrgbaDecodedColors[uiPixel] = encodingTry.m_afrgbaDecodedColors[uiPixel];
-						}
-
-						m_fError = encodingTry.m_fError;
+						*a_pcandidate = candidateTry;
 
 						boolImprovement = true;
 					}
@@ -1140,22 +1115,19 @@ namespace Etc
 	// ----------------------------------------------------------------------------------------------------
 	// try different corner colors by slightly changing G
 	//
-	bool Block4x4Encoding_RGB8::TwiddlePlanarG()
+	bool Block4x4Encoding_RGB8::TwiddlePlanarG(Candidate *a_pcandidate)
 	{
 		bool boolImprovement = false;
 
-		Block4x4Encoding_RGB8 encodingTry = *this;
+		Candidate candidateTry;
+		candidateTry.mode = MODE_PLANAR;
+		candidateTry.frgbaColor1 = a_pcandidate->frgbaColor1;
+		candidateTry.frgbaColor2 = a_pcandidate->frgbaColor2;
+		candidateTry.frgbaColor3 = a_pcandidate->frgbaColor3;
 
-		// init "try"
-		{
-			encodingTry.m_mode = MODE_PLANAR;
-			encodingTry.m_boolDiff = true;
-			encodingTry.m_boolFlip = false;
-		}
-
-		int iOriginGreen = encodingTry.m_frgbaColor1.IntGreen(127.0f);
-		int iHorizGreen = encodingTry.m_frgbaColor2.IntGreen(127.0f);
-		int iVertGreen = encodingTry.m_frgbaColor3.IntGreen(127.0f);
+		int iOriginGreen = candidateTry.frgbaColor1.IntGreen(127.0f);
+		int iHorizGreen = candidateTry.frgbaColor2.IntGreen(127.0f);
+		int iVertGreen = candidateTry.frgbaColor3.IntGreen(127.0f);
 
 		for (int iTryOriginGreen = iOriginGreen - 1; iTryOriginGreen <= iOriginGreen + 1; iTryOriginGreen++)
 		{
@@ -1165,7 +1137,7 @@ namespace Etc
 				continue;
 			}
 
-			encodingTry.m_frgbaColor1.fG = ((iTryOriginGreen << 1) + (iTryOriginGreen >> 6)) / 255.0f;
+			candidateTry.frgbaColor1.fG = ((iTryOriginGreen << 1) + (iTryOriginGreen >> 6)) / 255.0f;
 
 			for (int iTryHorizGreen = iHorizGreen - 1; iTryHorizGreen <= iHorizGreen + 1; iTryHorizGreen++)
 			{
@@ -1175,7 +1147,7 @@ namespace Etc
 					continue;
 				}
 
-				encodingTry.m_frgbaColor2.fG = ((iTryHorizGreen << 1) + (iTryHorizGreen >> 6)) / 255.0f;
+				candidateTry.frgbaColor2.fG = ((iTryHorizGreen << 1) + (iTryHorizGreen >> 6)) / 255.0f;
 
 				for (int iTryVertGreen = iVertGreen - 1; iTryVertGreen <= iVertGreen + 1; iTryVertGreen++)
 				{
@@ -1193,27 +1165,16 @@ namespace Etc
 						continue;
 					}
 
-					encodingTry.m_frgbaColor3.fG = ((iTryVertGreen << 1) + (iTryVertGreen >> 6)) / 255.0f;
+					candidateTry.frgbaColor3.fG = ((iTryVertGreen << 1) + (iTryVertGreen >> 6)) / 255.0f;
 
-					encodingTry.DecodePixels_Planar();
+					DecodePixels_Planar(candidateTry.frgbaColor1, candidateTry.frgbaColor2, candidateTry.frgbaColor3,
+										candidateTry.afrgbaDecodedColors);
 
-					encodingTry.CalcBlockError();
+					candidateTry.fError = CalcBlockError(candidateTry.afrgbaDecodedColors);
 
-					if (encodingTry.m_fError < m_fError)
+					if (candidateTry.fError < a_pcandidate->fError)
 					{
-						m_mode = MODE_PLANAR;
-						m_boolDiff = true;
-						m_boolFlip = false;
-						m_frgbaColor1 = encodingTry.m_frgbaColor1;
-						m_frgbaColor2 = encodingTry.m_frgbaColor2;
-						m_frgbaColor3 = encodingTry.m_frgbaColor3;
-
-						for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
-						{
-							m_afrgbaDecodedColors[uiPixel] = encodingTry.m_afrgbaDecodedColors[uiPixel];
-						}
-
-						m_fError = encodingTry.m_fError;
+						*a_pcandidate = candidateTry;
 
 						boolImprovement = true;
 					}
@@ -1227,22 +1188,19 @@ namespace Etc
 	// ----------------------------------------------------------------------------------------------------
 	// try different corner colors by slightly changing B
 	//
-	bool Block4x4Encoding_RGB8::TwiddlePlanarB()
+	bool Block4x4Encoding_RGB8::TwiddlePlanarB(Candidate *a_pcandidate)
 	{
 		bool boolImprovement = false;
 
-		Block4x4Encoding_RGB8 encodingTry = *this;
-
-		// init "try"
-		{
-			encodingTry.m_mode = MODE_PLANAR;
-			encodingTry.m_boolDiff = true;
-			encodingTry.m_boolFlip = false;
-		}
+		Candidate candidateTry;
+		candidateTry.mode = MODE_PLANAR;
+		candidateTry.frgbaColor1 = a_pcandidate->frgbaColor1;
+		candidateTry.frgbaColor2 = a_pcandidate->frgbaColor2;
+		candidateTry.frgbaColor3 = a_pcandidate->frgbaColor3;
 
-		int iOriginBlue = encodingTry.m_frgbaColor1.IntBlue(63.0f);
-		int iHorizBlue = encodingTry.m_frgbaColor2.IntBlue(63.0f);
-		int iVertBlue = encodingTry.m_frgbaColor3.IntBlue(63.0f);
+		int iOriginBlue = candidateTry.frgbaColor1.IntBlue(63.0f);
+		int iHorizBlue = candidateTry.frgbaColor2.IntBlue(63.0f);
+		int iVertBlue = candidateTry.frgbaColor3.IntBlue(63.0f);
 
 		for (int iTryOriginBlue = iOriginBlue - 1; iTryOriginBlue <= iOriginBlue + 1; iTryOriginBlue++)
 		{
@@ -1252,7 +1210,7 @@ namespace Etc
 				continue;
 			}
 
-			encodingTry.m_frgbaColor1.fB = ((iTryOriginBlue << 2) + (iTryOriginBlue >> 4)) / 255.0f;
+			candidateTry.frgbaColor1.fB = ((iTryOriginBlue << 2) + (iTryOriginBlue >> 4)) / 255.0f;
 
 			for (int iTryHorizBlue = iHorizBlue - 1; iTryHorizBlue <= iHorizBlue + 1; iTryHorizBlue++)
 			{
@@ -1262,7 +1220,7 @@ namespace Etc
 					continue;
 				}
 
-				encodingTry.m_frgbaColor2.fB = ((iTryHorizBlue << 2) + (iTryHorizBlue >> 4)) / 255.0f;
+				candidateTry.frgbaColor2.fB = ((iTryHorizBlue << 2) + (iTryHorizBlue >> 4)) / 255.0f;
 
 				for (int iTryVertBlue = iVertBlue - 1; iTryVertBlue <= iVertBlue + 1; iTryVertBlue++)
 				{
@@ -1278,27 +1236,16 @@ namespace Etc
 						continue;
 					}
 
-					encodingTry.m_frgbaColor3.fB = ((iTryVertBlue << 2) + (iTryVertBlue >> 4)) / 255.0f;
+					candidateTry.frgbaColor3.fB = ((iTryVertBlue << 2) + (iTryVertBlue >> 4)) / 255.0f;
 
-					encodingTry.DecodePixels_Planar();
+					DecodePixels_Planar(candidateTry.frgbaColor1, candidateTry.frgbaColor2, candidateTry.frgbaColor3,
+										candidateTry.afrgbaDecodedColors);
 
-					encodingTry.CalcBlockError();
+					candidateTry.fError = CalcBlockError(candidateTry.afrgbaDecodedColors);
 
-					if (encodingTry.m_fError < m_fError)
+					if (candidateTry.fError < a_pcandidate->fError)
 					{
-						m_mode = MODE_PLANAR;
-						m_boolDiff = true;
-						m_boolFlip = false;
-						m_frgbaColor1 = encodingTry.m_frgbaColor1;
-						m_frgbaColor2 = encodingTry.m_frgbaColor2;
-						m_frgbaColor3 = encodingTry.m_frgbaColor3;
-
-						for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
-						{
-							m_afrgbaDecodedColors[uiPixel] = encodingTry.m_afrgbaDecodedColors[uiPixel];
-						}
-
-						m_fError = encodingTry.m_fError;
+						*a_pcandidate = candidateTry;
 
 						boolImprovement = true;
 					}
@@ -1600,19 +1547,19 @@ namespace Etc
 			switch (m_auiSelectors[uiPixel])
 			{
 			case 0:
-				m_afrgbaDecodedColors[uiPixel] = m_frgbaColor1;
+				m_pafrgbaDecodedColors[uiPixel] = m_frgbaColor1;
 				break;
 
 			case 1:
-				m_afrgbaDecodedColors[uiPixel] = (m_frgbaColor2 + frgbaDistance).ClampRGB();
+				m_pafrgbaDecodedColors[uiPixel] = (m_frgbaColor2 + frgbaDistance).ClampRGB();
 				break;
 
 			case 2:
-				m_afrgbaDecodedColors[uiPixel] = m_frgbaColor2;
+				m_pafrgbaDecodedColors[uiPixel] = m_frgbaColor2;
 				break;
 
 			case 3:
-				m_afrgbaDecodedColors[uiPixel] = (m_frgbaColor2 - frgbaDistance).ClampRGB();
+				m_pafrgbaDecodedColors[uiPixel] = (m_frgbaColor2 - frgbaDistance).ClampRGB();
 				break;
 			}
 
@@ -1634,19 +1581,19 @@ namespace Etc
 			switch (m_auiSelectors[uiPixel])
 			{
 			case 0:
-				m_afrgbaDecodedColors[uiPixel] = (m_frgbaColor1 + frgbaDistance).ClampRGB();
+				m_pafrgbaDecodedColors[uiPixel] = (m_frgbaColor1 + frgbaDistance).ClampRGB();
 				break;
 
 			case 1:
-				m_afrgbaDecodedColors[uiPixel] = (m_frgbaColor1 - frgbaDistance).ClampRGB();
+				m_pafrgbaDecodedColors[uiPixel] = (m_frgbaColor1 - frgbaDistance).ClampRGB();
 				break;
 
 			case 2:
-				m_afrgbaDecodedColors[uiPixel] = (m_frgbaColor2 + frgbaDistance).ClampRGB();
+				m_pafrgbaDecodedColors[uiPixel] = (m_frgbaColor2 + frgbaDistance).ClampRGB();
 				break;
 
 			case 3:
-				m_afrgbaDecodedColors[uiPixel] = (m_frgbaColor2 - frgbaDistance).ClampRGB();
+				m_pafrgbaDecodedColors[uiPixel] = (m_frgbaColor2 - frgbaDistance).ClampRGB();
 				break;
 			}
 
@@ -1658,19 +1605,28 @@ namespace Etc
 	// set the decoded colors and decoded alpha based on the encoding state for Planar mode
 	//
 	void Block4x4Encoding_RGB8::DecodePixels_Planar(void)
+	{
+		DecodePixels_Planar(m_frgbaColor1, m_frgbaColor2, m_frgbaColor3, m_pafrgbaDecodedColors);
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// decode the pixels of planar corner colors a_frgbaOrigin, a_frgbaHorizontal and a_frgbaVertical
+	//
+	void Block4x4Encoding_RGB8::DecodePixels_Planar(const ColorFloatRGBA &a_frgbaOrigin, const ColorFloatRGBA &a_frgbaHorizontal,
+													const ColorFloatRGBA &a_frgbaVertical, ColorFloatRGBA *a_pafrgbaDecodedColors)
 	{
 
-		int iRO = (int)roundf(m_frgbaColor1.fR * 255.0f);
-		int iGO = (int)roundf(m_frgbaColor1.fG * 255.0f);
-		int iBO = (int)roundf(m_frgbaColor1.fB * 255.0f);
+		int iRO = (int)roundf(a_frgbaOrigin.fR * 255.0f);
+		int iGO = (int)roundf(a_frgbaOrigin.fG * 255.0f);
+		int iBO = (int)roundf(a_frgbaOrigin.fB * 255.0f);
 
-		int iRH = (int)roundf(m_frgbaColor2.fR * 255.0f);
-		int iGH = (int)roundf(m_frgbaColor2.fG * 255.0f);
-		int iBH = (int)roundf(m_frgbaColor2.fB * 255.0f);
+		int iRH = (int)roundf(a_frgbaHorizontal.fR * 255.0f);
+		int iGH = (int)roundf(a_frgbaHorizontal.fG * 255.0f);
+		int iBH = (int)roundf(a_frgbaHorizontal.fB * 255.0f);
 
-		int iRV = (int)roundf(m_frgbaColor3.fR * 255.0f);
-		int iGV = (int)roundf(m_frgbaColor3.fG * 255.0f);
-		int iBV = (int)roundf(m_frgbaColor3.fB * 255.0f);
+		int iRV = (int)roundf(a_frgbaVertical.fR * 255.0f);
+		int iGV = (int)roundf(a_frgbaVertical.fG * 255.0f);
+		int iBV = (int)roundf(a_frgbaVertical.fB * 255.0f);
 
 		for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
 		{
@@ -1687,7 +1643,7 @@ namespace Etc
 			frgba.fB = (float)iB / 255.0f;
 			frgba.fA = 1.0f;
 
-			m_afrgbaDecodedColors[uiPixel] = frgba.ClampRGB();
+			a_pafrgbaDecodedColors[uiPixel] = frgba.ClampRGB();
 		}
 
 	}
@@ -35,6 +35,8 @@ namespace Etc
 											ErrorMetric a_errormetric) override;
 
 		virtual void PerformIteration(Image::Format a_encoding, ErrorMetric a_errormetric, float a_fEffort) override;
+
+		virtual bool EncodeSolidColor(Image::Format a_encoding) override;
 		
 		virtual void SetEncodingBits(Image::Format a_encoding) override;
 
@@ -51,6 +53,24 @@ namespace Etc
 
 		static float s_afTHDistanceTable[TH_DISTANCES];
 
+		// a T, H or planar encoding under evaluation
+		// candidates are scored without copying the encoder and only an improvement is committed
+		struct Candidate
+		{
+			Mode			mode;
+			ColorFloatRGBA	frgbaColor1;
+			ColorFloatRGBA	frgbaColor2;
+			ColorFloatRGBA	frgbaColor3;			// planar only
+			unsigned int	uiCW1;					// T and H only
+			unsigned int	auiSelectors[PIXELS];	// T and H only
+			ColorFloatRGBA	afrgbaDecodedColors[PIXELS];
+			float			fError;
+		};
+
+		void CommitCandidate(const Candidate &a_candidate);
+
+		void SetSolidColor_ETC2(const SolidColor::Encoding &a_encoding);
+
 		void TryPlanar(unsigned int a_uiRadius);
 		void TryTAndH(ErrorMetric a_errormetric, unsigned int a_uiRadius);
 
@@ -62,15 +82,11 @@ namespace Etc
 		void SetEncodingBits_H(void);
 		void SetEncodingBits_Planar(void);
 
-		// state shared between iterations
-		ColorFloatRGBA	m_frgbaOriginalColor1_TAndH;
-		ColorFloatRGBA	m_frgbaOriginalColor2_TAndH;
-
 		void CalculateBaseColorsForTAndH(ErrorMetric a_errormetric);
 		void TryT(unsigned int a_uiRadius);
-		void TryT_BestSelectorCombination(void);
+		void TryT_BestSelectorCombination(Candidate *a_pcandidate);
 		void TryH(unsigned int a_uiRadius);
-		void TryH_BestSelectorCombination(void);
+		void TryH_BestSelectorCombination(Candidate *a_pcandidate);
 
 	private:
 
@@ -82,15 +98,18 @@ namespace Etc
 		void ColorRegression(ColorFloatRGBA *a_pafrgbaPixels, unsigned int a_uiPixels,
 			ColorFloatRGBA *a_pfrgbaSlope, ColorFloatRGBA *a_pfrgbaOffset);
 
-		bool TwiddlePlanar(void);
-		bool TwiddlePlanarR();
-		bool TwiddlePlanarG();
-		bool TwiddlePlanarB();
+		bool TwiddlePlanar(Candidate *a_pcandidate);
+		bool TwiddlePlanarR(Candidate *a_pcandidate);
+		bool TwiddlePlanarG(Candidate *a_pcandidate);
+		bool TwiddlePlanarB(Candidate *a_pcandidate);
 
 		void DecodePixels_T(void);
 		void DecodePixels_H(void);
 		void DecodePixels_Planar(void);
 
+		static void DecodePixels_Planar(const ColorFloatRGBA &a_frgbaOrigin, const ColorFloatRGBA &a_frgbaHorizontal,
+										const ColorFloatRGBA &a_frgbaVertical, ColorFloatRGBA *a_pafrgbaDecodedColors);
+
 	};
 
 } // namespace Etc
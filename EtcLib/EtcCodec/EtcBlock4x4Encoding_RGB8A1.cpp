@@ -32,6 +32,7 @@ Block4x4Encoding_RGB8A1 is used when there is a mixture of alphas in the 4x4 blo
 #include "EtcBlock4x4Encoding_RGB8A1.h"
 
 #include "EtcBlock4x4.h"
+#include "EtcBlockError.h"
 #include "EtcBlock4x4EncodingBits.h"
 #include "EtcBlock4x4Encoding_RGB8.h"
 
@@ -310,12 +311,12 @@ namespace Etc
 
 			if (m_boolOpaque == false && m_auiSelectors[uiPixel] == TRANSPARENT_SELECTOR)
 			{
-				m_afrgbaDecodedColors[uiPixel] = ColorFloatRGBA();
+				m_pafrgbaDecodedColors[uiPixel] = ColorFloatRGBA();
 				m_afDecodedAlphas[uiPixel] = 0.0f;
 			}
 			else
 			{
-				m_afrgbaDecodedColors[uiPixel] = (*pfrgbaCenter + fDelta).ClampRGB();
+				m_pafrgbaDecodedColors[uiPixel] = (*pfrgbaCenter + fDelta).ClampRGB();
 				m_afDecodedAlphas[uiPixel] = 1.0f;
 			}
 		}
@@ -336,30 +337,30 @@ namespace Etc
 			switch (m_auiSelectors[uiPixel])
 			{
 			case 0:
-				m_afrgbaDecodedColors[uiPixel] = m_frgbaColor1;
+				m_pafrgbaDecodedColors[uiPixel] = m_frgbaColor1;
 				m_afDecodedAlphas[uiPixel] = 1.0f;
 				break;
 
 			case 1:
-				m_afrgbaDecodedColors[uiPixel] = (m_frgbaColor2 + frgbaDistance).ClampRGB();
+				m_pafrgbaDecodedColors[uiPixel] = (m_frgbaColor2 + frgbaDistance).ClampRGB();
 				m_afDecodedAlphas[uiPixel] = 1.0f;
 				break;
 
 			case 2:
 				if (m_boolOpaque == false)
 				{
-					m_afrgbaDecodedColors[uiPixel] = ColorFloatRGBA();
+					m_pafrgbaDecodedColors[uiPixel] = ColorFloatRGBA();
 					m_afDecodedAlphas[uiPixel] = 0.0f;
 				}
 				else
 				{
-					m_afrgbaDecodedColors[uiPixel] = m_frgbaColor2;
+					m_pafrgbaDecodedColors[uiPixel] = m_frgbaColor2;
 					m_afDecodedAlphas[uiPixel] = 1.0f;
 				}
 				break;
 
 			case 3:
-				m_afrgbaDecodedColors[uiPixel] = (m_frgbaColor2 - frgbaDistance).ClampRGB();
+				m_pafrgbaDecodedColors[uiPixel] = (m_frgbaColor2 - frgbaDistance).ClampRGB();
 				m_afDecodedAlphas[uiPixel] = 1.0f;
 				break;
 			}
@@ -382,30 +383,30 @@ namespace Etc
 			switch (m_auiSelectors[uiPixel])
 			{
 			case 0:
-				m_afrgbaDecodedColors[uiPixel] = (m_frgbaColor1 + frgbaDistance).ClampRGB();
+				m_pafrgbaDecodedColors[uiPixel] = (m_frgbaColor1 + frgbaDistance).ClampRGB();
 				m_afDecodedAlphas[uiPixel] = 1.0f;
 				break;
 
 			case 1:
-				m_afrgbaDecodedColors[uiPixel] = (m_frgbaColor1 - frgbaDistance).ClampRGB();
+				m_pafrgbaDecodedColors[uiPixel] = (m_frgbaColor1 - frgbaDistance).ClampRGB();
 				m_afDecodedAlphas[uiPixel] = 1.0f;
 				break;
 
 			case 2:
 				if (m_boolOpaque == false)
 				{
-					m_afrgbaDecodedColors[uiPixel] = ColorFloatRGBA();
+					m_pafrgbaDecodedColors[uiPixel] = ColorFloatRGBA();
 					m_afDecodedAlphas[uiPixel] = 0.0f;
 				}
 				else
 				{
-					m_afrgbaDecodedColors[uiPixel] = (m_frgbaColor2 + frgbaDistance).ClampRGB();
+					m_pafrgbaDecodedColors[uiPixel] = (m_frgbaColor2 + frgbaDistance).ClampRGB();
 					m_afDecodedAlphas[uiPixel] = 1.0f;
 				}
 				break;
 
 			case 3:
-				m_afrgbaDecodedColors[uiPixel] = (m_frgbaColor2 - frgbaDistance).ClampRGB();
+				m_pafrgbaDecodedColors[uiPixel] = (m_frgbaColor2 - frgbaDistance).ClampRGB();
 				m_afDecodedAlphas[uiPixel] = 1.0f;
 				break;
 			}
@@ -415,6 +416,33 @@ namespace Etc
 	}
 
 
+	// ----------------------------------------------------------------------------------------------------
+	// encode an opaque solid color block with the best differential, planar or T encoding of its color
+	// RGB8A1 can't use individual mode
+	// blocks with transparent or border pixels are iterated, since the opaque bit changes how they decode
+	//
+	bool Block4x4Encoding_RGB8A1::EncodeSolidColor(Image::Format)
+	{
+		if (!m_boolOpaque)
+		{
+			return false;
+		}
+
+		SolidColor::Encoding encoding;
+		if (!FindSolidColor(SolidColor::ETC1_DIFFERENTIAL | SolidColor::PLANAR | SolidColor::T, &encoding))
+		{
+			return false;
+		}
+
+		SetSolidColor_ETC2(encoding);
+		CalcBlockError();
+
+		m_uiEncodingIterations = 1;
+		m_boolDone = true;
+
+		return true;
+	}
+
 	// ----------------------------------------------------------------------------------------------------
 	// perform a single encoding iteration
 	// replace the encoding if a better encoding was found
@@ -437,11 +465,11 @@ namespace Etc
 			break;
 
 		case 1:
-			TryDifferential(m_boolMostLikelyFlip, 1, 0, 0);
+			TryDifferential(m_analysis.boolMostLikelyFlip, 1, 0, 0);
 			break;
 
 		case 2:
-			TryDifferential(!m_boolMostLikelyFlip, 1, 0, 0);
+			TryDifferential(!m_analysis.boolMostLikelyFlip, 1, 0, 0);
 			if (a_fEffort <= 39.5f)
 			{
 				m_boolDone = true;
@@ -503,17 +531,17 @@ namespace Etc
 	//
 	void Block4x4Encoding_RGB8A1::PerformFirstIteration(ErrorMetric const a_errormetric)
 	{
-		Block4x4Encoding_ETC1::CalculateMostLikelyFlip(a_errormetric);
+		Block4x4Encoding_ETC1::AnalyzeSource(a_errormetric);
 
 		m_fError = FLT_MAX;
 
-		TryDifferential(m_boolMostLikelyFlip, 0, 0, 0);
+		TryDifferential(m_analysis.boolMostLikelyFlip, 0, 0, 0);
 		SetDoneIfPerfect();
 		if (m_boolDone)
 		{
 			return;
 		}
-		TryDifferential(!m_boolMostLikelyFlip, 0, 0, 0);
+		TryDifferential(!m_analysis.boolMostLikelyFlip, 0, 0, 0);
 		SetDoneIfPerfect();
 
 	}
@@ -521,7 +549,7 @@ namespace Etc
 	// ----------------------------------------------------------------------------------------------------
 	// mostly copied from ETC1
 	// differences:
-	//		Block4x4Encoding_RGB8A1 encodingTry = *this;
+	//		punch through pixels use the transparent selector and the opaque unset CW table
 	//
 	void Block4x4Encoding_RGB8A1::TryDifferential(bool a_boolFlip, unsigned int a_uiRadius, 
 													int a_iGrayOffset1, int a_iGrayOffset2)
@@ -535,16 +563,16 @@ namespace Etc
 
 		if (a_boolFlip)
 		{
-			frgbaColor1 = m_frgbaSourceAverageTop;
-			frgbaColor2 = m_frgbaSourceAverageBottom;
+			frgbaColor1 = m_analysis.frgbaAverageTop;
+			frgbaColor2 = m_analysis.frgbaAverageBottom;
 
 			pauiPixelMapping1 = s_auiTopPixelMapping;
 			pauiPixelMapping2 = s_auiBottomPixelMapping;
 		}
 		else
 		{
-			frgbaColor1 = m_frgbaSourceAverageLeft;
-			frgbaColor2 = m_frgbaSourceAverageRight;
+			frgbaColor1 = m_analysis.frgbaAverageLeft;
+			frgbaColor2 = m_analysis.frgbaAverageRight;
 
 			pauiPixelMapping1 = s_auiLeftPixelMapping;
 			pauiPixelMapping2 = s_auiRightPixelMapping;
@@ -553,16 +581,13 @@ namespace Etc
 		DifferentialTrys trys(frgbaColor1, frgbaColor2, pauiPixelMapping1, pauiPixelMapping2, 
 								a_uiRadius, a_iGrayOffset1, a_iGrayOffset2);
 
-		Block4x4Encoding_RGB8A1 encodingTry = *this;
-		encodingTry.m_boolFlip = a_boolFlip;
-
-		encodingTry.TryDifferentialHalf(&trys.m_half1);
-		encodingTry.TryDifferentialHalf(&trys.m_half2);
+		TryDifferentialHalf(&trys.m_half1);
+		TryDifferentialHalf(&trys.m_half2);
 
 		// find best halves that are within differential range
 		DifferentialTrys::Try *ptryBest1 = nullptr;
 		DifferentialTrys::Try *ptryBest2 = nullptr;
-		encodingTry.m_fError = FLT_MAX;
+		float fBestError = FLT_MAX;
 
 		// see if the best of each half are in differential range
 		int iDRed = trys.m_half2.m_ptryBest->m_iRed - trys.m_half1.m_ptryBest->m_iRed;
@@ -572,7 +597,7 @@ namespace Etc
 		{
 			ptryBest1 = trys.m_half1.m_ptryBest;
 			ptryBest2 = trys.m_half2.m_ptryBest;
-			encodingTry.m_fError = trys.m_half1.m_ptryBest->m_fError + trys.m_half2.m_ptryBest->m_fError;
+			fBestError = trys.m_half1.m_ptryBest->m_fError + trys.m_half2.m_ptryBest->m_fError;
 		}
 		else
 		{
@@ -596,9 +621,9 @@ namespace Etc
 					{
 						float fError = ptry1->m_fError + ptry2->m_fError;
 
-						if (fError < encodingTry.m_fError)
+						if (fError < fBestError)
 						{
-							encodingTry.m_fError = fError;
+							fBestError = fError;
 
 							ptryBest1 = ptry1;
 							ptryBest2 = ptry2;
@@ -607,16 +632,16 @@ namespace Etc
 
 				}
 			}
-			assert(encodingTry.m_fError < FLT_MAX);
+			assert(fBestError < FLT_MAX);
 			assert(ptryBest1 != nullptr);
 			assert(ptryBest2 != nullptr);
 		}
 
-		if (encodingTry.m_fError < m_fError)
+		if (fBestError < m_fError)
 		{
 			m_mode = MODE_ETC1;
 			m_boolDiff = true;
-			m_boolFlip = encodingTry.m_boolFlip;
+			m_boolFlip = a_boolFlip;
 			m_frgbaColor1 = ColorFloatRGBA::ConvertFromRGB5((unsigned char)ptryBest1->m_iRed, (unsigned char)ptryBest1->m_iGreen, (unsigned char)ptryBest1->m_iBlue);
 			m_frgbaColor2 = ColorFloatRGBA::ConvertFromRGB5((unsigned char)ptryBest2->m_iRed, (unsigned char)ptryBest2->m_iGreen, (unsigned char)ptryBest2->m_iBlue);
 			m_uiCW1 = ptryBest1->m_uiCW;
@@ -636,25 +661,25 @@ namespace Etc
 
 				if (uiSelector1 == TRANSPARENT_SELECTOR)
 				{
-					m_afrgbaDecodedColors[uiPixel1] = ColorFloatRGBA();
+					m_pafrgbaDecodedColors[uiPixel1] = ColorFloatRGBA();
 					m_afDecodedAlphas[uiPixel1] = 0.0f;
 				}
 				else
 				{
 					float fDeltaRGB1 = s_aafCwOpaqueUnsetTable[m_uiCW1][uiSelector1];
-					m_afrgbaDecodedColors[uiPixel1] = (m_frgbaColor1 + fDeltaRGB1).ClampRGB();
+					m_pafrgbaDecodedColors[uiPixel1] = (m_frgbaColor1 + fDeltaRGB1).ClampRGB();
 					m_afDecodedAlphas[uiPixel1] = 1.0f;
 				}
 
 				if (uiSelector2 == TRANSPARENT_SELECTOR)
 				{
-					m_afrgbaDecodedColors[uiPixel2] = ColorFloatRGBA();
+					m_pafrgbaDecodedColors[uiPixel2] = ColorFloatRGBA();
 					m_afDecodedAlphas[uiPixel2] = 0.0f;
 				}
 				else
 				{
 					float fDeltaRGB2 = s_aafCwOpaqueUnsetTable[m_uiCW2][uiSelector2];
-					m_afrgbaDecodedColors[uiPixel2] = (m_frgbaColor2 + fDeltaRGB2).ClampRGB();
+					m_pafrgbaDecodedColors[uiPixel2] = (m_frgbaColor2 + fDeltaRGB2).ClampRGB();
 					m_afDecodedAlphas[uiPixel2] = 1.0f;
 				}
 
@@ -735,9 +760,6 @@ namespace Etc
 					for (unsigned int uiCW = 0; uiCW < CW_RANGES; uiCW++)
 					{
 						unsigned int auiPixelSelectors[PIXELS / 2];
-						ColorFloatRGBA	afrgbaDecodedColors[PIXELS / 2];
-						float afPixelErrors[PIXELS / 2] = { FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX,
-							FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX };
 
 						// pre-compute decoded pixels for each selector
 						ColorFloatRGBA afrgbaSelectors[SELECTORS];
@@ -747,49 +769,9 @@ namespace Etc
 						afrgbaSelectors[2] = ColorFloatRGBA();
 						afrgbaSelectors[3] = (frgbaColor + s_aafCwOpaqueUnsetTable[uiCW][3]).ClampRGB();
 
-						for (unsigned int uiPixel = 0; uiPixel < 8; uiPixel++)
-						{
-							ColorFloatRGBA *pfrgbaSourcePixel = &m_pafrgbaSource[a_phalf->m_pauiPixelMapping[uiPixel]];
-							ColorFloatRGBA frgbaDecodedPixel;
-
-							for (unsigned int uiSelector = 0; uiSelector < SELECTORS; uiSelector++)
-							{
-								if (pfrgbaSourcePixel->fA < 0.5f)
-								{
-									uiSelector = TRANSPARENT_SELECTOR;
-								}
-								else if (uiSelector == TRANSPARENT_SELECTOR)
-								{
-									continue;
-								}
-
-								frgbaDecodedPixel = afrgbaSelectors[uiSelector];
-
-								float fPixelError;
-								
-								fPixelError = CalcPixelError(frgbaDecodedPixel, m_afDecodedAlphas[a_phalf->m_pauiPixelMapping[uiPixel]],
-																	*pfrgbaSourcePixel);
-
-								if (fPixelError < afPixelErrors[uiPixel])
-								{
-									auiPixelSelectors[uiPixel] = uiSelector;
-									afrgbaDecodedColors[uiPixel] = frgbaDecodedPixel;
-									afPixelErrors[uiPixel] = fPixelError;
-								}
-
-								if (uiSelector == TRANSPARENT_SELECTOR)
-								{
-									break;
-								}
-							}
-						}
-
-						// add up all pixel errors
-						float fCWError = 0.0f;
-						for (unsigned int uiPixel = 0; uiPixel < 8; uiPixel++)
-						{
-							fCWError += afPixelErrors[uiPixel];
-						}
+						// pick the best selector for each pixel and add up the pixel errors
+						float fCWError = m_pmetrickernels->pfnHalfSelectors(afrgbaSelectors, m_afDecodedAlphas, m_pafrgbaSource,
+																			a_phalf->m_pauiPixelMapping, true, auiPixelSelectors);
 
 						// if best CW so far
 						if (fCWError < ptry->m_fError)
@@ -828,19 +810,13 @@ namespace Etc
 	//
 	void Block4x4Encoding_RGB8A1::TryT(unsigned int a_uiRadius)
 	{
-		Block4x4Encoding_RGB8A1 encodingTry = *this;
-
-		// init "try"
-		{
-			encodingTry.m_mode = MODE_T;
-			encodingTry.m_boolDiff = true;
-			encodingTry.m_boolFlip = false;
-			encodingTry.m_fError = FLT_MAX;
-		}
+		Candidate candidate;
+		candidate.mode = MODE_T;
+		candidate.fError = FLT_MAX;
 
-		int iColor1Red = m_frgbaOriginalColor1_TAndH.IntRed(15.0f);
-		int iColor1Green = m_frgbaOriginalColor1_TAndH.IntGreen(15.0f);
-		int iColor1Blue = m_frgbaOriginalColor1_TAndH.IntBlue(15.0f);
+		int iColor1Red = m_analysis.frgbaTAndHColor1.IntRed(15.0f);
+		int iColor1Green = m_analysis.frgbaTAndHColor1.IntGreen(15.0f);
+		int iColor1Blue = m_analysis.frgbaTAndHColor1.IntBlue(15.0f);
 
 		int iMinRed1 = iColor1Red - (int)a_uiRadius;
 		if (iMinRed1 < 0)
@@ -875,9 +851,9 @@ namespace Etc
 			iMinBlue1 = 15;
 		}
 
-		int iColor2Red = m_frgbaOriginalColor2_TAndH.IntRed(15.0f);
-		int iColor2Green = m_frgbaOriginalColor2_TAndH.IntGreen(15.0f);
-		int iColor2Blue = m_frgbaOriginalColor2_TAndH.IntBlue(15.0f);
+		int iColor2Red = m_analysis.frgbaTAndHColor2.IntRed(15.0f);
+		int iColor2Green = m_analysis.frgbaTAndHColor2.IntGreen(15.0f);
+		int iColor2Blue = m_analysis.frgbaTAndHColor2.IntBlue(15.0f);
 
 		int iMinRed2 = iColor2Red - (int)a_uiRadius;
 		if (iMinRed2 < 0)
@@ -914,9 +890,9 @@ namespace Etc
 
 		for (unsigned int uiDistance = 0; uiDistance < TH_DISTANCES; uiDistance++)
 		{
-			encodingTry.m_uiCW1 = uiDistance;
+			candidate.uiCW1 = uiDistance;
 
-			// twiddle m_frgbaOriginalColor2_TAndH
+			// twiddle m_analysis.frgbaTAndHColor2
 			// twiddle color2 first, since it affects 3 selectors, while color1 only affects one selector
 			//
 			for (int iRed2 = iMinRed2; iRed2 <= iMaxRed2; iRed2++)
@@ -929,41 +905,27 @@ namespace Etc
 						{
 							if (uiBaseColorSwaps == 0)
 							{
-								encodingTry.m_frgbaColor1 = m_frgbaOriginalColor1_TAndH;
-								encodingTry.m_frgbaColor2 = ColorFloatRGBA::ConvertFromRGB4((unsigned char)iRed2, (unsigned char)iGreen2, (unsigned char)iBlue2);
+								candidate.frgbaColor1 = m_analysis.frgbaTAndHColor1;
+								candidate.frgbaColor2 = ColorFloatRGBA::ConvertFromRGB4((unsigned char)iRed2, (unsigned char)iGreen2, (unsigned char)iBlue2);
 							}
 							else
 							{
-								encodingTry.m_frgbaColor1 = ColorFloatRGBA::ConvertFromRGB4((unsigned char)iRed2, (unsigned char)iGreen2, (unsigned char)iBlue2);
-								encodingTry.m_frgbaColor2 = m_frgbaOriginalColor1_TAndH;
+								candidate.frgbaColor1 = ColorFloatRGBA::ConvertFromRGB4((unsigned char)iRed2, (unsigned char)iGreen2, (unsigned char)iBlue2);
+								candidate.frgbaColor2 = m_analysis.frgbaTAndHColor1;
 							}
 
-							encodingTry.TryT_BestSelectorCombination();
+							TryT_BestSelectorCombination(&candidate);
 
-							if (encodingTry.m_fError < m_fError)
+							if (candidate.fError < m_fError)
 							{
-								m_mode = encodingTry.m_mode;
-								m_boolDiff = encodingTry.m_boolDiff;
-								m_boolFlip = encodingTry.m_boolFlip;
-
-								m_frgbaColor1 = encodingTry.m_frgbaColor1;
-								m_frgbaColor2 = encodingTry.m_frgbaColor2;
-								m_uiCW1 = encodingTry.m_uiCW1;
-
-								for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
-								{
-									m_auiSelectors[uiPixel] = encodingTry.m_auiSelectors[uiPixel];
-									m_afrgbaDecodedColors[uiPixel] = encodingTry.m_afrgbaDecodedColors[uiPixel];
-								}
-
-								m_fError = encodingTry.m_fError;
+								CommitCandidate(candidate);
 							}
 						}
 					}
 				}
 			}
 
-			// twiddle m_frgbaOriginalColor1_TAndH
+			// twiddle m_analysis.frgbaTAndHColor1
 			for (int iRed1 = iMinRed1; iRed1 <= iMaxRed1; iRed1++)
 			{
 				for (int iGreen1 = iMinGreen1; iGreen1 <= iMaxGreen1; iGreen1++)
@@ -974,34 +936,20 @@ namespace Etc
 						{
 							if (uiBaseColorSwaps == 0)
 							{
-								encodingTry.m_frgbaColor1 = ColorFloatRGBA::ConvertFromRGB4((unsigned char)iRed1, (unsigned char)iGreen1, (unsigned char)iBlue1);
-								encodingTry.m_frgbaColor2 = m_frgbaOriginalColor2_TAndH;
+								candidate.frgbaColor1 = ColorFloatRGBA::ConvertFromRGB4((unsigned char)iRed1, (unsigned char)iGreen1, (unsigned char)iBlue1);
+								candidate.frgbaColor2 = m_analysis.frgbaTAndHColor2;
 							}
 							else
 							{
-								encodingTry.m_frgbaColor1 = m_frgbaOriginalColor2_TAndH;
-								encodingTry.m_frgbaColor2 = ColorFloatRGBA::ConvertFromRGB4((unsigned char)iRed1, (unsigned char)iGreen1, (unsigned char)iBlue1);
+								candidate.frgbaColor1 = m_analysis.frgbaTAndHColor2;
+								candidate.frgbaColor2 = ColorFloatRGBA::ConvertFromRGB4((unsigned char)iRed1, (unsigned char)iGreen1, (unsigned char)iBlue1);
 							}
 
-							encodingTry.TryT_BestSelectorCombination();
+							TryT_BestSelectorCombination(&candidate);
 
-							if (encodingTry.m_fError < m_fError)
+							if (candidate.fError < m_fError)
 							{
-								m_mode = encodingTry.m_mode;
-								m_boolDiff = encodingTry.m_boolDiff;
-								m_boolFlip = encodingTry.m_boolFlip;
-
-								m_frgbaColor1 = encodingTry.m_frgbaColor1;
-								m_frgbaColor2 = encodingTry.m_frgbaColor2;
-								m_uiCW1 = encodingTry.m_uiCW1;
-
-								for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
-								{
-									m_auiSelectors[uiPixel] = encodingTry.m_auiSelectors[uiPixel];
-									m_afrgbaDecodedColors[uiPixel] = encodingTry.m_afrgbaDecodedColors[uiPixel];
-								}
-
-								m_fError = encodingTry.m_fError;
+								CommitCandidate(candidate);
 							}
 						}
 					}
@@ -1014,67 +962,33 @@ namespace Etc
 
 	// ----------------------------------------------------------------------------------------------------
 	// find best selector combination for TryT
-	// called on an encodingTry
+	// keep the selectors and decoded colors in a_pcandidate if they improve its error
 	//
-	void Block4x4Encoding_RGB8A1::TryT_BestSelectorCombination(void)
+	void Block4x4Encoding_RGB8A1::TryT_BestSelectorCombination(Candidate *a_pcandidate)
 	{
 
-		float fDistance = s_afTHDistanceTable[m_uiCW1];
+		float fDistance = s_afTHDistanceTable[a_pcandidate->uiCW1];
 
-		unsigned int auiBestPixelSelectors[PIXELS];
-		float afBestPixelErrors[PIXELS] = { FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX,
-			FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX };
-		ColorFloatRGBA	afrgbaBestDecodedPixels[PIXELS];
 		ColorFloatRGBA afrgbaDecodedPixel[SELECTORS];
 
 		static_assert(SELECTORS == 4, "");
-		afrgbaDecodedPixel[0] = m_frgbaColor1;
-		afrgbaDecodedPixel[1] = (m_frgbaColor2 + fDistance).ClampRGB();
+		afrgbaDecodedPixel[0] = a_pcandidate->frgbaColor1;
+		afrgbaDecodedPixel[1] = (a_pcandidate->frgbaColor2 + fDistance).ClampRGB();
 		afrgbaDecodedPixel[2] = ColorFloatRGBA();
-		afrgbaDecodedPixel[3] = (m_frgbaColor2 - fDistance).ClampRGB();
-
-		// try each selector
-		for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
-		{
-			unsigned int uiMinSelector = 0;
-			unsigned int uiMaxSelector = SELECTORS - 1;
-
-			if (m_pafrgbaSource[uiPixel].fA < 0.5f)
-			{
-				uiMinSelector = 2;
-				uiMaxSelector = 2;
-			}
-
-			for (unsigned int uiSelector = uiMinSelector; uiSelector <= uiMaxSelector; uiSelector++)
-			{
-				float fPixelError = CalcPixelError(afrgbaDecodedPixel[uiSelector], m_afDecodedAlphas[uiPixel],
-													m_pafrgbaSource[uiPixel]);
+		afrgbaDecodedPixel[3] = (a_pcandidate->frgbaColor2 - fDistance).ClampRGB();
 
-				if (fPixelError < afBestPixelErrors[uiPixel])
-				{
-					afBestPixelErrors[uiPixel] = fPixelError;
-					auiBestPixelSelectors[uiPixel] = uiSelector;
-					afrgbaBestDecodedPixels[uiPixel] = afrgbaDecodedPixel[uiSelector];
-				}
-			}
-		}
-		
-
-		// add up all of the pixel errors
-		float fBlockError = 0.0f;
-		for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
-		{
-			fBlockError += afBestPixelErrors[uiPixel];
-		}
+		unsigned int auiBestPixelSelectors[PIXELS];
+		float fBlockError = m_pmetrickernels->pfnBestSelectors(afrgbaDecodedPixel, m_afDecodedAlphas, m_pafrgbaSource,
+																	true, auiBestPixelSelectors);
 
-		if (fBlockError < m_fError)
+		if (fBlockError < a_pcandidate->fError)
 		{
-			m_fError = fBlockError;
+			a_pcandidate->fError = fBlockError;
 
 			for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
 			{
-				m_auiSelectors[uiPixel] = auiBestPixelSelectors[uiPixel];
-				m_afrgbaDecodedColors[uiPixel] = afrgbaBestDecodedPixels[uiPixel];
+				a_pcandidate->auiSelectors[uiPixel] = auiBestPixelSelectors[uiPixel];
+				a_pcandidate->afrgbaDecodedColors[uiPixel] = afrgbaDecodedPixel[auiBestPixelSelectors[uiPixel]];
 			}
 		}
 
@@ -1089,19 +1003,13 @@ namespace Etc
 	//
 	void Block4x4Encoding_RGB8A1::TryH(unsigned int a_uiRadius)
 	{
-		Block4x4Encoding_RGB8A1 encodingTry = *this;
-
-		// init "try"
-		{
-			encodingTry.m_mode = MODE_H;
-			encodingTry.m_boolDiff = true;
-			encodingTry.m_boolFlip = false;
-			encodingTry.m_fError = FLT_MAX;
-		}
+		Candidate candidate;
+		candidate.mode = MODE_H;
+		candidate.fError = FLT_MAX;
 
-		int iColor1Red = m_frgbaOriginalColor1_TAndH.IntRed(15.0f);
-		int iColor1Green = m_frgbaOriginalColor1_TAndH.IntGreen(15.0f);
-		int iColor1Blue = m_frgbaOriginalColor1_TAndH.IntBlue(15.0f);
+		int iColor1Red = m_analysis.frgbaTAndHColor1.IntRed(15.0f);
+		int iColor1Green = m_analysis.frgbaTAndHColor1.IntGreen(15.0f);
+		int iColor1Blue = m_analysis.frgbaTAndHColor1.IntBlue(15.0f);
 
 		int iMinRed1 = iColor1Red - (int)a_uiRadius;
 		if (iMinRed1 < 0)
@@ -1136,9 +1044,9 @@ namespace Etc
 			iMinBlue1 = 15;
 		}
 
-		int iColor2Red = m_frgbaOriginalColor2_TAndH.IntRed(15.0f);
-		int iColor2Green = m_frgbaOriginalColor2_TAndH.IntGreen(15.0f);
-		int iColor2Blue = m_frgbaOriginalColor2_TAndH.IntBlue(15.0f);
+		int iColor2Red = m_analysis.frgbaTAndHColor2.IntRed(15.0f);
+		int iColor2Green = m_analysis.frgbaTAndHColor2.IntGreen(15.0f);
+		int iColor2Blue = m_analysis.frgbaTAndHColor2.IntBlue(15.0f);
 
 		int iMinRed2 = iColor2Red - (int)a_uiRadius;
 		if (iMinRed2 < 0)
@@ -1175,17 +1083,17 @@ namespace Etc
 
 		for (unsigned int uiDistance = 0; uiDistance < TH_DISTANCES; uiDistance++)
 		{
-			encodingTry.m_uiCW1 = uiDistance;
+			candidate.uiCW1 = uiDistance;
 
-			// twiddle m_frgbaOriginalColor1_TAndH
+			// twiddle m_analysis.frgbaTAndHColor1
 			for (int iRed1 = iMinRed1; iRed1 <= iMaxRed1; iRed1++)
 			{
 				for (int iGreen1 = iMinGreen1; iGreen1 <= iMaxGreen1; iGreen1++)
 				{
 					for (int iBlue1 = iMinBlue1; iBlue1 <= iMaxBlue1; iBlue1++)
 					{
-						encodingTry.m_frgbaColor1 = ColorFloatRGBA::ConvertFromRGB4((unsigned char)iRed1, (unsigned char)iGreen1, (unsigned char)iBlue1);
-						encodingTry.m_frgbaColor2 = m_frgbaOriginalColor2_TAndH;
+						candidate.frgbaColor1 = ColorFloatRGBA::ConvertFromRGB4((unsigned char)iRed1, (unsigned char)iGreen1, (unsigned char)iBlue1);
+						candidate.frgbaColor2 = m_analysis.frgbaTAndHColor2;
 
 						// if color1 == color2, H encoding issues can pop up, so abort
 						if (iRed1 == iColor2Red && iGreen1 == iColor2Green && iBlue1 == iColor2Blue)
@@ -1193,39 +1101,25 @@ namespace Etc
 							continue;
 						}
 
-						encodingTry.TryH_BestSelectorCombination();
+						TryH_BestSelectorCombination(&candidate);
 
-						if (encodingTry.m_fError < m_fError)
+						if (candidate.fError < m_fError)
 						{
-							m_mode = encodingTry.m_mode;
-							m_boolDiff = encodingTry.m_boolDiff;
-							m_boolFlip = encodingTry.m_boolFlip;
-
-							m_frgbaColor1 = encodingTry.m_frgbaColor1;
-							m_frgbaColor2 = encodingTry.m_frgbaColor2;
-							m_uiCW1 = encodingTry.m_uiCW1;
-
-							for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
-							{
-								m_auiSelectors[uiPixel] = encodingTry.m_auiSelectors[uiPixel];
-								m_afrgbaDecodedColors[uiPixel] = encodingTry.m_afrgbaDecodedColors[uiPixel];
-							}
-
-							m_fError = encodingTry.m_fError;
+							CommitCandidate(candidate);
 						}
 					}
 				}
 			}
 
-			// twiddle m_frgbaOriginalColor2_TAndH
+			// twiddle m_analysis.frgbaTAndHColor2
 			for (int iRed2 = iMinRed2; iRed2 <= iMaxRed2; iRed2++)
 			{
 				for (int iGreen2 = iMinGreen2; iGreen2 <= iMaxGreen2; iGreen2++)
 				{
 					for (int iBlue2 = iMinBlue2; iBlue2 <= iMaxBlue2; iBlue2++)
 					{
-						encodingTry.m_frgbaColor1 = m_frgbaOriginalColor1_TAndH;
-						encodingTry.m_frgbaColor2 = ColorFloatRGBA::ConvertFromRGB4((unsigned char)iRed2, (unsigned char)iGreen2, (unsigned char)iBlue2);
+						candidate.frgbaColor1 = m_analysis.frgbaTAndHColor1;
+						candidate.frgbaColor2 = ColorFloatRGBA::ConvertFromRGB4((unsigned char)iRed2, (unsigned char)iGreen2, (unsigned char)iBlue2);
 
 						// if color1 == color2, H encoding issues can pop up, so abort
 						if (iRed2 == iColor1Red && iGreen2 == iColor1Green && iBlue2 == iColor1Blue)
@@ -1233,25 +1127,11 @@ namespace Etc
 							continue;
 						}
 
-						encodingTry.TryH_BestSelectorCombination();
+						TryH_BestSelectorCombination(&candidate);
 
-						if (encodingTry.m_fError < m_fError)
+						if (candidate.fError < m_fError)
 						{
-							m_mode = encodingTry.m_mode;
-							m_boolDiff = encodingTry.m_boolDiff;
-							m_boolFlip = encodingTry.m_boolFlip;
-
-							m_frgbaColor1 = encodingTry.m_frgbaColor1;
-							m_frgbaColor2 = encodingTry.m_frgbaColor2;
-							m_uiCW1 = encodingTry.m_uiCW1;
-
-							for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
-							{
-								m_auiSelectors[uiPixel] = encodingTry.m_auiSelectors[uiPixel];
-								m_afrgbaDecodedColors[uiPixel] = encodingTry.m_afrgbaDecodedColors[uiPixel];
-							}
-
-							m_fError = encodingTry.m_fError;
+							CommitCandidate(candidate);
 						}
 					}
 				}
@@ -1263,24 +1143,24 @@ namespace Etc
 
 	// ----------------------------------------------------------------------------------------------------
 	// find best selector combination for TryH
-	// called on an encodingTry
+	// keep the selectors and decoded colors in a_pcandidate if they improve its error
 	//
-	void Block4x4Encoding_RGB8A1::TryH_BestSelectorCombination(void)
+	void Block4x4Encoding_RGB8A1::TryH_BestSelectorCombination(Candidate *a_pcandidate)
 	{
 
 		// abort if colors and CW will pose an encoding problem
 		{
-			unsigned int uiRed1 = (unsigned int)m_frgbaColor1.IntRed(255.0f);
-			unsigned int uiGreen1 = (unsigned int)m_frgbaColor1.IntGreen(255.0f);
-			unsigned int uiBlue1 = (unsigned int)m_frgbaColor1.IntBlue(255.0f);
+			unsigned int uiRed1 = (unsigned int)a_pcandidate->frgbaColor1.IntRed(255.0f);
+			unsigned int uiGreen1 = (unsigned int)a_pcandidate->frgbaColor1.IntGreen(255.0f);
+			unsigned int uiBlue1 = (unsigned int)a_pcandidate->frgbaColor1.IntBlue(255.0f);
 			unsigned int uiColorValue1 = (uiRed1 << 16) + (uiGreen1 << 8) + uiBlue1;
 
-			unsigned int uiRed2 = (unsigned int)m_frgbaColor2.IntRed(255.0f);
-			unsigned int uiGreen2 = (unsigned int)m_frgbaColor2.IntGreen(255.0f);
-			unsigned int uiBlue2 = (unsigned int)m_frgbaColor2.IntBlue(255.0f);
+			unsigned int uiRed2 = (unsigned int)a_pcandidate->frgbaColor2.IntRed(255.0f);
+			unsigned int uiGreen2 = (unsigned int)a_pcandidate->frgbaColor2.IntGreen(255.0f);
+			unsigned int uiBlue2 = (unsigned int)a_pcandidate->frgbaColor2.IntBlue(255.0f);
 			unsigned int uiColorValue2 = (uiRed2 << 16) + (uiGreen2 << 8) + uiBlue2;
 
-			unsigned int uiCWLsb = m_uiCW1 & 1;
+			unsigned int uiCWLsb = a_pcandidate->uiCW1 & 1;
 
 			if ((uiColorValue1 >= (uiColorValue2 & uiCWLsb)) == 0 ||
 				(uiColorValue1 < (uiColorValue2 & uiCWLsb)) == 1)
@@ -1289,63 +1169,29 @@ namespace Etc
 			}
 		}
 
-		float fDistance = s_afTHDistanceTable[m_uiCW1];
+		float fDistance = s_afTHDistanceTable[a_pcandidate->uiCW1];
 
-		unsigned int auiBestPixelSelectors[PIXELS];
-		float afBestPixelErrors[PIXELS] = { FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX,
-											FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX };
-		ColorFloatRGBA	afrgbaBestDecodedPixels[PIXELS];
 		ColorFloatRGBA afrgbaDecodedPixel[SELECTORS];
 
 		static_assert(SELECTORS == 4, "");
-		afrgbaDecodedPixel[0] = (m_frgbaColor1 + fDistance).ClampRGB();
-		afrgbaDecodedPixel[1] = (m_frgbaColor1 - fDistance).ClampRGB();
+		afrgbaDecodedPixel[0] = (a_pcandidate->frgbaColor1 + fDistance).ClampRGB();
+		afrgbaDecodedPixel[1] = (a_pcandidate->frgbaColor1 - fDistance).ClampRGB();
 		afrgbaDecodedPixel[2] = ColorFloatRGBA();;
-		afrgbaDecodedPixel[3] = (m_frgbaColor2 - fDistance).ClampRGB();
+		afrgbaDecodedPixel[3] = (a_pcandidate->frgbaColor2 - fDistance).ClampRGB();
 
 
-		// try each selector
-		for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
-		{
-			unsigned int uiMinSelector = 0;
-			unsigned int uiMaxSelector = SELECTORS - 1;
-
-			if (m_pafrgbaSource[uiPixel].fA < 0.5f)
-			{
-				uiMinSelector = 2;
-				uiMaxSelector = 2;
-			}
-
-			for (unsigned int uiSelector = uiMinSelector; uiSelector <= uiMaxSelector; uiSelector++)
-			{
-				float fPixelError = CalcPixelError(afrgbaDecodedPixel[uiSelector], m_afDecodedAlphas[uiPixel],
-													m_pafrgbaSource[uiPixel]);
-
-				if (fPixelError < afBestPixelErrors[uiPixel])
-				{
-					afBestPixelErrors[uiPixel] = fPixelError;
-					auiBestPixelSelectors[uiPixel] = uiSelector;
-					afrgbaBestDecodedPixels[uiPixel] = afrgbaDecodedPixel[uiSelector];
-				}
-			}
-		}
-		
-
-		// add up all of the pixel errors
-		float fBlockError = 0.0f;
-		for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
-		{
-			fBlockError += afBestPixelErrors[uiPixel];
-		}
+		unsigned int auiBestPixelSelectors[PIXELS];
+		float fBlockError = m_pmetrickernels->pfnBestSelectors(afrgbaDecodedPixel, m_afDecodedAlphas, m_pafrgbaSource,
+																	true, auiBestPixelSelectors);
 
-		if (fBlockError < m_fError)
+		if (fBlockError < a_pcandidate->fError)
 		{
-			m_fError = fBlockError;
+			a_pcandidate->fError = fBlockError;
 
 			for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
 			{
-				m_auiSelectors[uiPixel] = auiBestPixelSelectors[uiPixel];
-				m_afrgbaDecodedColors[uiPixel] = afrgbaBestDecodedPixels[uiPixel];
+				a_pcandidate->auiSelectors[uiPixel] = auiBestPixelSelectors[uiPixel];
+				a_pcandidate->afrgbaDecodedColors[uiPixel] = afrgbaDecodedPixel[auiBestPixelSelectors[uiPixel]];
 			}
 		}
 
@@ -1360,10 +1206,10 @@ namespace Etc
 	void Block4x4Encoding_RGB8A1::TryDegenerates1(void)
 	{
 
-		TryDifferential(m_boolMostLikelyFlip, 1, -2, 0);
-		TryDifferential(m_boolMostLikelyFlip, 1, 2, 0);
-		TryDifferential(m_boolMostLikelyFlip, 1, 0, 2);
-		TryDifferential(m_boolMostLikelyFlip, 1, 0, -2);
+		TryDifferential(m_analysis.boolMostLikelyFlip, 1, -2, 0);
+		TryDifferential(m_analysis.boolMostLikelyFlip, 1, 2, 0);
+		TryDifferential(m_analysis.boolMostLikelyFlip, 1, 0, 2);
+		TryDifferential(m_analysis.boolMostLikelyFlip, 1, 0, -2);
 
 	}
 
@@ -1376,10 +1222,10 @@ namespace Etc
 	void Block4x4Encoding_RGB8A1::TryDegenerates2(void)
 	{
 
-		TryDifferential(!m_boolMostLikelyFlip, 1, -2, 0);
-		TryDifferential(!m_boolMostLikelyFlip, 1, 2, 0);
-		TryDifferential(!m_boolMostLikelyFlip, 1, 0, 2);
-		TryDifferential(!m_boolMostLikelyFlip, 1, 0, -2);
+		TryDifferential(!m_analysis.boolMostLikelyFlip, 1, -2, 0);
+		TryDifferential(!m_analysis.boolMostLikelyFlip, 1, 2, 0);
+		TryDifferential(!m_analysis.boolMostLikelyFlip, 1, 0, 2);
+		TryDifferential(!m_analysis.boolMostLikelyFlip, 1, 0, -2);
 
 	}
 
@@ -1392,10 +1238,10 @@ namespace Etc
 	void Block4x4Encoding_RGB8A1::TryDegenerates3(void)
 	{
 
-		TryDifferential(m_boolMostLikelyFlip, 1, -2, -2);
-		TryDifferential(m_boolMostLikelyFlip, 1, -2, 2);
-		TryDifferential(m_boolMostLikelyFlip, 1, 2, -2);
-		TryDifferential(m_boolMostLikelyFlip, 1, 2, 2);
+		TryDifferential(m_analysis.boolMostLikelyFlip, 1, -2, -2);
+		TryDifferential(m_analysis.boolMostLikelyFlip, 1, -2, 2);
+		TryDifferential(m_analysis.boolMostLikelyFlip, 1, 2, -2);
+		TryDifferential(m_analysis.boolMostLikelyFlip, 1, 2, 2);
 
 	}
 
@@ -1408,10 +1254,10 @@ namespace Etc
 	void Block4x4Encoding_RGB8A1::TryDegenerates4(void)
 	{
 
-		TryDifferential(m_boolMostLikelyFlip, 1, -4, 0);
-		TryDifferential(m_boolMostLikelyFlip, 1, 4, 0);
-		TryDifferential(m_boolMostLikelyFlip, 1, 0, 4);
-		TryDifferential(m_boolMostLikelyFlip, 1, 0, -4);
+		TryDifferential(m_analysis.boolMostLikelyFlip, 1, -4, 0);
+		TryDifferential(m_analysis.boolMostLikelyFlip, 1, 4, 0);
+		TryDifferential(m_analysis.boolMostLikelyFlip, 1, 0, 4);
+		TryDifferential(m_analysis.boolMostLikelyFlip, 1, 0, -4);
 
 	}
 
@@ -1675,11 +1521,11 @@ namespace Etc
 			break;
 
 		case 1:
-			Block4x4Encoding_ETC1::TryDifferential(m_boolMostLikelyFlip, 1, 0, 0);
+			Block4x4Encoding_ETC1::TryDifferential(m_analysis.boolMostLikelyFlip, 1, 0, 0);
 			break;
 
 		case 2:
-			Block4x4Encoding_ETC1::TryDifferential(!m_boolMostLikelyFlip, 1, 0, 0);
+			Block4x4Encoding_ETC1::TryDifferential(!m_analysis.boolMostLikelyFlip, 1, 0, 0);
 			break;
 
 		case 3:
@@ -1749,17 +1595,17 @@ namespace Etc
 			m_fError += fDeltaA * fDeltaA;
 		}
 
-		CalculateMostLikelyFlip(a_errormetric);
+		AnalyzeSource(a_errormetric);
 
 		m_fError = FLT_MAX;
 
-		Block4x4Encoding_ETC1::TryDifferential(m_boolMostLikelyFlip, 0, 0, 0);
+		Block4x4Encoding_ETC1::TryDifferential(m_analysis.boolMostLikelyFlip, 0, 0, 0);
 		SetDoneIfPerfect();
 		if (m_boolDone)
 		{
 			return;
 		}
-		Block4x4Encoding_ETC1::TryDifferential(!m_boolMostLikelyFlip, 0, 0, 0);
+		Block4x4Encoding_ETC1::TryDifferential(!m_analysis.boolMostLikelyFlip, 0, 0, 0);
 		SetDoneIfPerfect();
 		if (m_boolDone)
 		{
@@ -1806,7 +1652,7 @@ namespace Etc
 		{
 			m_auiSelectors[uiPixel] = TRANSPARENT_SELECTOR;
 
-			m_afrgbaDecodedColors[uiPixel] = ColorFloatRGBA();
+			m_pafrgbaDecodedColors[uiPixel] = ColorFloatRGBA();
 			m_afDecodedAlphas[uiPixel] = 0.0f;
 		}
 
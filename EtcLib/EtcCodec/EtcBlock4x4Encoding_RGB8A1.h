@@ -51,6 +51,8 @@ namespace Etc
 
 		virtual void PerformIteration(Image::Format a_encoding, ErrorMetric a_errormetric, float a_fEffort) override;
 
+		virtual bool EncodeSolidColor(Image::Format a_encoding) override;
+
 		virtual void SetEncodingBits(Image::Format a_encoding) override;
 
 		void InitFromEncodingBits_ETC1(Block4x4 *a_pblockParent,
@@ -85,9 +87,9 @@ namespace Etc
 		void TryDifferentialHalf(DifferentialTrys::Half *a_phalf);
 
 		void TryT(unsigned int a_uiRadius);
-		void TryT_BestSelectorCombination(void);
+		void TryT_BestSelectorCombination(Candidate *a_pcandidate);
 		void TryH(unsigned int a_uiRadius);
-		void TryH_BestSelectorCombination(void);
+		void TryH_BestSelectorCombination(Candidate *a_pcandidate);
 
 		void TryDegenerates1(void);
 		void TryDegenerates2(void);
@@ -17,6 +17,7 @@
 #pragma once
 
 #include "EtcBlock4x4Encoding_RGB8.h"
+#include "EtcEacSearch.h"
 
 namespace Etc
 {
@@ -47,16 +48,15 @@ namespace Etc
 
 		virtual void PerformIteration(Image::Format a_encoding, ErrorMetric a_errormetric, float a_fEffort) override;
 
+		virtual bool EncodeSolidColor(Image::Format a_encoding) override;
+
 		virtual void SetEncodingBits(Image::Format a_encoding) override;
 
 	protected:
 
-		static const unsigned int MODIFIER_TABLE_ENTRYS = 16;
 		static const unsigned int ALPHA_SELECTOR_BITS = 3;
 		static const unsigned int ALPHA_SELECTORS = 1 << ALPHA_SELECTOR_BITS;
 
-		static float s_aafModifierTable[MODIFIER_TABLE_ENTRYS][ALPHA_SELECTORS];
-
 		void CalculateA8(float a_fRadius);
 
 		Block4x4EncodingBits_A8 *m_pencodingbitsA8;	// A8 portion of Block4x4EncodingBits_RGBA8
@@ -72,7 +72,7 @@ namespace Etc
 										unsigned int a_uiTableIndex, unsigned int a_uiSelector)
 		{
 			float fPixelAlpha = a_fBase + 
-								a_fMultiplier*s_aafModifierTable[a_uiTableIndex][a_uiSelector];
+								a_fMultiplier*EacModifierTable::s_aafModifiers[a_uiTableIndex][a_uiSelector];
 			if (fPixelAlpha < 0.0f)
 			{
 				fPixelAlpha = 0.0f;
@@ -98,6 +98,8 @@ namespace Etc
 
 		virtual void PerformIteration(Image::Format a_encoding, ErrorMetric a_errormetric, float a_fEffort) override;
 
+		virtual bool EncodeSolidColor(Image::Format a_encoding) override;
+
 		virtual void SetEncodingBits(Image::Format a_encoding) override;
 
 	};
@@ -113,6 +115,12 @@ namespace Etc
 
 		virtual void PerformIteration(Image::Format a_encoding, ErrorMetric a_errormetric, float a_fEffort) override;
 
+		// the first iteration is already a shortcut
+		virtual bool EncodeSolidColor(Image::Format) override
+		{
+			return false;
+		}
+
 		virtual void SetEncodingBits(Image::Format a_encoding) override;
 
 	};
@@ -0,0 +1,169 @@
+/*
+ * Copyright 2015 The Etc2Comp Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+EtcBlockAnalysis.cpp
+
+BlockAnalysis holds the features of a block that the encoders derive from its source pixels:
+color statistics, the ETC1 half block averages and flip, the planar fit and the T and H base colors.
+
+The ETC1 based encoders fill it during their first iteration, when each feature is first needed,
+and read it in later iterations.  The features only depend on the source pixels and the error metric,
+so reading them gives the same encoding as calculating them again.
+
+*/
+
+#include "EtcConfig.h"
+#include "EtcBlockAnalysis.h"
+
+#include <cfloat>
+#include <cmath>
+
+namespace Etc
+{
+
+	// ----------------------------------------------------------------------------------------------------
+	//
+	void BlockAnalysis::Reset(void)
+	{
+		boolColorStatistics = false;
+		boolHalfAverages = false;
+		boolMostLikelyFlip = false;
+		boolPlanarCornerColors = false;
+		boolTAndHBaseColors = false;
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// min, max, mean and covariance of the RGB of the pixels that aren't border pixels
+	// the principal axis is the covariance's eigenvector with the largest eigenvalue, found by power iteration
+	//
+	void BlockAnalysis::CalculateColorStatistics(const ColorFloatRGBA *a_pafrgbaSource)
+	{
+		static const unsigned int POWER_ITERATIONS = 8;
+
+		uiPixels = 0;
+		frgbaMin = ColorFloatRGBA(FLT_MAX, FLT_MAX, FLT_MAX, 0.0f);
+		frgbaMax = ColorFloatRGBA(-FLT_MAX, -FLT_MAX, -FLT_MAX, 0.0f);
+		frgbaMean = ColorFloatRGBA(0.0f, 0.0f, 0.0f, 0.0f);
+		for (unsigned int uiCovariance = 0; uiCovariance < 6; uiCovariance++)
+		{
+			afCovariance[uiCovariance] = 0.0f;
+		}
+		frgbaPrincipalAxis = ColorFloatRGBA(0.0f, 0.0f, 0.0f, 0.0f);
+
+		boolColorStatistics = true;
+
+		for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
+		{
+			const ColorFloatRGBA &frgbaPixel = a_pafrgbaSource[uiPixel];
+
+			// if a border pixel
+			if (std::isnan(frgbaPixel.fA))
+			{
+				continue;
+			}
+
+			frgbaMin.fR = fminf(frgbaMin.fR, frgbaPixel.fR);
+			frgbaMin.fG = fminf(frgbaMin.fG, frgbaPixel.fG);
+			frgbaMin.fB = fminf(frgbaMin.fB, frgbaPixel.fB);
+			frgbaMax.fR = fmaxf(frgbaMax.fR, frgbaPixel.fR);
+			frgbaMax.fG = fmaxf(frgbaMax.fG, frgbaPixel.fG);
+			frgbaMax.fB = fmaxf(frgbaMax.fB, frgbaPixel.fB);
+
+			frgbaMean.fR += frgbaPixel.fR;
+			frgbaMean.fG += frgbaPixel.fG;
+			frgbaMean.fB += frgbaPixel.fB;
+
+			uiPixels++;
+		}
+
+		if (uiPixels == 0)
+		{
+			frgbaMin = ColorFloatRGBA(0.0f, 0.0f, 0.0f, 0.0f);
+			frgbaMax = ColorFloatRGBA(0.0f, 0.0f, 0.0f, 0.0f);
+			return;
+		}
+
+		float fInversePixels = 1.0f / (float)uiPixels;
+		frgbaMean.fR *= fInversePixels;
+		frgbaMean.fG *= fInversePixels;
+		frgbaMean.fB *= fInversePixels;
+
+		for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
+		{
+			const ColorFloatRGBA &frgbaPixel = a_pafrgbaSource[uiPixel];
+
+			if (std::isnan(frgbaPixel.fA))
+			{
+				continue;
+			}
+
+			float fDR = frgbaPixel.fR - frgbaMean.fR;
+			float fDG = frgbaPixel.fG - frgbaMean.fG;
+			float fDB = frgbaPixel.fB - frgbaMean.fB;
+
+			afCovariance[0] += fDR * fDR;
+			afCovariance[1] += fDR * fDG;
+			afCovariance[2] += fDR * fDB;
+			afCovariance[3] += fDG * fDG;
+			afCovariance[4] += fDG * fDB;
+			afCovariance[5] += fDB * fDB;
+		}
+
+		for (unsigned int uiCovariance = 0; uiCovariance < 6; uiCovariance++)
+		{
+			afCovariance[uiCovariance] *= fInversePixels;
+		}
+
+		// start with the covariance column of the channel that varies most
+		// unlike the bounding box diagonal, it can't be perpendicular to the principal axis
+		float fAxisR = afCovariance[0];
+		float fAxisG = afCovariance[1];
+		float fAxisB = afCovariance[2];
+		if (afCovariance[3] > afCovariance[0] && afCovariance[3] >= afCovariance[5])
+		{
+			fAxisR = afCovariance[1];
+			fAxisG = afCovariance[3];
+			fAxisB = afCovariance[4];
+		}
+		else if (afCovariance[5] > afCovariance[0] && afCovariance[5] > afCovariance[3])
+		{
+			fAxisR = afCovariance[2];
+			fAxisG = afCovariance[4];
+			fAxisB = afCovariance[5];
+		}
+
+		for (unsigned int uiIteration = 0; uiIteration < POWER_ITERATIONS; uiIteration++)
+		{
+			float fR = afCovariance[0] * fAxisR + afCovariance[1] * fAxisG + afCovariance[2] * fAxisB;
+			float fG = afCovariance[1] * fAxisR + afCovariance[3] * fAxisG + afCovariance[4] * fAxisB;
+			float fB = afCovariance[2] * fAxisR + afCovariance[4] * fAxisG + afCovariance[5] * fAxisB;
+
+			float fLength = sqrtf(fR*fR + fG*fG + fB*fB);
+			if (fLength == 0.0f)
+			{
+				return;
+			}
+
+			fAxisR = fR / fLength;
+			fAxisG = fG / fLength;
+			fAxisB = fB / fLength;
+		}
+
+		frgbaPrincipalAxis = ColorFloatRGBA(fAxisR, fAxisG, fAxisB, 0.0f);
+	}
+
+} // namespace Etc
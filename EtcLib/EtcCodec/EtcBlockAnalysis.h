@@ -0,0 +1,82 @@
+/*
+ * Copyright 2015 The Etc2Comp Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "EtcColorFloatRGBA.h"
+
+namespace Etc
+{
+
+	// ################################################################################
+	// BlockAnalysis
+	// features of a block's source pixels, calculated once by an encoder's first iteration
+	// later iterations read them instead of calculating them again
+	// ################################################################################
+
+	struct BlockAnalysis
+	{
+		static const unsigned int PIXELS = 16;
+		static const unsigned int PLANAR_CORNER_COLORS = 3;
+
+		BlockAnalysis(void)
+		{
+			Reset();
+		}
+
+		// mark every feature as not calculated
+		void Reset(void);
+
+		// calculate the color statistics of the RGB of the pixels that aren't border pixels
+		void CalculateColorStatistics(const ColorFloatRGBA *a_pafrgbaSource);
+
+		// calculate the color statistics unless an earlier iteration already did
+		inline void NeedColorStatistics(const ColorFloatRGBA *a_pafrgbaSource)
+		{
+			if (!boolColorStatistics)
+			{
+				CalculateColorStatistics(a_pafrgbaSource);
+			}
+		}
+
+		// color statistics, only calculated for the searches that read them, see NeedColorStatistics()
+		bool			boolColorStatistics;
+		unsigned int	uiPixels;					// pixels that aren't border pixels
+		ColorFloatRGBA	frgbaMin;
+		ColorFloatRGBA	frgbaMax;
+		ColorFloatRGBA	frgbaMean;
+		float			afCovariance[6];			// RR, RG, RB, GG, GB, BB
+		ColorFloatRGBA	frgbaPrincipalAxis;			// unit length RGB, 0 if all pixels have the same color
+
+		// ETC1 half block averages, alpha weighted unless the block is opaque, and the flip they suggest
+		bool			boolHalfAverages;
+		ColorFloatRGBA	frgbaAverageLeft;
+		ColorFloatRGBA	frgbaAverageRight;
+		ColorFloatRGBA	frgbaAverageTop;
+		ColorFloatRGBA	frgbaAverageBottom;
+		bool			boolMostLikelyFlip;
+
+		// planar fit, quantized to 6/7/6
+		bool			boolPlanarCornerColors;
+		ColorFloatRGBA	afrgbaPlanarCornerColors[PLANAR_CORNER_COLORS];		// origin, horizontal, vertical
+
+		// T and H base colors found by clustering, quantized to 4/4/4
+		bool			boolTAndHBaseColors;
+		ColorFloatRGBA	frgbaTAndHColor1;
+		ColorFloatRGBA	frgbaTAndHColor2;
+	};
+
+} // namespace Etc
@@ -0,0 +1,1168 @@
+/*
+ * Copyright 2015 The Etc2Comp Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+EtcBlockError.cpp
+
+Block error kernels, one per error metric, picked once instead of branching on the metric for every pixel.
+
+The SSE4.1 kernels transpose 4 pixels at a time into R, G, B and A lanes and evaluate the same operations
+as the scalar metric in the same order, so that every pixel error is bit identical.
+The pixel errors are then added up in pixel order, again like the scalar code.
+
+The best selector kernels do the same for the 4 selector colors of the T and H modes,
+keeping the lowest error per pixel with vector compares and blends.
+The half selector kernels do the same for the 8 pixels of an ETC1 half block, gathered through its pixel mapping.
+
+The half error bounds are scalar in every kernel. The selector colors of a base color all lie on the
+clamped gray line through it, so the differences between their channels only take a small range of values,
+a single value if they don't clamp. Source pixels whose channel differences are away from that value
+have an error of at least the distance to it, whatever the modifier and selector.
+
+The EAC selector kernels do the same for the 8 selector values of one A8, R11 or G11 channel.
+The squared error kernels don't depend on the error metric. They are used by the A8 search and the fast R11/G11 fit.
+The metric kernels replace the red or green of the source pixels and compare with the error metric, like the
+exhaustive R11/G11 search.
+
+*/
+
+#include "EtcConfig.h"
+#include "EtcBlockError.h"
+
+#include <cfloat>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define ETC_BLOCK_ERROR_SSE41 1
+#include <smmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define ETC_TARGET_SSE41
+#else
+#define ETC_TARGET_SSE41 __attribute__((target("sse4.1")))
+#endif
+#endif
+
+namespace Etc
+{
+	static const unsigned int PIXELS = Block4x4Encoding::PIXELS;
+	static const unsigned int HALF_PIXELS = PIXELS / 2;
+	static const unsigned int SELECTORS = 4;
+	static const unsigned int TRANSPARENT_SELECTOR = 2;
+	static const unsigned int EAC_SELECTORS = 8;
+
+	// ----------------------------------------------------------------------------------------------------
+	// scalar kernel
+	//
+	template <ErrorMetric M>
+	static float CalcBlockErrorScalar(const ColorFloatRGBA *a_pafrgbaDecodedColors,
+										const float *a_pafDecodedAlphas,
+										const ColorFloatRGBA *a_pafrgbaSource)
+	{
+		float fError = 0.0f;
+
+		for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
+		{
+			// if a border pixel
+			if (std::isnan(a_pafrgbaSource[uiPixel].fA))
+			{
+				fError += 0.0f;
+				continue;
+			}
+
+			fError += CalcPixelErrorForMetric<M>(a_pafrgbaDecodedColors[uiPixel], a_pafDecodedAlphas[uiPixel],
+													a_pafrgbaSource[uiPixel]);
+		}
+
+		return fError;
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// scalar best selectors
+	//
+	template <ErrorMetric M>
+	static float FindBestSelectorsScalar(const ColorFloatRGBA *a_pafrgbaSelectorColors,
+											const float *a_pafDecodedAlphas,
+											const ColorFloatRGBA *a_pafrgbaSource,
+											bool a_boolPunchThrough,
+											unsigned int *a_pauiSelectors)
+	{
+		float afBestPixelErrors[PIXELS];
+
+		for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
+		{
+			afBestPixelErrors[uiPixel] = FLT_MAX;
+			a_pauiSelectors[uiPixel] = 0;
+
+			unsigned int uiMinSelector = 0;
+			unsigned int uiMaxSelector = SELECTORS - 1;
+
+			if (a_boolPunchThrough && a_pafrgbaSource[uiPixel].fA < 0.5f)
+			{
+				uiMinSelector = TRANSPARENT_SELECTOR;
+				uiMaxSelector = TRANSPARENT_SELECTOR;
+			}
+
+			for (unsigned int uiSelector = uiMinSelector; uiSelector <= uiMaxSelector; uiSelector++)
+			{
+				// border pixels have no error
+				float fPixelError = 0.0f;
+				if (!std::isnan(a_pafrgbaSource[uiPixel].fA))
+				{
+					fPixelError = CalcPixelErrorForMetric<M>(a_pafrgbaSelectorColors[uiSelector], a_pafDecodedAlphas[uiPixel],
+																a_pafrgbaSource[uiPixel]);
+				}
+
+				if (fPixelError < afBestPixelErrors[uiPixel])
+				{
+					afBestPixelErrors[uiPixel] = fPixelError;
+					a_pauiSelectors[uiPixel] = uiSelector;
+				}
+			}
+		}
+
+		float fError = 0.0f;
+		for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
+		{
+			fError += afBestPixelErrors[uiPixel];
+		}
+
+		return fError;
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// scalar half selectors
+	//
+	template <ErrorMetric M>
+	static float FindHalfSelectorsScalar(const ColorFloatRGBA *a_pafrgbaSelectorColors,
+											const float *a_pafDecodedAlphas,
+											const ColorFloatRGBA *a_pafrgbaSource,
+											const unsigned int *a_pauiPixelMapping,
+											bool a_boolPunchThrough,
+											unsigned int *a_pauiSelectors)
+	{
+		float afBestPixelErrors[HALF_PIXELS];
+
+		for (unsigned int uiPixel = 0; uiPixel < HALF_PIXELS; uiPixel++)
+		{
+			const ColorFloatRGBA &frgbaSourcePixel = a_pafrgbaSource[a_pauiPixelMapping[uiPixel]];
+			float fDecodedAlpha = a_pafDecodedAlphas[a_pauiPixelMapping[uiPixel]];
+
+			afBestPixelErrors[uiPixel] = FLT_MAX;
+			a_pauiSelectors[uiPixel] = 0;
+
+			bool boolTransparent = a_boolPunchThrough && frgbaSourcePixel.fA < 0.5f;
+
+			for (unsigned int uiSelector = 0; uiSelector < SELECTORS; uiSelector++)
+			{
+				if (a_boolPunchThrough && (uiSelector == TRANSPARENT_SELECTOR) != boolTransparent)
+				{
+					continue;
+				}
+
+				// border pixels have no error
+				float fPixelError = 0.0f;
+				if (!std::isnan(frgbaSourcePixel.fA))
+				{
+					fPixelError = CalcPixelErrorForMetric<M>(a_pafrgbaSelectorColors[uiSelector], fDecodedAlpha,
+																frgbaSourcePixel);
+				}
+
+				if (fPixelError < afBestPixelErrors[uiPixel])
+				{
+					afBestPixelErrors[uiPixel] = fPixelError;
+					a_pauiSelectors[uiPixel] = uiSelector;
+				}
+			}
+		}
+
+		float fError = 0.0f;
+		for (unsigned int uiPixel = 0; uiPixel < HALF_PIXELS; uiPixel++)
+		{
+			fError += afBestPixelErrors[uiPixel];
+		}
+
+		return fError;
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// the error bounds compare features of a color that are linear in its channel differences
+	// a pixel's error is at least the weighted sum of the squared differences of its source and decoded features
+	// for the squared RGB metrics, |d|^2 >= ((dR - dG)^2 + (dG - dB)^2 + (dB - dR)^2) / 3 for any d
+	// for REC709, the features are the chromas, which are weighted sums of the channel differences
+	// the metrics that scale colors by alpha scale the features by alpha too
+	//
+	template <ErrorMetric M>
+	struct BoundFeatures
+	{
+		static constexpr bool ALPHA_SCALED = (M == ErrorMetric::RGBA);
+		static constexpr bool ALPHA_ERROR = (M != ErrorMetric::NUMERIC);
+
+		static inline float Weight(unsigned int)
+		{
+			return 1.0f / 3.0f;
+		}
+
+		static inline void Calculate(const ColorFloatRGBA &a_frgba, float *a_pafFeatures)
+		{
+			a_pafFeatures[0] = a_frgba.fR - a_frgba.fG;
+			a_pafFeatures[1] = a_frgba.fG - a_frgba.fB;
+			a_pafFeatures[2] = a_frgba.fB - a_frgba.fR;
+		}
+	};
+
+	template <>
+	struct BoundFeatures<ErrorMetric::REC709>
+	{
+		static constexpr bool ALPHA_SCALED = true;
+		static constexpr bool ALPHA_ERROR = true;
+
+		static inline float Weight(unsigned int a_uiFeature)
+		{
+			static const float s_afWeights[HALF_ERROR_BOUND_FEATURES] = { 1.0f, Block4x4Encoding::CHROMA_BLUE_WEIGHT, 0.0f };
+			return s_afWeights[a_uiFeature];
+		}
+
+		// the chromas, as calculated by the metric
+		static inline void Calculate(const ColorFloatRGBA &a_frgba, float *a_pafFeatures)
+		{
+			float fLuma = a_frgba.fR*0.2126f + a_frgba.fG*0.7152f + a_frgba.fB*0.0722f;
+			a_pafFeatures[0] = 0.5f * ((a_frgba.fR - fLuma) * (1.0f / (1.0f - 0.2126f)));
+			a_pafFeatures[1] = 0.5f * ((a_frgba.fB - fLuma) * (1.0f / (1.0f - 0.0722f)));
+			a_pafFeatures[2] = 0.0f;
+		}
+	};
+
+	// ----------------------------------------------------------------------------------------------------
+	// half error bound statistics, used by every kernel
+	// the means are weighted by the decoded weights w (the decoded alphas or 1), so that
+	// sum((w * f - s)^2) = W * (f - mean)^2 + spread, with W = sum(w^2), for the decoded and source features f and s
+	//
+	template <ErrorMetric M>
+	static void CalcHalfErrorBoundStatistics(const float *a_pafDecodedAlphas,
+												const ColorFloatRGBA *a_pafrgbaSource,
+												const unsigned int *a_pauiPixelMapping,
+												HalfErrorBoundStatistics *a_pstatistics)
+	{
+		typedef BoundFeatures<M> Features;
+
+		float aafSourceFeatures[HALF_PIXELS][HALF_ERROR_BOUND_FEATURES];
+		float afDecodedWeights[HALF_PIXELS];
+		unsigned int uiPixels = 0;
+
+		a_pstatistics->fWeights2 = 0.0f;
+		a_pstatistics->fSpreadError = 0.0f;
+		a_pstatistics->fAlphaError = 0.0f;
+		for (unsigned int uiFeature = 0; uiFeature < HALF_ERROR_BOUND_FEATURES; uiFeature++)
+		{
+			a_pstatistics->afMeans[uiFeature] = 0.0f;
+		}
+
+		// the normal metric isn't bounded by the channel differences
+		if (M == ErrorMetric::NORMALXYZ)
+		{
+			return;
+		}
+
+		for (unsigned int uiPixel = 0; uiPixel < HALF_PIXELS; uiPixel++)
+		{
+			const ColorFloatRGBA &frgbaSourcePixel = a_pafrgbaSource[a_pauiPixelMapping[uiPixel]];
+			float fDecodedAlpha = a_pafDecodedAlphas[a_pauiPixelMapping[uiPixel]];
+
+			// border pixels have no error
+			if (std::isnan(frgbaSourcePixel.fA))
+			{
+				continue;
+			}
+
+			Features::Calculate(frgbaSourcePixel, aafSourceFeatures[uiPixels]);
+			afDecodedWeights[uiPixels] = 1.0f;
+			if (Features::ALPHA_SCALED)
+			{
+				for (unsigned int uiFeature = 0; uiFeature < HALF_ERROR_BOUND_FEATURES; uiFeature++)
+				{
+					aafSourceFeatures[uiPixels][uiFeature] *= frgbaSourcePixel.fA;
+				}
+				afDecodedWeights[uiPixels] = fDecodedAlpha;
+			}
+			if (Features::ALPHA_ERROR)
+			{
+				float fDAlpha = fDecodedAlpha - frgbaSourcePixel.fA;
+				a_pstatistics->fAlphaError += fDAlpha * fDAlpha;
+			}
+
+			a_pstatistics->fWeights2 += afDecodedWeights[uiPixels] * afDecodedWeights[uiPixels];
+			for (unsigned int uiFeature = 0; uiFeature < HALF_ERROR_BOUND_FEATURES; uiFeature++)
+			{
+				a_pstatistics->afMeans[uiFeature] += afDecodedWeights[uiPixels] * aafSourceFeatures[uiPixels][uiFeature];
+			}
+
+			uiPixels++;
+		}
+
+		for (unsigned int uiFeature = 0; uiFeature < HALF_ERROR_BOUND_FEATURES; uiFeature++)
+		{
+			if (a_pstatistics->fWeights2 > 0.0f)
+			{
+				a_pstatistics->afMeans[uiFeature] /= a_pstatistics->fWeights2;
+			}
+
+			float fSpread = 0.0f;
+			for (unsigned int uiPixel = 0; uiPixel < uiPixels; uiPixel++)
+			{
+				float fDelta = aafSourceFeatures[uiPixel][uiFeature] - afDecodedWeights[uiPixel] * a_pstatistics->afMeans[uiFeature];
+				fSpread += fDelta * fDelta;
+			}
+
+			a_pstatistics->fSpreadError += Features::Weight(uiFeature) * fSpread;
+		}
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// half error bounds, used by every kernel
+	// if the modifiers don't clamp, all selector colors have the features of the base color
+	// else only the alpha error is bounded, bounding the clamped features costs more than the CWs it skips
+	//
+	template <ErrorMetric M>
+	static void CalcHalfErrorBounds(const HalfErrorBoundStatistics &a_statistics,
+									const ColorFloatRGBA &a_frgbaBaseColor,
+									const float *a_pafMaxModifiers, unsigned int a_uiModifiers,
+									float *a_pafErrorBounds)
+	{
+		typedef BoundFeatures<M> Features;
+
+		// leaves room for the rounding of the exact errors and of the bounds
+		static const float RELATIVE_MARGIN = 1.0f / 1024.0f;
+		static const float ABSOLUTE_MARGIN = 1.0f / (1024.0f * 1024.0f);
+
+		if (M == ErrorMetric::NORMALXYZ)
+		{
+			for (unsigned int uiModifier = 0; uiModifier < a_uiModifiers; uiModifier++)
+			{
+				a_pafErrorBounds[uiModifier] = 0.0f;
+			}
+			return;
+		}
+
+		float afBaseFeatures[HALF_ERROR_BOUND_FEATURES];
+		Features::Calculate(a_frgbaBaseColor, afBaseFeatures);
+
+		float fUnclampedError = a_statistics.fSpreadError;
+		for (unsigned int uiFeature = 0; uiFeature < HALF_ERROR_BOUND_FEATURES; uiFeature++)
+		{
+			float fDelta = afBaseFeatures[uiFeature] - a_statistics.afMeans[uiFeature];
+			fUnclampedError += Features::Weight(uiFeature) * a_statistics.fWeights2 * fDelta * fDelta;
+		}
+		fUnclampedError += a_statistics.fAlphaError;
+
+		float fMinChannel = fminf(fminf(a_frgbaBaseColor.fR, a_frgbaBaseColor.fG), a_frgbaBaseColor.fB);
+		float fMaxChannel = fmaxf(fmaxf(a_frgbaBaseColor.fR, a_frgbaBaseColor.fG), a_frgbaBaseColor.fB);
+
+		for (unsigned int uiModifier = 0; uiModifier < a_uiModifiers; uiModifier++)
+		{
+			assert(a_pafMaxModifiers[uiModifier] >= 0.0f);
+
+			float fError = fUnclampedError;
+
+			if (fMinChannel - a_pafMaxModifiers[uiModifier] < 0.0f || fMaxChannel + a_pafMaxModifiers[uiModifier] > 1.0f)
+			{
+				fError = a_statistics.fAlphaError;
+			}
+
+			a_pafErrorBounds[uiModifier] = fError * (1.0f - RELATIVE_MARGIN) - ABSOLUTE_MARGIN;
+		}
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// scalar EAC selectors
+	//
+	static float FindEacSelectorsScalar(const float *a_pafSelectorValues,
+										const float *a_pafSource,
+										const float *a_pafWeights,
+										unsigned int *a_pauiSelectors)
+	{
+		float fError = 0.0f;
+
+		for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
+		{
+			float fBestPixelError = FLT_MAX;
+			a_pauiSelectors[uiPixel] = 0;
+
+			for (unsigned int uiSelector = 0; uiSelector < EAC_SELECTORS; uiSelector++)
+			{
+				float fDelta = a_pafSelectorValues[uiSelector] - a_pafSource[uiPixel];
+				float fPixelError = fDelta * fDelta * a_pafWeights[uiPixel];
+
+				if (fPixelError < fBestPixelError)
+				{
+					fBestPixelError = fPixelError;
+					a_pauiSelectors[uiPixel] = uiSelector;
+				}
+			}
+
+			fError += fBestPixelError;
+		}
+
+		return fError;
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// scalar EAC metric selectors
+	//
+	template <ErrorMetric M>
+	static float FindEacMetricSelectorsScalar(const float *a_pafSelectorValues,
+												const ColorFloatRGBA *a_pafrgbaSource,
+												unsigned int a_uiChannel,
+												unsigned int *a_pauiSelectors)
+	{
+		float fError = 0.0f;
+
+		for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
+		{
+			float fBestPixelError = FLT_MAX;
+			a_pauiSelectors[uiPixel] = 0;
+
+			for (unsigned int uiSelector = 0; uiSelector < EAC_SELECTORS; uiSelector++)
+			{
+				// border pixels have no error
+				float fPixelError = 0.0f;
+				if (!std::isnan(a_pafrgbaSource[uiPixel].fA))
+				{
+					ColorFloatRGBA frgbaDecoded(a_pafrgbaSource[uiPixel].fR, a_pafrgbaSource[uiPixel].fG, 0.0f, 1.0f);
+					if (a_uiChannel == 0)
+					{
+						frgbaDecoded.fR = a_pafSelectorValues[uiSelector];
+					}
+					else
+					{
+						frgbaDecoded.fG = a_pafSelectorValues[uiSelector];
+					}
+
+					fPixelError = CalcPixelErrorForMetric<M>(frgbaDecoded, 1.0f, a_pafrgbaSource[uiPixel]);
+				}
+
+				if (fPixelError < fBestPixelError)
+				{
+					fBestPixelError = fPixelError;
+					a_pauiSelectors[uiPixel] = uiSelector;
+				}
+			}
+
+			fError += fBestPixelError;
+		}
+
+		return fError;
+	}
+
+#if ETC_BLOCK_ERROR_SSE41
+
+	// 4 pixels in SoA form
+	struct PixelLanes
+	{
+		__m128 r;
+		__m128 g;
+		__m128 b;
+		__m128 a;
+	};
+
+	ETC_TARGET_SSE41 static inline PixelLanes LoadPixelLanes(const ColorFloatRGBA *a_pafrgba)
+	{
+		PixelLanes lanes;
+		lanes.r = _mm_loadu_ps(&a_pafrgba[0].fR);
+		lanes.g = _mm_loadu_ps(&a_pafrgba[1].fR);
+		lanes.b = _mm_loadu_ps(&a_pafrgba[2].fR);
+		lanes.a = _mm_loadu_ps(&a_pafrgba[3].fR);
+		_MM_TRANSPOSE4_PS(lanes.r, lanes.g, lanes.b, lanes.a);
+		return lanes;
+	}
+
+	ETC_TARGET_SSE41 static inline PixelLanes LoadMappedPixelLanes(const ColorFloatRGBA *a_pafrgba,
+																	const unsigned int *a_pauiPixelMapping)
+	{
+		PixelLanes lanes;
+		lanes.r = _mm_loadu_ps(&a_pafrgba[a_pauiPixelMapping[0]].fR);
+		lanes.g = _mm_loadu_ps(&a_pafrgba[a_pauiPixelMapping[1]].fR);
+		lanes.b = _mm_loadu_ps(&a_pafrgba[a_pauiPixelMapping[2]].fR);
+		lanes.a = _mm_loadu_ps(&a_pafrgba[a_pauiPixelMapping[3]].fR);
+		_MM_TRANSPOSE4_PS(lanes.r, lanes.g, lanes.b, lanes.a);
+		return lanes;
+	}
+
+	ETC_TARGET_SSE41 static inline PixelLanes BroadcastPixel(const ColorFloatRGBA &a_frgba)
+	{
+		PixelLanes lanes;
+		lanes.r = _mm_set1_ps(a_frgba.fR);
+		lanes.g = _mm_set1_ps(a_frgba.fG);
+		lanes.b = _mm_set1_ps(a_frgba.fB);
+		lanes.a = _mm_set1_ps(a_frgba.fA);
+		return lanes;
+	}
+
+	ETC_TARGET_SSE41 static inline __m128 Square(__m128 a_v)
+	{
+		return _mm_mul_ps(a_v, a_v);
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// SSE4.1 versions of CalcPixelErrorForMetric()
+	// the operations and their order follow the scalar code exactly
+	//
+	template <ErrorMetric M>
+	static __m128 CalcPixelErrorsSSE41(const PixelLanes &a_decoded, __m128 a_decodedAlpha, const PixelLanes &a_source);
+
+	template <>
+	ETC_TARGET_SSE41 inline __m128 CalcPixelErrorsSSE41<ErrorMetric::RGBA>(const PixelLanes &a_decoded, __m128 a_decodedAlpha,
+																			const PixelLanes &a_source)
+	{
+		__m128 dRed = _mm_sub_ps(_mm_mul_ps(a_decodedAlpha, a_decoded.r), _mm_mul_ps(a_source.a, a_source.r));
+		__m128 dGreen = _mm_sub_ps(_mm_mul_ps(a_decodedAlpha, a_decoded.g), _mm_mul_ps(a_source.a, a_source.g));
+		__m128 dBlue = _mm_sub_ps(_mm_mul_ps(a_decodedAlpha, a_decoded.b), _mm_mul_ps(a_source.a, a_source.b));
+		__m128 dAlpha = _mm_sub_ps(a_decodedAlpha, a_source.a);
+
+		return _mm_add_ps(_mm_add_ps(_mm_add_ps(Square(dRed), Square(dGreen)), Square(dBlue)), Square(dAlpha));
+	}
+
+	template <>
+	ETC_TARGET_SSE41 inline __m128 CalcPixelErrorsSSE41<ErrorMetric::RGBX>(const PixelLanes &a_decoded, __m128 a_decodedAlpha,
+																			const PixelLanes &a_source)
+	{
+		__m128 dRed = _mm_sub_ps(a_decoded.r, a_source.r);
+		__m128 dGreen = _mm_sub_ps(a_decoded.g, a_source.g);
+		__m128 dBlue = _mm_sub_ps(a_decoded.b, a_source.b);
+		__m128 dAlpha = _mm_sub_ps(a_decodedAlpha, a_source.a);
+
+		return _mm_add_ps(_mm_add_ps(_mm_add_ps(Square(dRed), Square(dGreen)), Square(dBlue)), Square(dAlpha));
+	}
+
+	template <>
+	ETC_TARGET_SSE41 inline __m128 CalcPixelErrorsSSE41<ErrorMetric::REC709>(const PixelLanes &a_decoded, __m128 a_decodedAlpha,
+																				const PixelLanes &a_source)
+	{
+		const __m128 lumaR = _mm_set1_ps(0.2126f);
+		const __m128 lumaG = _mm_set1_ps(0.7152f);
+		const __m128 lumaB = _mm_set1_ps(0.0722f);
+		const __m128 half = _mm_set1_ps(0.5f);
+		const __m128 chromaRScale = _mm_set1_ps(1.0f / (1.0f - 0.2126f));
+		const __m128 chromaBScale = _mm_set1_ps(1.0f / (1.0f - 0.0722f));
+
+		__m128 luma1 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a_source.r, lumaR), _mm_mul_ps(a_source.g, lumaG)),
+									_mm_mul_ps(a_source.b, lumaB));
+		__m128 chromaR1 = _mm_mul_ps(half, _mm_mul_ps(_mm_sub_ps(a_source.r, luma1), chromaRScale));
+		__m128 chromaB1 = _mm_mul_ps(half, _mm_mul_ps(_mm_sub_ps(a_source.b, luma1), chromaBScale));
+
+		__m128 luma2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a_decoded.r, lumaR), _mm_mul_ps(a_decoded.g, lumaG)),
+									_mm_mul_ps(a_decoded.b, lumaB));
+		__m128 chromaR2 = _mm_mul_ps(half, _mm_mul_ps(_mm_sub_ps(a_decoded.r, luma2), chromaRScale));
+		__m128 chromaB2 = _mm_mul_ps(half, _mm_mul_ps(_mm_sub_ps(a_decoded.b, luma2), chromaBScale));
+
+		__m128 deltaL = _mm_sub_ps(_mm_mul_ps(a_source.a, luma1), _mm_mul_ps(a_decodedAlpha, luma2));
+		__m128 deltaCr = _mm_sub_ps(_mm_mul_ps(a_source.a, chromaR1), _mm_mul_ps(a_decodedAlpha, chromaR2));
+		__m128 deltaCb = _mm_sub_ps(_mm_mul_ps(a_source.a, chromaB1), _mm_mul_ps(a_decodedAlpha, chromaB2));
+
+		__m128 dAlpha = _mm_sub_ps(a_decodedAlpha, a_source.a);
+
+		__m128 lumaError = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(Block4x4Encoding::LUMA_WEIGHT), deltaL), deltaL);
+		__m128 chromaBError = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(Block4x4Encoding::CHROMA_BLUE_WEIGHT), deltaCb), deltaCb);
+
+		return _mm_add_ps(_mm_add_ps(_mm_add_ps(lumaError, Square(deltaCr)), chromaBError), Square(dAlpha));
+	}
+
+	template <>
+	ETC_TARGET_SSE41 inline __m128 CalcPixelErrorsSSE41<ErrorMetric::NORMALXYZ>(const PixelLanes &a_decoded, __m128,
+																				const PixelLanes &a_source)
+	{
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 two = _mm_set1_ps(2.0f);
+		const __m128 half = _mm_set1_ps(0.5f);
+
+		__m128 decodedX = _mm_sub_ps(_mm_mul_ps(two, a_decoded.r), one);
+		__m128 decodedY = _mm_sub_ps(_mm_mul_ps(two, a_decoded.g), one);
+		__m128 decodedZ = _mm_sub_ps(_mm_mul_ps(two, a_decoded.b), one);
+
+		__m128 decodedLength = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(Square(decodedX), Square(decodedY)), Square(decodedZ)));
+
+		// decoded normals shorter than 0.5 have an error of 1, which also covers a length of 0
+		__m128 shortDecoded = _mm_cmplt_ps(decodedLength, half);
+
+		decodedX = _mm_div_ps(decodedX, decodedLength);
+		decodedY = _mm_div_ps(decodedY, decodedLength);
+		decodedZ = _mm_div_ps(decodedZ, decodedLength);
+
+		__m128 sourceX = _mm_sub_ps(_mm_mul_ps(two, a_source.r), one);
+		__m128 sourceY = _mm_sub_ps(_mm_mul_ps(two, a_source.g), one);
+		__m128 sourceZ = _mm_sub_ps(_mm_mul_ps(two, a_source.b), one);
+
+		__m128 sourceLength = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(Square(sourceX), Square(sourceY)), Square(sourceZ)));
+		__m128 zeroSource = _mm_cmpeq_ps(sourceLength, zero);
+
+		sourceX = _mm_blendv_ps(_mm_div_ps(sourceX, sourceLength), one, zeroSource);
+		sourceY = _mm_blendv_ps(_mm_div_ps(sourceY, sourceLength), zero, zeroSource);
+		sourceZ = _mm_blendv_ps(_mm_div_ps(sourceZ, sourceLength), zero, zeroSource);
+
+		__m128 dotProduct = _mm_add_ps(_mm_add_ps(_mm_mul_ps(sourceX, decodedX), _mm_mul_ps(sourceY, decodedY)),
+										_mm_mul_ps(sourceZ, decodedZ));
+		__m128 normalizedDotProduct = _mm_sub_ps(one, _mm_mul_ps(half, _mm_add_ps(dotProduct, one)));
+		__m128 dotProductError = Square(normalizedDotProduct);
+
+		__m128 length2 = _mm_add_ps(_mm_add_ps(Square(decodedX), Square(decodedY)), Square(decodedZ));
+		__m128 length2Error = _mm_andnot_ps(_mm_set1_ps(-0.0f), _mm_sub_ps(one, length2));
+
+		__m128 errorW = Square(_mm_sub_ps(a_decoded.a, a_source.a));
+
+		__m128 error = _mm_add_ps(_mm_add_ps(dotProductError, length2Error), errorW);
+
+		return _mm_blendv_ps(error, one, shortDecoded);
+	}
+
+	template <>
+	ETC_TARGET_SSE41 inline __m128 CalcPixelErrorsSSE41<ErrorMetric::NUMERIC>(const PixelLanes &a_decoded, __m128,
+																				const PixelLanes &a_source)
+	{
+		__m128 dX = _mm_sub_ps(a_decoded.r, a_source.r);
+		__m128 dY = _mm_sub_ps(a_decoded.g, a_source.g);
+		__m128 dZ = _mm_sub_ps(a_decoded.b, a_source.b);
+		__m128 dW = _mm_sub_ps(a_decoded.a, a_source.a);
+
+		return _mm_add_ps(_mm_add_ps(_mm_add_ps(Square(dX), Square(dY)), Square(dZ)), Square(dW));
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// SSE4.1 kernel
+	//
+	template <ErrorMetric M>
+	ETC_TARGET_SSE41 static float CalcBlockErrorSSE41(const ColorFloatRGBA *a_pafrgbaDecodedColors,
+														const float *a_pafDecodedAlphas,
+														const ColorFloatRGBA *a_pafrgbaSource)
+	{
+		float afPixelErrors[PIXELS];
+
+		for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel += 4)
+		{
+			PixelLanes decoded = LoadPixelLanes(&a_pafrgbaDecodedColors[uiPixel]);
+			PixelLanes source = LoadPixelLanes(&a_pafrgbaSource[uiPixel]);
+			__m128 decodedAlpha = _mm_loadu_ps(&a_pafDecodedAlphas[uiPixel]);
+
+			__m128 errors = CalcPixelErrorsSSE41<M>(decoded, decodedAlpha, source);
+
+			// border pixels have a source alpha of NAN
+			errors = _mm_blendv_ps(errors, _mm_setzero_ps(), _mm_cmpunord_ps(source.a, source.a));
+
+			_mm_storeu_ps(&afPixelErrors[uiPixel], errors);
+		}
+
+		// sum in pixel order, like the scalar kernel
+		float fError = 0.0f;
+		for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
+		{
+			fError += afPixelErrors[uiPixel];
+		}
+
+		return fError;
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// SSE4.1 best selectors
+	// each selector color is compared against 4 pixels at a time
+	//
+	template <ErrorMetric M>
+	ETC_TARGET_SSE41 static float FindBestSelectorsSSE41(const ColorFloatRGBA *a_pafrgbaSelectorColors,
+															const float *a_pafDecodedAlphas,
+															const ColorFloatRGBA *a_pafrgbaSource,
+															bool a_boolPunchThrough,
+															unsigned int *a_pauiSelectors)
+	{
+		PixelLanes aselectorcolors[SELECTORS];
+		for (unsigned int uiSelector = 0; uiSelector < SELECTORS; uiSelector++)
+		{
+			aselectorcolors[uiSelector] = BroadcastPixel(a_pafrgbaSelectorColors[uiSelector]);
+		}
+
+		float afBestPixelErrors[PIXELS];
+
+		for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel += 4)
+		{
+			PixelLanes source = LoadPixelLanes(&a_pafrgbaSource[uiPixel]);
+			__m128 decodedAlpha = _mm_loadu_ps(&a_pafDecodedAlphas[uiPixel]);
+
+			// border pixels have a source alpha of NAN
+			__m128 border = _mm_cmpunord_ps(source.a, source.a);
+			__m128 transparent = a_boolPunchThrough ? _mm_cmplt_ps(source.a, _mm_set1_ps(0.5f)) : _mm_setzero_ps();
+
+			__m128 bestErrors = _mm_set1_ps(FLT_MAX);
+			__m128 bestSelectors = _mm_setzero_ps();
+
+			for (unsigned int uiSelector = 0; uiSelector < SELECTORS; uiSelector++)
+			{
+				__m128 errors = CalcPixelErrorsSSE41<M>(aselectorcolors[uiSelector], decodedAlpha, source);
+				errors = _mm_blendv_ps(errors, _mm_setzero_ps(), border);
+
+				__m128 better = _mm_cmplt_ps(errors, bestErrors);
+				if (uiSelector != TRANSPARENT_SELECTOR)
+				{
+					better = _mm_andnot_ps(transparent, better);
+				}
+
+				bestErrors = _mm_blendv_ps(bestErrors, errors, better);
+				bestSelectors = _mm_blendv_ps(bestSelectors, _mm_set1_ps((float)uiSelector), better);
+			}
+
+			_mm_storeu_ps(&afBestPixelErrors[uiPixel], bestErrors);
+			_mm_storeu_si128((__m128i *)&a_pauiSelectors[uiPixel], _mm_cvttps_epi32(bestSelectors));
+		}
+
+		// sum in pixel order, like the scalar kernel
+		float fError = 0.0f;
+		for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
+		{
+			fError += afBestPixelErrors[uiPixel];
+		}
+
+		return fError;
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// SSE4.1 half selectors
+	// like the SSE4.1 best selectors, with the 4 pixels of a lane group gathered through the pixel mapping
+	//
+	template <ErrorMetric M>
+	ETC_TARGET_SSE41 static float FindHalfSelectorsSSE41(const ColorFloatRGBA *a_pafrgbaSelectorColors,
+															const float *a_pafDecodedAlphas,
+															const ColorFloatRGBA *a_pafrgbaSource,
+															const unsigned int *a_pauiPixelMapping,
+															bool a_boolPunchThrough,
+															unsigned int *a_pauiSelectors)
+	{
+		PixelLanes aselectorcolors[SELECTORS];
+		for (unsigned int uiSelector = 0; uiSelector < SELECTORS; uiSelector++)
+		{
+			aselectorcolors[uiSelector] = BroadcastPixel(a_pafrgbaSelectorColors[uiSelector]);
+		}
+
+		float afBestPixelErrors[HALF_PIXELS];
+
+		for (unsigned int uiPixel = 0; uiPixel < HALF_PIXELS; uiPixel += 4)
+		{
+			const unsigned int *pauiPixelMapping = &a_pauiPixelMapping[uiPixel];
+
+			PixelLanes source = LoadMappedPixelLanes(a_pafrgbaSource, pauiPixelMapping);
+			__m128 decodedAlpha = _mm_setr_ps(a_pafDecodedAlphas[pauiPixelMapping[0]],
+												a_pafDecodedAlphas[pauiPixelMapping[1]],
+												a_pafDecodedAlphas[pauiPixelMapping[2]],
+												a_pafDecodedAlphas[pauiPixelMapping[3]]);
+
+			// border pixels have a source alpha of NAN
+			__m128 border = _mm_cmpunord_ps(source.a, source.a);
+			__m128 transparent = _mm_cmplt_ps(source.a, _mm_set1_ps(0.5f));
+
+			__m128 bestErrors = _mm_set1_ps(FLT_MAX);
+			__m128 bestSelectors = _mm_setzero_ps();
+
+			for (unsigned int uiSelector = 0; uiSelector < SELECTORS; uiSelector++)
+			{
+				__m128 errors = CalcPixelErrorsSSE41<M>(aselectorcolors[uiSelector], decodedAlpha, source);
+				errors = _mm_blendv_ps(errors, _mm_setzero_ps(), border);
+
+				__m128 better = _mm_cmplt_ps(errors, bestErrors);
+				if (a_boolPunchThrough)
+				{
+					better = (uiSelector == TRANSPARENT_SELECTOR) ? _mm_and_ps(transparent, better)
+																	: _mm_andnot_ps(transparent, better);
+				}
+
+				bestErrors = _mm_blendv_ps(bestErrors, errors, better);
+				bestSelectors = _mm_blendv_ps(bestSelectors, _mm_set1_ps((float)uiSelector), better);
+			}
+
+			_mm_storeu_ps(&afBestPixelErrors[uiPixel], bestErrors);
+			_mm_storeu_si128((__m128i *)&a_pauiSelectors[uiPixel], _mm_cvttps_epi32(bestSelectors));
+		}
+
+		// sum in mapping order, like the scalar kernel
+		float fError = 0.0f;
+		for (unsigned int uiPixel = 0; uiPixel < HALF_PIXELS; uiPixel++)
+		{
+			fError += afBestPixelErrors[uiPixel];
+		}
+
+		return fError;
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// SSE4.1 EAC selectors
+	// 4 pixels per lane group, the 8 selector values are broadcast one at a time
+	//
+	ETC_TARGET_SSE41 static float FindEacSelectorsSSE41(const float *a_pafSelectorValues,
+														const float *a_pafSource,
+														const float *a_pafWeights,
+														unsigned int *a_pauiSelectors)
+	{
+		float afBestPixelErrors[PIXELS];
+
+		for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel += 4)
+		{
+			__m128 source = _mm_loadu_ps(&a_pafSource[uiPixel]);
+			__m128 weights = _mm_loadu_ps(&a_pafWeights[uiPixel]);
+
+			__m128 bestErrors = _mm_set1_ps(FLT_MAX);
+			__m128 bestSelectors = _mm_setzero_ps();
+
+			for (unsigned int uiSelector = 0; uiSelector < EAC_SELECTORS; uiSelector++)
+			{
+				__m128 delta = _mm_sub_ps(_mm_set1_ps(a_pafSelectorValues[uiSelector]), source);
+				__m128 errors = _mm_mul_ps(_mm_mul_ps(delta, delta), weights);
+
+				__m128 better = _mm_cmplt_ps(errors, bestErrors);
+				bestErrors = _mm_blendv_ps(bestErrors, errors, better);
+				bestSelectors = _mm_blendv_ps(bestSelectors, _mm_set1_ps((float)uiSelector), better);
+			}
+
+			_mm_storeu_ps(&afBestPixelErrors[uiPixel], bestErrors);
+			_mm_storeu_si128((__m128i *)&a_pauiSelectors[uiPixel], _mm_cvttps_epi32(bestSelectors));
+		}
+
+		// sum in pixel order, like the scalar kernel
+		float fError = 0.0f;
+		for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
+		{
+			fError += afBestPixelErrors[uiPixel];
+		}
+
+		return fError;
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// SSE4.1 EAC metric selectors
+	//
+	template <ErrorMetric M>
+	ETC_TARGET_SSE41 static float FindEacMetricSelectorsSSE41(const float *a_pafSelectorValues,
+																const ColorFloatRGBA *a_pafrgbaSource,
+																unsigned int a_uiChannel,
+																unsigned int *a_pauiSelectors)
+	{
+		float afBestPixelErrors[PIXELS];
+
+		__m128 decodedAlpha = _mm_set1_ps(1.0f);
+
+		for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel += 4)
+		{
+			PixelLanes source = LoadPixelLanes(&a_pafrgbaSource[uiPixel]);
+
+			// border pixels have a source alpha of NAN
+			__m128 border = _mm_cmpunord_ps(source.a, source.a);
+
+			PixelLanes decoded;
+			decoded.r = source.r;
+			decoded.g = source.g;
+			decoded.b = _mm_setzero_ps();
+			decoded.a = decodedAlpha;
+
+			__m128 bestErrors = _mm_set1_ps(FLT_MAX);
+			__m128 bestSelectors = _mm_setzero_ps();
+
+			for (unsigned int uiSelector = 0; uiSelector < EAC_SELECTORS; uiSelector++)
+			{
+				if (a_uiChannel == 0)
+				{
+					decoded.r = _mm_set1_ps(a_pafSelectorValues[uiSelector]);
+				}
+				else
+				{
+					decoded.g = _mm_set1_ps(a_pafSelectorValues[uiSelector]);
+				}
+
+				__m128 errors = CalcPixelErrorsSSE41<M>(decoded, decodedAlpha, source);
+				errors = _mm_blendv_ps(errors, _mm_setzero_ps(), border);
+
+				__m128 better = _mm_cmplt_ps(errors, bestErrors);
+				bestErrors = _mm_blendv_ps(bestErrors, errors, better);
+				bestSelectors = _mm_blendv_ps(bestSelectors, _mm_set1_ps((float)uiSelector), better);
+			}
+
+			_mm_storeu_ps(&afBestPixelErrors[uiPixel], bestErrors);
+			_mm_storeu_si128((__m128i *)&a_pauiSelectors[uiPixel], _mm_cvttps_epi32(bestSelectors));
+		}
+
+		// sum in pixel order, like the scalar kernel
+		float fError = 0.0f;
+		for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
+		{
+			fError += afBestPixelErrors[uiPixel];
+		}
+
+		return fError;
+	}
+
+	static bool CpuSupportsSSE41(void)
+	{
+#if defined(_MSC_VER)
+		int aiCpuInfo[4];
+		__cpuid(aiCpuInfo, 1);
+		return (aiCpuInfo[2] & (1 << 19)) != 0;
+#else
+		return __builtin_cpu_supports("sse4.1");
+#endif
+	}
+
+#endif
+
+	// ----------------------------------------------------------------------------------------------------
+	//
+	template <template <ErrorMetric> class Kernel, ErrorMetric M>
+	static MetricKernels MakeMetricKernels(void)
+	{
+		return { Kernel<M>::BlockError, Kernel<M>::BestSelectors, Kernel<M>::EacMetricSelectors,
+					Kernel<M>::HalfSelectors, CalcHalfErrorBoundStatistics<M>, CalcHalfErrorBounds<M> };
+	}
+
+	template <template <ErrorMetric> class Kernel>
+	static MetricKernels SelectMetric(ErrorMetric a_errormetric)
+	{
+		switch (a_errormetric)
+		{
+		case ErrorMetric::RGBA:
+			return MakeMetricKernels<Kernel, ErrorMetric::RGBA>();
+		case ErrorMetric::RGBX:
+			return MakeMetricKernels<Kernel, ErrorMetric::RGBX>();
+		case ErrorMetric::REC709:
+			return MakeMetricKernels<Kernel, ErrorMetric::REC709>();
+		case ErrorMetric::NUMERIC:
+			return MakeMetricKernels<Kernel, ErrorMetric::NUMERIC>();
+		case ErrorMetric::NORMALXYZ:
+			return MakeMetricKernels<Kernel, ErrorMetric::NORMALXYZ>();
+		default:
+			assert(0);
+			return { nullptr, nullptr, nullptr, nullptr, nullptr, nullptr };
+		}
+	}
+
+	template <ErrorMetric M>
+	struct ScalarKernel
+	{
+		static constexpr BlockErrorFunction BlockError = CalcBlockErrorScalar<M>;
+		static constexpr BestSelectorsFunction BestSelectors = FindBestSelectorsScalar<M>;
+		static constexpr EacMetricSelectorsFunction EacMetricSelectors = FindEacMetricSelectorsScalar<M>;
+		static constexpr HalfSelectorsFunction HalfSelectors = FindHalfSelectorsScalar<M>;
+	};
+
+#if ETC_BLOCK_ERROR_SSE41
+	template <ErrorMetric M>
+	struct SSE41Kernel
+	{
+		static constexpr BlockErrorFunction BlockError = CalcBlockErrorSSE41<M>;
+		static constexpr BestSelectorsFunction BestSelectors = FindBestSelectorsSSE41<M>;
+		static constexpr EacMetricSelectorsFunction EacMetricSelectors = FindEacMetricSelectorsSSE41<M>;
+		static constexpr HalfSelectorsFunction HalfSelectors = FindHalfSelectorsSSE41<M>;
+	};
+#endif
+
+	// ----------------------------------------------------------------------------------------------------
+	// the functions of a kernel, or nullptrs if the CPU or the build doesn't support it
+	//
+	static MetricKernels GetKernelFunctions(ErrorMetric a_errormetric, BlockErrorKernel a_kernel)
+	{
+		switch (a_kernel)
+		{
+		case BlockErrorKernel::SCALAR:
+			return SelectMetric<ScalarKernel>(a_errormetric);
+
+#if ETC_BLOCK_ERROR_SSE41
+		case BlockErrorKernel::SSE41:
+			if (CpuSupportsSSE41())
+			{
+				return SelectMetric<SSE41Kernel>(a_errormetric);
+			}
+			return { nullptr, nullptr, nullptr, nullptr, nullptr, nullptr };
+#endif
+
+		default:
+			return { nullptr, nullptr, nullptr, nullptr, nullptr, nullptr };
+		}
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// the EAC selectors function of a kernel, or nullptr if the CPU or the build doesn't support it
+	//
+	static EacSelectorsFunction GetEacSelectorsKernel(BlockErrorKernel a_kernel)
+	{
+		switch (a_kernel)
+		{
+		case BlockErrorKernel::SCALAR:
+			return FindEacSelectorsScalar;
+
+#if ETC_BLOCK_ERROR_SSE41
+		case BlockErrorKernel::SSE41:
+			if (CpuSupportsSSE41())
+			{
+				return FindEacSelectorsSSE41;
+			}
+			return nullptr;
+#endif
+
+		default:
+			return nullptr;
+		}
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// the functions used by the encoders, for each error metric
+	// starts out with the fastest kernel this CPU supports
+	//
+	class KernelTable
+	{
+	public:
+
+		KernelTable(void)
+		{
+			if (!Select(BlockErrorKernel::SSE41))
+			{
+				Select(BlockErrorKernel::SCALAR);
+			}
+		}
+
+		bool Select(BlockErrorKernel a_kernel)
+		{
+			MetricKernels afunctions[ErrorMetric::ERROR_METRICS];
+			for (int iMetric = 0; iMetric < ErrorMetric::ERROR_METRICS; iMetric++)
+			{
+				afunctions[iMetric] = GetKernelFunctions((ErrorMetric)iMetric, a_kernel);
+				if (afunctions[iMetric].pfnBlockError == nullptr)
+				{
+					return false;
+				}
+			}
+
+			EacSelectorsFunction pfnEacSelectors = GetEacSelectorsKernel(a_kernel);
+			if (pfnEacSelectors == nullptr)
+			{
+				return false;
+			}
+
+			for (int iMetric = 0; iMetric < ErrorMetric::ERROR_METRICS; iMetric++)
+			{
+				m_afunctions[iMetric] = afunctions[iMetric];
+			}
+			m_pfnEacSelectors = pfnEacSelectors;
+			return true;
+		}
+
+		inline const MetricKernels &Get(ErrorMetric a_errormetric) const
+		{
+			assert(a_errormetric >= 0 && a_errormetric < ErrorMetric::ERROR_METRICS);
+			return m_afunctions[a_errormetric];
+		}
+
+		inline EacSelectorsFunction GetEacSelectors(void) const
+		{
+			return m_pfnEacSelectors;
+		}
+
+	private:
+
+		MetricKernels m_afunctions[ErrorMetric::ERROR_METRICS];
+		EacSelectorsFunction m_pfnEacSelectors;
+	};
+
+	static KernelTable &GetKernelTable(void)
+	{
+		static KernelTable s_kerneltable;
+		return s_kerneltable;
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	//
+	const MetricKernels &GetMetricKernels(ErrorMetric a_errormetric)
+	{
+		return GetKernelTable().Get(a_errormetric);
+	}
+
+	BlockErrorFunction GetBlockErrorFunction(ErrorMetric a_errormetric)
+	{
+		return GetKernelTable().Get(a_errormetric).pfnBlockError;
+	}
+
+	BestSelectorsFunction GetBestSelectorsFunction(ErrorMetric a_errormetric)
+	{
+		return GetKernelTable().Get(a_errormetric).pfnBestSelectors;
+	}
+
+	EacMetricSelectorsFunction GetEacMetricSelectorsFunction(ErrorMetric a_errormetric)
+	{
+		return GetKernelTable().Get(a_errormetric).pfnEacMetricSelectors;
+	}
+
+	HalfSelectorsFunction GetHalfSelectorsFunction(ErrorMetric a_errormetric)
+	{
+		return GetKernelTable().Get(a_errormetric).pfnHalfSelectors;
+	}
+
+	HalfErrorBoundStatisticsFunction GetHalfErrorBoundStatisticsFunction(ErrorMetric a_errormetric)
+	{
+		return GetKernelTable().Get(a_errormetric).pfnHalfErrorBoundStatistics;
+	}
+
+	HalfErrorBoundsFunction GetHalfErrorBoundsFunction(ErrorMetric a_errormetric)
+	{
+		return GetKernelTable().Get(a_errormetric).pfnHalfErrorBounds;
+	}
+
+	EacSelectorsFunction GetEacSelectorsFunction(void)
+	{
+		return GetKernelTable().GetEacSelectors();
+	}
+
+	BlockErrorFunction GetBlockErrorFunction(ErrorMetric a_errormetric, BlockErrorKernel a_kernel)
+	{
+		return GetKernelFunctions(a_errormetric, a_kernel).pfnBlockError;
+	}
+
+	BestSelectorsFunction GetBestSelectorsFunction(ErrorMetric a_errormetric, BlockErrorKernel a_kernel)
+	{
+		return GetKernelFunctions(a_errormetric, a_kernel).pfnBestSelectors;
+	}
+
+	EacMetricSelectorsFunction GetEacMetricSelectorsFunction(ErrorMetric a_errormetric, BlockErrorKernel a_kernel)
+	{
+		return GetKernelFunctions(a_errormetric, a_kernel).pfnEacMetricSelectors;
+	}
+
+	HalfSelectorsFunction GetHalfSelectorsFunction(ErrorMetric a_errormetric, BlockErrorKernel a_kernel)
+	{
+		return GetKernelFunctions(a_errormetric, a_kernel).pfnHalfSelectors;
+	}
+
+	HalfErrorBoundStatisticsFunction GetHalfErrorBoundStatisticsFunction(ErrorMetric a_errormetric, BlockErrorKernel a_kernel)
+	{
+		return GetKernelFunctions(a_errormetric, a_kernel).pfnHalfErrorBoundStatistics;
+	}
+
+	HalfErrorBoundsFunction GetHalfErrorBoundsFunction(ErrorMetric a_errormetric, BlockErrorKernel a_kernel)
+	{
+		return GetKernelFunctions(a_errormetric, a_kernel).pfnHalfErrorBounds;
+	}
+
+	EacSelectorsFunction GetEacSelectorsFunction(BlockErrorKernel a_kernel)
+	{
+		return GetEacSelectorsKernel(a_kernel);
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	//
+	bool SetBlockErrorKernel(BlockErrorKernel a_kernel)
+	{
+		return GetKernelTable().Select(a_kernel);
+	}
+
+} // namespace Etc
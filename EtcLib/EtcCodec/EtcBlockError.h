@@ -0,0 +1,312 @@
+/*
+ * Copyright 2015 The Etc2Comp Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "EtcBlock4x4Encoding.h"
+
+#include <cassert>
+#include <cmath>
+
+namespace Etc
+{
+	// ----------------------------------------------------------------------------------------------------
+	// error between a source pixel and a decoded pixel for one error metric
+	// the source pixel must not be a border pixel (source alpha of NAN)
+	//
+	template <ErrorMetric M>
+	float CalcPixelErrorForMetric(const ColorFloatRGBA &a_frgbaDecodedColor, float a_fDecodedAlpha,
+									const ColorFloatRGBA &a_frgbaSourcePixel);
+
+	template <>
+	inline float CalcPixelErrorForMetric<ErrorMetric::RGBA>(const ColorFloatRGBA &a_frgbaDecodedColor, float a_fDecodedAlpha,
+															const ColorFloatRGBA &a_frgbaSourcePixel)
+	{
+		assert(a_fDecodedAlpha >= 0.0f);
+
+		float fDRed = (a_fDecodedAlpha * a_frgbaDecodedColor.fR) -
+						(a_frgbaSourcePixel.fA * a_frgbaSourcePixel.fR);
+		float fDGreen = (a_fDecodedAlpha * a_frgbaDecodedColor.fG) -
+						(a_frgbaSourcePixel.fA * a_frgbaSourcePixel.fG);
+		float fDBlue = (a_fDecodedAlpha * a_frgbaDecodedColor.fB) -
+						(a_frgbaSourcePixel.fA * a_frgbaSourcePixel.fB);
+
+		float fDAlpha = a_fDecodedAlpha - a_frgbaSourcePixel.fA;
+
+		return fDRed*fDRed + fDGreen*fDGreen + fDBlue*fDBlue + fDAlpha*fDAlpha;
+	}
+
+	template <>
+	inline float CalcPixelErrorForMetric<ErrorMetric::RGBX>(const ColorFloatRGBA &a_frgbaDecodedColor, float a_fDecodedAlpha,
+															const ColorFloatRGBA &a_frgbaSourcePixel)
+	{
+		assert(a_fDecodedAlpha >= 0.0f);
+
+		float fDRed = a_frgbaDecodedColor.fR - a_frgbaSourcePixel.fR;
+		float fDGreen = a_frgbaDecodedColor.fG - a_frgbaSourcePixel.fG;
+		float fDBlue = a_frgbaDecodedColor.fB - a_frgbaSourcePixel.fB;
+		float fDAlpha = a_fDecodedAlpha - a_frgbaSourcePixel.fA;
+
+		return fDRed*fDRed + fDGreen*fDGreen + fDBlue*fDBlue + fDAlpha*fDAlpha;
+	}
+
+	template <>
+	inline float CalcPixelErrorForMetric<ErrorMetric::REC709>(const ColorFloatRGBA &a_frgbaDecodedColor, float a_fDecodedAlpha,
+																const ColorFloatRGBA &a_frgbaSourcePixel)
+	{
+		assert(a_fDecodedAlpha >= 0.0f);
+
+		float fLuma1 = a_frgbaSourcePixel.fR*0.2126f + a_frgbaSourcePixel.fG*0.7152f + a_frgbaSourcePixel.fB*0.0722f;
+		float fChromaR1 = 0.5f * ((a_frgbaSourcePixel.fR - fLuma1) * (1.0f / (1.0f - 0.2126f)));
+		float fChromaB1 = 0.5f * ((a_frgbaSourcePixel.fB - fLuma1) * (1.0f / (1.0f - 0.0722f)));
+
+		float fLuma2 = a_frgbaDecodedColor.fR*0.2126f +
+						a_frgbaDecodedColor.fG*0.7152f +
+						a_frgbaDecodedColor.fB*0.0722f;
+		float fChromaR2 = 0.5f * ((a_frgbaDecodedColor.fR - fLuma2) * (1.0f / (1.0f - 0.2126f)));
+		float fChromaB2 = 0.5f * ((a_frgbaDecodedColor.fB - fLuma2) * (1.0f / (1.0f - 0.0722f)));
+
+		float fDeltaL = a_frgbaSourcePixel.fA * fLuma1 - a_fDecodedAlpha * fLuma2;
+		float fDeltaCr = a_frgbaSourcePixel.fA * fChromaR1 - a_fDecodedAlpha * fChromaR2;
+		float fDeltaCb = a_frgbaSourcePixel.fA * fChromaB1 - a_fDecodedAlpha * fChromaB2;
+
+		float fDAlpha = a_fDecodedAlpha - a_frgbaSourcePixel.fA;
+
+		// Favor Luma accuracy over Chroma, and Red over Blue 
+		return Block4x4Encoding::LUMA_WEIGHT*fDeltaL*fDeltaL +
+				fDeltaCr*fDeltaCr +
+				Block4x4Encoding::CHROMA_BLUE_WEIGHT*fDeltaCb*fDeltaCb +
+				fDAlpha*fDAlpha;
+	}
+
+	template <>
+	inline float CalcPixelErrorForMetric<ErrorMetric::NORMALXYZ>(const ColorFloatRGBA &a_frgbaDecodedColor, float,
+																	const ColorFloatRGBA &a_frgbaSourcePixel)
+	{
+		float fDecodedX = 2.0f * a_frgbaDecodedColor.fR - 1.0f;
+		float fDecodedY = 2.0f * a_frgbaDecodedColor.fG - 1.0f;
+		float fDecodedZ = 2.0f * a_frgbaDecodedColor.fB - 1.0f;
+
+		float fDecodedLength = sqrtf(fDecodedX*fDecodedX + fDecodedY*fDecodedY + fDecodedZ*fDecodedZ);
+
+		if (fDecodedLength < 0.5f)
+		{
+			return 1.0f;
+		}
+		else if (fDecodedLength == 0.0f)
+		{
+			fDecodedX = 1.0f;
+			fDecodedY = 0.0f;
+			fDecodedZ = 0.0f;
+		}
+		else
+		{
+			fDecodedX /= fDecodedLength;
+			fDecodedY /= fDecodedLength;
+			fDecodedZ /= fDecodedLength;
+		}
+
+		float fSourceX = 2.0f * a_frgbaSourcePixel.fR - 1.0f;
+		float fSourceY = 2.0f * a_frgbaSourcePixel.fG - 1.0f;
+		float fSourceZ = 2.0f * a_frgbaSourcePixel.fB - 1.0f;
+
+		float fSourceLength = sqrtf(fSourceX*fSourceX + fSourceY*fSourceY + fSourceZ*fSourceZ);
+
+		if (fSourceLength == 0.0f)
+		{
+			fSourceX = 1.0f;
+			fSourceY = 0.0f;
+			fSourceZ = 0.0f;
+		}
+		else
+		{
+			fSourceX /= fSourceLength;
+			fSourceY /= fSourceLength;
+			fSourceZ /= fSourceLength;
+		}
+
+		float fDotProduct = fSourceX*fDecodedX + fSourceY*fDecodedY + fSourceZ*fDecodedZ;
+		float fNormalizedDotProduct = 1.0f - 0.5f * (fDotProduct + 1.0f);
+		float fDotProductError = fNormalizedDotProduct * fNormalizedDotProduct;
+		
+		float fLength2 = fDecodedX*fDecodedX + fDecodedY*fDecodedY + fDecodedZ*fDecodedZ;
+		float fLength2Error = fabsf(1.0f - fLength2);
+
+		float fDeltaW = a_frgbaDecodedColor.fA - a_frgbaSourcePixel.fA;
+		float fErrorW = fDeltaW * fDeltaW;
+
+		return fDotProductError + fLength2Error + fErrorW;
+	}
+
+	template <>
+	inline float CalcPixelErrorForMetric<ErrorMetric::NUMERIC>(const ColorFloatRGBA &a_frgbaDecodedColor, float a_fDecodedAlpha,
+																const ColorFloatRGBA &a_frgbaSourcePixel)
+	{
+		assert(a_fDecodedAlpha >= 0.0f);
+		(void)a_fDecodedAlpha;
+
+		float fDX = a_frgbaDecodedColor.fR - a_frgbaSourcePixel.fR;
+		float fDY = a_frgbaDecodedColor.fG - a_frgbaSourcePixel.fG;
+		float fDZ = a_frgbaDecodedColor.fB - a_frgbaSourcePixel.fB;
+		float fDW = a_frgbaDecodedColor.fA - a_frgbaSourcePixel.fA;
+
+		return fDX*fDX + fDY*fDY + fDZ*fDZ + fDW*fDW;
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// sum of the pixel errors of a 4x4 block, added up in pixel order like Block4x4Encoding::CalcBlockError()
+	// border pixels (source alpha of NAN) add no error
+	//
+	typedef float (*BlockErrorFunction)(const ColorFloatRGBA *a_pafrgbaDecodedColors,
+										const float *a_pafDecodedAlphas,
+										const ColorFloatRGBA *a_pafrgbaSource);
+
+	// implementations of BlockErrorFunction
+	// all of them give bit identical results
+	enum class BlockErrorKernel
+	{
+		SCALAR,
+		SSE41,			// 4 pixels per instruction, x86 with SSE4.1 only
+		//
+		KERNELS
+	};
+
+	// ----------------------------------------------------------------------------------------------------
+	// pick the best of 4 selector colors for each pixel of a 4x4 block, as done by the T and H mode searches
+	// ties go to the lower selector, like a search over the selectors in order
+	// if a_boolPunchThrough, pixels with a source alpha < 0.5 can only use selector 2 (the RGB8A1 transparent selector)
+	// writes the selectors to a_pauiSelectors and returns the block error, added up in pixel order
+	//
+	typedef float (*BestSelectorsFunction)(const ColorFloatRGBA *a_pafrgbaSelectorColors,
+											const float *a_pafDecodedAlphas,
+											const ColorFloatRGBA *a_pafrgbaSource,
+											bool a_boolPunchThrough,
+											unsigned int *a_pauiSelectors);
+
+	// ----------------------------------------------------------------------------------------------------
+	// pick the closest of the 8 EAC selector values for each pixel of one channel of a 4x4 block, as done by the A8 search
+	// ties go to the lower selector
+	// each squared pixel error is scaled by the pixel's weight before comparing,
+	// so that pixels with a weight of 0 add no error and get selector 0
+	// a_pafSource must not contain NANs, use a weight of 0 for border pixels instead
+	// writes the selectors to a_pauiSelectors and returns the block error, added up in pixel order
+	//
+	typedef float (*EacSelectorsFunction)(const float *a_pafSelectorValues,
+											const float *a_pafSource,
+											const float *a_pafWeights,
+											unsigned int *a_pauiSelectors);
+
+	// ----------------------------------------------------------------------------------------------------
+	// pick the best of the 8 EAC selector values for the red (a_uiChannel 0) or green (a_uiChannel 1) channel
+	// of each pixel of a 4x4 block, as done by the R11 and RG11 searches
+	// a pixel decodes to its source pixel with the channel replaced, a blue of 0 and an alpha of 1,
+	// and is compared to the source pixel with the error metric
+	// ties go to the lower selector, border pixels (source alpha of NAN) add no error and get selector 0
+	// writes the selectors to a_pauiSelectors and returns the block error, added up in pixel order
+	//
+	typedef float (*EacMetricSelectorsFunction)(const float *a_pafSelectorValues,
+												const ColorFloatRGBA *a_pafrgbaSource,
+												unsigned int a_uiChannel,
+												unsigned int *a_pauiSelectors);
+
+	// ----------------------------------------------------------------------------------------------------
+	// pick the best of 4 selector colors for each pixel of an ETC1 half block, as done by the differential
+	// and individual mode searches
+	// a_pauiPixelMapping gives the 8 block pixels of the half
+	// ties go to the lower selector, border pixels (source alpha of NAN) add no error and get selector 0
+	// if a_boolPunchThrough, pixels with a source alpha < 0.5 can only use selector 2 (the RGB8A1 transparent selector)
+	// and all other pixels can't use it
+	// writes the selectors of the 8 pixels to a_pauiSelectors and returns the half's error, added up in mapping order
+	//
+	typedef float (*HalfSelectorsFunction)(const ColorFloatRGBA *a_pafrgbaSelectorColors,
+											const float *a_pafDecodedAlphas,
+											const ColorFloatRGBA *a_pafrgbaSource,
+											const unsigned int *a_pauiPixelMapping,
+											bool a_boolPunchThrough,
+											unsigned int *a_pauiSelectors);
+
+	// ----------------------------------------------------------------------------------------------------
+	// lower bounds of the half error HalfSelectorsFunction returns without punch-through, for the differential
+	// and individual mode searches to skip the CWs and base colors that can't beat their best one
+	// the bounds compare features of the source pixels and of the selector colors that only depend on the
+	// differences between their channels, which the modifiers don't change unless they clamp
+	//
+	static const unsigned int HALF_ERROR_BOUND_FEATURES = 3;
+
+	// the statistics of the source pixels of a half that the bounds depend on
+	struct HalfErrorBoundStatistics
+	{
+		float afMeans[HALF_ERROR_BOUND_FEATURES];	// means of the source features
+		float fWeights2;							// sum of the squared weights of the decoded features
+		float fSpreadError;							// error of the source features' spread around their means
+		float fAlphaError;							// error of the alpha, which the selectors don't change
+	};
+
+	// calculates the statistics of the half a_pauiPixelMapping gives
+	typedef void (*HalfErrorBoundStatisticsFunction)(const float *a_pafDecodedAlphas,
+														const ColorFloatRGBA *a_pafrgbaSource,
+														const unsigned int *a_pauiPixelMapping,
+														HalfErrorBoundStatistics *a_pstatistics);
+
+	// calculates a bound for each of a_uiModifiers ranges of modifiers [-a_pafMaxModifiers[i], a_pafMaxModifiers[i]]
+	// each bound holds for any selector colors (a_frgbaBaseColor + modifier).ClampRGB() with modifiers in the range
+	// the base color must be in [0, 1]
+	// the bounds are a little lower than the exact ones, so that float rounding can't make them too high
+	// writes the bounds to a_pafErrorBounds
+	typedef void (*HalfErrorBoundsFunction)(const HalfErrorBoundStatistics &a_statistics,
+											const ColorFloatRGBA &a_frgbaBaseColor,
+											const float *a_pafMaxModifiers, unsigned int a_uiModifiers,
+											float *a_pafErrorBounds);
+
+	// the functions of a kernel that are specialized on one error metric
+	// an encoder looks these up once when it's initialized, so that its searches don't branch on the metric
+	struct MetricKernels
+	{
+		BlockErrorFunction pfnBlockError;
+		BestSelectorsFunction pfnBestSelectors;
+		EacMetricSelectorsFunction pfnEacMetricSelectors;
+		HalfSelectorsFunction pfnHalfSelectors;
+		HalfErrorBoundStatisticsFunction pfnHalfErrorBoundStatistics;
+		HalfErrorBoundsFunction pfnHalfErrorBounds;
+	};
+
+	// the functions of the current kernel
+	// this is the fastest kernel this CPU supports, unless changed with SetBlockErrorKernel()
+	// the MetricKernels stay valid and follow SetBlockErrorKernel()
+	const MetricKernels &GetMetricKernels(ErrorMetric a_errormetric);
+	BlockErrorFunction GetBlockErrorFunction(ErrorMetric a_errormetric);
+	BestSelectorsFunction GetBestSelectorsFunction(ErrorMetric a_errormetric);
+	EacMetricSelectorsFunction GetEacMetricSelectorsFunction(ErrorMetric a_errormetric);
+	HalfSelectorsFunction GetHalfSelectorsFunction(ErrorMetric a_errormetric);
+	HalfErrorBoundStatisticsFunction GetHalfErrorBoundStatisticsFunction(ErrorMetric a_errormetric);
+	HalfErrorBoundsFunction GetHalfErrorBoundsFunction(ErrorMetric a_errormetric);
+	EacSelectorsFunction GetEacSelectorsFunction(void);
+
+	// the functions of a specific kernel, or nullptr if the CPU or the build doesn't support it
+	BlockErrorFunction GetBlockErrorFunction(ErrorMetric a_errormetric, BlockErrorKernel a_kernel);
+	BestSelectorsFunction GetBestSelectorsFunction(ErrorMetric a_errormetric, BlockErrorKernel a_kernel);
+	EacMetricSelectorsFunction GetEacMetricSelectorsFunction(ErrorMetric a_errormetric, BlockErrorKernel a_kernel);
+	HalfSelectorsFunction GetHalfSelectorsFunction(ErrorMetric a_errormetric, BlockErrorKernel a_kernel);
+	HalfErrorBoundStatisticsFunction GetHalfErrorBoundStatisticsFunction(ErrorMetric a_errormetric, BlockErrorKernel a_kernel);
+	HalfErrorBoundsFunction GetHalfErrorBoundsFunction(ErrorMetric a_errormetric, BlockErrorKernel a_kernel);
+	EacSelectorsFunction GetEacSelectorsFunction(BlockErrorKernel a_kernel);
+
+	// change the kernel used by all encoders, e.g. to compare kernels
+	// must not be called while encoding
+	// returns false and keeps the current kernel if a_kernel isn't supported
+	bool SetBlockErrorKernel(BlockErrorKernel a_kernel);
+
+} // namespace Etc
@@ -0,0 +1,227 @@
+/*
+ * Copyright 2015 The Etc2Comp Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+EtcBlockPriorityQueue.cpp
+
+BlockPriorityQueue keeps the unfinished 4x4 blocks of an image in error buckets between effort passes,
+so that each pass only pays for the blocks it touched.
+
+The bucket of a block comes from the top bits of its float error,
+which makes the buckets logarithmic and independent of the image's max error.
+
+*/
+
+#include "EtcConfig.h"
+#include "EtcBlockPriorityQueue.h"
+
+#include <cstring>
+
+namespace Etc
+{
+
+	// ----------------------------------------------------------------------------------------------------
+	// construct an empty queue with room for all of the image's 4x4 blocks
+	//
+	BlockPriorityQueue::BlockPriorityQueue(unsigned int a_uiImageBlocks)
+	{
+		m_uiImageBlocks = a_uiImageBlocks;
+		m_pafBlockError = nullptr;
+		m_paboolBlockDone = nullptr;
+
+		m_pauiNext = new unsigned int[m_uiImageBlocks];
+		m_pauiPrev = new unsigned int[m_uiImageBlocks];
+		m_pauiBlockBucket = new unsigned int[m_uiImageBlocks];
+		m_pauiBucketFirst = new unsigned int[BUCKETS];
+		m_pauiBucketLast = new unsigned int[BUCKETS];
+		m_pauiSelectedBlocks = new unsigned int[m_uiImageBlocks];
+
+		m_uiTopBucket = 0;
+		m_uiQueuedBlocks = 0;
+		m_uiSelectedBlocks = 0;
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	//
+	BlockPriorityQueue::~BlockPriorityQueue(void)
+	{
+		delete[] m_pauiNext;
+		delete[] m_pauiPrev;
+		delete[] m_pauiBlockBucket;
+		delete[] m_pauiBucketFirst;
+		delete[] m_pauiBucketLast;
+		delete[] m_pauiSelectedBlocks;
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// queue all unfinished blocks in image order
+	// every block must have a first encoding
+	//
+	void BlockPriorityQueue::Init(const float *a_pafBlockError, const bool *a_paboolBlockDone)
+	{
+		m_pafBlockError = a_pafBlockError;
+		m_paboolBlockDone = a_paboolBlockDone;
+
+		for (unsigned int uiBucket = 0; uiBucket < BUCKETS; uiBucket++)
+		{
+			m_pauiBucketFirst[uiBucket] = NONE;
+			m_pauiBucketLast[uiBucket] = NONE;
+		}
+
+		m_uiTopBucket = 0;
+		m_uiQueuedBlocks = 0;
+		m_uiSelectedBlocks = 0;
+
+		for (unsigned int uiBlock = 0; uiBlock < m_uiImageBlocks; uiBlock++)
+		{
+			m_pauiBlockBucket[uiBlock] = NONE;
+
+			if (!m_paboolBlockDone[uiBlock])
+			{
+				Insert(uiBlock, CalcBucket(m_pafBlockError[uiBlock]));
+			}
+		}
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// walk the buckets from the most error down and select up to a_uiMaxBlocks blocks
+	// the selected blocks stay queued until UpdateSelectedBlocks()
+	//
+	unsigned int BlockPriorityQueue::SelectWorstBlocks(unsigned int a_uiMaxBlocks)
+	{
+		m_uiSelectedBlocks = 0;
+
+		// skip buckets that emptied out since the last selection
+		while (m_uiTopBucket > 0 && m_pauiBucketFirst[m_uiTopBucket] == NONE)
+		{
+			m_uiTopBucket--;
+		}
+
+		for (int iBucket = (int)m_uiTopBucket; iBucket >= 0 && m_uiSelectedBlocks < a_uiMaxBlocks; iBucket--)
+		{
+			for (unsigned int uiBlock = m_pauiBucketFirst[iBucket];
+					uiBlock != NONE && m_uiSelectedBlocks < a_uiMaxBlocks;
+					uiBlock = m_pauiNext[uiBlock])
+			{
+				m_pauiSelectedBlocks[m_uiSelectedBlocks++] = uiBlock;
+			}
+		}
+
+		return m_uiSelectedBlocks;
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// move each selected block to the bucket of its new error, or drop it if its encoding is done
+	// done in selection order, so the result does not depend on how the blocks were iterated
+	//
+	void BlockPriorityQueue::UpdateSelectedBlocks(void)
+	{
+		for (unsigned int uiSelected = 0; uiSelected < m_uiSelectedBlocks; uiSelected++)
+		{
+			unsigned int uiBlock = m_pauiSelectedBlocks[uiSelected];
+
+			Remove(uiBlock);
+
+			if (!m_paboolBlockDone[uiBlock])
+			{
+				Insert(uiBlock, CalcBucket(m_pafBlockError[uiBlock]));
+			}
+		}
+
+		m_uiSelectedBlocks = 0;
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// bucket for a block error
+	// the bit pattern of a non-negative float increases with its value
+	//
+	unsigned int BlockPriorityQueue::CalcBucket(float a_fError)
+	{
+		assert(a_fError >= 0.0f);
+
+		unsigned int uiBits;
+		memcpy(&uiBits, &a_fError, sizeof(uiBits));
+
+		unsigned int uiBucket = uiBits >> BUCKET_SHIFT;
+		return uiBucket < BUCKETS ? uiBucket : BUCKETS - 1;
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// add a block to the end of a bucket
+	//
+	void BlockPriorityQueue::Insert(unsigned int a_uiBlock, unsigned int a_uiBucket)
+	{
+		assert(m_pauiBlockBucket[a_uiBlock] == NONE);
+
+		m_pauiBlockBucket[a_uiBlock] = a_uiBucket;
+		m_pauiNext[a_uiBlock] = NONE;
+		m_pauiPrev[a_uiBlock] = m_pauiBucketLast[a_uiBucket];
+
+		if (m_pauiBucketLast[a_uiBucket] == NONE)
+		{
+			m_pauiBucketFirst[a_uiBucket] = a_uiBlock;
+		}
+		else
+		{
+			m_pauiNext[m_pauiBucketLast[a_uiBucket]] = a_uiBlock;
+		}
+		m_pauiBucketLast[a_uiBucket] = a_uiBlock;
+
+		if (a_uiBucket > m_uiTopBucket)
+		{
+			m_uiTopBucket = a_uiBucket;
+		}
+
+		m_uiQueuedBlocks++;
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// unlink a block from its bucket
+	//
+	void BlockPriorityQueue::Remove(unsigned int a_uiBlock)
+	{
+		unsigned int uiBucket = m_pauiBlockBucket[a_uiBlock];
+		assert(uiBucket != NONE);
+
+		unsigned int uiNext = m_pauiNext[a_uiBlock];
+		unsigned int uiPrev = m_pauiPrev[a_uiBlock];
+
+		if (uiPrev == NONE)
+		{
+			m_pauiBucketFirst[uiBucket] = uiNext;
+		}
+		else
+		{
+			m_pauiNext[uiPrev] = uiNext;
+		}
+
+		if (uiNext == NONE)
+		{
+			m_pauiBucketLast[uiBucket] = uiPrev;
+		}
+		else
+		{
+			m_pauiPrev[uiNext] = uiPrev;
+		}
+
+		m_pauiBlockBucket[a_uiBlock] = NONE;
+		m_uiQueuedBlocks--;
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	//
+
+}   // namespace Etc
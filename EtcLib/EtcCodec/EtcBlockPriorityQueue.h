@@ -0,0 +1,92 @@
+/*
+ * Copyright 2015 The Etc2Comp Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cassert>
+
+namespace Etc
+{
+	// incremental priority queue of the unfinished 4x4 blocks of an image, keyed on block error
+	//
+	// unlike SortedBlockList, which re-sorts every block on each effort pass,
+	// only the blocks selected for the last pass are re-keyed, and finished blocks are dropped for good
+	// the buckets are logarithmic in the error, so the order is approximate like SortedBlockList's
+	//
+	class BlockPriorityQueue
+	{
+	public:
+
+		BlockPriorityQueue(unsigned int a_uiImageBlocks);
+		~BlockPriorityQueue(void);
+
+		// queue every unfinished block, keyed on its current error
+		// a_pafBlockError and a_paboolBlockDone hold the error and done flag of each image block
+		void Init(const float *a_pafBlockError, const bool *a_paboolBlockDone);
+
+		// select up to a_uiMaxBlocks of the queued blocks, from most to least error
+		unsigned int SelectWorstBlocks(unsigned int a_uiMaxBlocks);
+
+		// re-key the selected blocks after they were iterated and drop the ones that are done
+		void UpdateSelectedBlocks(void);
+
+		// indices of the selected blocks, from most to least error
+		inline const unsigned int * GetSelectedBlockIndices(void)
+		{
+			return m_pauiSelectedBlocks;
+		}
+
+		inline unsigned int GetNumberOfSelectedBlocks(void)
+		{
+			return m_uiSelectedBlocks;
+		}
+
+		inline unsigned int GetNumberOfQueuedBlocks(void)
+		{
+			return m_uiQueuedBlocks;
+		}
+
+	private:
+
+		// 4 mantissa bits per power of 2 of error
+		static const unsigned int BUCKET_SHIFT = 19;
+		static const unsigned int BUCKETS = 1 << (31 - BUCKET_SHIFT);
+		static const unsigned int NONE = ~0u;
+
+		static unsigned int CalcBucket(float a_fError);
+
+		void Insert(unsigned int a_uiBlock, unsigned int a_uiBucket);
+		void Remove(unsigned int a_uiBlock);
+
+		unsigned int m_uiImageBlocks;
+		const float *m_pafBlockError;
+		const bool *m_paboolBlockDone;
+
+		// each bucket is a doubly linked list of block indices, oldest first
+		unsigned int *m_pauiNext;
+		unsigned int *m_pauiPrev;
+		unsigned int *m_pauiBlockBucket;	// NONE if the block is not queued
+		unsigned int *m_pauiBucketFirst;
+		unsigned int *m_pauiBucketLast;
+		unsigned int m_uiTopBucket;			// no queued block is in a higher bucket
+		unsigned int m_uiQueuedBlocks;
+
+		unsigned int *m_pauiSelectedBlocks;
+		unsigned int m_uiSelectedBlocks;
+
+	};
+
+} // namespace Etc
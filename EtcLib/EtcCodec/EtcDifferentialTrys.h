@@ -58,7 +58,9 @@ namespace Etc
 			int m_iBlue;
 			unsigned int m_uiCW;
 			unsigned int m_auiSelectors[SELECTORS];
-			float m_fError;
+			float m_fError;			// lowest error of the CWs evaluated, FLT_MAX if none were
+			float m_fErrorBound;	// lowest error bound of the CWs skipped, FLT_MAX if none were
+									// m_fError is the try's error if it's lower than m_fErrorBound
         };
 
 		class Half
@@ -0,0 +1,678 @@
+/*
+ * Copyright 2015 The Etc2Comp Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+EtcEacSearch.cpp
+
+EacSearch finds the base, multiplier, modifier table entry and selectors of one EAC channel.
+It is shared by the alpha of RGBA8 (A8), R11 and RG11.
+
+The channels differ in how a base, multiplier and modifier decode:
+	A8:		base + multiplier * modifier
+	R11/G11:	(base * 8 + 4 + 8 * multiplier * modifier) / 2047, with a multiplier of 0 decoding as 1/8
+and in how a decoded value is compared to the source:
+	A8:		squared alpha error
+	R11/G11:	the error metric, with the other channels taken from the source
+
+multiplier * modifier comes from a precomputed table, evaluated with the same operations as the
+original per pixel decoders, so that every decoded value is bit identical.
+The selectors are picked with the EAC kernels of EtcBlockError.
+
+*/
+
+#include "EtcConfig.h"
+#include "EtcEacSearch.h"
+#include "EtcSolidColor.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+namespace Etc
+{
+
+	const float EacModifierTable::s_aafModifiers[ENTRYS][SELECTORS]
+	{
+		{ -3.0f / 255.0f, -6.0f / 255.0f,  -9.0f / 255.0f, -15.0f / 255.0f, 2.0f / 255.0f, 5.0f / 255.0f, 8.0f / 255.0f, 14.0f / 255.0f },
+		{ -3.0f / 255.0f, -7.0f / 255.0f, -10.0f / 255.0f, -13.0f / 255.0f, 2.0f / 255.0f, 6.0f / 255.0f, 9.0f / 255.0f, 12.0f / 255.0f },
+		{ -2.0f / 255.0f, -5.0f / 255.0f,  -8.0f / 255.0f, -13.0f / 255.0f, 1.0f / 255.0f, 4.0f / 255.0f, 7.0f / 255.0f, 12.0f / 255.0f },
+		{ -2.0f / 255.0f, -4.0f / 255.0f,  -6.0f / 255.0f, -13.0f / 255.0f, 1.0f / 255.0f, 3.0f / 255.0f, 5.0f / 255.0f, 12.0f / 255.0f },
+
+		{ -3.0f / 255.0f, -6.0f / 255.0f,  -8.0f / 255.0f, -12.0f / 255.0f, 2.0f / 255.0f, 5.0f / 255.0f, 7.0f / 255.0f, 11.0f / 255.0f },
+		{ -3.0f / 255.0f, -7.0f / 255.0f,  -9.0f / 255.0f, -11.0f / 255.0f, 2.0f / 255.0f, 6.0f / 255.0f, 8.0f / 255.0f, 10.0f / 255.0f },
+		{ -4.0f / 255.0f, -7.0f / 255.0f,  -8.0f / 255.0f, -11.0f / 255.0f, 3.0f / 255.0f, 6.0f / 255.0f, 7.0f / 255.0f, 10.0f / 255.0f },
+		{ -3.0f / 255.0f, -5.0f / 255.0f,  -8.0f / 255.0f, -11.0f / 255.0f, 2.0f / 255.0f, 4.0f / 255.0f, 7.0f / 255.0f, 10.0f / 255.0f },
+
+		{ -2.0f / 255.0f, -6.0f / 255.0f,  -8.0f / 255.0f, -10.0f / 255.0f, 1.0f / 255.0f, 5.0f / 255.0f, 7.0f / 255.0f,  9.0f / 255.0f },
+		{ -2.0f / 255.0f, -5.0f / 255.0f,  -8.0f / 255.0f, -10.0f / 255.0f, 1.0f / 255.0f, 4.0f / 255.0f, 7.0f / 255.0f,  9.0f / 255.0f },
+		{ -2.0f / 255.0f, -4.0f / 255.0f,  -8.0f / 255.0f, -10.0f / 255.0f, 1.0f / 255.0f, 3.0f / 255.0f, 7.0f / 255.0f,  9.0f / 255.0f },
+		{ -2.0f / 255.0f, -5.0f / 255.0f,  -7.0f / 255.0f, -10.0f / 255.0f, 1.0f / 255.0f, 4.0f / 255.0f, 6.0f / 255.0f,  9.0f / 255.0f },
+
+		{ -3.0f / 255.0f, -4.0f / 255.0f,  -7.0f / 255.0f, -10.0f / 255.0f, 2.0f / 255.0f, 3.0f / 255.0f, 6.0f / 255.0f,  9.0f / 255.0f },
+		{ -1.0f / 255.0f, -2.0f / 255.0f,  -3.0f / 255.0f, -10.0f / 255.0f, 0.0f / 255.0f, 1.0f / 255.0f, 2.0f / 255.0f,  9.0f / 255.0f },
+		{ -4.0f / 255.0f, -6.0f / 255.0f,  -8.0f / 255.0f,  -9.0f / 255.0f, 3.0f / 255.0f, 5.0f / 255.0f, 7.0f / 255.0f,  8.0f / 255.0f },
+		{ -3.0f / 255.0f, -5.0f / 255.0f,  -7.0f / 255.0f,  -9.0f / 255.0f, 2.0f / 255.0f, 4.0f / 255.0f, 6.0f / 255.0f,  8.0f / 255.0f }
+	};
+
+	// ----------------------------------------------------------------------------------------------------
+	// per channel constants
+	// a decoded value times VALUE_SCALE is BASE_SCALE * base + BASE_OFFSET + BASE_SCALE * multiplier * 255 * modifier
+	//
+	template <EacChannel C>
+	struct EacChannelTraits
+	{
+		static constexpr bool ELEVEN_BITS = true;
+		static constexpr float MIN_MULTIPLIER = 0.0f;		// decodes as 1/8
+		static constexpr float VALUE_SCALE = 2047.0f;
+		static constexpr float BASE_SCALE = 8.0f;
+		static constexpr float BASE_OFFSET = 4.0f;
+	};
+
+	template <>
+	struct EacChannelTraits<EacChannel::A8>
+	{
+		static constexpr bool ELEVEN_BITS = false;
+		static constexpr float MIN_MULTIPLIER = 1.0f;		// a multiplier of 0 isn't valid
+		static constexpr float VALUE_SCALE = 255.0f;
+		static constexpr float BASE_SCALE = 1.0f;
+		static constexpr float BASE_OFFSET = 0.0f;
+	};
+
+	// ----------------------------------------------------------------------------------------------------
+	// multiplier * modifier for every modifier table entry, multiplier and selector
+	//
+	class ScaledModifierTable
+	{
+	public:
+
+		static const unsigned int MULTIPLIERS = 16;
+
+		ScaledModifierTable(bool a_boolElevenBits)
+		{
+			for (unsigned int uiTableEntry = 0; uiTableEntry < EacModifierTable::ENTRYS; uiTableEntry++)
+			{
+				for (unsigned int uiMultiplier = 0; uiMultiplier < MULTIPLIERS; uiMultiplier++)
+				{
+					for (unsigned int uiSelector = 0; uiSelector < EacModifierTable::SELECTORS; uiSelector++)
+					{
+						float fModifier = EacModifierTable::s_aafModifiers[uiTableEntry][uiSelector];
+						float fMultiplier = (float)uiMultiplier;
+
+						if (a_boolElevenBits)
+						{
+							if (fMultiplier <= 0.0f)
+							{
+								fMultiplier = 1.0f / 8.0f;
+							}
+							m_aaafScaledModifiers[uiTableEntry][uiMultiplier][uiSelector] = 8 * fMultiplier*fModifier*255;
+						}
+						else
+						{
+							m_aaafScaledModifiers[uiTableEntry][uiMultiplier][uiSelector] = fMultiplier*fModifier;
+						}
+					}
+				}
+			}
+		}
+
+		inline const float * Get(unsigned int a_uiTableEntry, unsigned int a_uiMultiplier) const
+		{
+			assert(a_uiTableEntry < EacModifierTable::ENTRYS);
+			assert(a_uiMultiplier < MULTIPLIERS);
+			return m_aaafScaledModifiers[a_uiTableEntry][a_uiMultiplier];
+		}
+
+	private:
+
+		float m_aaafScaledModifiers[EacModifierTable::ENTRYS][MULTIPLIERS][EacModifierTable::SELECTORS];
+	};
+
+	static const ScaledModifierTable &GetScaledModifierTable(bool a_boolElevenBits)
+	{
+		static const ScaledModifierTable s_scaledmodifiertableA8(false);
+		static const ScaledModifierTable s_scaledmodifiertable11(true);
+
+		return a_boolElevenBits ? s_scaledmodifiertable11 : s_scaledmodifiertableA8;
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	//
+	template <EacChannel C>
+	EacSearch<C>::EacSearch(const ColorFloatRGBA *a_pafrgbaSource, ErrorMetric a_errormetric)
+	{
+		m_pafrgbaSource = a_pafrgbaSource;
+
+		m_fMinValue = 1.0f;
+		m_fMaxValue = 0.0f;
+		for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
+		{
+			// ignore border pixels
+			if (std::isnan(a_pafrgbaSource[uiPixel].fA))
+			{
+				m_afValues[uiPixel] = 0.0f;
+				m_afWeights[uiPixel] = 0.0f;
+				continue;
+			}
+
+			float fValue;
+			if (C == EacChannel::A8)
+			{
+				fValue = a_pafrgbaSource[uiPixel].fA;
+			}
+			else if (C == EacChannel::R11)
+			{
+				fValue = a_pafrgbaSource[uiPixel].fR;
+			}
+			else
+			{
+				fValue = a_pafrgbaSource[uiPixel].fG;
+			}
+
+			m_afValues[uiPixel] = fValue;
+			m_afWeights[uiPixel] = 1.0f;
+
+			if (fValue < m_fMinValue)
+			{
+				m_fMinValue = fValue;
+			}
+			if (fValue > m_fMaxValue)
+			{
+				m_fMaxValue = fValue;
+			}
+		}
+
+		m_pfnEacSelectors = GetEacSelectorsFunction();
+		m_pfnEacMetricSelectors = (C == EacChannel::A8) ? nullptr : GetEacMetricSelectorsFunction(a_errormetric);
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// a_fBase is in the 0-1 range
+	// a_fMultiplier must be a whole number in the 0-15 range
+	//
+	template <EacChannel C>
+	void EacSearch<C>::DecodeValues(float a_fBase, float a_fMultiplier, unsigned int a_uiTableEntry,
+									float *a_pafValues)
+	{
+		typedef EacChannelTraits<C> Traits;
+
+		const float *pafScaledModifiers = GetScaledModifierTable(Traits::ELEVEN_BITS).Get(a_uiTableEntry,
+																							(unsigned int)a_fMultiplier);
+
+		float fBase = Traits::ELEVEN_BITS ? a_fBase * 255.0f : a_fBase;
+
+		for (unsigned int uiSelector = 0; uiSelector < SELECTORS; uiSelector++)
+		{
+			float fValue;
+			if (Traits::ELEVEN_BITS)
+			{
+				fValue = fBase * 8 + 4 + pafScaledModifiers[uiSelector];
+				fValue /= 2047.0f;
+			}
+			else
+			{
+				fValue = fBase + pafScaledModifiers[uiSelector];
+			}
+
+			if (fValue < 0.0f)
+			{
+				fValue = 0.0f;
+			}
+			else if (fValue > 1.0f)
+			{
+				fValue = 1.0f;
+			}
+
+			a_pafValues[uiSelector] = fValue;
+		}
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// exhaustive search
+	//
+	// a_uiSelectorsUsed limits the number of selector combinations to try
+	// a_fBaseRadius limits the range of base values to try
+	// a_fMultiplierRadius limits the range of multipliers to try
+	//
+	template <EacChannel C>
+	bool EacSearch<C>::Search(unsigned int a_uiSelectorsUsed, float a_fBaseRadius, float a_fMultiplierRadius,
+								Encoding *a_pencoding)
+	{
+		// maps from virtual (monotonic) selector to ETC selector
+		static const unsigned int auiVirtualSelectorMap[8] = {3, 2, 1, 0, 4, 5, 6, 7};
+
+		assert(m_fMinValue <= m_fMaxValue);
+
+		float fRange = (m_fMaxValue - m_fMinValue);
+
+		bool boolFound = false;
+
+		// try each modifier table entry
+		for (unsigned int uiTableEntry = 0; uiTableEntry < EacModifierTable::ENTRYS; uiTableEntry++)
+		{
+			const float *pafModifiers = EacModifierTable::s_aafModifiers[uiTableEntry];
+
+			for (unsigned int uiMinVirtualSelector = 0;
+					uiMinVirtualSelector <= (8 - a_uiSelectorsUsed);
+					uiMinVirtualSelector++)
+			{
+				unsigned int uiMaxVirtualSelector = uiMinVirtualSelector + a_uiSelectorsUsed - 1;
+
+				unsigned int uiMinSelector = auiVirtualSelectorMap[uiMinVirtualSelector];
+				unsigned int uiMaxSelector = auiVirtualSelectorMap[uiMaxVirtualSelector];
+
+				float fTableEntryCenter = -pafModifiers[uiMinSelector];
+
+				float fTableEntryRange = pafModifiers[uiMaxSelector] - pafModifiers[uiMinSelector];
+
+				float fCenterRatio = fTableEntryCenter / fTableEntryRange;
+
+				float fCenter = m_fMinValue + fCenterRatio*fRange;
+				fCenter = roundf(255.0f * fCenter) / 255.0f;
+
+				float fMinBase = fCenter - (a_fBaseRadius / 255.0f);
+				if (fMinBase < 0.0f)
+				{
+					fMinBase = 0.0f;
+				}
+
+				float fMaxBase = fCenter + (a_fBaseRadius / 255.0f);
+				if (fMaxBase > 1.0f)
+				{
+					fMaxBase = 1.0f;
+				}
+
+				for (float fBase = fMinBase; fBase <= fMaxBase; fBase += (0.999999f / 255.0f))
+				{
+					float fRangeMultiplier = roundf(fRange / fTableEntryRange);
+
+					float fMinMultiplier = fRangeMultiplier - a_fMultiplierRadius;
+					if (fMinMultiplier < 1.0f)
+					{
+						fMinMultiplier = EacChannelTraits<C>::MIN_MULTIPLIER;
+					}
+					else if (fMinMultiplier > 15.0f)
+					{
+						fMinMultiplier = 15.0f;
+					}
+
+					float fMaxMultiplier = fRangeMultiplier + a_fMultiplierRadius;
+					if (fMaxMultiplier < 1.0f)
+					{
+						fMaxMultiplier = 1.0f;
+					}
+					else if (fMaxMultiplier > 15.0f)
+					{
+						fMaxMultiplier = 15.0f;
+					}
+
+					for (float fMultiplier = fMinMultiplier; fMultiplier <= fMaxMultiplier; fMultiplier += 1.0f)
+					{
+						if (Try(fBase, fMultiplier, uiTableEntry, a_pencoding))
+						{
+							boolFound = true;
+						}
+					}
+				}
+			}
+		}
+
+		return boolFound;
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// fit base and multiplier to the source for each modifier table entry and
+	// only evaluate the winner with the channel's error
+	//
+	template <EacChannel C>
+	bool EacSearch<C>::SearchFast(Encoding *a_pencoding)
+	{
+		unsigned int uiBase;
+		unsigned int uiMultiplier;
+		unsigned int uiTableEntry;
+		Fit(&uiBase, &uiMultiplier, &uiTableEntry);
+
+		return Try((float)uiBase / 255.0f, (float)uiMultiplier, uiTableEntry, a_pencoding);
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// the base, multiplier and modifier table entry with a decoded value closest to each 8-bit value
+	// built once from every combination, decoded by the channel's DecodeValues()
+	//
+	class SolidValueTable
+	{
+	public:
+
+		static const unsigned int VALUES = 256;
+
+		struct Entry
+		{
+			unsigned char ucBase;
+			unsigned char ucMultiplier;
+			unsigned char ucTableEntry;
+		};
+
+		typedef void (*DecodeValuesFunction)(float a_fBase, float a_fMultiplier, unsigned int a_uiTableEntry,
+												float *a_pafValues);
+
+		SolidValueTable(DecodeValuesFunction a_pfnDecodeValues, float a_fMinMultiplier)
+		{
+			float afDistances[VALUES];
+			for (unsigned int uiValue = 0; uiValue < VALUES; uiValue++)
+			{
+				afDistances[uiValue] = FLT_MAX;
+				m_aentries[uiValue] = Entry();
+			}
+
+			for (unsigned int uiBase = 0; uiBase < 256; uiBase++)
+			{
+				for (unsigned int uiMultiplier = (unsigned int)a_fMinMultiplier;
+						uiMultiplier < ScaledModifierTable::MULTIPLIERS;
+						uiMultiplier++)
+				{
+					for (unsigned int uiTableEntry = 0; uiTableEntry < EacModifierTable::ENTRYS; uiTableEntry++)
+					{
+						float afValues[EacModifierTable::SELECTORS];
+						a_pfnDecodeValues((float)uiBase / 255.0f, (float)uiMultiplier, uiTableEntry, afValues);
+
+						for (unsigned int uiSelector = 0; uiSelector < EacModifierTable::SELECTORS; uiSelector++)
+						{
+							// the decoded value can only be closest to the 8-bit values around it
+							int iNearest = (int)roundf(afValues[uiSelector] * 255.0f);
+							int iFirst = std::max(iNearest - 1, 0);
+							int iLast = std::min(iNearest + 1, (int)VALUES - 1);
+
+							for (int iValue = iFirst; iValue <= iLast; iValue++)
+							{
+								float fDistance = fabsf(afValues[uiSelector] - (float)iValue / 255.0f);
+								if (fDistance < afDistances[iValue])
+								{
+									afDistances[iValue] = fDistance;
+									m_aentries[iValue].ucBase = (unsigned char)uiBase;
+									m_aentries[iValue].ucMultiplier = (unsigned char)uiMultiplier;
+									m_aentries[iValue].ucTableEntry = (unsigned char)uiTableEntry;
+								}
+							}
+						}
+					}
+				}
+			}
+		}
+
+		inline const Entry & Get(unsigned int a_uiValue) const
+		{
+			assert(a_uiValue < VALUES);
+			return m_aentries[a_uiValue];
+		}
+
+	private:
+
+		Entry m_aentries[VALUES];
+	};
+
+	static const SolidValueTable &GetSolidValueTable(bool a_boolElevenBits)
+	{
+		// R11 and G11 decode alike
+		static const SolidValueTable s_solidvaluetableA8(EacSearch<EacChannel::A8>::DecodeValues,
+															EacChannelTraits<EacChannel::A8>::MIN_MULTIPLIER);
+		static const SolidValueTable s_solidvaluetable11(EacSearch<EacChannel::R11>::DecodeValues,
+															EacChannelTraits<EacChannel::R11>::MIN_MULTIPLIER);
+
+		return a_boolElevenBits ? s_solidvaluetable11 : s_solidvaluetableA8;
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// every pixel gets the selector that decodes closest to the value, so the error is the lowest
+	// any encoding can have
+	//
+	template <EacChannel C>
+	bool EacSearch<C>::SearchSolid(Encoding *a_pencoding)
+	{
+		unsigned int uiValue;
+		if (m_fMinValue != m_fMaxValue || !SolidColor::GetEightBitValue(m_fMinValue, &uiValue))
+		{
+			return false;
+		}
+
+		const SolidValueTable::Entry &entry = GetSolidValueTable(EacChannelTraits<C>::ELEVEN_BITS).Get(uiValue);
+
+		return Try((float)entry.ucBase / 255.0f, (float)entry.ucMultiplier, entry.ucTableEntry, a_pencoding);
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// find the best selectors for a base, multiplier and modifier table entry
+	// replace a_pencoding if the error is lower
+	//
+	template <EacChannel C>
+	bool EacSearch<C>::Try(float a_fBase, float a_fMultiplier, unsigned int a_uiTableEntry, Encoding *a_pencoding)
+	{
+		float afValues[SELECTORS];
+		DecodeValues(a_fBase, a_fMultiplier, a_uiTableEntry, afValues);
+
+		unsigned int auiSelectors[PIXELS];
+		float fError = FindSelectors(afValues, auiSelectors);
+
+		if (fError < a_pencoding->fError)
+		{
+			a_pencoding->fError = fError;
+			a_pencoding->fBase = a_fBase;
+			a_pencoding->fMultiplier = a_fMultiplier;
+			a_pencoding->uiTableEntry = a_uiTableEntry;
+			for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
+			{
+				a_pencoding->auiSelectors[uiPixel] = auiSelectors[uiPixel];
+				a_pencoding->afDecodedValues[uiPixel] = afValues[auiSelectors[uiPixel]];
+			}
+			return true;
+		}
+
+		return false;
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// pick the best of the selector values for each pixel
+	// returns the block error
+	//
+	template <EacChannel C>
+	float EacSearch<C>::FindSelectors(const float *a_pafValues, unsigned int *a_pauiSelectors) const
+	{
+		if (C == EacChannel::A8)
+		{
+			return m_pfnEacSelectors(a_pafValues, m_afValues, m_afWeights, a_pauiSelectors);
+		}
+
+		return m_pfnEacMetricSelectors(a_pafValues, m_pafrgbaSource, (C == EacChannel::R11) ? 0 : 1,
+										a_pauiSelectors);
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// squared error of the channel for a base (0-255), multiplier and modifier table entry
+	// writes the closest selector of each pixel to a_pauiSelectors
+	//
+	template <EacChannel C>
+	float EacSearch<C>::CalcSquaredError(int a_iBase, int a_iMultiplier, unsigned int a_uiTableEntry,
+											unsigned int *a_pauiSelectors) const
+	{
+		float afValues[SELECTORS];
+		DecodeValues((float)a_iBase / 255.0f, (float)a_iMultiplier, a_uiTableEntry, afValues);
+
+		return m_pfnEacSelectors(afValues, m_afValues, m_afWeights, a_pauiSelectors);
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// find the base (0-255), multiplier (0-15) and modifier table entry with the lowest squared error
+	//
+	// for each table entry, base and multiplier start from the channel's range and
+	// are refit with least squares to the selectors they produce
+	// the fits of the best table entries are then nudged by +/- 1
+	//
+	template <EacChannel C>
+	void EacSearch<C>::Fit(unsigned int *a_puiBase, unsigned int *a_puiMultiplier, unsigned int *a_puiTableEntry) const
+	{
+		typedef EacChannelTraits<C> Traits;
+
+		static const unsigned int MIN_SELECTOR = 3;
+		static const unsigned int MAX_SELECTOR = 7;
+		static const unsigned int REFITS = 2;
+		static const unsigned int NUDGED_TABLE_ENTRYS = 2;
+
+		const int iMinMultiplier = (int)Traits::MIN_MULTIPLIER;
+
+		assert(m_fMinValue <= m_fMaxValue);
+
+		int aiBases[EacModifierTable::ENTRYS];
+		int aiMultipliers[EacModifierTable::ENTRYS];
+		float afErrors[EacModifierTable::ENTRYS];
+
+		for (unsigned int uiTableEntry = 0; uiTableEntry < EacModifierTable::ENTRYS; uiTableEntry++)
+		{
+			const float *pafModifiers = EacModifierTable::s_aafModifiers[uiTableEntry];
+
+			// start by spanning the channel's range with the table's range
+			float fTableRange = pafModifiers[MAX_SELECTOR] - pafModifiers[MIN_SELECTOR];
+			float fTableCenter = 0.5f * (pafModifiers[MAX_SELECTOR] + pafModifiers[MIN_SELECTOR]);
+
+			int iMultiplier = (int)roundf((m_fMaxValue - m_fMinValue) / fTableRange);
+			iMultiplier = std::min(std::max(iMultiplier, 1), 15);
+
+			int iBase = (int)roundf(255.0f * (0.5f * (m_fMinValue + m_fMaxValue) - iMultiplier * fTableCenter));
+			iBase = std::min(std::max(iBase, 0), 255);
+
+			unsigned int auiSelectors[PIXELS];
+			float fTableError = CalcSquaredError(iBase, iMultiplier, uiTableEntry, auiSelectors);
+
+			// least squares fit of the decoded value to the source, with the selectors fixed
+			for (unsigned int uiRefit = 0; uiRefit < REFITS; uiRefit++)
+			{
+				float fW = 0.0f;
+				float fP = 0.0f;
+				float fY = 0.0f;
+				float fPP = 0.0f;
+				float fPY = 0.0f;
+				for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
+				{
+					float fWeight = m_afWeights[uiPixel];
+					float fModifier = 255.0f * pafModifiers[auiSelectors[uiPixel]];
+					float fSource = Traits::VALUE_SCALE * m_afValues[uiPixel];
+
+					fW += fWeight;
+					fP += fWeight * fModifier;
+					fY += fWeight * fSource;
+					fPP += fWeight * fModifier * fModifier;
+					fPY += fWeight * fModifier * fSource;
+				}
+
+				float fDenominator = fW * fPP - fP * fP;
+				if (fDenominator <= 0.0f)
+				{
+					break;
+				}
+
+				float fSlope = (fW * fPY - fP * fY) / fDenominator;
+				int iFitMultiplier = (int)roundf(fSlope / Traits::BASE_SCALE);
+				iFitMultiplier = std::min(std::max(iFitMultiplier, iMinMultiplier), 15);
+
+				// an 11 bit multiplier of 0 decodes as 1/8
+				float fFitSlope = Traits::BASE_SCALE * ((iFitMultiplier == 0) ? 1.0f / 8.0f : (float)iFitMultiplier);
+				int iFitBase = (int)roundf(((fY - fFitSlope * fP) / fW - Traits::BASE_OFFSET) / Traits::BASE_SCALE);
+				iFitBase = std::min(std::max(iFitBase, 0), 255);
+
+				if (iFitBase == iBase && iFitMultiplier == iMultiplier)
+				{
+					break;
+				}
+
+				unsigned int auiFitSelectors[PIXELS];
+				float fFitError = CalcSquaredError(iFitBase, iFitMultiplier, uiTableEntry, auiFitSelectors);
+				if (fFitError >= fTableError)
+				{
+					break;
+				}
+
+				fTableError = fFitError;
+				iBase = iFitBase;
+				iMultiplier = iFitMultiplier;
+				memcpy(auiSelectors, auiFitSelectors, sizeof(auiSelectors));
+			}
+
+			aiBases[uiTableEntry] = iBase;
+			aiMultipliers[uiTableEntry] = iMultiplier;
+			afErrors[uiTableEntry] = fTableError;
+		}
+
+		// rounding the fit can be off by one
+		float fBestError = FLT_MAX;
+		*a_puiBase = 0;
+		*a_puiMultiplier = 0;
+		*a_puiTableEntry = 0;
+
+		for (unsigned int uiNudge = 0; uiNudge < NUDGED_TABLE_ENTRYS; uiNudge++)
+		{
+			// the next best table entry
+			unsigned int uiTableEntry = 0;
+			for (unsigned int uiEntry = 1; uiEntry < EacModifierTable::ENTRYS; uiEntry++)
+			{
+				if (afErrors[uiEntry] < afErrors[uiTableEntry])
+				{
+					uiTableEntry = uiEntry;
+				}
+			}
+
+			int iBase = aiBases[uiTableEntry];
+			int iMultiplier = aiMultipliers[uiTableEntry];
+			float fTableError = afErrors[uiTableEntry];
+			afErrors[uiTableEntry] = FLT_MAX;
+
+			unsigned int auiSelectors[PIXELS];
+			int iBestBase = iBase;
+			int iBestMultiplier = iMultiplier;
+			for (int iBase2 = std::max(iBase - 1, 0); iBase2 <= std::min(iBase + 1, 255); iBase2++)
+			{
+				for (int iMultiplier2 = std::max(iMultiplier - 1, iMinMultiplier); iMultiplier2 <= std::min(iMultiplier + 1, 15); iMultiplier2++)
+				{
+					if (iBase2 == iBase && iMultiplier2 == iMultiplier)
+					{
+						continue;
+					}
+
+					float fError = CalcSquaredError(iBase2, iMultiplier2, uiTableEntry, auiSelectors);
+					if (fError < fTableError)
+					{
+						fTableError = fError;
+						iBestBase = iBase2;
+						iBestMultiplier = iMultiplier2;
+					}
+				}
+			}
+
+			if (fTableError < fBestError)
+			{
+				fBestError = fTableError;
+				*a_puiBase = (unsigned int)iBestBase;
+				*a_puiMultiplier = (unsigned int)iBestMultiplier;
+				*a_puiTableEntry = uiTableEntry;
+			}
+		}
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	//
+	template class EacSearch<EacChannel::A8>;
+	template class EacSearch<EacChannel::R11>;
+	template class EacSearch<EacChannel::G11>;
+
+} // namespace Etc
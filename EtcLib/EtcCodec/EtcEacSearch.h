@@ -0,0 +1,115 @@
+/*
+ * Copyright 2015 The Etc2Comp Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "EtcBlock4x4Encoding.h"
+#include "EtcBlockError.h"
+
+namespace Etc
+{
+
+	// ################################################################################
+	// EacModifierTable
+	// the modifier table of the EAC formats A8 (the alpha of RGBA8), R11 and RG11
+	// ################################################################################
+
+	class EacModifierTable
+	{
+	public:
+
+		static const unsigned int ENTRYS = 16;
+		static const unsigned int SELECTORS = 8;
+
+		static const float s_aafModifiers[ENTRYS][SELECTORS];
+	};
+
+	// the channel an EacSearch encodes
+	enum class EacChannel
+	{
+		A8,			// alpha of RGBA8, compared by squared error
+		R11,		// red of R11 and RG11, compared with the error metric
+		G11			// green of RG11, compared with the error metric
+	};
+
+	// ################################################################################
+	// EacSearch
+	// the base, multiplier, modifier table entry and selector search shared by the EAC channels
+	// ################################################################################
+
+	template <EacChannel C>
+	class EacSearch
+	{
+	public:
+
+		static const unsigned int PIXELS = Block4x4Encoding::PIXELS;
+
+		// the best encoding found so far
+		struct Encoding
+		{
+			float fBase;				// 0-1, also for the signed formats
+			float fMultiplier;
+			unsigned int uiTableEntry;
+			unsigned int auiSelectors[PIXELS];
+			float afDecodedValues[PIXELS];
+			float fError;
+		};
+
+		EacSearch(const ColorFloatRGBA *a_pafrgbaSource, ErrorMetric a_errormetric);
+
+		// try the bases and multipliers within a radius of the ones that span the channel's range
+		// a_uiSelectorsUsed limits the number of selector combinations to try
+		// replaces a_pencoding and returns true if a lower error was found
+		bool Search(unsigned int a_uiSelectorsUsed, float a_fBaseRadius, float a_fMultiplierRadius,
+					Encoding *a_pencoding);
+
+		// closed-form search, much faster than Search() and a little less accurate
+		// replaces a_pencoding and returns true if a lower error was found
+		bool SearchFast(Encoding *a_pencoding);
+
+		// table lookup for a channel whose pixels all have the same 8-bit value
+		// returns false without searching if they don't, else replaces a_pencoding like Search()
+		bool SearchSolid(Encoding *a_pencoding);
+
+		// decode the 8 selector values of a base, multiplier and modifier table entry
+		static void DecodeValues(float a_fBase, float a_fMultiplier, unsigned int a_uiTableEntry,
+									float *a_pafValues);
+
+	private:
+
+		static const unsigned int SELECTORS = EacModifierTable::SELECTORS;
+
+		bool Try(float a_fBase, float a_fMultiplier, unsigned int a_uiTableEntry, Encoding *a_pencoding);
+
+		float FindSelectors(const float *a_pafValues, unsigned int *a_pauiSelectors) const;
+
+		float CalcSquaredError(int a_iBase, int a_iMultiplier, unsigned int a_uiTableEntry,
+								unsigned int *a_pauiSelectors) const;
+
+		void Fit(unsigned int *a_puiBase, unsigned int *a_puiMultiplier, unsigned int *a_puiTableEntry) const;
+
+		const ColorFloatRGBA *m_pafrgbaSource;
+
+		float m_afValues[PIXELS];		// the channel of the source, 0 for border pixels
+		float m_afWeights[PIXELS];		// 0 for border pixels, else 1
+		float m_fMinValue;
+		float m_fMaxValue;
+
+		EacSelectorsFunction m_pfnEacSelectors;
+		EacMetricSelectorsFunction m_pfnEacMetricSelectors;
+	};
+
+} // namespace Etc
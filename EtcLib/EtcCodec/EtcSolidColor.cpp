@@ -0,0 +1,489 @@
+/*
+ * Copyright 2015 The Etc2Comp Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+EtcSolidColor.cpp
+
+SolidColor finds the best encoding of a block whose pixels all have the same color.
+
+The ETC1 and T modes decode such a block best with a single color, since every pixel picks its selector
+for the same source color: a base color plus a modifier that is added to all 3 channels (the ETC1 CW
+modifiers, the T mode distances, or nothing for the T mode's first color).  Once the modifier is picked,
+each channel's best base only depends on the channel's value, so it is looked up in a table of the 256
+values.
+
+Planar decodes a gradient, which can get closer to a value on average than any single color, e.g. some
+pixels exact and the rest one step off.  Its channels are independent too, so each channel's best origin,
+horizontal and vertical colors are looked up in a table of the 256 values as well.  That table holds the
+error of all 16 pixels, so blocks with border pixels search the few colors around the value instead.
+
+The tables are built once, the first time they're needed.  Finding the encoding tries every modifier,
+which adds up 3 table errors each: O(1) per block, instead of the iterations of the encoders.
+
+*/
+
+#include "EtcConfig.h"
+#include "EtcSolidColor.h"
+
+#include <climits>
+#include <cmath>
+
+namespace Etc
+{
+	static const unsigned int VALUES = 256;
+	static const unsigned int PIXELS = 16;
+	static const unsigned int ALL_PIXELS = (1u << PIXELS) - 1;
+
+	static const unsigned int CW_RANGES = 8;
+	static const unsigned int CW_SELECTORS = 4;
+	static const unsigned int T_DISTANCES = 8;
+
+	// the planar colors searched are within this many steps of the base closest to the value
+	// the best planar colors of every value and border are within 2 steps
+	static const int PLANAR_SEARCH_RADIUS = 2;
+
+	// the ETC1 CW modifiers and the T and H distances, in 8-bit steps
+	static const int s_aaiCwTable[CW_RANGES][CW_SELECTORS] =
+	{
+		{ 2, 8, -2, -8 },
+		{ 5, 17, -5, -17 },
+		{ 9, 29, -9, -29 },
+		{ 13, 42, -13, -42 },
+		{ 18, 60, -18, -60 },
+		{ 24, 80, -24, -80 },
+		{ 33, 106, -33, -106 },
+		{ 47, 183, -47, -183 }
+	};
+
+	static const int s_aiTDistanceTable[T_DISTANCES] = { 3, 6, 11, 16, 23, 32, 41, 64 };
+
+	// the T mode selectors that add and subtract the distance from the second color
+	static const unsigned int T_PLUS_SELECTOR = 1;
+	static const unsigned int T_MINUS_SELECTOR = 3;
+
+	// ----------------------------------------------------------------------------------------------------
+	// expand a base to 8 bits by repeating its high bits
+	//
+	static inline int ExpandBase(unsigned int a_uiBase, unsigned int a_uiBaseBits)
+	{
+		return (int)((a_uiBase << (8 - a_uiBaseBits)) | (a_uiBase >> (2 * a_uiBaseBits - 8)));
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	//
+	static inline int Clamp255(int a_iValue)
+	{
+		if (a_iValue < 0)
+		{
+			return 0;
+		}
+		else if (a_iValue > 255)
+		{
+			return 255;
+		}
+
+		return a_iValue;
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// find the planar origin, horizontal and vertical bases of one channel with the lowest error for a_uiValue
+	// a_uiPixelMask has a bit for each pixel that isn't a border pixel
+	// returns the sum of the squared errors of those pixels
+	//
+	static unsigned int SearchPlanarChannel(unsigned int a_uiBaseBits, unsigned int a_uiValue,
+											unsigned int a_uiPixelMask, unsigned int *a_pauiBases)
+	{
+		int iMaxBase = (1 << a_uiBaseBits) - 1;
+		int iClosestBase = ((int)a_uiValue * iMaxBase + 127) / 255;
+		int iMinBase = iClosestBase - PLANAR_SEARCH_RADIUS < 0 ? 0 : iClosestBase - PLANAR_SEARCH_RADIUS;
+		int iLastBase = iClosestBase + PLANAR_SEARCH_RADIUS > iMaxBase ? iMaxBase : iClosestBase + PLANAR_SEARCH_RADIUS;
+
+		unsigned int uiBestError = UINT_MAX;
+
+		for (int iOrigin = iMinBase; iOrigin <= iLastBase; iOrigin++)
+		{
+			int iO = ExpandBase((unsigned int)iOrigin, a_uiBaseBits);
+
+			for (int iHorizontal = iMinBase; iHorizontal <= iLastBase; iHorizontal++)
+			{
+				int iH = ExpandBase((unsigned int)iHorizontal, a_uiBaseBits);
+
+				for (int iVertical = iMinBase; iVertical <= iLastBase; iVertical++)
+				{
+					int iV = ExpandBase((unsigned int)iVertical, a_uiBaseBits);
+
+					unsigned int uiError = 0;
+					for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
+					{
+						if ((a_uiPixelMask & (1u << uiPixel)) == 0)
+						{
+							continue;
+						}
+
+						// same as Block4x4Encoding_RGB8::DecodePixels_Planar()
+						int iX = (int)(uiPixel >> 2);
+						int iY = (int)(uiPixel & 3);
+						int iDecoded = Clamp255((iX * (iH - iO) + iY * (iV - iO) + 4 * iO + 2) >> 2);
+
+						int iDelta = iDecoded - (int)a_uiValue;
+						uiError += (unsigned int)(iDelta * iDelta);
+					}
+
+					if (uiError < uiBestError)
+					{
+						a_pauiBases[0] = (unsigned int)iOrigin;
+						a_pauiBases[1] = (unsigned int)iHorizontal;
+						a_pauiBases[2] = (unsigned int)iVertical;
+						uiBestError = uiError;
+					}
+				}
+			}
+		}
+
+		return uiBestError;
+	}
+
+	// ################################################################################
+	// SolidColorTable
+	// the base with the lowest error for each 8-bit value, given the bits of the base and the modifier
+	// ################################################################################
+
+	class SolidColorTable
+	{
+	public:
+
+		void Init(unsigned int a_uiBaseBits, int a_iModifier)
+		{
+			for (unsigned int uiValue = 0; uiValue < VALUES; uiValue++)
+			{
+				unsigned int uiBestError = UINT_MAX;
+
+				for (unsigned int uiBase = 0; uiBase < (1u << a_uiBaseBits); uiBase++)
+				{
+					int iDecoded = Clamp255(ExpandBase(uiBase, a_uiBaseBits) + a_iModifier);
+
+					int iDelta = iDecoded - (int)uiValue;
+					unsigned int uiError = (unsigned int)(iDelta * iDelta);
+
+					if (uiError < uiBestError)
+					{
+						m_aucBases[uiValue] = (unsigned char)uiBase;
+						m_ausErrors[uiValue] = (unsigned short)uiError;
+						uiBestError = uiError;
+					}
+				}
+			}
+		}
+
+		inline unsigned int GetBase(unsigned int a_uiValue) const
+		{
+			return m_aucBases[a_uiValue];
+		}
+
+		// the error of one pixel
+		inline unsigned int GetError(unsigned int a_uiValue) const
+		{
+			return m_ausErrors[a_uiValue];
+		}
+
+	private:
+
+		unsigned char m_aucBases[VALUES];
+		unsigned short m_ausErrors[VALUES];
+	};
+
+	// ################################################################################
+	// PlanarSolidColorTable
+	// the planar origin, horizontal and vertical bases of one channel with the lowest error for each 8-bit
+	// value, for blocks without border pixels
+	// ################################################################################
+
+	class PlanarSolidColorTable
+	{
+	public:
+
+		void Init(unsigned int a_uiBaseBits)
+		{
+			for (unsigned int uiValue = 0; uiValue < VALUES; uiValue++)
+			{
+				unsigned int auiBases[3] = {};
+				m_auiErrors[uiValue] = SearchPlanarChannel(a_uiBaseBits, uiValue, ALL_PIXELS, auiBases);
+				for (unsigned int uiBase = 0; uiBase < 3; uiBase++)
+				{
+					m_aaucBases[uiValue][uiBase] = (unsigned char)auiBases[uiBase];
+				}
+			}
+		}
+
+		// origin, horizontal and vertical
+		inline unsigned int GetBase(unsigned int a_uiValue, unsigned int a_uiBase) const
+		{
+			return m_aaucBases[a_uiValue][a_uiBase];
+		}
+
+		// the error of all 16 pixels
+		inline unsigned int GetError(unsigned int a_uiValue) const
+		{
+			return m_auiErrors[a_uiValue];
+		}
+
+	private:
+
+		unsigned char m_aaucBases[VALUES][3];
+		unsigned int m_auiErrors[VALUES];
+	};
+
+	// ----------------------------------------------------------------------------------------------------
+	// the tables of every modifier of every mode
+	//
+	struct SolidColorTables
+	{
+		SolidColorTables(void)
+		{
+			for (unsigned int uiCW = 0; uiCW < CW_RANGES; uiCW++)
+			{
+				for (unsigned int uiSelector = 0; uiSelector < CW_SELECTORS; uiSelector++)
+				{
+					aaDifferential[uiCW][uiSelector].Init(5, s_aaiCwTable[uiCW][uiSelector]);
+					aaIndividual[uiCW][uiSelector].Init(4, s_aaiCwTable[uiCW][uiSelector]);
+				}
+			}
+
+			for (unsigned int uiDistance = 0; uiDistance < T_DISTANCES; uiDistance++)
+			{
+				aTPlus[uiDistance].Init(4, s_aiTDistanceTable[uiDistance]);
+				aTMinus[uiDistance].Init(4, -s_aiTDistanceTable[uiDistance]);
+			}
+
+			t.Init(4, 0);
+			planar6.Init(6);
+			planar7.Init(7);
+		}
+
+		SolidColorTable aaDifferential[CW_RANGES][CW_SELECTORS];
+		SolidColorTable aaIndividual[CW_RANGES][CW_SELECTORS];
+		SolidColorTable aTPlus[T_DISTANCES];
+		SolidColorTable aTMinus[T_DISTANCES];
+		SolidColorTable t;				// the first T color, which isn't modified
+		PlanarSolidColorTable planar6;	// red and blue
+		PlanarSolidColorTable planar7;	// green
+	};
+
+	static const SolidColorTables &GetSolidColorTables(void)
+	{
+		static const SolidColorTables s_solidcolortables;
+
+		return s_solidcolortables;
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// replace a_pencoding if the bases of a_pauiValues in the 3 tables have a lower error
+	//
+	static void TryTables(const SolidColorTable &a_tableRed,
+							const SolidColorTable &a_tableGreen,
+							const SolidColorTable &a_tableBlue,
+							const unsigned int *a_pauiValues, unsigned int a_uiPixels,
+							Block4x4Encoding::Mode a_mode, bool a_boolDiff,
+							unsigned int a_uiCW, unsigned int a_uiSelector,
+							SolidColor::Encoding *a_pencoding)
+	{
+		unsigned int uiError = a_uiPixels * (a_tableRed.GetError(a_pauiValues[0]) +
+												a_tableGreen.GetError(a_pauiValues[1]) +
+												a_tableBlue.GetError(a_pauiValues[2]));
+
+		if (uiError < a_pencoding->uiError)
+		{
+			a_pencoding->mode = a_mode;
+			a_pencoding->boolDiff = a_boolDiff;
+			a_pencoding->auiBase[0] = a_tableRed.GetBase(a_pauiValues[0]);
+			a_pencoding->auiBase[1] = a_tableGreen.GetBase(a_pauiValues[1]);
+			a_pencoding->auiBase[2] = a_tableBlue.GetBase(a_pauiValues[2]);
+			a_pencoding->uiCW = a_uiCW;
+			a_pencoding->uiSelector = a_uiSelector;
+			a_pencoding->uiError = uiError;
+		}
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// replace a_pencoding if planar has a lower error
+	//
+	static void TryPlanar(const SolidColorTables &a_tables,
+							const unsigned int *a_pauiValues, unsigned int a_uiPixelMask,
+							SolidColor::Encoding *a_pencoding)
+	{
+		static const unsigned int s_auiBaseBits[3] = { 6, 7, 6 };
+
+		unsigned int aauiBases[3][3];
+		unsigned int uiError = 0;
+
+		for (unsigned int uiChannel = 0; uiChannel < 3; uiChannel++)
+		{
+			unsigned int uiValue = a_pauiValues[uiChannel];
+
+			if (a_uiPixelMask == ALL_PIXELS)
+			{
+				const PlanarSolidColorTable &table = uiChannel == 1 ? a_tables.planar7 : a_tables.planar6;
+				for (unsigned int uiBase = 0; uiBase < 3; uiBase++)
+				{
+					aauiBases[uiChannel][uiBase] = table.GetBase(uiValue, uiBase);
+				}
+				uiError += table.GetError(uiValue);
+			}
+			else
+			{
+				uiError += SearchPlanarChannel(s_auiBaseBits[uiChannel], uiValue, a_uiPixelMask, aauiBases[uiChannel]);
+			}
+		}
+
+		if (uiError < a_pencoding->uiError)
+		{
+			a_pencoding->mode = Block4x4Encoding::MODE_PLANAR;
+			a_pencoding->boolDiff = true;
+			for (unsigned int uiChannel = 0; uiChannel < 3; uiChannel++)
+			{
+				a_pencoding->auiBase[uiChannel] = aauiBases[uiChannel][0];
+				a_pencoding->auiHorizontal[uiChannel] = aauiBases[uiChannel][1];
+				a_pencoding->auiVertical[uiChannel] = aauiBases[uiChannel][2];
+			}
+			a_pencoding->uiCW = 0;
+			a_pencoding->uiSelector = 0;
+			a_pencoding->uiError = uiError;
+		}
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// on ties, the modes are preferred in the order differential, individual, planar, T
+	//
+	bool SolidColor::Find(const ColorFloatRGBA *a_pafrgbaSource, unsigned int a_uiModes, Encoding *a_pencoding)
+	{
+		unsigned int uiPixelMask = 0;
+		unsigned int uiPixels = 0;
+		unsigned int uiFirstPixel = 0;
+		for (unsigned int uiPixel = 0; uiPixel < PIXELS; uiPixel++)
+		{
+			if (!std::isnan(a_pafrgbaSource[uiPixel].fA))
+			{
+				if (uiPixels == 0)
+				{
+					uiFirstPixel = uiPixel;
+				}
+				uiPixelMask |= 1u << uiPixel;
+				uiPixels++;
+			}
+		}
+
+		const ColorFloatRGBA &frgbaColor = a_pafrgbaSource[uiFirstPixel];
+
+		unsigned int auiValues[3];
+		if (uiPixels == 0 ||
+			!GetEightBitValue(frgbaColor.fR, &auiValues[0]) ||
+			!GetEightBitValue(frgbaColor.fG, &auiValues[1]) ||
+			!GetEightBitValue(frgbaColor.fB, &auiValues[2]))
+		{
+			return false;
+		}
+
+		const SolidColorTables &tables = GetSolidColorTables();
+
+		a_pencoding->uiError = UINT_MAX;
+
+		if (a_uiModes & ETC1_DIFFERENTIAL)
+		{
+			for (unsigned int uiCW = 0; uiCW < CW_RANGES; uiCW++)
+			{
+				for (unsigned int uiSelector = 0; uiSelector < CW_SELECTORS; uiSelector++)
+				{
+					const SolidColorTable &table = tables.aaDifferential[uiCW][uiSelector];
+					TryTables(table, table, table, auiValues, uiPixels, Block4x4Encoding::MODE_ETC1, true,
+								uiCW, uiSelector, a_pencoding);
+				}
+			}
+		}
+
+		if (a_uiModes & ETC1_INDIVIDUAL)
+		{
+			for (unsigned int uiCW = 0; uiCW < CW_RANGES; uiCW++)
+			{
+				for (unsigned int uiSelector = 0; uiSelector < CW_SELECTORS; uiSelector++)
+				{
+					const SolidColorTable &table = tables.aaIndividual[uiCW][uiSelector];
+					TryTables(table, table, table, auiValues, uiPixels, Block4x4Encoding::MODE_ETC1, false,
+								uiCW, uiSelector, a_pencoding);
+				}
+			}
+		}
+
+		if (a_uiModes & PLANAR)
+		{
+			TryPlanar(tables, auiValues, uiPixelMask, a_pencoding);
+		}
+
+		if (a_uiModes & T)
+		{
+			TryTables(tables.t, tables.t, tables.t, auiValues, uiPixels, Block4x4Encoding::MODE_T, true,
+						0, 0, a_pencoding);
+
+			for (unsigned int uiDistance = 0; uiDistance < T_DISTANCES; uiDistance++)
+			{
+				const SolidColorTable &tablePlus = tables.aTPlus[uiDistance];
+				TryTables(tablePlus, tablePlus, tablePlus, auiValues, uiPixels, Block4x4Encoding::MODE_T, true,
+							uiDistance, T_PLUS_SELECTOR, a_pencoding);
+
+				const SolidColorTable &tableMinus = tables.aTMinus[uiDistance];
+				TryTables(tableMinus, tableMinus, tableMinus, auiValues, uiPixels, Block4x4Encoding::MODE_T, true,
+							uiDistance, T_MINUS_SELECTOR, a_pencoding);
+			}
+		}
+
+		return a_pencoding->uiError != UINT_MAX;
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// the channel errors of these metrics only depend on the channel's own decoded value, and grow with its
+	// distance from the source value
+	// REC709 mixes the channels and NORMALXYZ normalizes them, so a closer channel isn't always better
+	//
+	bool SolidColor::IsBestForMetric(ErrorMetric a_errormetric)
+	{
+		return a_errormetric == ErrorMetric::RGBA ||
+				a_errormetric == ErrorMetric::RGBX ||
+				a_errormetric == ErrorMetric::NUMERIC;
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// 8-bit sources are converted to float by dividing by 255
+	//
+	bool SolidColor::GetEightBitValue(float a_fValue, unsigned int *a_puiValue)
+	{
+		if (!(a_fValue >= 0.0f && a_fValue <= 1.0f))
+		{
+			return false;
+		}
+
+		unsigned int uiValue = (unsigned int)roundf(a_fValue * 255.0f);
+		if ((float)uiValue / 255.0f != a_fValue)
+		{
+			return false;
+		}
+
+		*a_puiValue = uiValue;
+		return true;
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	//
+
+} // namespace Etc
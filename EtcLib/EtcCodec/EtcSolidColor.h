@@ -0,0 +1,69 @@
+/*
+ * Copyright 2015 The Etc2Comp Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "EtcBlock4x4Encoding.h"
+#include "EtcColorFloatRGBA.h"
+#include "EtcErrorMetric.h"
+
+namespace Etc
+{
+
+	// ################################################################################
+	// SolidColor
+	// the best RGB encoding of a block whose pixels all have the same 8-bit color
+	// ################################################################################
+
+	class SolidColor
+	{
+	public:
+
+		// the modes a format can pick from
+		static const unsigned int ETC1_DIFFERENTIAL = 1 << 0;
+		static const unsigned int ETC1_INDIVIDUAL = 1 << 1;
+		static const unsigned int PLANAR = 1 << 2;
+		static const unsigned int T = 1 << 3;
+
+		static const unsigned int ETC1_MODES = ETC1_DIFFERENTIAL | ETC1_INDIVIDUAL;
+		static const unsigned int ETC2_MODES = ETC1_DIFFERENTIAL | ETC1_INDIVIDUAL | PLANAR | T;
+
+		struct Encoding
+		{
+			Block4x4Encoding::Mode mode;	// MODE_ETC1, MODE_PLANAR or MODE_T
+			bool boolDiff;					// MODE_ETC1 only
+			unsigned int auiBase[3];		// RGB, 5 bits if differential, 4 bits if individual or T, 6/7/6 bits if planar
+			unsigned int auiHorizontal[3];	// MODE_PLANAR only, 6/7/6 bits
+			unsigned int auiVertical[3];	// MODE_PLANAR only, 6/7/6 bits
+			unsigned int uiCW;				// the ETC1 CW or the T distance
+			unsigned int uiSelector;		// the selector of every pixel, 0 (the base color itself) for planar
+			unsigned int uiError;			// sum of the squared 8-bit channel errors of the pixels that aren't border pixels
+		};
+
+		// find the encoding of a_pafrgbaSource with the lowest error of a_uiModes
+		// the 16 source pixels that aren't border pixels must all have the same RGB
+		// returns false if they're all border pixels or a channel isn't an 8-bit value
+		static bool Find(const ColorFloatRGBA *a_pafrgbaSource, unsigned int a_uiModes, Encoding *a_pencoding);
+
+		// true if a_errormetric adds up squared channel errors, so that Find() picks its best encoding
+		static bool IsBestForMetric(ErrorMetric a_errormetric);
+
+		// the 8-bit value a channel is encoded from, false if a_fValue isn't one
+		static bool GetEightBitValue(float a_fValue, unsigned int *a_puiValue);
+
+	};
+
+} // namespace Etc
@@ -42,18 +42,27 @@ namespace Etc
 	// allocate enough memory to add all of the image's 4x4 blocks later
 	// allocate enough buckets to sort the blocks
 	//
-	SortedBlockList::SortedBlockList(unsigned int a_uiImageBlocks, unsigned int a_uiBuckets)
+	SortedBlockList::SortedBlockList(unsigned int a_uiImageBlocks, unsigned int a_uiBuckets,
+										const float *a_pafBlockError, const bool *a_paboolBlockDone)
 	{
 		m_uiImageBlocks = a_uiImageBlocks;
 		m_iBuckets = (int)a_uiBuckets;
+		m_pafBlockError = a_pafBlockError;
+		m_paboolBlockDone = a_paboolBlockDone;
 
 		m_uiAddedBlocks = 0;
 		m_uiSortedBlocks = 0;
-		m_palinkPool = new Link[m_uiImageBlocks];
-		m_pabucket = new Bucket[m_iBuckets];
+		m_papblock = new Block4x4 *[m_uiImageBlocks];
+		m_paiBlockBucket = new int[m_uiImageBlocks];
+		m_pauiSortedBlocks = new unsigned int[m_uiImageBlocks];
 		m_fMaxError = 0.0f;
 
-		InitBuckets();
+		m_uiChunks = 0;
+		m_uiAllocatedChunks = 0;
+		m_pafChunkMaxError = nullptr;
+		m_pauiChunkBucketCounts = nullptr;
+		m_pauiBucketBlocks = new unsigned int[m_iBuckets];
+		memset(m_pauiBucketBlocks, 0, m_iBuckets * sizeof(unsigned int));
 
 	}
 
@@ -61,8 +70,12 @@ namespace Etc
 	//
 	SortedBlockList::~SortedBlockList(void)
 	{
-		delete[] m_palinkPool;
-		delete[] m_pabucket;
+		delete[] m_papblock;
+		delete[] m_paiBlockBucket;
+		delete[] m_pauiSortedBlocks;
+		delete[] m_pafChunkMaxError;
+		delete[] m_pauiChunkBucketCounts;
+		delete[] m_pauiBucketBlocks;
 	}
 
 	// ----------------------------------------------------------------------------------------------------
@@ -72,8 +85,7 @@ namespace Etc
     void SortedBlockList::AddBlock(Block4x4 *a_pblock)
     {
         assert(m_uiAddedBlocks < m_uiImageBlocks);
-        Link *plink = &m_palinkPool[m_uiAddedBlocks++];
-		plink->Init(a_pblock);
+		m_papblock[m_uiAddedBlocks++] = a_pblock;
     }
 
 	// ----------------------------------------------------------------------------------------------------
@@ -81,140 +93,171 @@ namespace Etc
 	//
 	// first, determine the maximum error, then assign an error range to each bucket
 	// next, determine which bucket each 4x4 block belongs to based on the 4x4 block's error
-	// add the 4x4 block to the appropriate bucket
-	// lastly, walk thru the buckets and add each bucket to a sorted linked list
+	// count the blocks in each bucket and turn the counts into write offsets
+	// lastly, write the index of each 4x4 block to its bucket's section of the sorted array
 	//
 	// the resultant sorting is an approximate sorting from most to least error
+	// blocks in the same bucket stay in the order they were added
 	//
     void SortedBlockList::Sort(void)
     {
+		Sort(1, [](unsigned int a_uiChunks, auto const &a_function)
+		{
+			for (unsigned int uiChunk = 0; uiChunk < a_uiChunks; uiChunk++)
+			{
+				a_function(uiChunk);
+			}
+		});
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// prepare the per chunk state for a sort with a_uiChunks chunks
+	//
+	void SortedBlockList::BeginSort(unsigned int a_uiChunks)
+	{
 		assert(m_uiAddedBlocks == m_uiImageBlocks);
-        InitBuckets();
+		assert(a_uiChunks > 0);
 
-        // find max block error
-        m_fMaxError = -1.0f;
+		if (a_uiChunks > m_uiAllocatedChunks)
+		{
+			delete[] m_pafChunkMaxError;
+			delete[] m_pauiChunkBucketCounts;
 
-        for (unsigned int uiLink = 0; uiLink < m_uiAddedBlocks; uiLink++)
-        {
-            Link *plinkBlock = &m_palinkPool[uiLink];
+			m_uiAllocatedChunks = a_uiChunks;
+			m_pafChunkMaxError = new float[m_uiAllocatedChunks];
+			m_pauiChunkBucketCounts = new unsigned int[m_uiAllocatedChunks * m_iBuckets];
+		}
+
+		m_uiChunks = a_uiChunks;
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// find the max block error within a chunk
+	//
+	void SortedBlockList::FindMaxError(unsigned int a_uiChunk)
+	{
+		float fMaxError = -1.0f;
+
+		unsigned int uiEndBlock = GetChunkFirstBlock(a_uiChunk + 1);
+		for (unsigned int uiBlock = GetChunkFirstBlock(a_uiChunk); uiBlock < uiEndBlock; uiBlock++)
+		{
+			float fBlockError = m_pafBlockError[uiBlock];
+			if (fBlockError > fMaxError)
+			{
+				fMaxError = fBlockError;
+			}
+		}
+
+		m_pafChunkMaxError[a_uiChunk] = fMaxError;
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// combine the max errors of all chunks
+	//
+	void SortedBlockList::ReduceMaxError(void)
+	{
+		m_fMaxError = -1.0f;
+
+		for (unsigned int uiChunk = 0; uiChunk < m_uiChunks; uiChunk++)
+		{
+			if (m_pafChunkMaxError[uiChunk] > m_fMaxError)
+			{
+				m_fMaxError = m_pafChunkMaxError[uiChunk];
+			}
+		}
 
-            float fBlockError = plinkBlock->GetBlock()->GetError();
-            if (fBlockError > m_fMaxError)
-            {
-                m_fMaxError = fBlockError;
-            }
-        }
         // prevent divide by zero or divide by negative
         if (m_fMaxError <= 0.0f)
         {
             m_fMaxError = 1.0f;
         }
-		//used for debugging
-		//int numDone = 0;
-        // put all of the blocks with unfinished encodings into the appropriate bucket
-		m_uiSortedBlocks = 0;
-        for (unsigned int uiLink = 0; uiLink < m_uiAddedBlocks; uiLink++)
-        {
-            Link *plinkBlock = &m_palinkPool[uiLink];
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// assign each block of a chunk to a bucket and count the blocks in each of the chunk's buckets
+	// blocks with finished encodings are not sorted
+	//
+	void SortedBlockList::CountBuckets(unsigned int a_uiChunk)
+	{
+		unsigned int *pauiBucketCounts = &m_pauiChunkBucketCounts[a_uiChunk * m_iBuckets];
+		memset(pauiBucketCounts, 0, m_iBuckets * sizeof(unsigned int));
 
+		unsigned int uiEndBlock = GetChunkFirstBlock(a_uiChunk + 1);
+		for (unsigned int uiBlock = GetChunkFirstBlock(a_uiChunk); uiBlock < uiEndBlock; uiBlock++)
+		{
 			// if the encoding is done, don't add it to the list
-			if (plinkBlock->GetBlock()->GetEncoding()->IsDone())
+			if (m_paboolBlockDone[uiBlock])
 			{
-				//numDone++;
+				m_paiBlockBucket[uiBlock] = DONE_BUCKET;
 				continue;
 			}
 
             // calculate the appropriate sort bucket
-            float fBlockError = plinkBlock->GetBlock()->GetError();
+            float fBlockError = m_pafBlockError[uiBlock];
             int iBucket = (int) floorf(m_iBuckets * fBlockError / m_fMaxError);
             // clamp to bucket index
             iBucket = iBucket < 0 ? 0 : iBucket >= m_iBuckets ? m_iBuckets - 1 : iBucket;
 
-            // add block to bucket
-			{
-				Bucket *pbucket = &m_pabucket[iBucket];
-				if (pbucket->plinkLast)
-				{
-					pbucket->plinkLast->SetNext(plinkBlock);
-					pbucket->plinkLast = plinkBlock;
-				}
-				else
-				{
-					pbucket->plinkFirst = pbucket->plinkLast = plinkBlock;
-				}
-				plinkBlock->SetNext(nullptr);
-			}
+			m_paiBlockBucket[uiBlock] = iBucket;
+			pauiBucketCounts[iBucket]++;
+		}
+	}
 
-			m_uiSortedBlocks++;
+	// ----------------------------------------------------------------------------------------------------
+	// turn the per chunk bucket counts into write offsets into the sorted array
+	// buckets are laid out from most to least error, and chunks in order within each bucket
+	//
+	void SortedBlockList::CalculateBucketOffsets(void)
+	{
+		unsigned int uiOffset = 0;
 
-            if (0)
-            {
-                printf("%u: e=%.3f\n", uiLink, fBlockError);
-                Print();
-                printf("\n\n\n");
-            }
-        }
-		//printf("num blocks already done: %d\n",numDone);
-		//link the blocks together across buckets
-		m_plinkFirst = nullptr;
-		m_plinkLast = nullptr;
 		for (int iBucket = m_iBuckets - 1; iBucket >= 0; iBucket--)
 		{
-			Bucket *pbucket = &m_pabucket[iBucket];
+			unsigned int uiBucketFirst = uiOffset;
 
-			if (pbucket->plinkFirst)
+			for (unsigned int uiChunk = 0; uiChunk < m_uiChunks; uiChunk++)
 			{
-				if (m_plinkFirst == nullptr)
-				{
-					m_plinkFirst = pbucket->plinkFirst;
-				}
-				else
-				{
-					assert(pbucket->plinkLast->GetNext() == nullptr);
-					m_plinkLast->SetNext(pbucket->plinkFirst);
-				}
-
-				m_plinkLast = pbucket->plinkLast;
+				unsigned int *puiCount = &m_pauiChunkBucketCounts[uiChunk * m_iBuckets + iBucket];
+				unsigned int uiCount = *puiCount;
+				*puiCount = uiOffset;
+				uiOffset += uiCount;
 			}
-		}
 
+			m_pauiBucketBlocks[iBucket] = uiOffset - uiBucketFirst;
+		}
 
+		m_uiSortedBlocks = uiOffset;
 	}
 
 	// ----------------------------------------------------------------------------------------------------
-	// clear all of the buckets.  normally done in preparation for a sort
+	// write the indices of a chunk's unfinished blocks to their places in the sorted array
 	//
-	void SortedBlockList::InitBuckets(void)
-    {
-        for (int iBucket = 0; iBucket < m_iBuckets; iBucket++)
-        {
-            Bucket *pbucket = &m_pabucket[iBucket];
+	void SortedBlockList::DistributeBlocks(unsigned int a_uiChunk)
+	{
+		unsigned int *pauiBucketOffsets = &m_pauiChunkBucketCounts[a_uiChunk * m_iBuckets];
 
-            pbucket->plinkFirst = nullptr;
-            pbucket->plinkLast = nullptr;
-        }
-    }
+		unsigned int uiEndBlock = GetChunkFirstBlock(a_uiChunk + 1);
+		for (unsigned int uiBlock = GetChunkFirstBlock(a_uiChunk); uiBlock < uiEndBlock; uiBlock++)
+		{
+			int iBucket = m_paiBlockBucket[uiBlock];
+			if (iBucket == DONE_BUCKET)
+			{
+				continue;
+			}
+
+			m_pauiSortedBlocks[pauiBucketOffsets[iBucket]++] = uiBlock;
+		}
+	}
 
     // ----------------------------------------------------------------------------------------------------
-    // print out the list of sorted 4x4 blocks
+    // print out the number of sorted 4x4 blocks in each bucket
 	// normally used for debugging
 	//
     void SortedBlockList::Print(void)
     {
         for (int iBucket = m_iBuckets-1; iBucket >= 0; iBucket--)
         {
-            Bucket *pbucket = &m_pabucket[iBucket];
-
-            unsigned int uiBlocks = 0;
-            for (Link *plink = pbucket->plinkFirst; plink != nullptr; plink = plink->GetNext() )
-            {
-                uiBlocks++;
-
-				if (plink == pbucket->plinkLast)
-				{
-					break;
-				}
-            }
+            unsigned int uiBlocks = m_pauiBucketBlocks[iBucket];
 
             float fBucketError = m_fMaxError * iBucket / m_iBuckets;
             float fBucketRMS = sqrtf(fBucketError / (4.0f*16.0f) );
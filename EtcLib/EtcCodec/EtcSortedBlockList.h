@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <cassert>
+
 namespace Etc
 {
 	class Block4x4;
@@ -24,64 +26,44 @@ namespace Etc
     {
     public:
 
-		class Link
-		{
-		public:
-
-			inline void Init(Block4x4 *a_pblock)
-			{
-				m_pblock = a_pblock;
-				m_plinkNext = nullptr;
-			}
-
-			inline Block4x4 * GetBlock(void)
-			{
-				return m_pblock;
-			}
-
-			inline void SetNext(Link *a_plinkNext)
-			{
-				m_plinkNext = a_plinkNext;
-			}
-
-			inline Link * GetNext(void)
-			{
-				return m_plinkNext;
-			}
-
-			inline Link * Advance(unsigned int a_uiSteps = 1)
-			{
-				Link *plink = this;
-
-				for (unsigned int uiStep = 0; uiStep < a_uiSteps; uiStep++)
-				{
-					if (plink == nullptr)
-					{
-						break;
-					}
+		// a_pafBlockError and a_paboolBlockDone hold the error and done flag of each block in the order the blocks are added
+		SortedBlockList(unsigned int a_uiImageBlocks, unsigned int a_uiBuckets,
+						const float *a_pafBlockError, const bool *a_paboolBlockDone);
+		~SortedBlockList(void);
 
-					plink = plink->m_plinkNext;
-				}
+        void AddBlock(Block4x4 *a_pblock);
 
-				return plink;
-			}
+		// sort on the calling thread
+        void Sort(void);
 
-		private:
+		// sort the added blocks as a_uiChunks independent slices
+		// a_runchunks(uiChunks, function) must call function(uiChunk) once for each uiChunk in [0, uiChunks)
+		// the calls may happen in any order and on any thread; the result does not depend on a_uiChunks
+		template <typename RunChunks>
+		void Sort(unsigned int a_uiChunks, RunChunks &&a_runchunks)
+		{
+			BeginSort(a_uiChunks);
 
-			Block4x4 *m_pblock;
-			Link *m_plinkNext;
-		};
+			a_runchunks(a_uiChunks, [this](unsigned int a_uiChunk) { FindMaxError(a_uiChunk); });
+			ReduceMaxError();
 
-		SortedBlockList(unsigned int a_uiImageBlocks, unsigned int a_uiBuckets);
-		~SortedBlockList(void);
+			a_runchunks(a_uiChunks, [this](unsigned int a_uiChunk) { CountBuckets(a_uiChunk); });
+			CalculateBucketOffsets();
 
-        void AddBlock(Block4x4 *a_pblock);
+			a_runchunks(a_uiChunks, [this](unsigned int a_uiChunk) { DistributeBlocks(a_uiChunk); });
+		}
 
-        void Sort(void);
+		// the a_uiSorted-th block with the most error
+		inline Block4x4 * GetSortedBlock(unsigned int a_uiSorted)
+		{
+			assert(a_uiSorted < m_uiSortedBlocks);
+			return m_papblock[m_pauiSortedBlocks[a_uiSorted]];
+		}
 
-		inline Link * GetLinkToFirstBlock(void)
+		// indices of the unfinished blocks (in the order they were added), from most to least error
+		inline const unsigned int * GetSortedBlockIndices(void)
 		{
-			return m_plinkFirst;
+			return m_pauiSortedBlocks;
 		}
 
 		inline unsigned int GetNumberOfAddedBlocks(void)
@@ -98,26 +80,38 @@ namespace Etc
 
 	private:
 
-        void InitBuckets(void);
+		static const int DONE_BUCKET = -1;
+
+		void BeginSort(unsigned int a_uiChunks);
+		void FindMaxError(unsigned int a_uiChunk);
+		void ReduceMaxError(void);
+		void CountBuckets(unsigned int a_uiChunk);
+		void CalculateBucketOffsets(void);
+		void DistributeBlocks(unsigned int a_uiChunk);
 
-        class Bucket
-        {
-        public:
-            Link *plinkFirst;
-            Link *plinkLast;
-        };
+		inline unsigned int GetChunkFirstBlock(unsigned int a_uiChunk)
+		{
+			return (unsigned int)(((unsigned long long)m_uiAddedBlocks * a_uiChunk) / m_uiChunks);
+		}
 
         unsigned int m_uiImageBlocks;
         int m_iBuckets;
 
 		unsigned int m_uiAddedBlocks;
 		unsigned int m_uiSortedBlocks;
-		Link *m_palinkPool;
-        Bucket *m_pabucket;
+		Block4x4 **m_papblock;					// blocks in the order they were added
+		const float *m_pafBlockError;			// error of each added block
+		const bool *m_paboolBlockDone;			// done flag of each added block
+		int *m_paiBlockBucket;					// bucket of each added block, DONE_BUCKET if the block is done
+		unsigned int *m_pauiSortedBlocks;		// indices into m_papblock, sorted from most to least error
         float m_fMaxError;
 
-		Link *m_plinkFirst;
-		Link *m_plinkLast;
+		// per chunk state of the current sort
+		unsigned int m_uiChunks;
+		unsigned int m_uiAllocatedChunks;
+		float *m_pafChunkMaxError;
+		unsigned int *m_pauiChunkBucketCounts;	// [chunk][bucket] counts, then [chunk][bucket] write offsets
+		unsigned int *m_pauiBucketBlocks;		// total blocks in each bucket
 
     };
 
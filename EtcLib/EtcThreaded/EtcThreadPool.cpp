@@ -0,0 +1,183 @@
+
+#include <cassert>
+
+#include "EtcThreadPool.h"
+
+namespace Etc {
+
+	// ----------------------------------------------------------------------------------------------------
+	// start a_uiThreads worker threads
+	// a pool with no threads is valid and runs all tasks on the calling thread
+	//
+	ThreadPool::ThreadPool(unsigned int const a_uiThreads)
+		: m_aqueue(a_uiThreads + 1)
+		, m_iQueuedTasks(0)
+		, m_uiNextQueue(0)
+		, m_boolStop(false)
+	{
+		m_athread.reserve(a_uiThreads);
+		for (unsigned int uiThread = 0; uiThread < a_uiThreads; uiThread++)
+		{
+			m_athread.emplace_back(&ThreadPool::WorkerLoop, this, uiThread);
+		}
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_boolStop = true;
+		}
+		m_condition.notify_all();
+
+		for (auto &thread : m_athread)
+		{
+			thread.join();
+		}
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// distribute a_uiTasks tasks round-robin over the worker queues and help execute them
+	// returns once every task of this batch has finished
+	// several threads may call Run() on the same pool at the same time
+	//
+	void ThreadPool::Run(unsigned int const a_uiTasks, TaskFunction const &a_function)
+	{
+		if (a_uiTasks == 0)
+		{
+			return;
+		}
+
+		if (m_athread.empty() || a_uiTasks == 1)
+		{
+			for (unsigned int uiTask = 0; uiTask < a_uiTasks; uiTask++)
+			{
+				a_function(uiTask);
+			}
+			return;
+		}
+
+		Batch batch;
+		batch.pfunction = &a_function;
+		batch.uiRemainingTasks = a_uiTasks;
+
+		unsigned int const uiQueues = static_cast<unsigned int>(m_aqueue.size());
+		unsigned int const uiFirstQueue = m_uiNextQueue.fetch_add(1);
+		for (unsigned int uiTask = 0; uiTask < a_uiTasks; uiTask++)
+		{
+			Queue &queue = m_aqueue[(uiFirstQueue + uiTask) % uiQueues];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			queue.tasks.push_back({ &batch, uiTask });
+		}
+
+		// the count is only raised once the tasks are queued, so it never exceeds the tasks in the queues
+		// and a worker that wakes on it always finds one, instead of spinning on empty queues
+		// tasks taken before the count is raised leave it briefly below zero
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_iQueuedTasks += static_cast<int>(a_uiTasks);
+		}
+		m_condition.notify_all();
+
+		// the calling thread works out of the extra queue and steals like a worker
+		unsigned int const uiCallerQueue = uiQueues - 1;
+		while (1)
+		{
+			Task task;
+			if (TryPopTask(uiCallerQueue, task) || TryStealTask(uiCallerQueue, task))
+			{
+				ExecuteTask(task);
+				continue;
+			}
+
+			// nothing left to steal, so the remaining tasks are running on workers
+			std::unique_lock<std::mutex> lock(batch.mutex);
+			batch.condition.wait(lock, [&batch]() { return batch.uiRemainingTasks == 0; });
+			break;
+		}
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// worker thread body
+	// take work from the worker's own queue first, then from the other queues, else sleep
+	//
+	void ThreadPool::WorkerLoop(unsigned int const a_uiQueue)
+	{
+		while (1)
+		{
+			Task task;
+			if (TryPopTask(a_uiQueue, task) || TryStealTask(a_uiQueue, task))
+			{
+				ExecuteTask(task);
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_condition.wait(lock, [this]() { return m_boolStop || m_iQueuedTasks > 0; });
+			if (m_boolStop && m_iQueuedTasks <= 0)
+			{
+				return;
+			}
+		}
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// take the most recently queued task from a queue's own end
+	//
+	bool ThreadPool::TryPopTask(unsigned int const a_uiQueue, Task &a_task)
+	{
+		Queue &queue = m_aqueue[a_uiQueue];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (queue.tasks.empty())
+		{
+			return false;
+		}
+
+		a_task = queue.tasks.back();
+		queue.tasks.pop_back();
+		m_iQueuedTasks--;
+		return true;
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// take the oldest task from any other queue
+	//
+	bool ThreadPool::TryStealTask(unsigned int const a_uiQueue, Task &a_task)
+	{
+		unsigned int const uiQueues = static_cast<unsigned int>(m_aqueue.size());
+		for (unsigned int uiVictim = 1; uiVictim < uiQueues; uiVictim++)
+		{
+			Queue &queue = m_aqueue[(a_uiQueue + uiVictim) % uiQueues];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if (queue.tasks.empty())
+			{
+				continue;
+			}
+
+			a_task = queue.tasks.front();
+			queue.tasks.pop_front();
+			m_iQueuedTasks--;
+			return true;
+		}
+
+		return false;
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// run a task and signal its batch when the last task finishes
+	// the batch lives on the stack of Run(), so it must not be touched after the final decrement
+	//
+	void ThreadPool::ExecuteTask(Task const &a_task)
+	{
+		Batch *pbatch = a_task.pbatch;
+		(*pbatch->pfunction)(a_task.uiTask);
+
+		std::lock_guard<std::mutex> lock(pbatch->mutex);
+		assert(pbatch->uiRemainingTasks > 0);
+		if (--pbatch->uiRemainingTasks == 0)
+		{
+			pbatch->condition.notify_all();
+		}
+	}
+
+} // namespace Etc
@@ -0,0 +1,77 @@
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Etc {
+
+	// a persistent pool of worker threads
+	// the pool is owned by the caller and can be shared across executors, images and encodes
+	// each worker has its own task queue and steals from the other queues when its own runs dry
+	//
+	class ThreadPool
+	{
+	public:
+		using TaskFunction = std::function<void(unsigned int)>;
+
+		ThreadPool(unsigned int a_uiThreads);
+		~ThreadPool();
+
+		ThreadPool(ThreadPool const&) = delete;
+		ThreadPool& operator=(ThreadPool const&) = delete;
+
+		// run a_function(uiTask) for each uiTask in [0, a_uiTasks)
+		// the calling thread helps with the work and returns when all tasks have finished
+		void Run(unsigned int a_uiTasks, TaskFunction const& a_function);
+
+		inline unsigned int GetNumberOfThreads(void) const
+		{
+			return static_cast<unsigned int>(m_athread.size());
+		}
+
+	private:
+
+		struct Batch
+		{
+			TaskFunction const *pfunction;
+			unsigned int uiRemainingTasks;
+			std::mutex mutex;
+			std::condition_variable condition;
+		};
+
+		struct Task
+		{
+			Batch *pbatch;
+			unsigned int uiTask;
+		};
+
+		struct Queue
+		{
+			std::mutex mutex;
+			std::deque<Task> tasks;
+		};
+
+		void WorkerLoop(unsigned int a_uiQueue);
+
+		bool TryPopTask(unsigned int a_uiQueue, Task &a_task);
+		bool TryStealTask(unsigned int a_uiQueue, Task &a_task);
+
+		void ExecuteTask(Task const &a_task);
+
+		std::vector<std::thread> m_athread;
+		std::vector<Queue> m_aqueue;			// one per worker, plus one for external callers
+
+		std::mutex m_mutex;
+		std::condition_variable m_condition;
+		std::atomic<int> m_iQueuedTasks;
+		std::atomic<unsigned int> m_uiNextQueue;
+		bool m_boolStop;
+	};
+
+} // namespace Etc
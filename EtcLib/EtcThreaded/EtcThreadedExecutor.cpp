@@ -1,26 +1,47 @@
 
-#include <future>
+#include <atomic>
 
 #include "Etc.h"
 #include "EtcBlock4x4.h"
+#include "EtcBlockPriorityQueue.h"
 #include "EtcSortedBlockList.h"
 #include "EtcThreadedExecutor.h"
 
 namespace Etc {
 
-	ThreadedExecutor::ThreadedExecutor(Image& a_image)
+	// ----------------------------------------------------------------------------------------------------
+	// claim the next a_uiChunk items of [0, a_uiEnd) from a cursor shared by all jobs
+	// returns false when there is nothing left to claim
+	//
+	static bool ClaimChunk(std::atomic<unsigned int> &a_uiCursor, unsigned int a_uiEnd, unsigned int a_uiChunk,
+							unsigned int &a_uiFirst, unsigned int &a_uiLast)
+	{
+		a_uiFirst = a_uiCursor.fetch_add(a_uiChunk);
+		if (a_uiFirst >= a_uiEnd)
+		{
+			return false;
+		}
+
+		a_uiLast = (a_uiEnd - a_uiFirst < a_uiChunk) ? a_uiEnd : a_uiFirst + a_uiChunk;
+		return true;
+	}
+
+	ThreadedExecutor::ThreadedExecutor(Image& a_image, ThreadPool *a_pthreadpool)
 		: Executor(a_image)
+		, m_pthreadpool(a_pthreadpool)
 	{}
 
 	unsigned int ThreadedExecutor::CalculateJobs(unsigned int a_uiJobs, unsigned int const a_uiMaxJobs) {
-		if (a_uiJobs < 1)
+		if (a_uiJobs > a_uiMaxJobs)
 		{
-			a_uiJobs = 1;
+			a_uiJobs = a_uiMaxJobs;
 			AddToEncodingStatus(WARNING_JOBS_OUT_OF_RANGE);
 		}
-		else if (a_uiJobs > a_uiMaxJobs)
+
+		// a_uiMaxJobs may be 0 as well, so always leave at least one job
+		if (a_uiJobs < 1)
 		{
-			a_uiJobs = a_uiMaxJobs;
+			a_uiJobs = 1;
 			AddToEncodingStatus(WARNING_JOBS_OUT_OF_RANGE);
 		}
 
@@ -45,30 +66,64 @@ namespace Etc {
 
 		a_uiJobs = CalculateJobs(a_uiJobs, a_uiMaxJobs);
 
-		std::future<void> *handle = new std::future<void>[a_uiMaxJobs];
+		// use the caller's pool when there is one, otherwise spin up a pool just for this encode
+		ThreadPool *pownedthreadpool = nullptr;
+		ThreadPool *pthreadpool = m_pthreadpool;
+		if (pthreadpool == nullptr)
+		{
+			pownedthreadpool = new ThreadPool(a_uiJobs - 1);
+			pthreadpool = pownedthreadpool;
+		}
 
 		unsigned int uiNumThreadsNeeded = 0;
 		unsigned int uiUnfinishedBlocks = GetImage().GetNumberOfBlocks();
 
 		uiNumThreadsNeeded = (uiUnfinishedBlocks < a_uiJobs) ? uiUnfinishedBlocks : a_uiJobs;
 
-		for (int i = 0; i < (int)uiNumThreadsNeeded - 1; i++)
-		{
-			handle[i] = async(std::launch::async, &ThreadedExecutor::RunFirstPass, this, m_fEffort, i, uiNumThreadsNeeded);
-		}
+		unsigned int const uiTileBlocks = CalculateTileBlocks(a_uiJobs);
 
-		RunFirstPass(m_fEffort, uiNumThreadsNeeded - 1, uiNumThreadsNeeded);
+		if (m_scheduling == Scheduling::CONTIGUOUS)
+		{
+			std::atomic<unsigned int> uiCursor(0);
 
-		for (int i = 0; i < (int)uiNumThreadsNeeded - 1; i++)
+			pthreadpool->Run(uiNumThreadsNeeded, [&, this](unsigned int) {
+				unsigned int uiFirstBlock, uiEndBlock;
+				while (ClaimChunk(uiCursor, GetImage().GetNumberOfBlocks(), uiTileBlocks, uiFirstBlock, uiEndBlock))
+				{
+					RunFirstPassOnRange(m_fEffort, uiFirstBlock, uiEndBlock);
+				}
+			});
+		}
+		else
 		{
-			handle[i].get();
+			pthreadpool->Run(uiNumThreadsNeeded, [this, uiNumThreadsNeeded](unsigned int a_uiTask) {
+				RunFirstPass(m_fEffort, a_uiTask, uiNumThreadsNeeded);
+			});
 		}
 
 		// perform effort-based encoding
 		if (m_fEffort > ETCCOMP_MIN_EFFORT_LEVEL)
 		{
+			BlockPriorityQueue *ppriorityqueue = nullptr;
+			if (m_prioritization == Prioritization::INCREMENTAL)
+			{
+				ppriorityqueue = new BlockPriorityQueue(GetImage().GetNumberOfBlocks());
+				ppriorityqueue->Init(GetImage().GetBlockErrors(), GetImage().GetBlockDoneFlags());
+			}
+
 			unsigned int uiFinishedBlocks = 0;
-			unsigned int uiTotalEffortBlocks = static_cast<unsigned int>(roundf(0.01f * m_fEffort  * GetImage().GetNumberOfBlocks()));
+
+			// copied blocks are finished without taking from the effort of the blocks that are encoded
+			// solid color blocks are finished without taking from the effort either, which the other blocks
+			// get instead, as they did when solid color blocks were iterated but were seldom among the worst
+			unsigned int uiEncodedBlocks = GetImage().GetNumberOfBlocks() - m_uiCopiedBlocks;
+			unsigned int uiTotalEffortBlocks = m_effortblocks ? m_effortblocks(GetImage()) :
+												static_cast<unsigned int>(roundf(0.01f * m_fEffort  * uiEncodedBlocks)) +
+												m_uiCopiedBlocks + m_uiSolidColorBlocks;
+			if (uiTotalEffortBlocks > GetImage().GetNumberOfBlocks())
+			{
+				uiTotalEffortBlocks = GetImage().GetNumberOfBlocks();
+			}
 
 			if (m_bVerboseOutput)
 			{
@@ -82,8 +137,21 @@ namespace Etc {
 					uiPass++;
 					printf("pass %u\n", uiPass);
 				}
-				m_psortedblocklist->Sort();
-				uiUnfinishedBlocks = m_psortedblocklist->GetNumberOfSortedBlocks();
+				if (ppriorityqueue)
+				{
+					// only the blocks iterated in the last pass changed
+					ppriorityqueue->UpdateSelectedBlocks();
+					uiUnfinishedBlocks = ppriorityqueue->GetNumberOfQueuedBlocks();
+				}
+				else
+				{
+					m_psortedblocklist->Sort(a_uiJobs, [pthreadpool](unsigned int a_uiChunks, ThreadPool::TaskFunction const &a_function) {
+						pthreadpool->Run(a_uiChunks, a_function);
+					});
+					uiUnfinishedBlocks = m_psortedblocklist->GetNumberOfSortedBlocks();
+					m_pauiWorstBlocks = m_psortedblocklist->GetSortedBlockIndices();
+					m_uiWorstBlocks = uiUnfinishedBlocks;
+				}
 				uiFinishedBlocks = GetImage().GetNumberOfBlocks() - uiUnfinishedBlocks;
 				if (m_bVerboseOutput)
 				{
@@ -105,7 +173,31 @@ namespace Etc {
 				unsigned int blocksToIterateThisPass = (uiTotalEffortBlocks - uiFinishedBlocks);
 				uiNumThreadsNeeded = (uiUnfinishedBlocks < a_uiJobs) ? uiUnfinishedBlocks : a_uiJobs;
 
-				if (uiNumThreadsNeeded <= 1)
+				if (ppriorityqueue)
+				{
+					ppriorityqueue->SelectWorstBlocks(blocksToIterateThisPass);
+					m_pauiWorstBlocks = ppriorityqueue->GetSelectedBlockIndices();
+					m_uiWorstBlocks = ppriorityqueue->GetNumberOfSelectedBlocks();
+				}
+
+				if (m_scheduling == Scheduling::CONTIGUOUS)
+				{
+					// jobs claim consecutive runs of the worst blocks
+					unsigned int const uiWorstBlocks = (blocksToIterateThisPass < m_uiWorstBlocks) ? blocksToIterateThisPass : m_uiWorstBlocks;
+					unsigned int const uiChunkBlocks = (uiWorstBlocks / (a_uiJobs * 4) > 0) ? uiWorstBlocks / (a_uiJobs * 4) : 1;
+					std::atomic<unsigned int> uiCursor(0);
+
+					pthreadpool->Run(uiNumThreadsNeeded, [&, this](unsigned int) {
+						unsigned int uiFirstBlock, uiEndBlock;
+						while (ClaimChunk(uiCursor, uiWorstBlocks, uiChunkBlocks, uiFirstBlock, uiEndBlock))
+						{
+							IterateThroughWorstBlockRange(m_fEffort, uiFirstBlock, uiEndBlock);
+						}
+					});
+
+					uiIteratedBlocks = uiWorstBlocks;
+				}
+				else if (uiNumThreadsNeeded <= 1)
 				{
 					//since we already how many blocks each thread will process
 					//cap the thread limit to do the proper amount of work, and not more
@@ -114,20 +206,13 @@ namespace Etc {
 				else
 				{
 					//we have a lot of work to do, so lets multi thread it
-					std::future<unsigned int> *handleToBlockEncoders = new std::future<unsigned int>[uiNumThreadsNeeded-1];
-
-					for (int i = 0; i < (int)uiNumThreadsNeeded - 1; i++)
-					{
-						handleToBlockEncoders[i] = async(std::launch::async, &ThreadedExecutor::IterateThroughWorstBlocks, this, m_fEffort, blocksToIterateThisPass, i, uiNumThreadsNeeded);
-					}
-					uiIteratedBlocks = IterateThroughWorstBlocks(m_fEffort, blocksToIterateThisPass, uiNumThreadsNeeded - 1, uiNumThreadsNeeded);
+					std::atomic<unsigned int> uiIteratedBlocksAllTasks(0);
 
-					for (int i = 0; i < (int)uiNumThreadsNeeded - 1; i++)
-					{
-						uiIteratedBlocks += handleToBlockEncoders[i].get();
-					}
+					pthreadpool->Run(uiNumThreadsNeeded, [&, this](unsigned int a_uiTask) {
+						uiIteratedBlocksAllTasks += IterateThroughWorstBlocks(m_fEffort, blocksToIterateThisPass, a_uiTask, uiNumThreadsNeeded);
+					});
 
-					delete[] handleToBlockEncoders;
+					uiIteratedBlocks = uiIteratedBlocksAllTasks;
 				}
 
 				if (m_bVerboseOutput)
@@ -135,27 +220,47 @@ namespace Etc {
 					printf("    %u iterated blocks\n", uiIteratedBlocks);
 				}
 			}
+
+			delete ppriorityqueue;
+			m_pauiWorstBlocks = nullptr;
+			m_uiWorstBlocks = 0;
 		}
 
 		// generate Etc2-compatible bit-format 4x4 blocks
-		for (int i = 0; i < (int)a_uiJobs - 1; i++)
+		if (m_scheduling == Scheduling::CONTIGUOUS)
 		{
-			handle[i] = async(std::launch::async, [this, i, a_uiJobs]() {
-				SetEncodingBits(i, a_uiJobs);
+			std::atomic<unsigned int> uiCursor(0);
+
+			pthreadpool->Run(a_uiJobs, [&, this](unsigned int) {
+				unsigned int uiFirstBlock, uiEndBlock;
+				while (ClaimChunk(uiCursor, GetImage().GetNumberOfBlocks(), uiTileBlocks, uiFirstBlock, uiEndBlock))
+				{
+					SetEncodingBitsOnRange(uiFirstBlock, uiEndBlock);
+				}
 			});
 		}
-		SetEncodingBits(a_uiJobs - 1, a_uiJobs);
-
-		for (int i = 0; i < (int)a_uiJobs - 1; i++)
+		else
 		{
-			handle[i].get();
+			pthreadpool->Run(a_uiJobs, [this, a_uiJobs](unsigned int a_uiTask) {
+				SetEncodingBits(a_uiTask, a_uiJobs);
+			});
 		}
 
-		delete[] handle;
-		delete m_psortedblocklist;
+		FinishCopiedBlocks();
+
+		delete pownedthreadpool;
 		return m_encodingStatus;
 	}
 
+	// ----------------------------------------------------------------------------------------------------
+	// iterate the encoding of one block and publish its new error and done flag to the image's block arrays
+	//
+	void ThreadedExecutor::IterateBlock(unsigned int const a_uiBlock, float const a_fEffort)
+	{
+		GetImage().GetBlocks()[a_uiBlock].PerformEncodingIteration(GetImage().GetFormat(), GetErrorMetric(), a_fEffort);
+		GetImage().UpdateBlockState(a_uiBlock);
+	}
+
 	// ----------------------------------------------------------------------------------------------------
 	// iterate the encoding thru the blocks with the worst error
 	// stop when a_uiMaxBlocks blocks have been iterated
@@ -167,21 +272,17 @@ namespace Etc {
 													unsigned int a_uiMultithreadingStride)
 	{
 		assert(a_uiMultithreadingStride > 0);
-		unsigned int uiIteratedBlocks = a_uiMultithreadingOffset;
+		unsigned int uiIteratedBlocks = 0;
 
-		SortedBlockList::Link *plink = m_psortedblocklist->GetLinkToFirstBlock();
-		for (plink = plink->Advance(a_uiMultithreadingOffset);
-				plink != nullptr;
-				plink = plink->Advance(a_uiMultithreadingStride) )
-		{
-			if (uiIteratedBlocks >= a_uiMaxBlocks)
-			{
-				break;
-			}
+		unsigned int uiEndBlock = (a_uiMaxBlocks < m_uiWorstBlocks) ? a_uiMaxBlocks : m_uiWorstBlocks;
 
-			plink->GetBlock()->PerformEncodingIteration(GetImage().GetFormat(), GetErrorMetric(), a_fEffort);
+		for (unsigned int uiWorst = a_uiMultithreadingOffset;
+				uiWorst < uiEndBlock;
+				uiWorst += a_uiMultithreadingStride)
+		{
+			IterateBlock(m_pauiWorstBlocks[uiWorst], a_fEffort);
 
-			uiIteratedBlocks += a_uiMultithreadingStride;
+			uiIteratedBlocks++;
 		}
 
 		return uiIteratedBlocks;
@@ -202,9 +303,53 @@ namespace Etc {
 				uiBlock < GetImage().GetNumberOfBlocks();
 				uiBlock += a_uiMultithreadingStride)
 		{
-			Block4x4 *pblock = &GetImage().GetBlocks()[uiBlock];
-			pblock->PerformEncodingIteration(GetImage().GetFormat(), GetErrorMetric(), a_fEffort);
+			IterateBlock(uiBlock, a_fEffort);
 		}
 	}
 
+	// ----------------------------------------------------------------------------------------------------
+	// iterate the encoding of the worst blocks [a_uiFirstWorst, a_uiEndWorst)
+	//
+	void ThreadedExecutor::IterateThroughWorstBlockRange(float const a_fEffort,
+															unsigned int a_uiFirstWorst,
+															unsigned int a_uiEndWorst)
+	{
+		assert(a_uiEndWorst <= m_uiWorstBlocks);
+
+		for (unsigned int uiWorst = a_uiFirstWorst; uiWorst < a_uiEndWorst; uiWorst++)
+		{
+			IterateBlock(m_pauiWorstBlocks[uiWorst], a_fEffort);
+		}
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// run the first pass of the encoder on the consecutive blocks [a_uiFirstBlock, a_uiEndBlock)
+	//
+	void ThreadedExecutor::RunFirstPassOnRange(float const a_fEffort,
+												unsigned int a_uiFirstBlock,
+												unsigned int a_uiEndBlock)
+	{
+		assert(a_uiEndBlock <= GetImage().GetNumberOfBlocks());
+
+		for (unsigned int uiBlock = a_uiFirstBlock; uiBlock < a_uiEndBlock; uiBlock++)
+		{
+			IterateBlock(uiBlock, a_fEffort);
+		}
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// number of blocks in one tile for contiguous scheduling
+	// a tile is a whole number of block rows, sized so that each job gets about 4 tiles to balance the load
+	//
+	unsigned int ThreadedExecutor::CalculateTileBlocks(unsigned int const a_uiJobs) const
+	{
+		unsigned int uiTileRows = GetImage().GetBlockRows() / (a_uiJobs * 4);
+		if (uiTileRows < 1)
+		{
+			uiTileRows = 1;
+		}
+
+		return uiTileRows * GetImage().GetBlockColumns();
+	}
+
 } // namespace Etc
\ No newline at end of file
@@ -1,18 +1,70 @@
 
 #pragma once
 
+#include <functional>
+
 #include "EtcExecutor.h"
+#include "EtcThreadPool.h"
 
 namespace Etc {
 
 	class ThreadedExecutor : public Executor
 	{
 	public:
-		ThreadedExecutor(Image& a_image);
+		// a_pthreadpool is optional and owned by the caller
+		// when it is nullptr, Encode() creates a pool of a_uiJobs - 1 threads for the duration of the encode
+		ThreadedExecutor(Image& a_image, ThreadPool *a_pthreadpool = nullptr);
+
+		// how the blocks of a pass are split between jobs
+		enum class Scheduling
+		{
+			STRIDED,		// job i takes blocks i, i + jobs, i + 2 * jobs, ...
+			CONTIGUOUS		// jobs claim tiles of consecutive block rows from a shared cursor
+		};
 
 		EncodingStatus Encode(Image::Format a_format, ErrorMetric a_errormetric, float a_fEffort,
 			unsigned int a_uiJobs, unsigned int a_uiMaxJobs);
+
+		inline void SetScheduling(Scheduling a_scheduling)
+		{
+			m_scheduling = a_scheduling;
+		}
+
+		inline Scheduling GetScheduling(void) const
+		{
+			return m_scheduling;
+		}
+
+		// how the effort passes find the blocks with the most error
+		enum class Prioritization
+		{
+			SORTED,			// re-sort all unfinished blocks with SortedBlockList before every pass
+			INCREMENTAL		// keep a BlockPriorityQueue and only re-key the blocks iterated in the last pass
+		};
+
+		inline void SetPrioritization(Prioritization a_prioritization)
+		{
+			m_prioritization = a_prioritization;
+		}
+
+		inline Prioritization GetPrioritization(void) const
+		{
+			return m_prioritization;
+		}
+
+		// the number of blocks the effort passes finish, given the image after the first pass, when the
+		// effort percentage of the image's blocks isn't the right share, e.g. for a band of a larger image
+		// it counts the blocks that are already done, copied and solid color blocks among them
+		using EffortBlocksFunction = std::function<unsigned int(Image &a_image)>;
+
+		inline void SetEffortBlocksFunction(EffortBlocksFunction a_effortblocks)
+		{
+			m_effortblocks = std::move(a_effortblocks);
+		}
+
 	private:
+		void IterateBlock(unsigned int a_uiBlock, float a_fEffort);
+
 		unsigned int IterateThroughWorstBlocks(float a_fEffort,
 										unsigned int a_uiMaxBlocks,
 										unsigned int a_uiMultithreadingOffset,
@@ -22,7 +74,26 @@ namespace Etc {
 							unsigned int a_uiMultithreadingOffset,
 							unsigned int a_uiMultithreadingStride);
 
+		void IterateThroughWorstBlockRange(float a_fEffort,
+											unsigned int a_uiFirstWorst,
+											unsigned int a_uiEndWorst);
+
+		void RunFirstPassOnRange(float a_fEffort,
+									unsigned int a_uiFirstBlock,
+									unsigned int a_uiEndBlock);
+
 		unsigned int CalculateJobs(unsigned int a_uiJobs, unsigned int a_uiMaxJobs);
+
+		unsigned int CalculateTileBlocks(unsigned int a_uiJobs) const;
+
+		ThreadPool *m_pthreadpool;
+		Scheduling m_scheduling = Scheduling::STRIDED;
+		Prioritization m_prioritization = Prioritization::SORTED;
+		EffortBlocksFunction m_effortblocks;
+
+		// block indices for the current effort pass, from most to least error
+		const unsigned int *m_pauiWorstBlocks = nullptr;
+		unsigned int m_uiWorstBlocks = 0;
 	};
 
 } // namespace Etc
@@ -0,0 +1,127 @@
+
+// Measures the per-block cost of the RGB8 and RGB8A1 encoders, which evaluate
+// many planar, T, H and ETC1 candidates per block at high effort.
+//
+// usage: EtcCandidateBenchmark [size] [repeats]
+// Encodes a random size x size image (default 256) single threaded at efforts
+// 40, 60, 80 and 100 and prints the best of repeats (default 3) runs as
+// nanoseconds and, on x86, timestamp counter cycles per block.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <random>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAS_RDTSC 1
+#elif defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#define HAS_RDTSC 1
+#endif
+
+#include "EtcThreadedExecutor.h"
+
+namespace {
+
+constexpr std::mt19937::result_type SEED = 1982;
+
+uint64_t ReadCycles() {
+#if HAS_RDTSC
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+struct BlockCost {
+  double nsPerBlock;
+  double cyclesPerBlock;
+};
+
+BlockCost
+MeasureEncode(std::vector<float>& imageData, unsigned int size, Etc::Image::Format format,
+              float effort, unsigned int repeats) {
+  unsigned int const blocks = (size / 4) * (size / 4);
+  BlockCost best = { std::numeric_limits<double>::max(), std::numeric_limits<double>::max() };
+
+  for (unsigned int repeat = 0; repeat < repeats; repeat++) {
+    Etc::Image image(imageData.data(), size, size, Etc::ErrorMetric::RGBA);
+    Etc::ThreadedExecutor executor(image);
+
+    auto const start = std::chrono::steady_clock::now();
+    uint64_t const startCycles = ReadCycles();
+    executor.Encode(format, Etc::ErrorMetric::RGBA, effort, 1, 1);
+    uint64_t const endCycles = ReadCycles();
+    auto const end = std::chrono::steady_clock::now();
+
+    delete[] executor.GetEncodingBits();
+
+    double const ns = double(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+    best.nsPerBlock = std::min(best.nsPerBlock, ns / blocks);
+    best.cyclesPerBlock = std::min(best.cyclesPerBlock, double(endCycles - startCycles) / blocks);
+  }
+
+  return best;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  unsigned int const size = (argc > 1) ? static_cast<unsigned int>(atoi(argv[1])) : 256;
+  unsigned int const repeats = (argc > 2) ? static_cast<unsigned int>(atoi(argv[2])) : 3;
+
+  if (size == 0 || size % 4 != 0 || repeats == 0) {
+    fprintf(stderr, "size must be a non-zero multiple of 4 and repeats must be non-zero\n");
+    return EXIT_FAILURE;
+  }
+
+  std::mt19937 gen(SEED);
+  std::uniform_real_distribution<float> dis;
+
+  // random colors with smooth gradients in the lower half, so that planar, T and H candidates all win some blocks
+  // alpha is opaque on the right and random on the left for RGB8A1
+  std::vector<float> imageData(size * size * 4);
+  for (unsigned int y = 0; y < size; y++) {
+    for (unsigned int x = 0; x < size; x++) {
+      float *pixel = &imageData[(y * size + x) * 4];
+      pixel[0] = dis(gen);
+      pixel[1] = dis(gen);
+      pixel[2] = dis(gen);
+      pixel[3] = (x >= size / 2) ? 1.0f : dis(gen);
+      if (y >= size / 2) {
+        pixel[0] = float(x) / size;
+        pixel[1] = float(y) / size;
+        pixel[2] = 0.5f * pixel[0] + 0.2f;
+      }
+    }
+  }
+
+  printf("%ux%u, best of %u\n", size, size, repeats);
+  printf("%8s %7s %14s %16s\n", "format", "effort", "ns/block", "cycles/block");
+
+  struct {
+    char const *name;
+    Etc::Image::Format format;
+  } const formats[] = {
+    { "RGB8", Etc::Image::Format::RGB8 },
+    { "RGB8A1", Etc::Image::Format::RGB8A1 },
+  };
+
+  for (auto const& format : formats) {
+    for (float effort : { 40.0f, 60.0f, 80.0f, 100.0f }) {
+      BlockCost const cost = MeasureEncode(imageData, size, format.format, effort, repeats);
+#if HAS_RDTSC
+      printf("%8s %7.0f %14.0f %16.0f\n", format.name, effort, cost.nsPerBlock, cost.cyclesPerBlock);
+#else
+      printf("%8s %7.0f %14.0f %16s\n", format.name, effort, cost.nsPerBlock, "n/a");
+#endif
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,131 @@
+// Measures the per-block cost and quality of the R11 and RG11 encoders on a
+// height map and the normal map derived from it.
+//
+// usage: EtcEacBenchmark [size] [repeats]
+// Encodes a size x size (default 256) R11 height map and RG11 normal map single
+// threaded at efforts 0, 40, 60 and 100 and prints the best of repeats
+// (default 3) runs as nanoseconds per block, together with the PSNR of the
+// encoded channels.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "EtcThreadedExecutor.h"
+
+namespace {
+
+constexpr std::mt19937::result_type SEED = 1982;
+
+struct EncodeCost {
+  double nsPerBlock;
+  double psnr;
+};
+
+EncodeCost
+MeasureEncode(std::vector<float>& imageData, unsigned int size, Etc::Image::Format format,
+              unsigned int channels, float effort, unsigned int repeats) {
+  unsigned int const blocks = (size / 4) * (size / 4);
+  EncodeCost best = { std::numeric_limits<double>::max(), 0.0 };
+
+  for (unsigned int repeat = 0; repeat < repeats; repeat++) {
+    Etc::Image image(imageData.data(), size, size, Etc::ErrorMetric::NUMERIC);
+    Etc::ThreadedExecutor executor(image);
+
+    auto const start = std::chrono::steady_clock::now();
+    executor.Encode(format, Etc::ErrorMetric::NUMERIC, effort, 1, 1);
+    auto const end = std::chrono::steady_clock::now();
+
+    delete[] executor.GetEncodingBits();
+
+    double const ns = double(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+    best.nsPerBlock = std::min(best.nsPerBlock, ns / blocks);
+
+    // the sources only use the encoded channels, so the NUMERIC error is the squared error of those channels
+    double const mse = double(image.GetError()) / (double(size) * size * channels);
+    best.psnr = (mse > 0.0) ? 10.0 * log10(1.0 / mse) : std::numeric_limits<double>::infinity();
+  }
+
+  return best;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  unsigned int const size = (argc > 1) ? static_cast<unsigned int>(atoi(argv[1])) : 256;
+  unsigned int const repeats = (argc > 2) ? static_cast<unsigned int>(atoi(argv[2])) : 3;
+
+  if (size == 0 || size % 4 != 0 || repeats == 0) {
+    fprintf(stderr, "size must be a non-zero multiple of 4 and repeats must be non-zero\n");
+    return EXIT_FAILURE;
+  }
+
+  std::mt19937 gen(SEED);
+  std::normal_distribution<float> noise(0.0f, 0.002f);
+
+  // a height map of a few overlapping waves with a little noise
+  std::vector<float> height(size * size);
+  for (unsigned int y = 0; y < size; y++) {
+    for (unsigned int x = 0; x < size; x++) {
+      float const u = 6.2831853f * x / size;
+      float const v = 6.2831853f * y / size;
+      float const h = 0.5f + 0.2f * sinf(3.0f * u) * cosf(2.0f * v) + 0.1f * sinf(11.0f * u + 7.0f * v) +
+                      0.05f * cosf(29.0f * v) + noise(gen);
+      height[y * size + x] = std::min(std::max(h, 0.0f), 1.0f);
+    }
+  }
+
+  // R11 stores the height, RG11 stores x and y of the normal derived from it
+  std::vector<float> heightData(size * size * 4);
+  std::vector<float> normalData(size * size * 4);
+  for (unsigned int y = 0; y < size; y++) {
+    for (unsigned int x = 0; x < size; x++) {
+      float const dx = height[y * size + (x + 1) % size] - height[y * size + (x + size - 1) % size];
+      float const dy = height[((y + 1) % size) * size + x] - height[((y + size - 1) % size) * size + x];
+      float const strength = 8.0f;
+      float const nx = -dx * strength;
+      float const ny = -dy * strength;
+      float const length = sqrtf(nx * nx + ny * ny + 1.0f);
+
+      float *heightPixel = &heightData[(y * size + x) * 4];
+      heightPixel[0] = height[y * size + x];
+      heightPixel[1] = 0.0f;
+      heightPixel[2] = 0.0f;
+      heightPixel[3] = 1.0f;
+
+      float *normalPixel = &normalData[(y * size + x) * 4];
+      normalPixel[0] = 0.5f * nx / length + 0.5f;
+      normalPixel[1] = 0.5f * ny / length + 0.5f;
+      normalPixel[2] = 0.0f;
+      normalPixel[3] = 1.0f;
+    }
+  }
+
+  printf("%ux%u, best of %u\n", size, size, repeats);
+  printf("%8s %7s %14s %10s\n", "format", "effort", "ns/block", "PSNR");
+
+  struct {
+    char const *name;
+    Etc::Image::Format format;
+    std::vector<float>& imageData;
+    unsigned int channels;
+  } const formats[] = {
+    { "R11", Etc::Image::Format::R11, heightData, 1 },
+    { "RG11", Etc::Image::Format::RG11, normalData, 2 },
+  };
+
+  for (auto const& format : formats) {
+    for (float effort : { 0.0f, 40.0f, 60.0f, 100.0f }) {
+      EncodeCost const cost = MeasureEncode(format.imageData, size, format.format, format.channels,
+                                            effort, repeats);
+      printf("%8s %7.0f %14.0f %10.2f\n", format.name, effort, cost.nsPerBlock, cost.psnr);
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
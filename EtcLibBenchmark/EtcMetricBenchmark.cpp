@@ -0,0 +1,102 @@
+// Measures the encoding throughput of each error metric, whose specialized
+// kernels every encoder looks up once when the encode starts.
+//
+// usage: EtcMetricBenchmark [size] [repeats] [effort]
+// Encodes a random size x size image (default 256) single threaded with every
+// error metric, in the ETC1, RGB8, RGBA8, RGB8A1 and RG11 formats, at the
+// given effort (default 40), and prints the best of repeats (default 3) runs
+// as nanoseconds per block and megapixels per second.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "EtcThreadedExecutor.h"
+
+namespace {
+
+constexpr std::mt19937::result_type SEED = 1982;
+
+double
+MeasureEncode(std::vector<float>& imageData, unsigned int size, Etc::Image::Format format,
+              Etc::ErrorMetric metric, float effort, unsigned int repeats) {
+  unsigned int const blocks = (size / 4) * (size / 4);
+  double best = std::numeric_limits<double>::max();
+
+  for (unsigned int repeat = 0; repeat < repeats; repeat++) {
+    Etc::Image image(imageData.data(), size, size, metric);
+    Etc::ThreadedExecutor executor(image);
+
+    auto const start = std::chrono::steady_clock::now();
+    executor.Encode(format, metric, effort, 1, 1);
+    auto const end = std::chrono::steady_clock::now();
+
+    delete[] executor.GetEncodingBits();
+
+    double const ns = double(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+    best = std::min(best, ns / blocks);
+  }
+
+  return best;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  unsigned int const size = (argc > 1) ? static_cast<unsigned int>(atoi(argv[1])) : 256;
+  unsigned int const repeats = (argc > 2) ? static_cast<unsigned int>(atoi(argv[2])) : 3;
+  float const effort = (argc > 3) ? static_cast<float>(atof(argv[3])) : 40.0f;
+
+  if (size == 0 || size % 4 != 0 || repeats == 0) {
+    fprintf(stderr, "size must be a non-zero multiple of 4 and repeats must be non-zero\n");
+    return EXIT_FAILURE;
+  }
+
+  std::mt19937 gen(SEED);
+  std::uniform_real_distribution<float> dis;
+
+  // smooth gradients with noise, opaque on the right and random alpha on the left
+  std::vector<float> imageData(size * size * 4);
+  for (unsigned int y = 0; y < size; y++) {
+    for (unsigned int x = 0; x < size; x++) {
+      float *pixel = &imageData[(y * size + x) * 4];
+      pixel[0] = std::min(float(x) / size + 0.1f * dis(gen), 1.0f);
+      pixel[1] = std::min(float(y) / size + 0.1f * dis(gen), 1.0f);
+      pixel[2] = dis(gen);
+      pixel[3] = (x >= size / 2) ? 1.0f : dis(gen);
+    }
+  }
+
+  printf("%ux%u, effort %.0f, best of %u\n", size, size, effort, repeats);
+  printf("%8s %10s %14s %12s\n", "format", "metric", "ns/block", "Mpixels/s");
+
+  struct {
+    char const *name;
+    Etc::Image::Format format;
+  } const formats[] = {
+    { "ETC1", Etc::Image::Format::ETC1 },
+    { "RGB8", Etc::Image::Format::RGB8 },
+    { "RGBA8", Etc::Image::Format::RGBA8 },
+    { "RGB8A1", Etc::Image::Format::RGB8A1 },
+    { "RG11", Etc::Image::Format::RG11 },
+  };
+
+  for (auto const& format : formats) {
+    for (int metric = 0; metric < Etc::ErrorMetric::ERROR_METRICS; metric++) {
+      // RGBX ignores alpha, which RGB8A1 needs for its transparent pixels
+      if (format.format == Etc::Image::Format::RGB8A1 && metric == Etc::ErrorMetric::RGBX) {
+        continue;
+      }
+      double const nsPerBlock = MeasureEncode(imageData, size, format.format, static_cast<Etc::ErrorMetric>(metric),
+                                              effort, repeats);
+      printf("%8s %10s %14.0f %12.2f\n", format.name, Etc::ErrorMetricToString(static_cast<Etc::ErrorMetric>(metric)),
+             nsPerBlock, 16.0 * 1000.0 / nsPerBlock);
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
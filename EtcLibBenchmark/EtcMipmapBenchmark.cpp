@@ -0,0 +1,97 @@
+// Measures the time EncodeMipmaps spends filtering the mip levels, with every
+// level filtered from the source, with the levels cascaded from the level
+// before them, and with each of the filters that halve the level before.
+//
+// usage: EtcMipmapBenchmark [size] [jobs] [effort]
+// Encodes the full mip chain of a random size x size image (default 2048) in
+// RGB8 with the given jobs (default 1) and effort (default 0), and prints the
+// filter time (wall time less the encode time EncodeMipmaps reports) of each
+// mode and the time it saves over filtering every level from the source.
+
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "Etc.h"
+#include "EtcFilter.h"
+
+namespace {
+
+constexpr std::mt19937::result_type SEED = 1982;
+
+struct MipmapsResult {
+  long long msTotalTime;
+  long long msEncodeTime;
+};
+
+MipmapsResult
+EncodeMipmaps(std::vector<float>& imageData, unsigned int size, unsigned int jobs, float effort,
+              unsigned int sourceFilteredMipmaps, Etc::MipFilter filter) {
+  unsigned int mipmaps = 0;
+  for (unsigned int dim = size; dim >= 1; dim >>= 1) {
+    mipmaps++;
+  }
+
+  std::vector<Etc::RawImage> mipmapImages(mipmaps);
+  int msEncodeTime;
+
+  auto const start = std::chrono::steady_clock::now();
+  Etc::EncodeMipmaps(imageData.data(), size, size, Etc::Image::Format::RGB8, Etc::ErrorMetric::RGBA, effort,
+                     jobs, jobs, mipmaps, Etc::FILTER_WRAP_NONE, mipmapImages.data(), &msEncodeTime,
+                     false, nullptr, nullptr, sourceFilteredMipmaps, filter);
+  auto const end = std::chrono::steady_clock::now();
+
+  return { std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count(), msEncodeTime };
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  unsigned int const size = (argc > 1) ? static_cast<unsigned int>(atoi(argv[1])) : 2048;
+  unsigned int const jobs = (argc > 2) ? static_cast<unsigned int>(atoi(argv[2])) : 1;
+  float const effort = (argc > 3) ? static_cast<float>(atof(argv[3])) : 0.0f;
+
+  std::mt19937 gen(SEED);
+  std::uniform_real_distribution<float> dis;
+
+  std::vector<float> imageData(size * size * 4);
+  for (float& component : imageData) {
+    component = dis(gen);
+  }
+
+  printf("%u x %u, %u jobs, effort %.0f\n", size, size, jobs, effort);
+  printf("%-22s %10s %10s %10s %10s\n", "mode", "total ms", "encode ms", "filter ms", "saved ms");
+
+  struct Mode {
+    const char *name;
+    unsigned int sourceFilteredMipmaps;
+    Etc::MipFilter filter;
+  };
+  static const Mode modes[] = {
+    { "from source", UINT_MAX, Etc::MipFilter::LANCZOS3 },
+    { "cascaded after 2", 2, Etc::MipFilter::LANCZOS3 },
+    { "cascaded after 1", 1, Etc::MipFilter::LANCZOS3 },
+    { "cascaded after 0", 0, Etc::MipFilter::LANCZOS3 },
+    { "halved, box", UINT_MAX, Etc::MipFilter::HALVE_BOX },
+    { "halved, kaiser", UINT_MAX, Etc::MipFilter::HALVE_KAISER },
+    { "halved, lanczos3", UINT_MAX, Etc::MipFilter::HALVE_LANCZOS3 },
+  };
+
+  long long msSourceFilterTime = 0;
+  for (Mode const& mode : modes) {
+    auto const result = EncodeMipmaps(imageData, size, jobs, effort, mode.sourceFilteredMipmaps, mode.filter);
+    long long const msFilterTime = result.msTotalTime - result.msEncodeTime;
+
+    if (mode.sourceFilteredMipmaps == UINT_MAX && mode.filter == Etc::MipFilter::LANCZOS3) {
+      msSourceFilterTime = msFilterTime;
+    }
+
+    printf("%-22s %10lld %10lld %10lld %10lld\n", mode.name, result.msTotalTime, result.msEncodeTime, msFilterTime,
+           msSourceFilterTime - msFilterTime);
+  }
+
+  return EXIT_SUCCESS;
+}
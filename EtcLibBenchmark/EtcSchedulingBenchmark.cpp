@@ -0,0 +1,85 @@
+
+// Compares strided and contiguous block scheduling of ThreadedExecutor.
+//
+// usage: EtcSchedulingBenchmark [effort] [max jobs]
+// Encodes random 1K, 2K and 4K RGB8 images with 1, 2, 4, ... up to max jobs
+// (default 64) in both scheduling modes, prints the encode times and checks
+// that both modes produce identical encoding bits.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "EtcThreadedExecutor.h"
+
+namespace {
+
+constexpr std::mt19937::result_type SEED = 1982;
+
+struct EncodeResult {
+  long long msEncodeTime;
+  std::unique_ptr<unsigned char[]> encodingBits;
+  unsigned int encodingBitsBytes;
+};
+
+EncodeResult
+EncodeWith(std::vector<float>& imageData, unsigned int size, float effort,
+           unsigned int jobs, Etc::ThreadPool& threadPool,
+           Etc::ThreadedExecutor::Scheduling scheduling) {
+  Etc::Image image(imageData.data(), size, size, Etc::ErrorMetric::RGBA);
+  Etc::ThreadedExecutor executor(image, &threadPool);
+  executor.SetScheduling(scheduling);
+
+  auto result = Etc::TimeEncode(executor, Etc::Image::Format::RGB8,
+                                Etc::ErrorMetric::RGBA, effort, jobs, jobs);
+
+  return { result.m_msEncodeTime.count(),
+           std::unique_ptr<unsigned char[]>(executor.GetEncodingBits()),
+           executor.GetEncodingBitsBytes() };
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  float const effort = (argc > 1) ? static_cast<float>(atof(argv[1])) : 40.0f;
+  unsigned int const maxJobs = (argc > 2) ? static_cast<unsigned int>(atoi(argv[2])) : 64;
+
+  std::mt19937 gen(SEED);
+  std::uniform_real_distribution<float> dis;
+
+  printf("effort %.0f\n", effort);
+  printf("%6s %5s %12s %15s %8s\n", "size", "jobs", "strided ms", "contiguous ms", "speedup");
+
+  int mismatches = 0;
+  for (unsigned int size : { 1024u, 2048u, 4096u }) {
+    std::vector<float> imageData(size * size * 4);
+    for (float& component : imageData) {
+      component = dis(gen);
+    }
+
+    for (unsigned int jobs = 1; jobs <= maxJobs; jobs *= 2) {
+      Etc::ThreadPool threadPool(jobs - 1);
+
+      auto const strided = EncodeWith(imageData, size, effort, jobs, threadPool,
+                                      Etc::ThreadedExecutor::Scheduling::STRIDED);
+      auto const contiguous = EncodeWith(imageData, size, effort, jobs, threadPool,
+                                         Etc::ThreadedExecutor::Scheduling::CONTIGUOUS);
+
+      bool const same = strided.encodingBitsBytes == contiguous.encodingBitsBytes &&
+        memcmp(strided.encodingBits.get(), contiguous.encodingBits.get(), strided.encodingBitsBytes) == 0;
+      if (!same) {
+        mismatches++;
+      }
+
+      printf("%6u %5u %12lld %15lld %7.2fx%s\n", size, jobs,
+             strided.msEncodeTime, contiguous.msEncodeTime,
+             contiguous.msEncodeTime > 0 ? double(strided.msEncodeTime) / contiguous.msEncodeTime : 0.0,
+             same ? "" : "  MISMATCH");
+    }
+  }
+
+  return mismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+#include <EtcBlockAnalysis.h>
+
+namespace {
+
+constexpr unsigned int PIXELS = Etc::BlockAnalysis::PIXELS;
+
+} // namespace
+
+TEST(BlockAnalysisTest, StartsWithNothingCalculated) {
+  Etc::BlockAnalysis analysis;
+  ASSERT_FALSE(analysis.boolColorStatistics);
+  ASSERT_FALSE(analysis.boolHalfAverages);
+  ASSERT_FALSE(analysis.boolPlanarCornerColors);
+  ASSERT_FALSE(analysis.boolTAndHBaseColors);
+}
+
+// colors along one line through RGB have that line as their principal axis, border pixels are ignored
+TEST(BlockAnalysisTest, ColorStatisticsOfAGradient) {
+  Etc::ColorFloatRGBA source[PIXELS];
+  for (unsigned int pixel = 0; pixel < PIXELS; pixel++) {
+    float const t = float(pixel) / (PIXELS - 1);
+    source[pixel] = Etc::ColorFloatRGBA(0.2f + 0.6f * t, 0.5f, 0.8f - 0.6f * t, 1.0f);
+  }
+  source[PIXELS - 1] = Etc::ColorFloatRGBA(5.0f, 5.0f, 5.0f, NAN);
+
+  Etc::BlockAnalysis analysis;
+  analysis.CalculateColorStatistics(source);
+
+  ASSERT_TRUE(analysis.boolColorStatistics);
+  EXPECT_EQ(analysis.uiPixels, PIXELS - 1);
+  EXPECT_FLOAT_EQ(analysis.frgbaMin.fR, 0.2f);
+  EXPECT_FLOAT_EQ(analysis.frgbaMax.fB, 0.8f);
+  EXPECT_FLOAT_EQ(analysis.frgbaMin.fG, 0.5f);
+  EXPECT_FLOAT_EQ(analysis.frgbaMax.fG, 0.5f);
+  EXPECT_NEAR(analysis.afCovariance[3], 0.0f, 1e-6f);
+
+  float const axis = 1.0f / sqrtf(2.0f);
+  EXPECT_NEAR(fabsf(analysis.frgbaPrincipalAxis.fR), axis, 1e-4f);
+  EXPECT_NEAR(analysis.frgbaPrincipalAxis.fG, 0.0f, 1e-4f);
+  EXPECT_NEAR(analysis.frgbaPrincipalAxis.fR, -analysis.frgbaPrincipalAxis.fB, 1e-4f);
+}
+
+// the color statistics are calculated when first needed and kept until the analysis is reset
+TEST(BlockAnalysisTest, NeedColorStatisticsCalculatesOnce) {
+  Etc::ColorFloatRGBA black[PIXELS];
+  Etc::ColorFloatRGBA white[PIXELS];
+  for (unsigned int pixel = 0; pixel < PIXELS; pixel++) {
+    black[pixel] = Etc::ColorFloatRGBA(0.0f, 0.0f, 0.0f, 1.0f);
+    white[pixel] = Etc::ColorFloatRGBA(1.0f, 1.0f, 1.0f, 1.0f);
+  }
+
+  Etc::BlockAnalysis analysis;
+  analysis.NeedColorStatistics(black);
+  analysis.NeedColorStatistics(white);
+  ASSERT_TRUE(analysis.boolColorStatistics);
+  EXPECT_EQ(analysis.frgbaMean.fR, 0.0f);
+
+  analysis.Reset();
+  analysis.NeedColorStatistics(white);
+  EXPECT_EQ(analysis.frgbaMean.fR, 1.0f);
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,125 @@
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Etc.h"
+#include "EtcBlockCache.h"
+#include "EtcTestImage.h"
+#include "EtcThreadedExecutor.h"
+
+namespace {
+
+constexpr unsigned int uiTileSize = 16;
+constexpr unsigned int uiWidth = 64;
+constexpr unsigned int uiHeight = 64;
+constexpr unsigned int uiTileBlocks = (uiTileSize / 4) * (uiTileSize / 4);
+constexpr unsigned int uiBlocks = (uiWidth / 4) * (uiHeight / 4);
+
+// an image of one random tile repeated, so each block of the tile repeats
+std::vector<float> MakeTiledImage() {
+  std::vector<float> const tile = MakeTestImage(uiTileSize, uiTileSize);
+
+  std::vector<float> image(uiWidth * uiHeight * 4);
+  for (unsigned int y = 0; y < uiHeight; y++) {
+    for (unsigned int x = 0; x < uiWidth; x++) {
+      memcpy(&image[(y * uiWidth + x) * 4], &tile[((y % uiTileSize) * uiTileSize + x % uiTileSize) * 4],
+             4 * sizeof(float));
+    }
+  }
+  return image;
+}
+
+std::unique_ptr<unsigned char[]> Encode(std::vector<float>& imageData, Etc::BlockCache *blockCache, float effort,
+                                        unsigned int jobs, unsigned int *bytes, float *error) {
+  Etc::Image image(imageData.data(), uiWidth, uiHeight, Etc::ErrorMetric::RGBA);
+  Etc::ThreadedExecutor executor(image);
+  executor.SetBlockCache(blockCache);
+  EXPECT_FALSE(Etc::IsError(executor.Encode(Etc::Image::Format::RGBA8, Etc::ErrorMetric::RGBA, effort, jobs, jobs)));
+  *bytes = executor.GetEncodingBitsBytes();
+  *error = image.GetError();
+  return std::unique_ptr<unsigned char[]>(executor.GetEncodingBits());
+}
+
+} // namespace
+
+// at full effort every block is encoded to the end, so copying a repeated block gives the same bits
+TEST(BlockCacheTest, RepeatedBlocksAreCopied) {
+  std::vector<float> imageData = MakeTiledImage();
+
+  unsigned int expectedBytes;
+  float expectedError;
+  auto const expectedBits = Encode(imageData, nullptr, 100.0f, 4, &expectedBytes, &expectedError);
+
+  Etc::BlockCache blockCache;
+  unsigned int bytes;
+  float error;
+  auto const bits = Encode(imageData, &blockCache, 100.0f, 4, &bytes, &error);
+
+  ASSERT_EQ(bytes, expectedBytes);
+  EXPECT_EQ(memcmp(bits.get(), expectedBits.get(), bytes), 0);
+  EXPECT_FLOAT_EQ(error, expectedError);
+  EXPECT_EQ(blockCache.GetMisses(), uiTileBlocks);
+  EXPECT_EQ(blockCache.GetHits(), uiBlocks - uiTileBlocks);
+  EXPECT_EQ(blockCache.GetNumberOfEntries(), uiTileBlocks);
+}
+
+// a later image gets every block from the cache, unless it's encoded with other settings
+TEST(BlockCacheTest, CacheIsSharedBetweenImages) {
+  std::vector<float> imageData = MakeTiledImage();
+
+  Etc::BlockCache blockCache;
+  unsigned int firstBytes;
+  float firstError;
+  auto const firstBits = Encode(imageData, &blockCache, 40.0f, 2, &firstBytes, &firstError);
+
+  blockCache.ResetCounters();
+  unsigned int bytes;
+  float error;
+  auto const bits = Encode(imageData, &blockCache, 40.0f, 2, &bytes, &error);
+
+  ASSERT_EQ(bytes, firstBytes);
+  EXPECT_EQ(memcmp(bits.get(), firstBits.get(), bytes), 0);
+  EXPECT_FLOAT_EQ(error, firstError);
+  EXPECT_EQ(blockCache.GetHits(), uiBlocks);
+  EXPECT_EQ(blockCache.GetMisses(), 0u);
+  EXPECT_FLOAT_EQ(blockCache.GetHitRate(), 1.0f);
+
+  Encode(imageData, &blockCache, 50.0f, 2, &bytes, &error);
+  EXPECT_EQ(blockCache.GetMisses(), uiTileBlocks);
+  EXPECT_EQ(blockCache.GetNumberOfEntries(), 2 * uiTileBlocks);
+
+  blockCache.Clear();
+  EXPECT_EQ(blockCache.GetNumberOfEntries(), 0u);
+}
+
+// a full cache forgets the least recently used blocks, but the encoding doesn't change
+TEST(BlockCacheTest, EntriesAreBounded) {
+  std::vector<float> imageData = MakeTiledImage();
+
+  unsigned int expectedBytes;
+  float expectedError;
+  auto const expectedBits = Encode(imageData, nullptr, 100.0f, 1, &expectedBytes, &expectedError);
+
+  constexpr unsigned int uiMaxEntries = uiTileBlocks / 2;
+  Etc::BlockCache blockCache(uiMaxEntries);
+  EXPECT_EQ(blockCache.GetMaxEntries(), uiMaxEntries);
+
+  for (float effort : {100.0f, 90.0f, 100.0f}) {
+    unsigned int bytes;
+    float error;
+    auto const bits = Encode(imageData, &blockCache, effort, 1, &bytes, &error);
+    EXPECT_EQ(blockCache.GetNumberOfEntries(), uiMaxEntries);
+
+    if (effort == 100.0f) {
+      ASSERT_EQ(bytes, expectedBytes);
+      EXPECT_EQ(memcmp(bits.get(), expectedBits.get(), bytes), 0);
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,433 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <random>
+#include <vector>
+
+#include <EtcBlockError.h>
+#include <Etc.h>
+
+namespace {
+
+constexpr std::mt19937::result_type SEED = 1982;
+constexpr unsigned int BLOCKS = 10000;
+
+Etc::ErrorMetric const METRICS[] = {
+  Etc::ErrorMetric::RGBA,
+  Etc::ErrorMetric::RGBX,
+  Etc::ErrorMetric::REC709,
+  Etc::ErrorMetric::NUMERIC,
+  Etc::ErrorMetric::NORMALXYZ,
+};
+
+struct TestBlock {
+  Etc::ColorFloatRGBA decodedColors[Etc::Block4x4Encoding::PIXELS];
+  float decodedAlphas[Etc::Block4x4Encoding::PIXELS];
+  Etc::ColorFloatRGBA source[Etc::Block4x4Encoding::PIXELS];
+};
+
+// random blocks with border pixels, out of range values and short or zero length normals
+void RandomizeBlock(std::mt19937& gen, TestBlock& block) {
+  std::uniform_real_distribution<float> dis(0.0f, 1.0f);
+  std::uniform_real_distribution<float> wide(-0.5f, 2.0f);
+  std::uniform_int_distribution<int> special(0, 15);
+
+  for (unsigned int pixel = 0; pixel < Etc::Block4x4Encoding::PIXELS; pixel++) {
+    Etc::ColorFloatRGBA& decoded = block.decodedColors[pixel];
+    Etc::ColorFloatRGBA& source = block.source[pixel];
+
+    decoded = Etc::ColorFloatRGBA(dis(gen), dis(gen), dis(gen), dis(gen));
+    source = Etc::ColorFloatRGBA(dis(gen), dis(gen), dis(gen), dis(gen));
+    block.decodedAlphas[pixel] = dis(gen);
+
+    switch (special(gen)) {
+    case 0:
+      source.fA = NAN;
+      break;
+    case 1:
+      source = Etc::ColorFloatRGBA(wide(gen), wide(gen), wide(gen), wide(gen));
+      break;
+    case 2:
+      decoded = Etc::ColorFloatRGBA(0.5f, 0.5f, 0.5f, decoded.fA);
+      break;
+    case 3:
+      source = Etc::ColorFloatRGBA(0.5f, 0.5f, 0.5f, source.fA);
+      break;
+    case 4:
+      decoded = Etc::ColorFloatRGBA(0.6f, 0.5f, 0.45f, decoded.fA);
+      break;
+    default:
+      break;
+    }
+  }
+}
+
+} // namespace
+
+TEST(BlockErrorTest, DispatchedKernelIsAvailable) {
+  for (Etc::ErrorMetric metric : METRICS) {
+    ASSERT_NE(Etc::GetBlockErrorFunction(metric), nullptr);
+    ASSERT_NE(Etc::GetBlockErrorFunction(metric, Etc::BlockErrorKernel::SCALAR), nullptr);
+  }
+}
+
+TEST(BlockErrorTest, KernelsMatchScalarBitForBit) {
+  for (int kernel = 0; kernel < static_cast<int>(Etc::BlockErrorKernel::KERNELS); kernel++) {
+    for (Etc::ErrorMetric metric : METRICS) {
+      Etc::BlockErrorFunction const scalar = Etc::GetBlockErrorFunction(metric, Etc::BlockErrorKernel::SCALAR);
+      Etc::BlockErrorFunction const function =
+        Etc::GetBlockErrorFunction(metric, static_cast<Etc::BlockErrorKernel>(kernel));
+      if (function == nullptr) {
+        continue;
+      }
+
+      std::mt19937 gen(SEED);
+      TestBlock block;
+      for (unsigned int uiBlock = 0; uiBlock < BLOCKS; uiBlock++) {
+        RandomizeBlock(gen, block);
+
+        float const expected = scalar(block.decodedColors, block.decodedAlphas, block.source);
+        float const actual = function(block.decodedColors, block.decodedAlphas, block.source);
+
+        ASSERT_EQ(memcmp(&expected, &actual, sizeof(float)), 0)
+          << "kernel " << kernel << " metric " << Etc::ErrorMetricToString(metric)
+          << " block " << uiBlock << ": " << expected << " != " << actual;
+      }
+    }
+  }
+}
+
+TEST(BlockErrorTest, BestSelectorKernelsMatchScalar) {
+  for (int kernel = 0; kernel < static_cast<int>(Etc::BlockErrorKernel::KERNELS); kernel++) {
+    for (Etc::ErrorMetric metric : METRICS) {
+      Etc::BestSelectorsFunction const scalar =
+        Etc::GetBestSelectorsFunction(metric, Etc::BlockErrorKernel::SCALAR);
+      Etc::BestSelectorsFunction const function =
+        Etc::GetBestSelectorsFunction(metric, static_cast<Etc::BlockErrorKernel>(kernel));
+      if (function == nullptr) {
+        continue;
+      }
+
+      std::mt19937 gen(SEED);
+      TestBlock block;
+      for (unsigned int uiBlock = 0; uiBlock < BLOCKS; uiBlock++) {
+        RandomizeBlock(gen, block);
+
+        // the first 4 decoded colors act as the selector colors
+        // duplicates check that ties go to the lower selector
+        if (uiBlock % 8 == 0) {
+          block.decodedColors[3] = block.decodedColors[1];
+        }
+
+        for (bool punchThrough : { false, true }) {
+          unsigned int expectedSelectors[Etc::Block4x4Encoding::PIXELS];
+          unsigned int actualSelectors[Etc::Block4x4Encoding::PIXELS];
+
+          float const expected = scalar(block.decodedColors, block.decodedAlphas, block.source,
+                                        punchThrough, expectedSelectors);
+          float const actual = function(block.decodedColors, block.decodedAlphas, block.source,
+                                        punchThrough, actualSelectors);
+
+          ASSERT_EQ(memcmp(&expected, &actual, sizeof(float)), 0)
+            << "kernel " << kernel << " metric " << Etc::ErrorMetricToString(metric)
+            << " block " << uiBlock << ": " << expected << " != " << actual;
+          ASSERT_EQ(memcmp(expectedSelectors, actualSelectors, sizeof(expectedSelectors)), 0)
+            << "kernel " << kernel << " metric " << Etc::ErrorMetricToString(metric) << " block " << uiBlock;
+        }
+      }
+    }
+  }
+}
+
+TEST(BlockErrorTest, EacSelectorKernelsMatchScalar) {
+  constexpr unsigned int SELECTORS = 8;
+
+  Etc::EacSelectorsFunction const scalar = Etc::GetEacSelectorsFunction(Etc::BlockErrorKernel::SCALAR);
+  ASSERT_NE(scalar, nullptr);
+
+  for (int kernel = 0; kernel < static_cast<int>(Etc::BlockErrorKernel::KERNELS); kernel++) {
+    Etc::EacSelectorsFunction const function =
+      Etc::GetEacSelectorsFunction(static_cast<Etc::BlockErrorKernel>(kernel));
+    if (function == nullptr) {
+      continue;
+    }
+
+    std::mt19937 gen(SEED);
+    std::uniform_real_distribution<float> dis(0.0f, 1.0f);
+    std::uniform_int_distribution<int> special(0, 15);
+    for (unsigned int uiBlock = 0; uiBlock < BLOCKS; uiBlock++) {
+      float selectorValues[SELECTORS];
+      for (float& value : selectorValues) {
+        value = dis(gen);
+      }
+      // duplicates check that ties go to the lower selector
+      if (uiBlock % 8 == 0) {
+        selectorValues[6] = selectorValues[2];
+      }
+
+      float source[Etc::Block4x4Encoding::PIXELS];
+      float weights[Etc::Block4x4Encoding::PIXELS];
+      for (unsigned int pixel = 0; pixel < Etc::Block4x4Encoding::PIXELS; pixel++) {
+        source[pixel] = dis(gen);
+        weights[pixel] = 1.0f;
+        switch (special(gen)) {
+        case 0:
+          weights[pixel] = 0.0f;
+          break;
+        case 1:
+          source[pixel] = selectorValues[uiBlock % SELECTORS];
+          break;
+        default:
+          break;
+        }
+      }
+
+      unsigned int expectedSelectors[Etc::Block4x4Encoding::PIXELS];
+      unsigned int actualSelectors[Etc::Block4x4Encoding::PIXELS];
+
+      float const expected = scalar(selectorValues, source, weights, expectedSelectors);
+      float const actual = function(selectorValues, source, weights, actualSelectors);
+
+      ASSERT_EQ(memcmp(&expected, &actual, sizeof(float)), 0)
+        << "kernel " << kernel << " block " << uiBlock << ": " << expected << " != " << actual;
+      ASSERT_EQ(memcmp(expectedSelectors, actualSelectors, sizeof(expectedSelectors)), 0)
+        << "kernel " << kernel << " block " << uiBlock;
+    }
+  }
+}
+
+TEST(BlockErrorTest, EacMetricSelectorKernelsMatchScalar) {
+  constexpr unsigned int SELECTORS = 8;
+
+  for (int kernel = 0; kernel < static_cast<int>(Etc::BlockErrorKernel::KERNELS); kernel++) {
+    for (Etc::ErrorMetric metric : METRICS) {
+      Etc::EacMetricSelectorsFunction const scalar =
+        Etc::GetEacMetricSelectorsFunction(metric, Etc::BlockErrorKernel::SCALAR);
+      Etc::EacMetricSelectorsFunction const function =
+        Etc::GetEacMetricSelectorsFunction(metric, static_cast<Etc::BlockErrorKernel>(kernel));
+      if (function == nullptr) {
+        continue;
+      }
+
+      std::mt19937 gen(SEED);
+      std::uniform_real_distribution<float> dis(0.0f, 1.0f);
+      TestBlock block;
+      for (unsigned int uiBlock = 0; uiBlock < BLOCKS; uiBlock++) {
+        RandomizeBlock(gen, block);
+
+        float selectorValues[SELECTORS];
+        for (float& value : selectorValues) {
+          value = dis(gen);
+        }
+        // duplicates check that ties go to the lower selector
+        if (uiBlock % 8 == 0) {
+          selectorValues[5] = selectorValues[1];
+        }
+
+        for (unsigned int channel : { 0u, 1u }) {
+          unsigned int expectedSelectors[Etc::Block4x4Encoding::PIXELS];
+          unsigned int actualSelectors[Etc::Block4x4Encoding::PIXELS];
+
+          float const expected = scalar(selectorValues, block.source, channel, expectedSelectors);
+          float const actual = function(selectorValues, block.source, channel, actualSelectors);
+
+          ASSERT_EQ(memcmp(&expected, &actual, sizeof(float)), 0)
+            << "kernel " << kernel << " metric " << Etc::ErrorMetricToString(metric) << " channel " << channel
+            << " block " << uiBlock << ": " << expected << " != " << actual;
+          ASSERT_EQ(memcmp(expectedSelectors, actualSelectors, sizeof(expectedSelectors)), 0)
+            << "kernel " << kernel << " metric " << Etc::ErrorMetricToString(metric) << " channel " << channel
+            << " block " << uiBlock;
+        }
+      }
+    }
+  }
+}
+
+TEST(BlockErrorTest, HalfSelectorKernelsMatchScalar) {
+  constexpr unsigned int HALF_PIXELS = Etc::Block4x4Encoding::PIXELS / 2;
+
+  for (int kernel = 0; kernel < static_cast<int>(Etc::BlockErrorKernel::KERNELS); kernel++) {
+    for (Etc::ErrorMetric metric : METRICS) {
+      Etc::HalfSelectorsFunction const scalar =
+        Etc::GetHalfSelectorsFunction(metric, Etc::BlockErrorKernel::SCALAR);
+      Etc::HalfSelectorsFunction const function =
+        Etc::GetHalfSelectorsFunction(metric, static_cast<Etc::BlockErrorKernel>(kernel));
+      if (function == nullptr) {
+        continue;
+      }
+
+      std::mt19937 gen(SEED);
+      TestBlock block;
+      unsigned int pixelMapping[Etc::Block4x4Encoding::PIXELS];
+      for (unsigned int uiPixel = 0; uiPixel < Etc::Block4x4Encoding::PIXELS; uiPixel++) {
+        pixelMapping[uiPixel] = uiPixel;
+      }
+
+      for (unsigned int uiBlock = 0; uiBlock < BLOCKS; uiBlock++) {
+        RandomizeBlock(gen, block);
+        std::shuffle(std::begin(pixelMapping), std::end(pixelMapping), gen);
+
+        // the first 4 decoded colors act as the selector colors
+        // duplicates check that ties go to the lower selector
+        if (uiBlock % 8 == 0) {
+          block.decodedColors[3] = block.decodedColors[1];
+        }
+
+        for (bool punchThrough : { false, true }) {
+          unsigned int expectedSelectors[HALF_PIXELS];
+          unsigned int actualSelectors[HALF_PIXELS];
+
+          float const expected = scalar(block.decodedColors, block.decodedAlphas, block.source, pixelMapping,
+                                        punchThrough, expectedSelectors);
+          float const actual = function(block.decodedColors, block.decodedAlphas, block.source, pixelMapping,
+                                        punchThrough, actualSelectors);
+
+          ASSERT_EQ(memcmp(&expected, &actual, sizeof(float)), 0)
+            << "kernel " << kernel << " metric " << Etc::ErrorMetricToString(metric)
+            << " block " << uiBlock << ": " << expected << " != " << actual;
+          ASSERT_EQ(memcmp(expectedSelectors, actualSelectors, sizeof(expectedSelectors)), 0)
+            << "kernel " << kernel << " metric " << Etc::ErrorMetricToString(metric) << " block " << uiBlock;
+        }
+      }
+    }
+  }
+}
+
+// the half error bounds can't be higher than the errors of the selector colors of any modifiers in their range
+TEST(BlockErrorTest, HalfErrorBoundsAreBelowHalfErrors) {
+  constexpr unsigned int MODIFIERS = 8;
+  float const maxModifiers[MODIFIERS] = {
+    8.0f / 255.0f, 17.0f / 255.0f, 29.0f / 255.0f, 42.0f / 255.0f,
+    60.0f / 255.0f, 80.0f / 255.0f, 106.0f / 255.0f, 183.0f / 255.0f,
+  };
+
+  for (Etc::ErrorMetric metric : METRICS) {
+    Etc::HalfSelectorsFunction const halfSelectors =
+      Etc::GetHalfSelectorsFunction(metric, Etc::BlockErrorKernel::SCALAR);
+    Etc::HalfErrorBoundStatisticsFunction const statistics =
+      Etc::GetHalfErrorBoundStatisticsFunction(metric, Etc::BlockErrorKernel::SCALAR);
+    Etc::HalfErrorBoundsFunction const bounds = Etc::GetHalfErrorBoundsFunction(metric, Etc::BlockErrorKernel::SCALAR);
+
+    std::mt19937 gen(SEED);
+    std::uniform_real_distribution<float> dis(0.0f, 1.0f);
+    TestBlock block;
+    unsigned int pixelMapping[Etc::Block4x4Encoding::PIXELS];
+    for (unsigned int uiPixel = 0; uiPixel < Etc::Block4x4Encoding::PIXELS; uiPixel++) {
+      pixelMapping[uiPixel] = uiPixel;
+    }
+
+    for (unsigned int uiBlock = 0; uiBlock < BLOCKS; uiBlock++) {
+      RandomizeBlock(gen, block);
+      std::shuffle(std::begin(pixelMapping), std::end(pixelMapping), gen);
+
+      // sources close to gray are the ones whose bounds come close to their errors
+      if (uiBlock % 2 == 0) {
+        for (Etc::ColorFloatRGBA& source : block.source) {
+          float const gray = dis(gen);
+          source.fR = gray + 0.05f * dis(gen);
+          source.fG = gray + 0.05f * dis(gen);
+          source.fB = gray + 0.05f * dis(gen);
+        }
+      }
+
+      Etc::HalfErrorBoundStatistics halfStatistics;
+      statistics(block.decodedAlphas, block.source, pixelMapping, &halfStatistics);
+
+      Etc::ColorFloatRGBA const base(dis(gen), dis(gen), dis(gen), 1.0f);
+      float errorBounds[MODIFIERS];
+      bounds(halfStatistics, base, maxModifiers, MODIFIERS, errorBounds);
+
+      for (unsigned int modifier = 0; modifier < MODIFIERS; modifier++) {
+        Etc::ColorFloatRGBA base1 = base;
+        Etc::ColorFloatRGBA base2 = base;
+        Etc::ColorFloatRGBA base3 = base;
+        Etc::ColorFloatRGBA base4 = base;
+        Etc::ColorFloatRGBA const selectorColors[4] = {
+          (base1 + -maxModifiers[modifier]).ClampRGB(),
+          (base2 + -maxModifiers[modifier] * dis(gen)).ClampRGB(),
+          (base3 + maxModifiers[modifier] * dis(gen)).ClampRGB(),
+          (base4 + maxModifiers[modifier]).ClampRGB(),
+        };
+
+        unsigned int selectors[Etc::Block4x4Encoding::PIXELS / 2];
+        float const error = halfSelectors(selectorColors, block.decodedAlphas, block.source, pixelMapping, false,
+                                          selectors);
+
+        ASSERT_LE(errorBounds[modifier], error)
+          << "metric " << Etc::ErrorMetricToString(metric) << " block " << uiBlock << " modifier " << modifier;
+      }
+    }
+  }
+}
+
+// every kernel must produce the same encoding bits as the scalar kernel
+TEST(BlockErrorTest, EncodingBitsMatchScalarKernel) {
+  constexpr unsigned int SIZE = 32;
+
+  std::mt19937 gen(SEED);
+  std::uniform_real_distribution<float> dis(0.0f, 1.0f);
+  std::vector<float> imageData(SIZE * SIZE * 4);
+  for (unsigned int y = 0; y < SIZE; y++) {
+    for (unsigned int x = 0; x < SIZE; x++) {
+      float* pixel = &imageData[(y * SIZE + x) * 4];
+      pixel[0] = dis(gen);
+      pixel[1] = dis(gen);
+      pixel[2] = dis(gen);
+      pixel[3] = (x >= SIZE / 2) ? 1.0f : dis(gen);
+      if (y >= SIZE / 2) {
+        pixel[0] = float(x) / SIZE;
+        pixel[1] = float(y) / SIZE;
+      }
+    }
+  }
+
+  Etc::Image::Format const formats[] = {
+    Etc::Image::Format::RGB8,
+    Etc::Image::Format::RGBA8,
+    Etc::Image::Format::RGB8A1,
+  };
+
+  for (int kernel = 0; kernel < static_cast<int>(Etc::BlockErrorKernel::KERNELS); kernel++) {
+    if (Etc::GetBlockErrorFunction(Etc::ErrorMetric::RGBA, static_cast<Etc::BlockErrorKernel>(kernel)) == nullptr) {
+      continue;
+    }
+
+    for (Etc::Image::Format format : formats) {
+      for (Etc::ErrorMetric metric : { Etc::ErrorMetric::RGBA, Etc::ErrorMetric::REC709 }) {
+        std::vector<unsigned char> encodingBits[2];
+        for (int pass = 0; pass < 2; pass++) {
+          ASSERT_TRUE(Etc::SetBlockErrorKernel(pass == 0 ? Etc::BlockErrorKernel::SCALAR
+                                                         : static_cast<Etc::BlockErrorKernel>(kernel)));
+
+          unsigned char* paucEncodingBits = nullptr;
+          unsigned int uiEncodingBitsBytes = 0;
+          unsigned int uiExtendedWidth = 0;
+          unsigned int uiExtendedHeight = 0;
+          int iEncodingTime_ms = 0;
+          Etc::Encode(imageData.data(), SIZE, SIZE, format, metric, 100.0f, 1, 1,
+                      &paucEncodingBits, &uiEncodingBitsBytes, &uiExtendedWidth, &uiExtendedHeight,
+                      &iEncodingTime_ms);
+          encodingBits[pass].assign(paucEncodingBits, paucEncodingBits + uiEncodingBitsBytes);
+          delete[] paucEncodingBits;
+        }
+
+        EXPECT_EQ(encodingBits[0], encodingBits[1])
+          << "kernel " << kernel << " format " << static_cast<int>(format)
+          << " metric " << Etc::ErrorMetricToString(metric);
+      }
+    }
+  }
+
+  // restore the default kernel
+  if (!Etc::SetBlockErrorKernel(Etc::BlockErrorKernel::SSE41)) {
+    Etc::SetBlockErrorKernel(Etc::BlockErrorKernel::SCALAR);
+  }
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
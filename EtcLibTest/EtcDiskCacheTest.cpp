@@ -0,0 +1,113 @@
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Etc.h"
+#include "EtcDiskCache.h"
+#include "EtcTestImage.h"
+#include "EtcThreadedExecutor.h"
+
+namespace {
+
+constexpr unsigned int uiWidth = 64;
+constexpr unsigned int uiHeight = 64;
+constexpr unsigned int uiBlockRows = uiHeight / 4;
+
+// an empty directory of its own for each test
+std::string MakeDirectory(const char *name) {
+  std::filesystem::path const path = std::filesystem::path(testing::TempDir()) / name;
+  std::filesystem::remove_all(path);
+  std::filesystem::create_directories(path);
+  return path.string();
+}
+
+std::unique_ptr<unsigned char[]> Encode(std::vector<float>& imageData, Etc::DiskCache *diskCache,
+                                        unsigned int *bytes, float *error) {
+  Etc::Image image(imageData.data(), uiWidth, uiHeight, Etc::ErrorMetric::RGBA);
+  Etc::ThreadedExecutor executor(image);
+  executor.SetDiskCache(diskCache);
+  EXPECT_FALSE(Etc::IsError(executor.Encode(Etc::Image::Format::RGBA8, Etc::ErrorMetric::RGBA, 100.0f, 2, 2)));
+  *bytes = executor.GetEncodingBitsBytes();
+  *error = image.GetError();
+  return std::unique_ptr<unsigned char[]>(executor.GetEncodingBits());
+}
+
+} // namespace
+
+// at full effort every block is encoded to the end, so the cached rows give the bits of an encode without the cache
+TEST(DiskCacheTest, OnlyEditedRowsAreEncoded) {
+  std::vector<float> imageData = MakeTestImage(uiWidth, uiHeight);
+  Etc::DiskCache diskCache(MakeDirectory("DiskCacheRows").c_str());
+
+  unsigned int firstBytes;
+  float firstError;
+  auto const firstBits = Encode(imageData, &diskCache, &firstBytes, &firstError);
+  EXPECT_EQ(diskCache.GetHits(), 0u);
+  EXPECT_EQ(diskCache.GetMisses(), uiBlockRows);
+
+  diskCache.ResetCounters();
+  unsigned int bytes;
+  float error;
+  auto const bits = Encode(imageData, &diskCache, &bytes, &error);
+  ASSERT_EQ(bytes, firstBytes);
+  EXPECT_EQ(memcmp(bits.get(), firstBits.get(), bytes), 0);
+  EXPECT_FLOAT_EQ(error, firstError);
+  EXPECT_EQ(diskCache.GetHits(), uiBlockRows);
+  EXPECT_EQ(diskCache.GetMisses(), 0u);
+
+  // a pixel of the second row of blocks
+  imageData[(5 * uiWidth + 9) * 4] = 1.0f - imageData[(5 * uiWidth + 9) * 4];
+
+  unsigned int expectedBytes;
+  float expectedError;
+  auto const expectedBits = Encode(imageData, nullptr, &expectedBytes, &expectedError);
+
+  diskCache.ResetCounters();
+  auto const editedBits = Encode(imageData, &diskCache, &bytes, &error);
+  ASSERT_EQ(bytes, expectedBytes);
+  EXPECT_EQ(memcmp(editedBits.get(), expectedBits.get(), bytes), 0);
+  EXPECT_FLOAT_EQ(error, expectedError);
+  EXPECT_EQ(diskCache.GetHits(), uiBlockRows - 1);
+  EXPECT_EQ(diskCache.GetMisses(), 1u);
+}
+
+// an entry file that isn't a whole entry is encoded again and written over
+TEST(DiskCacheTest, DamagedEntriesAreIgnored) {
+  std::vector<float> imageData = MakeTestImage(uiWidth, uiHeight);
+  std::string const directory = MakeDirectory("DiskCacheImage");
+  Etc::DiskCache diskCache(directory.c_str(), Etc::DiskCache::Granularity::IMAGE);
+
+  unsigned int firstBytes;
+  float firstError;
+  auto const firstBits = Encode(imageData, &diskCache, &firstBytes, &firstError);
+  EXPECT_EQ(diskCache.GetMisses(), 1u);
+
+  unsigned int entries = 0;
+  for (auto const& entry : std::filesystem::directory_iterator(directory)) {
+    std::filesystem::resize_file(entry.path(), std::filesystem::file_size(entry.path()) / 2);
+    entries++;
+  }
+  ASSERT_EQ(entries, 1u);
+
+  unsigned int bytes;
+  float error;
+  Encode(imageData, &diskCache, &bytes, &error);
+  EXPECT_EQ(diskCache.GetHits(), 0u);
+  EXPECT_EQ(diskCache.GetMisses(), 2u);
+
+  auto const bits = Encode(imageData, &diskCache, &bytes, &error);
+  ASSERT_EQ(bytes, firstBytes);
+  EXPECT_EQ(memcmp(bits.get(), firstBits.get(), bytes), 0);
+  EXPECT_FLOAT_EQ(error, firstError);
+  EXPECT_EQ(diskCache.GetHits(), 1u);
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,53 @@
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "EtcEncoderContext.h"
+#include "EtcTestImage.h"
+#include "EtcThreadedExecutor.h"
+
+namespace {
+
+constexpr unsigned int uiSourceWidth = 128;
+constexpr unsigned int uiSourceHeight = 96;
+
+void
+ExpectSameAsFreshEncode(Etc::EncoderContext& context, std::vector<float>& imageData,
+                        unsigned int uiWidth, unsigned int uiHeight, Etc::Image::Format format) {
+  Etc::Image image(imageData.data(), uiWidth, uiHeight, Etc::ErrorMetric::RGBA);
+  Etc::ThreadedExecutor executor(image);
+  auto const status = executor.Encode(format, Etc::ErrorMetric::RGBA, 40, 2, 4);
+  std::unique_ptr<unsigned char[]> expectedBits(executor.GetEncodingBits());
+
+  ASSERT_EQ(context.Encode(imageData.data(), uiWidth, uiHeight, format, Etc::ErrorMetric::RGBA, 40, 2, 4), status);
+  ASSERT_EQ(context.GetEncodingBitsBytes(), executor.GetEncodingBitsBytes());
+  ASSERT_EQ(context.GetExtendedWidth(), image.GetExtendedWidth());
+  ASSERT_EQ(context.GetExtendedHeight(), image.GetExtendedHeight());
+  ASSERT_EQ(memcmp(context.GetEncodingBits(), expectedBits.get(), context.GetEncodingBitsBytes()), 0);
+}
+
+} // namespace
+
+TEST(EncoderContextTest, ReuseMatchesFreshEncodes) {
+  Etc::EncoderContext context;
+
+  // same size images reuse the context's image, then a format and a size change
+  auto first = MakeTestImage(uiSourceWidth, uiSourceHeight, TEST_IMAGE_SEED);
+  auto second = MakeTestImage(uiSourceWidth, uiSourceHeight, TEST_IMAGE_SEED + 1);
+  auto third = MakeTestImage(uiSourceWidth / 2, uiSourceHeight / 2, TEST_IMAGE_SEED + 2);
+
+  ExpectSameAsFreshEncode(context, first, uiSourceWidth, uiSourceHeight, Etc::Image::Format::RGB8);
+  unsigned char *paucEncodingBits = context.GetEncodingBits();
+  ExpectSameAsFreshEncode(context, second, uiSourceWidth, uiSourceHeight, Etc::Image::Format::RGB8);
+  ASSERT_EQ(context.GetEncodingBits(), paucEncodingBits);
+  ExpectSameAsFreshEncode(context, second, uiSourceWidth, uiSourceHeight, Etc::Image::Format::RGBA8);
+  ExpectSameAsFreshEncode(context, third, uiSourceWidth / 2, uiSourceHeight / 2, Etc::Image::Format::RGBA8);
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
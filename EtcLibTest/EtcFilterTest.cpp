@@ -0,0 +1,158 @@
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "EtcFilter.h"
+#include "EtcTestImage.h"
+#include "EtcThreadPool.h"
+
+// the row tiled float filter gives the double precision filter's pixels, on one thread or many
+TEST(FilterTest, FloatFilterMatchesDoubleFilter) {
+  static const int sizes[][4] = { { 256, 256, 128, 128 }, { 300, 140, 150, 70 }, { 200, 200, 25, 25 } };
+  Etc::ThreadPool threadPool(3);
+
+  for (auto const& size : sizes) {
+    std::vector<float> source = MakeTestImage(size[0], size[1]);
+
+    for (unsigned int wrapFlags = 0; wrapFlags <= (Etc::FILTER_WRAP_X | Etc::FILTER_WRAP_Y); wrapFlags++) {
+      std::vector<float> expected(size[2] * size[3] * 4);
+      Etc::FilterTwoPass<float>(source.data(), size[0], size[1], expected.data(), size[2], size[3], wrapFlags,
+                                Etc::FilterLanczos3);
+
+      for (Etc::ThreadPool *pool : { static_cast<Etc::ThreadPool *>(nullptr), &threadPool }) {
+        std::vector<float> filtered(expected.size());
+        ASSERT_EQ(Etc::FilterTwoPass(source.data(), size[0], size[1], filtered.data(), size[2], size[3], wrapFlags,
+                                     Etc::FilterLanczos3, pool), 1);
+
+        for (size_t component = 0; component < expected.size(); component++) {
+          ASSERT_NEAR(filtered[component], expected[component], 1e-5f)
+              << size[0] << "x" << size[1] << " wrap " << wrapFlags << " component " << component;
+        }
+      }
+    }
+  }
+}
+
+// a filter wider than the source wraps around it more than once without reading outside it
+TEST(FilterTest, WrapAroundSmallSource) {
+  std::vector<float> source(2 * 2 * 4, 0.5f);
+  std::vector<float> filtered(4);
+
+  ASSERT_EQ(Etc::FilterTwoPass(source.data(), 2, 2, filtered.data(), 1, 1, Etc::FILTER_WRAP_X | Etc::FILTER_WRAP_Y,
+                               Etc::FilterLanczos3), 1);
+  for (float component : filtered) {
+    EXPECT_NEAR(component, 0.5f, 1e-5f);
+  }
+}
+
+// more sizes than the contribution cache keeps still filter right, before and after their contributions are evicted
+TEST(FilterTest, FilterManySizes) {
+  std::vector<float> source = MakeTestImage(64, 64);
+
+  for (int pass = 0; pass < 2; pass++) {
+    for (int size = 8; size < 48; size++) {
+      std::vector<float> expected(size * size * 4);
+      std::vector<float> filtered(expected.size());
+      Etc::FilterTwoPass<float>(source.data(), 64, 64, expected.data(), size, size, Etc::FILTER_WRAP_NONE,
+                                Etc::FilterLanczos3);
+      ASSERT_EQ(Etc::FilterTwoPass(source.data(), 64, 64, filtered.data(), size, size, Etc::FILTER_WRAP_NONE,
+                                   Etc::FilterLanczos3), 1);
+
+      for (size_t component = 0; component < expected.size(); component++) {
+        ASSERT_NEAR(filtered[component], expected[component], 1e-5f) << size << " pass " << pass;
+      }
+    }
+  }
+}
+
+// each destination pixel of the box halving is the average of the 2x2 source pixels it covers
+TEST(FilterTest, HalveBoxAveragesEach2x2) {
+  std::vector<float> source = MakeTestImage(64, 32);
+  std::vector<float> halved(32 * 16 * 4);
+
+  ASSERT_EQ(Etc::FilterHalve(source.data(), 64, 32, halved.data(), 32, 16, Etc::MipFilter::HALVE_BOX,
+                             Etc::FILTER_WRAP_NONE), 1);
+  for (int row = 0; row < 16; row++) {
+    for (int col = 0; col < 32; col++) {
+      for (int component = 0; component < 4; component++) {
+        float const sum = source[((2 * row) * 64 + 2 * col) * 4 + component] +
+                          source[((2 * row) * 64 + 2 * col + 1) * 4 + component] +
+                          source[((2 * row + 1) * 64 + 2 * col) * 4 + component] +
+                          source[((2 * row + 1) * 64 + 2 * col + 1) * 4 + component];
+        ASSERT_NEAR(halved[(row * 32 + col) * 4 + component], sum / 4.0f, 1e-6f);
+      }
+    }
+  }
+}
+
+// an RGBA8 source halves to the same pixels as the float source Image would convert it to
+TEST(FilterTest, HalveRGBA8MatchesFloat) {
+  std::mt19937 gen(TEST_IMAGE_SEED);
+  std::uniform_int_distribution<int> dis(0, 255);
+
+  // odd sizes go through FilterTwoPass
+  static const int sizes[][4] = { { 66, 34, 33, 17 }, { 67, 35, 33, 17 } };
+  Etc::ThreadPool threadPool(3);
+
+  for (auto const& size : sizes) {
+    std::vector<unsigned char> source8(size[0] * size[1] * 4);
+    std::vector<float> source(source8.size());
+    for (size_t component = 0; component < source8.size(); component++) {
+      source8[component] = static_cast<unsigned char>(dis(gen));
+      source[component] = source8[component] / 255.0f;
+    }
+
+    for (Etc::MipFilter filter : { Etc::MipFilter::HALVE_BOX, Etc::MipFilter::HALVE_KAISER,
+                                   Etc::MipFilter::HALVE_LANCZOS3 }) {
+      for (unsigned int flags : { 0u, static_cast<unsigned int>(Etc::FILTER_WRAP_X | Etc::FILTER_WRAP_Y),
+                                  static_cast<unsigned int>(Etc::FILTER_SRGB) }) {
+        std::vector<float> expected(size[2] * size[3] * 4);
+        std::vector<float> halved(expected.size());
+        ASSERT_EQ(Etc::FilterHalve(source.data(), size[0], size[1], expected.data(), size[2], size[3], filter, flags), 1);
+        ASSERT_EQ(Etc::FilterHalve(source8.data(), size[0], size[1], halved.data(), size[2], size[3], filter, flags,
+                                   &threadPool), 1);
+
+        for (size_t component = 0; component < expected.size(); component++) {
+          // the 8 bit sRGB table is exact, the float one interpolated
+          ASSERT_NEAR(halved[component], expected[component], 1e-5f)
+              << size[0] << "x" << size[1] << " flags " << flags << " component " << component;
+        }
+      }
+    }
+  }
+}
+
+// black and white average to half the light, not half the sRGB value, and alpha stays linear
+TEST(FilterTest, HalveSrgbFiltersInLinearLight) {
+  std::vector<float> source = { 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f, 1.0f,
+                                0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f, 1.0f };
+  std::vector<float> halved(4);
+
+  ASSERT_EQ(Etc::FilterHalve(source.data(), 2, 2, halved.data(), 1, 1, Etc::MipFilter::HALVE_BOX, Etc::FILTER_SRGB), 1);
+  for (int component = 0; component < 3; component++) {
+    EXPECT_NEAR(halved[component], 1.055f * std::pow(0.5f, 1.0f / 2.4f) - 0.055f, 1e-4f);
+  }
+  EXPECT_NEAR(halved[3], 0.5f, 1e-6f);
+}
+
+// the windowed sinc halvings keep a flat image flat, at its edges too
+TEST(FilterTest, HalveSincKeepsFlatImage) {
+  std::vector<float> source(40 * 24 * 4, 0.25f);
+  std::vector<float> halved(20 * 12 * 4);
+
+  for (Etc::MipFilter filter : { Etc::MipFilter::HALVE_KAISER, Etc::MipFilter::HALVE_LANCZOS3 }) {
+    for (unsigned int wrapFlags = 0; wrapFlags <= (Etc::FILTER_WRAP_X | Etc::FILTER_WRAP_Y); wrapFlags++) {
+      ASSERT_EQ(Etc::FilterHalve(source.data(), 40, 24, halved.data(), 20, 12, filter, wrapFlags), 1);
+      for (float component : halved) {
+        ASSERT_NEAR(component, 0.25f, 1e-6f);
+      }
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+#include <EtcSolidColor.h>
+
+namespace {
+
+constexpr unsigned int PIXELS = 16;
+
+int Expand(unsigned int base, unsigned int bits) {
+  return int((base << (8 - bits)) | (base >> (2 * bits - 8)));
+}
+
+int Clamp(int value) {
+  return value < 0 ? 0 : (value > 255 ? 255 : value);
+}
+
+void Fill(Etc::ColorFloatRGBA *source, unsigned int red, unsigned int green, unsigned int blue) {
+  for (unsigned int pixel = 0; pixel < PIXELS; pixel++) {
+    source[pixel] = Etc::ColorFloatRGBA(red / 255.0f, green / 255.0f, blue / 255.0f, 1.0f);
+  }
+}
+
+// the error of a planar encoding of one channel, decoded the way the planar decoder does
+unsigned int PlanarChannelError(const Etc::SolidColor::Encoding& encoding, unsigned int channel, unsigned int bits,
+                                unsigned int value, const Etc::ColorFloatRGBA *source) {
+  int const o = Expand(encoding.auiBase[channel], bits);
+  int const h = Expand(encoding.auiHorizontal[channel], bits);
+  int const v = Expand(encoding.auiVertical[channel], bits);
+  unsigned int error = 0;
+  for (unsigned int pixel = 0; pixel < PIXELS; pixel++) {
+    if (std::isnan(source[pixel].fA)) {
+      continue;
+    }
+    int const x = int(pixel >> 2);
+    int const y = int(pixel & 3);
+    int const delta = Clamp((x * (h - o) + y * (v - o) + 4 * o + 2) >> 2) - int(value);
+    error += unsigned(delta * delta);
+  }
+  return error;
+}
+
+} // namespace
+
+TEST(SolidColorTest, OnlyEightBitValues) {
+  unsigned int value;
+  EXPECT_TRUE(Etc::SolidColor::GetEightBitValue(128 / 255.0f, &value));
+  EXPECT_EQ(value, 128u);
+  EXPECT_TRUE(Etc::SolidColor::GetEightBitValue(1.0f, &value));
+  EXPECT_EQ(value, 255u);
+  EXPECT_FALSE(Etc::SolidColor::GetEightBitValue(0.5f, &value));
+  EXPECT_FALSE(Etc::SolidColor::GetEightBitValue(-0.1f, &value));
+  EXPECT_FALSE(Etc::SolidColor::GetEightBitValue(NAN, &value));
+}
+
+// the lookup finds the same error as trying every differential base, CW and selector
+TEST(SolidColorTest, DifferentialMatchesBruteForce) {
+  static const int cwTable[8][4] = {
+    { 2, 8, -2, -8 }, { 5, 17, -5, -17 }, { 9, 29, -9, -29 }, { 13, 42, -13, -42 },
+    { 18, 60, -18, -60 }, { 24, 80, -24, -80 }, { 33, 106, -33, -106 }, { 47, 183, -47, -183 }
+  };
+
+  for (unsigned int value = 0; value < 256; value += 5) {
+    unsigned int const red = value;
+    unsigned int const green = 255 - value;
+    unsigned int const blue = (value * 7) & 255;
+
+    unsigned int best = UINT_MAX;
+    for (unsigned int cw = 0; cw < 8; cw++) {
+      for (unsigned int selector = 0; selector < 4; selector++) {
+        unsigned int error = 0;
+        for (unsigned int channelValue : { red, green, blue }) {
+          unsigned int channelBest = UINT_MAX;
+          for (unsigned int base = 0; base < 32; base++) {
+            int const delta = Clamp(Expand(base, 5) + cwTable[cw][selector]) - int(channelValue);
+            channelBest = std::min(channelBest, unsigned(delta * delta));
+          }
+          error += channelBest;
+        }
+        best = std::min(best, error);
+      }
+    }
+
+    Etc::ColorFloatRGBA source[PIXELS];
+    Fill(source, red, green, blue);
+
+    Etc::SolidColor::Encoding encoding;
+    ASSERT_TRUE(Etc::SolidColor::Find(source, Etc::SolidColor::ETC1_DIFFERENTIAL, &encoding));
+    EXPECT_EQ(encoding.mode, Etc::Block4x4Encoding::MODE_ETC1);
+    EXPECT_TRUE(encoding.boolDiff);
+    EXPECT_EQ(encoding.uiError, PIXELS * best) << "value " << value;
+  }
+}
+
+// a planar gradient gets closer to a value between two 6-bit colors than either color
+TEST(SolidColorTest, PlanarGradientBeatsOneColor) {
+  Etc::ColorFloatRGBA source[PIXELS];
+  Fill(source, 2, 2, 2);
+
+  Etc::SolidColor::Encoding encoding;
+  ASSERT_TRUE(Etc::SolidColor::Find(source, Etc::SolidColor::PLANAR, &encoding));
+  EXPECT_EQ(encoding.mode, Etc::Block4x4Encoding::MODE_PLANAR);
+
+  unsigned int const error = PlanarChannelError(encoding, 0, 6, 2, source) +
+                             PlanarChannelError(encoding, 1, 7, 2, source) +
+                             PlanarChannelError(encoding, 2, 6, 2, source);
+  EXPECT_EQ(encoding.uiError, error);
+
+  // 6-bit 0 and 1 decode to 0 and 4
+  EXPECT_LT(PlanarChannelError(encoding, 0, 6, 2, source), PIXELS * 4);
+}
+
+// border pixels don't count, and the planar search only fits the pixels that do
+TEST(SolidColorTest, BorderPixelsAreIgnored) {
+  Etc::ColorFloatRGBA source[PIXELS];
+  Fill(source, 63, 192, 100);
+  for (unsigned int pixel = 0; pixel < PIXELS; pixel++) {
+    if ((pixel >> 2) >= 2 || (pixel & 3) >= 1) {
+      source[pixel] = Etc::ColorFloatRGBA(0.0f, 0.0f, 0.0f, NAN);
+    }
+  }
+
+  Etc::SolidColor::Encoding encoding;
+  ASSERT_TRUE(Etc::SolidColor::Find(source, Etc::SolidColor::PLANAR, &encoding));
+  EXPECT_EQ(encoding.uiError, PlanarChannelError(encoding, 0, 6, 63, source) +
+                              PlanarChannelError(encoding, 1, 7, 192, source) +
+                              PlanarChannelError(encoding, 2, 6, 100, source));
+
+  for (unsigned int pixel = 0; pixel < PIXELS; pixel++) {
+    source[pixel] = Etc::ColorFloatRGBA(0.0f, 0.0f, 0.0f, NAN);
+  }
+  EXPECT_FALSE(Etc::SolidColor::Find(source, Etc::SolidColor::ETC2_MODES, &encoding));
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
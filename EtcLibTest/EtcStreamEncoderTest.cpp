@@ -0,0 +1,106 @@
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Etc.h"
+#include "EtcStreamEncoder.h"
+#include "EtcTestImage.h"
+
+namespace {
+
+// a partial last block row, and a partial last band of 3 block rows
+constexpr unsigned int uiWidth = 70;
+constexpr unsigned int uiHeight = 50;
+constexpr unsigned int uiBandBlockRows = 3;
+
+Etc::StreamEncoder::SourceFunction MakeSource(std::vector<float> const& imageData) {
+  return [&imageData](unsigned int firstRow, unsigned int rows, float *rgba) {
+    memcpy(rgba, &imageData[firstRow * uiWidth * 4], rows * uiWidth * 4 * sizeof(float));
+    return true;
+  };
+}
+
+} // namespace
+
+// at full effort every block is encoded to the end, so the bands give the bits of the whole image encoded at once
+TEST(StreamEncoderTest, BandsMatchWholeImage) {
+  std::vector<float> imageData = MakeTestImage(uiWidth, uiHeight);
+
+  unsigned char *expectedBits;
+  unsigned int expectedBytes;
+  unsigned int extendedWidth;
+  unsigned int extendedHeight;
+  int msEncodingTime;
+  Etc::Encode(imageData.data(), uiWidth, uiHeight, Etc::Image::Format::RGBA8, Etc::ErrorMetric::RGBA, 100.0f, 2, 2,
+              &expectedBits, &expectedBytes, &extendedWidth, &extendedHeight, &msEncodingTime);
+  std::unique_ptr<unsigned char[]> const expected(expectedBits);
+
+  for (auto effortBudget : { Etc::StreamEncoder::EffortBudget::PER_BAND, Etc::StreamEncoder::EffortBudget::GLOBAL }) {
+    Etc::StreamEncoder encoder(uiBandBlockRows, effortBudget);
+
+    std::vector<unsigned char> bits;
+    unsigned int nextBlockRow = 0;
+    auto sink = [&](unsigned int firstBlockRow, unsigned int blockRows, const unsigned char *encodingBits,
+                    unsigned int encodingBitsBytes) {
+      EXPECT_EQ(firstBlockRow, nextBlockRow);
+      nextBlockRow = firstBlockRow + blockRows;
+      bits.insert(bits.end(), encodingBits, encodingBits + encodingBitsBytes);
+      return true;
+    };
+
+    ASSERT_FALSE(Etc::IsError(encoder.Encode(MakeSource(imageData), uiWidth, uiHeight, Etc::Image::Format::RGBA8,
+                                             Etc::ErrorMetric::RGBA, 100.0f, 2, 2, sink)));
+    EXPECT_EQ(nextBlockRow, extendedHeight / 4);
+    ASSERT_EQ(bits.size(), expectedBytes);
+    EXPECT_EQ(encoder.GetEncodingBitsBytes(), expectedBytes);
+    EXPECT_EQ(memcmp(bits.data(), expected.get(), expectedBytes), 0);
+  }
+}
+
+// the global budget leaves the flat bands to the noisy bands after them, for no more error than a budget per band
+TEST(StreamEncoderTest, GlobalBudgetSpendsEffortWhereTheErrorIs) {
+  // a flat top half and a noisy bottom half
+  std::vector<float> imageData = MakeTestImage(uiWidth, uiHeight);
+  std::fill(imageData.begin(), imageData.begin() + imageData.size() / 2, 0.5f);
+
+  auto encode = [&](Etc::StreamEncoder::EffortBudget effortBudget) {
+    Etc::StreamEncoder encoder(uiBandBlockRows, effortBudget);
+    auto sink = [](unsigned int, unsigned int, const unsigned char *, unsigned int) { return true; };
+    EXPECT_FALSE(Etc::IsError(encoder.Encode(MakeSource(imageData), uiWidth, uiHeight, Etc::Image::Format::RGBA8,
+                                             Etc::ErrorMetric::RGBA, 30.0f, 1, 1, sink)));
+    return encoder.GetError();
+  };
+
+  EXPECT_LE(encode(Etc::StreamEncoder::EffortBudget::GLOBAL), encode(Etc::StreamEncoder::EffortBudget::PER_BAND));
+}
+
+// a band that can't be read stops the stream after the bands before it
+TEST(StreamEncoderTest, SourceFailureStopsTheStream) {
+  std::vector<float> imageData = MakeTestImage(uiWidth, uiHeight);
+  Etc::StreamEncoder encoder(uiBandBlockRows);
+
+  auto source = [&](unsigned int firstRow, unsigned int rows, float *rgba) {
+    if (firstRow >= 2 * 4 * uiBandBlockRows) {
+      return false;
+    }
+    return MakeSource(imageData)(firstRow, rows, rgba);
+  };
+
+  unsigned int sunkBands = 0;
+  auto sink = [&](unsigned int, unsigned int, const unsigned char *, unsigned int) {
+    sunkBands++;
+    return true;
+  };
+
+  auto const status = encoder.Encode(source, uiWidth, uiHeight, Etc::Image::Format::RGB8, Etc::ErrorMetric::RGBA,
+                                     0.0f, 2, 2, sink);
+  EXPECT_TRUE(status & Etc::Executor::ERROR_STREAM_SOURCE_FAILED);
+  EXPECT_EQ(sunkBands, 2u);
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <random>
+#include <vector>
+
+// the seed the tests' images are made from, unless a test needs more than one image
+constexpr std::mt19937::result_type TEST_IMAGE_SEED = 1982;
+
+// a width x height image of random RGBA floats, each one of the 256 values an 8 bit channel converts to
+inline std::vector<float> MakeTestImage(unsigned int width, unsigned int height,
+                                        std::mt19937::result_type seed = TEST_IMAGE_SEED) {
+  std::mt19937 gen(seed);
+  std::uniform_int_distribution<int> dis(0, 255);
+
+  std::vector<float> image(width * height * 4);
+  for (float& value : image) {
+    value = float(dis(gen)) / 255.0f;
+  }
+  return image;
+}
@@ -1,8 +1,13 @@
 
+#include <cstring>
+#include <memory>
 #include <random>
+#include <vector>
 
 #include <gtest/gtest.h>
 
+#include "Etc.h"
+#include "EtcBlock4x4EncodingArena.h"
 #include "EtcThreadedExecutor.h"
 
 namespace {
@@ -40,12 +45,213 @@ ThreadedExecutorTest::SetUp() {
 
 TEST_F(ThreadedExecutorTest, EncodeWithInvalidJobs) {
   Etc::ThreadedExecutor executor(*image_);
-  ASSERT_EQ(executor.Encode(Etc::Image::Format::RGBA8, Etc::ErrorMetric::RGBA, 100, -1, 0), Etc::Executor::EncodingStatus::SUCCESS);
+  ASSERT_EQ(executor.Encode(Etc::Image::Format::RGBA8, Etc::ErrorMetric::RGBA, 100, -1, 0), Etc::Executor::EncodingStatus::WARNING_JOBS_OUT_OF_RANGE);
 }
 
 TEST_F(ThreadedExecutorTest, EncodeWithTooManyJobs) {
   Etc::ThreadedExecutor executor(*image_);
-  ASSERT_EQ(executor.Encode(Etc::Image::Format::ETC1, Etc::ErrorMetric::RGBA, 90, 5, 2), Etc::Executor::EncodingStatus::SUCCESS);
+  ASSERT_EQ(executor.Encode(Etc::Image::Format::ETC1, Etc::ErrorMetric::RGBA, 90, 5, 2), Etc::Executor::EncodingStatus::WARNING_JOBS_OUT_OF_RANGE);
+}
+
+TEST_F(ThreadedExecutorTest, EncodeWithSharedThreadPool) {
+  constexpr unsigned int uiWidth = 256;
+  constexpr unsigned int uiHeight = 256;
+
+  Etc::Image ownedPoolImage(imageData_.data(), uiWidth, uiHeight, Etc::ErrorMetric::RGBA);
+  Etc::ThreadedExecutor ownedPoolExecutor(ownedPoolImage);
+  auto const status = ownedPoolExecutor.Encode(Etc::Image::Format::RGB8, Etc::ErrorMetric::RGBA, 50, 4, 4);
+  ASSERT_FALSE(Etc::IsError(status));
+  std::unique_ptr<unsigned char[]> expectedBits(ownedPoolExecutor.GetEncodingBits());
+
+  Etc::ThreadPool threadPool(3);
+  for (int encode = 0; encode < 2; encode++) {
+    Etc::Image image(imageData_.data(), uiWidth, uiHeight, Etc::ErrorMetric::RGBA);
+    Etc::ThreadedExecutor executor(image, &threadPool);
+    ASSERT_EQ(executor.Encode(Etc::Image::Format::RGB8, Etc::ErrorMetric::RGBA, 50, 4, 4), status);
+    std::unique_ptr<unsigned char[]> bits(executor.GetEncodingBits());
+    ASSERT_EQ(executor.GetEncodingBitsBytes(), ownedPoolExecutor.GetEncodingBitsBytes());
+    ASSERT_EQ(memcmp(bits.get(), expectedBits.get(), executor.GetEncodingBitsBytes()), 0);
+  }
+}
+
+TEST_F(ThreadedExecutorTest, EncodeWithSharedArena) {
+  constexpr unsigned int uiWidth = 128;
+  constexpr unsigned int uiHeight = 128;
+
+  Etc::Image ownedArenaImage(imageData_.data(), uiWidth, uiHeight, Etc::ErrorMetric::RGBA);
+  Etc::ThreadedExecutor ownedArenaExecutor(ownedArenaImage);
+  auto const status = ownedArenaExecutor.Encode(Etc::Image::Format::RGBA8, Etc::ErrorMetric::RGBA, 40, 2, 4);
+  ASSERT_FALSE(Etc::IsError(status));
+  std::unique_ptr<unsigned char[]> expectedBits(ownedArenaExecutor.GetEncodingBits());
+
+  Etc::Block4x4EncodingArena arena;
+  size_t allocatedBytes = 0;
+  for (int encode = 0; encode < 2; encode++) {
+    Etc::Image image(imageData_.data(), uiWidth, uiHeight, Etc::ErrorMetric::RGBA, &arena);
+    Etc::ThreadedExecutor executor(image);
+    ASSERT_EQ(executor.Encode(Etc::Image::Format::RGBA8, Etc::ErrorMetric::RGBA, 40, 2, 4), status);
+    std::unique_ptr<unsigned char[]> bits(executor.GetEncodingBits());
+    ASSERT_EQ(executor.GetEncodingBitsBytes(), ownedArenaExecutor.GetEncodingBitsBytes());
+    ASSERT_EQ(memcmp(bits.get(), expectedBits.get(), executor.GetEncodingBitsBytes()), 0);
+
+    // the second image of the same size reuses the first image's storage
+    if (encode == 0) {
+      allocatedBytes = arena.GetAllocatedBytes();
+      ASSERT_GT(allocatedBytes, 0u);
+    } else {
+      ASSERT_EQ(arena.GetAllocatedBytes(), allocatedBytes);
+    }
+  }
+}
+
+TEST_F(ThreadedExecutorTest, EncodeIntoCallerBuffer) {
+  constexpr unsigned int uiWidth = 100;
+  constexpr unsigned int uiHeight = 60;
+
+  Etc::Image ownedBitsImage(imageData_.data(), uiWidth, uiHeight, Etc::ErrorMetric::RGBA);
+  Etc::ThreadedExecutor ownedBitsExecutor(ownedBitsImage);
+  auto const status = ownedBitsExecutor.Encode(Etc::Image::Format::RG11, Etc::ErrorMetric::RGBA, 40, 2, 4);
+  ASSERT_FALSE(Etc::IsError(status));
+  std::unique_ptr<unsigned char[]> expectedBits(ownedBitsExecutor.GetEncodingBits());
+
+  unsigned int const uiBytes = Etc::GetEncodingBitsBytes(uiWidth, uiHeight, Etc::Image::Format::RG11);
+  ASSERT_EQ(uiBytes, ownedBitsExecutor.GetEncodingBitsBytes());
+
+  // one spare byte on each side to catch writes outside the span
+  std::vector<unsigned char> buffer(uiBytes + 2, 0xA5);
+  unsigned int uiExtendedWidth, uiExtendedHeight;
+  int iEncodingTime;
+
+  auto const tooSmallStatus = Etc::Encode(imageData_.data(), uiWidth, uiHeight, Etc::Image::Format::RG11,
+    Etc::ErrorMetric::RGBA, 40, 2, 4, &buffer[1], uiBytes - 1, &uiExtendedWidth, &uiExtendedHeight, &iEncodingTime);
+  ASSERT_TRUE(tooSmallStatus & Etc::Executor::ERROR_ENCODING_BITS_BUFFER_TOO_SMALL);
+  ASSERT_EQ(buffer[1], 0xA5);
+
+  ASSERT_EQ(Etc::Encode(imageData_.data(), uiWidth, uiHeight, Etc::Image::Format::RG11,
+    Etc::ErrorMetric::RGBA, 40, 2, 4, &buffer[1], uiBytes, &uiExtendedWidth, &uiExtendedHeight, &iEncodingTime), status);
+  ASSERT_EQ(uiExtendedWidth, ownedBitsImage.GetExtendedWidth());
+  ASSERT_EQ(uiExtendedHeight, ownedBitsImage.GetExtendedHeight());
+  ASSERT_EQ(memcmp(&buffer[1], expectedBits.get(), uiBytes), 0);
+  ASSERT_EQ(buffer.front(), 0xA5);
+  ASSERT_EQ(buffer.back(), 0xA5);
+}
+
+TEST_F(ThreadedExecutorTest, EncodeFromIntegerSources) {
+  constexpr unsigned int uiWidth = 70;
+  constexpr unsigned int uiHeight = 50;
+  constexpr unsigned int uiComponents = uiWidth * uiHeight * 4;
+
+  std::mt19937 gen(SEED);
+  std::uniform_int_distribution<unsigned int> dis(0, 65535);
+
+  std::vector<unsigned char> imageData8(uiComponents);
+  std::vector<unsigned short> imageData16(uiComponents);
+  std::vector<float> imageData8AsFloat(uiComponents);
+  std::vector<float> imageData16AsFloat(uiComponents);
+  for (unsigned int uiComponent = 0; uiComponent < uiComponents; uiComponent++) {
+    unsigned int const value = dis(gen);
+    imageData16[uiComponent] = static_cast<unsigned short>(value);
+    imageData8[uiComponent] = static_cast<unsigned char>(value >> 8);
+    imageData16AsFloat[uiComponent] = imageData16[uiComponent] / 65535.0f;
+    imageData8AsFloat[uiComponent] = imageData8[uiComponent] / 255.0f;
+  }
+
+  auto encode = [](auto *source) {
+    Etc::Image image(source, uiWidth, uiHeight, Etc::ErrorMetric::RGBA);
+    Etc::ThreadedExecutor executor(image);
+    EXPECT_FALSE(Etc::IsError(executor.Encode(Etc::Image::Format::RGBA8, Etc::ErrorMetric::RGBA, 30, 2, 4)));
+    std::unique_ptr<unsigned char[]> bits(executor.GetEncodingBits());
+    return std::vector<unsigned char>(bits.get(), bits.get() + executor.GetEncodingBitsBytes());
+  };
+
+  // the integer sources are converted per block exactly like a float copy of the image would be
+  ASSERT_EQ(encode(static_cast<const unsigned char *>(imageData8.data())), encode(imageData8AsFloat.data()));
+  ASSERT_EQ(encode(static_cast<const unsigned short *>(imageData16.data())), encode(imageData16AsFloat.data()));
+}
+
+TEST_F(ThreadedExecutorTest, EncodeMipmapsFromRGBA8Source) {
+  constexpr unsigned int uiWidth = 96;
+  constexpr unsigned int uiHeight = 64;
+  constexpr unsigned int uiMipmaps = 7;
+  constexpr unsigned int uiComponents = uiWidth * uiHeight * 4;
+
+  std::mt19937 gen(SEED);
+  std::uniform_int_distribution<unsigned int> dis(0, 255);
+
+  std::vector<unsigned char> imageData8(uiComponents);
+  std::vector<float> imageData8AsFloat(uiComponents);
+  for (unsigned int uiComponent = 0; uiComponent < uiComponents; uiComponent++) {
+    imageData8[uiComponent] = static_cast<unsigned char>(dis(gen));
+    imageData8AsFloat[uiComponent] = imageData8[uiComponent] / 255.0f;
+  }
+
+  auto encode = [](auto *source, Etc::MipFilter filter, unsigned int flags) {
+    std::vector<Etc::RawImage> mipmaps(uiMipmaps);
+    int msEncodingTime;
+    Etc::EncodeMipmaps(source, uiWidth, uiHeight, Etc::Image::Format::RGBA8, Etc::ErrorMetric::RGBA, 30, 2, 4,
+                       uiMipmaps, flags, mipmaps.data(), &msEncodingTime, false, nullptr, nullptr, UINT_MAX, filter);
+
+    std::vector<unsigned char> bits;
+    for (Etc::RawImage const& mipmap : mipmaps) {
+      EXPECT_NE(mipmap.paucEncodingBits, nullptr);
+      bits.insert(bits.end(), mipmap.paucEncodingBits.get(), mipmap.paucEncodingBits.get() + mipmap.uiEncodingBitsBytes);
+    }
+    return bits;
+  };
+
+  // the rows of the RGBA8 source are converted to float as a float copy of it would be, down to the bits
+  for (Etc::MipFilter filter : { Etc::MipFilter::LANCZOS3, Etc::MipFilter::HALVE_BOX, Etc::MipFilter::HALVE_KAISER }) {
+    ASSERT_EQ(encode(static_cast<const unsigned char *>(imageData8.data()), filter, Etc::FILTER_WRAP_NONE),
+              encode(imageData8AsFloat.data(), filter, Etc::FILTER_WRAP_NONE));
+  }
+}
+
+TEST_F(ThreadedExecutorTest, ContiguousSchedulingMatchesStrided) {
+  constexpr unsigned int uiWidth = 256;
+  constexpr unsigned int uiHeight = 256;
+
+  Etc::Image stridedImage(imageData_.data(), uiWidth, uiHeight, Etc::ErrorMetric::RGBA);
+  Etc::ThreadedExecutor stridedExecutor(stridedImage);
+  auto const status = stridedExecutor.Encode(Etc::Image::Format::RGBA8, Etc::ErrorMetric::RGBA, 60, 3, 4);
+  ASSERT_FALSE(Etc::IsError(status));
+  std::unique_ptr<unsigned char[]> expectedBits(stridedExecutor.GetEncodingBits());
+
+  Etc::Image image(imageData_.data(), uiWidth, uiHeight, Etc::ErrorMetric::RGBA);
+  Etc::ThreadedExecutor executor(image);
+  executor.SetScheduling(Etc::ThreadedExecutor::Scheduling::CONTIGUOUS);
+  ASSERT_EQ(executor.Encode(Etc::Image::Format::RGBA8, Etc::ErrorMetric::RGBA, 60, 3, 4), status);
+  std::unique_ptr<unsigned char[]> bits(executor.GetEncodingBits());
+  ASSERT_EQ(executor.GetEncodingBitsBytes(), stridedExecutor.GetEncodingBitsBytes());
+  ASSERT_EQ(memcmp(bits.get(), expectedBits.get(), executor.GetEncodingBitsBytes()), 0);
+}
+
+TEST_F(ThreadedExecutorTest, IncrementalPrioritization) {
+  constexpr unsigned int uiWidth = 256;
+  constexpr unsigned int uiHeight = 256;
+
+  Etc::Image sortedImage(imageData_.data(), uiWidth, uiHeight, Etc::ErrorMetric::RGBA);
+  Etc::ThreadedExecutor sortedExecutor(sortedImage);
+  ASSERT_FALSE(Etc::IsError(sortedExecutor.Encode(Etc::Image::Format::RGB8, Etc::ErrorMetric::RGBA, 70, 1, 4)));
+  delete[] sortedExecutor.GetEncodingBits();
+
+  std::unique_ptr<unsigned char[]> expectedBits;
+  for (unsigned int jobs : { 1u, 3u }) {
+    Etc::Image image(imageData_.data(), uiWidth, uiHeight, Etc::ErrorMetric::RGBA);
+    Etc::ThreadedExecutor executor(image);
+    executor.SetPrioritization(Etc::ThreadedExecutor::Prioritization::INCREMENTAL);
+    ASSERT_FALSE(Etc::IsError(executor.Encode(Etc::Image::Format::RGB8, Etc::ErrorMetric::RGBA, 70, jobs, 4)));
+    std::unique_ptr<unsigned char[]> bits(executor.GetEncodingBits());
+
+    // the queue orders blocks differently, but should end up just as good
+    EXPECT_NEAR(image.GetError(), sortedImage.GetError(), 0.001f * sortedImage.GetError());
+
+    // and its result must not depend on the number of jobs
+    if (expectedBits) {
+      ASSERT_EQ(memcmp(bits.get(), expectedBits.get(), executor.GetEncodingBitsBytes()), 0);
+    } else {
+      expectedBits = std::move(bits);
+    }
+  }
 }
 
 int main(int argc, char **argv) {
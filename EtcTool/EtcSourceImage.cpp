@@ -46,6 +46,8 @@ namespace Etc
 		m_uiWidth = 0;
 		m_uiHeight = 0;
 		m_pafrgbaPixels = nullptr;
+		m_paucPixels = nullptr;
+		m_boolRGBA16 = false;
 
 		SetName(a_pstrFilename);
 
@@ -64,6 +66,8 @@ namespace Etc
 		m_uiWidth = a_uiSourceWidth;
 		m_uiHeight = a_uiSourceHeight;
 		m_pafrgbaPixels = a_pafrgbaSource;
+		m_paucPixels = nullptr;
+		m_boolRGBA16 = false;
 
 	}
 	// ----------------------------------------------------------------------------------------------------
@@ -88,6 +92,7 @@ namespace Etc
 			delete[] m_pafrgbaPixels;
 			m_pafrgbaPixels = nullptr;
 		}
+		FreePixels();
 		m_uiWidth = 0;
 		m_uiHeight = 0;
 	}
@@ -122,11 +127,28 @@ namespace Etc
 		if (paucPixels == nullptr)
 		{
 			//we can load 8 or 16 bit pngs
-			int iBitDepth = 16;
-			int error = lodepng_decode_file(&paucPixels,
-				(unsigned int*)&iWidth, (unsigned int*)&iHeight,
-				m_pstrFilename,
-				LCT_RGBA, iBitDepth);
+			//decode to 16 bits only if the png has them, so that an 8 bit png takes 4 bytes per pixel
+			unsigned char *paucFile = nullptr;
+			size_t fileSize = 0;
+			int error = lodepng_load_file(&paucFile, &fileSize, m_pstrFilename);
+
+			LodePNGState state;
+			lodepng_state_init(&state);
+			if (!error)
+			{
+				error = lodepng_inspect((unsigned int*)&iWidth, (unsigned int*)&iHeight, &state, paucFile, fileSize);
+			}
+
+			int iBitDepth = (state.info_png.color.bitdepth > 8) ? 16 : 8;
+			if (!error)
+			{
+				error = lodepng_decode_memory(&paucPixels,
+					(unsigned int*)&iWidth, (unsigned int*)&iHeight,
+					paucFile, fileSize,
+					LCT_RGBA, iBitDepth);
+			}
+			lodepng_state_cleanup(&state);
+			free(paucFile);
 
 			bool16BitImage = (iBitDepth == 16) ? true : false;
 			if (error)
@@ -161,49 +183,100 @@ namespace Etc
 			m_uiHeight = iHeight;
 		}
 
-		m_pafrgbaPixels = new ColorFloatRGBA[m_uiWidth * m_uiHeight];
-		assert(m_pafrgbaPixels);
-
 		int iBytesPerPixel = bool16BitImage ? 8 : 4;
-		unsigned char *pucPixel;	// = &paucPixels[(iBlockY * iWidth + iBlockX) * iBytesPerPixel];
-		ColorFloatRGBA *pfrgbaPixel = m_pafrgbaPixels;
 
-		// convert pixels from RGBA* to ColorFloatRGBA
-		for (unsigned int uiV = iBlockY; uiV < (iBlockY+m_uiHeight); ++uiV)
+		// in 1 block mode, keep only the rows of the block
+		if (m_uiWidth != (unsigned int)iWidth || m_uiHeight != (unsigned int)iHeight)
 		{
-			// reset coordinate for each row
-			pucPixel = &paucPixels[(uiV * iWidth + iBlockX) * iBytesPerPixel];
+			unsigned char *paucBlock = (unsigned char *)malloc(m_uiWidth * m_uiHeight * iBytesPerPixel);
+			assert(paucBlock);
 
-			// read each row
-			for (unsigned int uiH = iBlockX; uiH < (iBlockX+m_uiWidth); ++uiH)
+			for (unsigned int uiRow = 0; uiRow < m_uiHeight; uiRow++)
 			{
-				if (bool16BitImage)
-				{
-						unsigned short ushR = (pucPixel[0]<<8) + pucPixel[1];
-						unsigned short ushG = (pucPixel[2]<<8) + pucPixel[3];
-						unsigned short ushB = (pucPixel[4]<<8) + pucPixel[5];
-						unsigned short ushA = (pucPixel[6]<<8) + pucPixel[7];
-
-						*pfrgbaPixel++ = ColorFloatRGBA((float)ushR / 65535.0f,
-														(float)ushG / 65535.0f,
-														(float)ushB / 65535.0f,
-														(float)ushA / 65535.0f);
-				}
-				else
-				{
-						*pfrgbaPixel++ = ColorFloatRGBA::ConvertFromRGBA8(pucPixel[0], pucPixel[1],
-																			pucPixel[2], pucPixel[3]);
-				}
-
-				pucPixel += iBytesPerPixel;
+				memcpy(&paucBlock[uiRow * m_uiWidth * iBytesPerPixel],
+						&paucPixels[((iBlockY + uiRow) * iWidth + iBlockX) * iBytesPerPixel],
+						m_uiWidth * iBytesPerPixel);
 			}
+
+#if USE_STB_IMAGE_LOAD
+			stbi_image_free(paucPixels);
+#else
+			free(paucPixels);
+#endif
+			paucPixels = paucBlock;
 		}
 
+		// png stores 16 bit channels big endian
+		if (bool16BitImage)
+		{
+			unsigned int uiChannels = m_uiWidth * m_uiHeight * 4;
+			unsigned short *paushChannel = (unsigned short *)paucPixels;
+			for (unsigned int uiChannel = 0; uiChannel < uiChannels; uiChannel++)
+			{
+				paushChannel[uiChannel] = (unsigned short)((paucPixels[2 * uiChannel] << 8) + paucPixels[2 * uiChannel + 1]);
+			}
+		}
+
+		m_paucPixels = paucPixels;
+		m_boolRGBA16 = bool16BitImage;
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	// convert the pixels that were read to ColorFloatRGBA the first time they are asked for
+	//
+	ColorFloatRGBA * SourceImage::GetPixels(void)
+	{
+		if (m_pafrgbaPixels != nullptr || m_paucPixels == nullptr)
+		{
+			return m_pafrgbaPixels;
+		}
+
+		unsigned int uiPixels = m_uiWidth * m_uiHeight;
+
+		m_pafrgbaPixels = new ColorFloatRGBA[uiPixels];
+		assert(m_pafrgbaPixels);
+
+		if (m_boolRGBA16)
+		{
+			const unsigned short *paushPixel = (const unsigned short *)m_paucPixels;
+			for (unsigned int uiPixel = 0; uiPixel < uiPixels; uiPixel++)
+			{
+				m_pafrgbaPixels[uiPixel] = ColorFloatRGBA((float)paushPixel[0] / 65535.0f,
+															(float)paushPixel[1] / 65535.0f,
+															(float)paushPixel[2] / 65535.0f,
+															(float)paushPixel[3] / 65535.0f);
+				paushPixel += 4;
+			}
+		}
+		else
+		{
+			const unsigned char *paucPixel = m_paucPixels;
+			for (unsigned int uiPixel = 0; uiPixel < uiPixels; uiPixel++)
+			{
+				m_pafrgbaPixels[uiPixel] = ColorFloatRGBA::ConvertFromRGBA8(paucPixel[0], paucPixel[1],
+																			paucPixel[2], paucPixel[3]);
+				paucPixel += 4;
+			}
+		}
+
+		FreePixels();
+
+		return m_pafrgbaPixels;
+	}
+
+	// ----------------------------------------------------------------------------------------------------
+	//
+	void SourceImage::FreePixels(void)
+	{
+		if (m_paucPixels != nullptr)
+		{
 #if USE_STB_IMAGE_LOAD
-		stbi_image_free(paucPixels);
+			stbi_image_free(m_paucPixels);
 #else
-		free(paucPixels);
+			free(m_paucPixels);
 #endif
+			m_paucPixels = nullptr;
+		}
 	}
 
 	// ----------------------------------------------------------------------------------------------------
@@ -253,7 +326,7 @@ namespace Etc
 	{
 		int iPixels = m_uiWidth * m_uiHeight;
 
-		ColorFloatRGBA *pfrgbaPixel = m_pafrgbaPixels;
+		ColorFloatRGBA *pfrgbaPixel = GetPixels();
 		for (int iPixel = 0; iPixel < iPixels; iPixel++)
 		{
 			float fX = 2.0f*pfrgbaPixel->fR - 1.0f;
@@ -62,31 +62,47 @@ namespace Etc
 			return m_uiHeight; 
 		}
 
-		inline ColorFloatRGBA * GetPixels(void)
+		// the pixels as float
+		// the first call converts the pixels that were read, and frees them
+		ColorFloatRGBA * GetPixels(void);
+
+		// the pixels as read, until GetPixels() converts them to float
+		// an image is read as RGBA8 unless its file has more than 8 bits per channel
+		inline const unsigned char * GetPixelsRGBA8(void)
 		{
-			return m_pafrgbaPixels;
+			return m_boolRGBA16 ? nullptr : m_paucPixels;
+		}
+
+		inline const unsigned short * GetPixelsRGBA16(void)
+		{
+			return m_boolRGBA16 ? (const unsigned short *)m_paucPixels : nullptr;
 		}
 
 		inline ColorFloatRGBA * GetPixel(unsigned int a_uiColumn, unsigned int a_uiRow)
 		{
-			if (m_pafrgbaPixels == nullptr)
+			ColorFloatRGBA *pafrgbaPixels = GetPixels();
+			if (pafrgbaPixels == nullptr)
 			{
 				return nullptr;
 			}
 
-			return &m_pafrgbaPixels[a_uiRow*m_uiWidth + a_uiColumn];
+			return &pafrgbaPixels[a_uiRow*m_uiWidth + a_uiColumn];
 		}
 
 	private:
 
 		void Read(int a_iPixelX = -1, int a_iPixelY = -1);
 
+		void FreePixels(void);
+
 		char *m_pstrFilename;				// includes directory path and file extension
 		char *m_pstrName;					// file name with directory path and file extension removed
 		char *m_pstrFileExtension;
 		unsigned int m_uiWidth;				// not necessarily block aligned
 		unsigned int m_uiHeight;			// not necessarily block aligned
 		ColorFloatRGBA *m_pafrgbaPixels;
+		unsigned char *m_paucPixels;		// RGBA8, or native RGBA16 if m_boolRGBA16, until converted to float
+		bool m_boolRGBA16;
 
 	};
 
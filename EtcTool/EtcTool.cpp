@@ -39,6 +39,7 @@ that can be created.
 #include "EtcImage.h"
 #include "EtcErrorMetric.h"
 #include "EtcBlock4x4EncodingBits.h"
+#include "EtcDiskCache.h"
 
 #include "EtcAnalysis.h"
 #include "EtcThreadedExecutor.h"
@@ -46,6 +47,7 @@ that can be created.
 #include <cassert>
 #include <cstdlib>
 #include <cstring>
+#include <memory>
 
 using namespace Etc;
 
@@ -93,6 +95,10 @@ public:
 		boolNormalizeXYZ = false;
 		mipmaps = 1;
 		mipFilterFlags = Etc::FILTER_WRAP_NONE;
+		mipSourceFilteredLevels = UINT_MAX;
+		mipFilter = MipFilter::LANCZOS3;
+		pstrDiskCacheDirectory = nullptr;
+		diskCacheGranularity = DiskCache::Granularity::BLOCK_ROW;
 	}
 
 	bool ProcessCommandLineArguments(int a_iArgs, const char *a_apstrArgs[]);
@@ -117,6 +123,10 @@ public:
 	bool boolNormalizeXYZ;
 	int mipmaps;
 	unsigned int mipFilterFlags;
+	unsigned int mipSourceFilteredLevels;
+	MipFilter mipFilter;
+	char *pstrDiskCacheDirectory;
+	DiskCache::Granularity diskCacheGranularity;
 };
 
 #include "EtcFileHeader.h"
@@ -154,9 +164,22 @@ int main(int argc, const char * argv[])
 		sourceimage.NormalizeXYZ();
 	}
 
+	// the encoders read 8 and 16 bit sources as they are, and only the analysis needs a float copy of the image
+	if (commands.pstrAnalysisDirectory)
+	{
+		sourceimage.GetPixels();
+	}
+
 	unsigned int uiSourceWidth = sourceimage.GetWidth();
 	unsigned int uiSourceHeight = sourceimage.GetHeight();
 
+	DiskCache *pdiskcache = nullptr;
+	if (commands.pstrDiskCacheDirectory)
+	{
+		CreateNewDir(commands.pstrDiskCacheDirectory);
+		pdiskcache = new DiskCache(commands.pstrDiskCacheDirectory, commands.diskCacheGranularity);
+	}
+
 	if(commands.mipmaps != 1)
 	{
 		int iEncodingTime_ms;
@@ -178,6 +201,16 @@ int main(int argc, const char * argv[])
 
 		Etc::RawImage *pMipmapImages = new Etc::RawImage[commands.mipmaps];
 
+		// the halving filters average the light of sRGB formats, not their encoded values
+		unsigned int mipFilterFlags = commands.mipFilterFlags;
+		if (commands.mipFilter != MipFilter::LANCZOS3 &&
+			(commands.format == Image::Format::SRGB8 ||
+			commands.format == Image::Format::SRGBA8 ||
+			commands.format == Image::Format::SRGB8A1))
+		{
+			mipFilterFlags |= Etc::FILTER_SRGB;
+		}
+
 		if (commands.verboseOutput)
 		{
 			printf("Encoding:\n");
@@ -185,17 +218,45 @@ int main(int argc, const char * argv[])
 			printf("  encoding =  %s\n", Image::EncodingFormatToString(commands.format));
 			printf("  error metric: %s\n", ErrorMetricToString(commands.e_ErrMetric));
 		}
-		Etc::EncodeMipmaps((float *)sourceimage.GetPixels(),
-			uiSourceWidth, uiSourceHeight,
-			commands.format,
-			commands.e_ErrMetric,
-			commands.fEffort,
-			commands.uiJobs,
-			MAX_JOBS,
-			commands.mipmaps,
-			commands.mipFilterFlags,
-			pMipmapImages,
-			&iEncodingTime_ms);
+		// there is no 16 bit mipmap source, so a 16 bit image is filtered as float
+		if (sourceimage.GetPixelsRGBA8())
+		{
+			Etc::EncodeMipmaps(sourceimage.GetPixelsRGBA8(),
+				uiSourceWidth, uiSourceHeight,
+				commands.format,
+				commands.e_ErrMetric,
+				commands.fEffort,
+				commands.uiJobs,
+				MAX_JOBS,
+				commands.mipmaps,
+				mipFilterFlags,
+				pMipmapImages,
+				&iEncodingTime_ms,
+				false,
+				nullptr,
+				pdiskcache,
+				commands.mipSourceFilteredLevels,
+				commands.mipFilter);
+		}
+		else
+		{
+			Etc::EncodeMipmaps((float *)sourceimage.GetPixels(),
+				uiSourceWidth, uiSourceHeight,
+				commands.format,
+				commands.e_ErrMetric,
+				commands.fEffort,
+				commands.uiJobs,
+				MAX_JOBS,
+				commands.mipmaps,
+				mipFilterFlags,
+				pMipmapImages,
+				&iEncodingTime_ms,
+				false,
+				nullptr,
+				pdiskcache,
+				commands.mipSourceFilteredLevels,
+				commands.mipFilter);
+		}
 		if (commands.verboseOutput)
 		{
 			printf("    encode time = %dms\n", iEncodingTime_ms);
@@ -225,16 +286,51 @@ int main(int argc, const char * argv[])
 			printf("  encoding =  %s\n", Image::EncodingFormatToString(commands.format));
 			printf("  error metric: %s\n", ErrorMetricToString(commands.e_ErrMetric));
 		}
-		Etc::Encode((float *)sourceimage.GetPixels(),
-					uiSourceWidth, uiSourceHeight,
-					commands.format,
-					commands.e_ErrMetric,
-					commands.fEffort,
-					commands.uiJobs,
-					MAX_JOBS,
-					&paucEncodingBits, &uiEncodingBitsBytes,
-					&uiExtendedWidth, &uiExtendedHeight,
-					&iEncodingTime_ms);
+		if (sourceimage.GetPixelsRGBA8())
+		{
+			Etc::Encode(sourceimage.GetPixelsRGBA8(),
+						uiSourceWidth, uiSourceHeight,
+						commands.format,
+						commands.e_ErrMetric,
+						commands.fEffort,
+						commands.uiJobs,
+						MAX_JOBS,
+						&paucEncodingBits, &uiEncodingBitsBytes,
+						&uiExtendedWidth, &uiExtendedHeight,
+						&iEncodingTime_ms,
+						false,
+						pdiskcache);
+		}
+		else if (sourceimage.GetPixelsRGBA16())
+		{
+			Etc::Encode(sourceimage.GetPixelsRGBA16(),
+						uiSourceWidth, uiSourceHeight,
+						commands.format,
+						commands.e_ErrMetric,
+						commands.fEffort,
+						commands.uiJobs,
+						MAX_JOBS,
+						&paucEncodingBits, &uiEncodingBitsBytes,
+						&uiExtendedWidth, &uiExtendedHeight,
+						&iEncodingTime_ms,
+						false,
+						pdiskcache);
+		}
+		else
+		{
+			Etc::Encode((float *)sourceimage.GetPixels(),
+						uiSourceWidth, uiSourceHeight,
+						commands.format,
+						commands.e_ErrMetric,
+						commands.fEffort,
+						commands.uiJobs,
+						MAX_JOBS,
+						&paucEncodingBits, &uiEncodingBitsBytes,
+						&uiExtendedWidth, &uiExtendedHeight,
+						&iEncodingTime_ms,
+						false,
+						pdiskcache);
+		}
 		if (commands.verboseOutput)
 		{
 			printf("    encode time = %dms\n", iEncodingTime_ms);
@@ -256,11 +352,30 @@ int main(int argc, const char * argv[])
 			printf("  encoding =  %s\n", Image::EncodingFormatToString(commands.format));
 			printf("  error metric: %s\n", ErrorMetricToString(commands.e_ErrMetric));
 		}
-		Etc::Image image((float *)sourceimage.GetPixels(),
-							uiSourceWidth, uiSourceHeight,
-							commands.e_ErrMetric);
+		// declared before the executor, so that the image outlives it
+		std::unique_ptr<Etc::Image> pimage;
+		if (sourceimage.GetPixelsRGBA8())
+		{
+			pimage.reset(new Etc::Image(sourceimage.GetPixelsRGBA8(),
+										uiSourceWidth, uiSourceHeight,
+										commands.e_ErrMetric));
+		}
+		else if (sourceimage.GetPixelsRGBA16())
+		{
+			pimage.reset(new Etc::Image(sourceimage.GetPixelsRGBA16(),
+										uiSourceWidth, uiSourceHeight,
+										commands.e_ErrMetric));
+		}
+		else
+		{
+			pimage.reset(new Etc::Image((float *)sourceimage.GetPixels(),
+										uiSourceWidth, uiSourceHeight,
+										commands.e_ErrMetric));
+		}
+		Etc::Image &image = *pimage;
 		Etc::ThreadedExecutor executor(image);
 		executor.m_bVerboseOutput = commands.verboseOutput;
+		executor.SetDiskCache(pdiskcache);
 		
 		auto [msEncodingTime, encStatus] = TimeEncode(executor, commands.format, commands.e_ErrMetric, commands.fEffort, commands.uiJobs,MAX_JOBS);
 		if (commands.verboseOutput)
@@ -293,6 +408,16 @@ int main(int argc, const char * argv[])
 
 	}
 
+	if (pdiskcache)
+	{
+		if (commands.verboseOutput)
+		{
+			printf("DiskCache: %s (%u hits, %u misses)\n", commands.pstrDiskCacheDirectory,
+					pdiskcache->GetHits(), pdiskcache->GetMisses());
+		}
+		delete pdiskcache;
+	}
+
 	return 0;
 }
 
@@ -723,6 +848,103 @@ bool Commands::ProcessCommandLineArguments(int a_iArgs, const char *a_apstrArgs[
 				}
 			}
 		}
+		else if (strcmp(a_apstrArgs[iArg], "-mipcascade") == 0)
+		{
+			++iArg;
+
+			if (iArg >= (a_iArgs))
+			{
+				printf("Error: missing level number parameter for -mipcascade\n");
+				return true;
+			}
+			else
+			{
+				unsigned int ui;
+				int result = sscanf(a_apstrArgs[iArg], "%u", &ui);
+				if (result == 1)
+				{
+					mipSourceFilteredLevels = ui;
+				}
+				else
+				{
+					printf("Error: -mipcascade argument needs to be a number\n");
+					return true;
+				}
+			}
+		}
+		else if (strcmp(a_apstrArgs[iArg], "-mipfilter") == 0)
+		{
+			++iArg;
+
+			if (iArg >= (a_iArgs))
+			{
+				printf("Error: missing filter parameter for -mipfilter\n");
+				return true;
+			}
+			else
+			{
+				if (0 == strcmp(a_apstrArgs[iArg], "resample"))
+				{
+					mipFilter = MipFilter::LANCZOS3;
+				}
+				else if (0 == strcmp(a_apstrArgs[iArg], "box"))
+				{
+					mipFilter = MipFilter::HALVE_BOX;
+				}
+				else if (0 == strcmp(a_apstrArgs[iArg], "kaiser"))
+				{
+					mipFilter = MipFilter::HALVE_KAISER;
+				}
+				else if (0 == strcmp(a_apstrArgs[iArg], "lanczos3"))
+				{
+					mipFilter = MipFilter::HALVE_LANCZOS3;
+				}
+				else
+				{
+					printf("Error: -mipfilter argument needs to be resample, box, kaiser or lanczos3\n");
+					return true;
+				}
+			}
+		}
+		else if (strcmp(a_apstrArgs[iArg], "-diskcache") == 0)
+		{
+			++iArg;
+
+			if (iArg >= (a_iArgs))
+			{
+				printf("Error: missing folder parameter for -diskcache\n");
+				return true;
+			}
+			else
+			{
+				pstrDiskCacheDirectory = new char[strlen(a_apstrArgs[iArg]) + 1];
+				strcpy(pstrDiskCacheDirectory, a_apstrArgs[iArg]);
+				FixSlashes(pstrDiskCacheDirectory);
+			}
+		}
+		else if (strcmp(a_apstrArgs[iArg], "-diskcachegranularity") == 0)
+		{
+			++iArg;
+
+			if (iArg >= (a_iArgs))
+			{
+				printf("Error: missing parameter for -diskcachegranularity\n");
+				return true;
+			}
+			else if (strcmp(a_apstrArgs[iArg], "image") == 0)
+			{
+				diskCacheGranularity = DiskCache::Granularity::IMAGE;
+			}
+			else if (strcmp(a_apstrArgs[iArg], "row") == 0)
+			{
+				diskCacheGranularity = DiskCache::Granularity::BLOCK_ROW;
+			}
+			else
+			{
+				printf("Error: -diskcachegranularity argument needs to be image or row\n");
+				return true;
+			}
+		}
 		else if (a_apstrArgs[iArg][0] == '-')
         {
 			printf("Error: unknown option (%s)\n", a_apstrArgs[iArg]);
@@ -793,6 +1015,10 @@ void Commands::PrintUsageMessage(void)
 	printf("    -blockAtHV <H V>              encodes a single block that contains the\n");
 	printf("                                  pixel specified by the H V coordinates\n");
 	printf("    -compare <comparison_image>   compares source_image to comparison_image\n");
+	printf("    -diskcache <cache_folder>     reuses the encodings kept in cache_folder by earlier\n");
+	printf("                                  runs with the same settings, and keeps new ones\n");
+	printf("    -diskcachegranularity <image|row>\n");
+	printf("                                  caches whole images or rows of blocks (default=row)\n");
 	printf("    -effort <amount>              number between 0 and 100\n");
 	printf("    -errormetric <error_metric>   specify the error metric, the options are\n");
 	printf("                                  rgba, rgbx, rec709, numeric and normalxyz\n");
@@ -805,6 +1031,11 @@ void Commands::PrintUsageMessage(void)
 	printf("                                  process\n");
 	printf("    -mipmaps or -m <mip_count>    sets the maximum number of mipaps to generate (default=1)\n");
 	printf("    -mipwrap or -w <x|y|xy>       sets the mipmap filter wrap mode (default=clamp)\n");
+	printf("    -mipcascade <level_count>     filters the mipmaps after the first level_count from\n");
+	printf("                                  the mipmap before them instead of the source image\n");
+	printf("    -mipfilter <filter>           resample (default) filters with Lanczos3 at any scale;\n");
+	printf("                                  box, kaiser and lanczos3 halve the mipmap before, in\n");
+	printf("                                  linear light for SRGB formats\n");
 	printf("\n");
 
 	exit(1);